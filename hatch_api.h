@@ -7,7 +7,11 @@
 #include <stdbool.h>
 #include <string.h>
 #include <immintrin.h>
+#ifdef _MSC_VER
 #include <intrin.h>
+#else
+#define __debugbreak() __builtin_trap()
+#endif
 
 typedef uint8_t   u8;
 typedef uint16_t  u16;
@@ -32,19 +36,21 @@ typedef union vec2 {
 	float _[2];
 } vec2;
 
+// The swizzle structs don't repeat the component names, as only MSVC allows that. The components before a swizzle are
+// padding with names of their own instead.
 typedef union vec3 {
 	struct { float x, y, z; };
-	struct { vec2 xy; float z; };
-	struct { float x; vec2 yz; };
+	struct { vec2 xy; };
+	struct { float _pad_x; vec2 yz; };
 	float _[3];
 } vec3;
 
 typedef union vec4 {
-	struct { vec3 xyz; float w; };
-	struct { float x; vec3 yzw; };
+	struct { vec3 xyz; float w; }; // first, so that vec4{xyz, w} and vec4{x, y, z, w} both work
+	struct { float x, y, z; };
+	struct { float _pad_x; vec3 yzw; };
 	struct { vec2 xy; vec2 zw; };
-	struct { float x; vec2 yz; float w; };
-	struct { float x, y, z, w; };
+	struct { float _pad_x2; vec2 yz; };
 	float _[4];
 	__m128 SSE;
 //#ifdef __cplusplus
@@ -63,17 +69,17 @@ typedef union ivec2 {
 
 typedef union ivec3 {
 	struct { int x, y, z; };
-	struct { ivec2 xy; int z; };
-	struct { int x; ivec2 yz; };
+	struct { ivec2 xy; };
+	struct { int _pad_x; ivec2 yz; };
 	int _[3];
 } ivec3;
 
 typedef union ivec4 {
 	struct { int x, y, z, w; };
 	struct { ivec2 xy; ivec2 zw; };
-	struct { int x; ivec2 yz; int w; };
-	struct { ivec3 xyz; int w; };
-	struct { int x; ivec3 yzw; };
+	struct { int _pad_x; ivec2 yz; };
+	struct { ivec3 xyz; };
+	struct { int _pad_x2; ivec3 yzw; };
 	int _[4];
 } ivec4;
 
@@ -85,6 +91,7 @@ typedef struct HT_StringView { // utf8-encoded string view, not null-terminated
 	inline HT_StringView(const char* _data, size_t _size) : data((char*)_data), size(_size) {}
 	inline HT_StringView(const char* _cstr) : data((char*)_cstr), size(_cstr ? strlen(_cstr) : 0) {}
 	inline HT_StringView(struct HT_String string); // needs to be defined after the HT_String struct
+	inline HT_StringView(struct HT_Name name); // needs to be defined after the HT_Name struct
 #endif
 } HT_StringView;
 
@@ -96,8 +103,22 @@ typedef struct HT_String { // utf8-encoded string, not null-terminated. TODO: we
 	size_t capacity;
 } HT_String;
 
+typedef u32 HT_NameID;
+
+// Interned, immutable string. Names with the same contents always have the same ID and share the same memory,
+// so two names can be compared by comparing their IDs. Create names with HT_API::InternName.
+typedef struct HT_Name {
+	union {
+		struct { char* data; size_t size; };
+		HT_StringView view;
+	};
+	HT_NameID id; // 0 for the empty name
+	HT_NameID folded_id; // ID of the lowercase version of this name. Names that match case-insensitively have the same folded ID.
+} HT_Name;
+
 #ifdef __cplusplus
 inline HT_StringView::HT_StringView(HT_String string) : data(string.data), size(string.size) {}
+inline HT_StringView::HT_StringView(HT_Name name) : data(name.data), size(name.size) {}
 #endif
 
 typedef enum HT_TypeKind {
@@ -159,7 +180,7 @@ typedef struct HT_ItemGroup {
 typedef struct HT_ItemHeader {
 	HT_ItemIndex prev;
 	HT_ItemIndex next;
-	HT_String name;
+	HT_Name name;
 } HT_ItemHeader;
 
 typedef struct HT_ItemHandleDecoded {
@@ -208,7 +229,9 @@ typedef struct HT_StaticExports {
 	void (*HT_UpdatePlugin)(struct HT_API* ht);
 } HT_StaticExports;
 
-#ifdef HT_STATIC_PLUGIN_ID
+// HT_DYNAMIC_PLUGIN is defined when the plugin is compiled into its own dynamic library, in which case the HT_EXPORT
+// functions are looked up by name and HT_STATIC_PLUGIN_ID is ignored.
+#if defined(HT_STATIC_PLUGIN_ID) && !defined(HT_DYNAMIC_PLUGIN)
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -228,25 +251,33 @@ HT_StaticExports HT__Concat(HT_STATIC_EXPORTS__, HT_STATIC_PLUGIN_ID) = { HT__St
 #ifdef __cplusplus
 } // extern "C"
 #endif
-#else
+#elif !defined(HT_DYNAMIC_PLUGIN)
 #ifndef HT_NO_STATIC_PLUGIN_EXPORTS
 #error HT_STATIC_PLUGIN_ID must be defined before including <hatch_api.h>
 #endif
 #endif
 
+#ifdef _WIN32
+#define HT__DLL_EXPORT __declspec(dllexport)
+#define HT__DLL_IMPORT __declspec(dllimport)
+#else
+#define HT__DLL_EXPORT __attribute__((visibility("default")))
+#define HT__DLL_IMPORT
+#endif
+
 #ifndef HT_EXPORT
 #ifdef __cplusplus
-#define HT_EXPORT extern "C" __declspec(dllexport)
+#define HT_EXPORT extern "C" HT__DLL_EXPORT
 #else
-#define HT_EXPORT __declspec(dllexport)
+#define HT_EXPORT HT__DLL_EXPORT
 #endif
 #endif
 
 #ifndef HT_IMPORT
 #ifdef __cplusplus
-#define HT_IMPORT extern "C" __declspec(dllimport)
+#define HT_IMPORT extern "C" HT__DLL_IMPORT
 #else
-#define HT_IMPORT __declspec(dllimport)
+#define HT_IMPORT HT__DLL_IMPORT
 #endif
 #endif
 
@@ -267,6 +298,28 @@ typedef struct HT_AssetViewerTabUpdate {
 
 typedef void (*TabUpdateProc)(struct HT_API* ht, const HT_AssetViewerTabUpdate* update_info);
 
+// A job. Runs on any thread of the worker pool.
+typedef void (*HT_JobProc)(void* user_data);
+
+// Counts the unfinished jobs that were submitted with it, so it can be waited on like a fence. Zero-initialize it before
+// submitting jobs; once WaitForCounter returns, it can be reused or freed.
+typedef struct HT_JobCounter {
+	volatile i32 pending;
+} HT_JobCounter;
+
+// Processes the range [begin, end). `worker_index` is in the range [0, GetWorkerCount()) and is unique
+// among the workers running at the same time, so it can be used to index into per-worker data.
+typedef void (*HT_ParallelForProc)(void* user_data, int worker_index, int begin, int end);
+
+// Accumulates the range [begin, end) into `partial_result`, which is private to the calling worker.
+typedef void (*HT_ParallelReduceProc)(void* user_data, void* partial_result, int begin, int end);
+
+// Combines `partial_result` into `result`.
+typedef void (*HT_ReduceCombineProc)(void* user_data, void* result, const void* partial_result);
+
+// Processes the items of `bucket` in the range [begin, end) of the item slots.
+typedef void (*HT_ItemGroupParallelForProc)(void* user_data, int worker_index, HT_ItemGroup* group, u32 bucket, u32 begin, u32 end);
+
 typedef struct HT_TabClass HT_TabClass;
 
 typedef struct HT_CustomTabUpdate {
@@ -501,10 +554,21 @@ struct HT_API {
 	// Returns 0 if the asset ref is invalid.
 	u64 (*AssetGetModtime)(HT_Asset asset);
 
+	// Returns the assets that `asset` refers to directly: the struct types and asset references in its data, or the data asset,
+	// code files and linker inputs of a plugin. Returns a temporary array (i.e. TempArenaPush).
+	HT_Asset* (*AssetGetDependencies)(HT_Asset asset, int* out_count);
+
+	// Returns every asset that depends on `asset`, directly or through other assets, i.e. everything that may be affected
+	// when `asset` changes. Direct dependents come first. Returns a temporary array (i.e. TempArenaPush).
+	HT_Asset* (*AssetGetDependents)(HT_Asset asset, int* out_count);
+
 	// Item group utilities
 	HT_ItemIndex (*ItemGroupAdd)(HT_ItemGroup* group);
 	void (*ItemGroupRemove)(HT_ItemGroup* group, HT_ItemIndex item);
 	void (*MoveItemToAfter)(HT_ItemGroup* group, HT_ItemIndex item, HT_ItemIndex move_after_this);
+
+	// Returns the interned name for `string`. Can be called from any thread. Interned names stay valid until the editor exits.
+	HT_Name (*InternName)(HT_StringView string);
 	
 	// -- Plugins -------------------------------------
 	
@@ -525,6 +589,55 @@ struct HT_API {
 	// The returned memory is uninitialized.
 	void* (*TempArenaPush)(size_t size, size_t align);
 	
+	// -- Multithreading -----------------------------
+	
+	// The procs passed to these functions run on a work-stealing worker pool shared by the editor and all plugins, with one
+	// worker per logical processor. Use it instead of starting threads of your own, so that the plugins don't oversubscribe
+	// the cores. The procs may only call the multithreading and profiling functions, since the rest of the API is not thread-safe.
+	// The parallel-for functions block until all work is done. If called from inside a job or a worker proc, the work is done
+	// on the calling thread.
+	//
+	// A plugin whose `update_on_worker_thread` option is set has its HT_UpdatePlugin called on the worker pool, in parallel with
+	// the other plugins. During the update, it may only call GetPluginData and the memory, multithreading and profiling functions, which
+	// then run on the calling worker thread. Use the `update_after` option to order it after the plugins whose results it reads.
+	// The other functions assert if they're called during such an update or from inside a job.
+	
+	// Returns the number of workers in the pool, including the calling thread.
+	int (*GetWorkerCount)();
+	
+	// Queues `proc(user_data)` to run on the pool and returns right away. If `counter` isn't NULL, it's incremented now
+	// and decremented once the job is done. Can be called from any thread, including from inside jobs.
+	void (*SubmitJob)(HT_JobProc proc, void* user_data, HT_JobCounter* counter);
+	
+	// Queues `proc(user_datas[i])` for each i in [0, count).
+	void (*SubmitJobs)(HT_JobProc proc, void** user_datas, int count, HT_JobCounter* counter);
+	
+	// Blocks until `counter` reaches zero. Meanwhile the calling thread runs queued jobs, so waiting from inside a job can't
+	// deadlock the pool. A ParallelReduce proc must not wait, since a job run meanwhile could use the same partial result.
+	void (*WaitForCounter)(HT_JobCounter* counter);
+	
+	// Splits the range [0, count) into batches of `batch_size` and calls `proc` on each batch.
+	// To process a DS_BucketArray, call this with `count` set to the number of buckets and `batch_size` set to 1.
+	void (*ParallelFor)(int count, int batch_size, HT_ParallelForProc proc, void* user_data);
+	
+	// Like ParallelFor, but each worker accumulates into its own partial result of `result_size` bytes. Every partial result
+	// starts as a copy of `*result`, which should therefore hold the identity value of the reduction. When all batches are done,
+	// the partial results are combined into `*result` in worker order, so the result is deterministic if `combine` is associative.
+	void (*ParallelReduce)(int count, int batch_size, HT_ParallelReduceProc proc, HT_ReduceCombineProc combine, void* user_data, void* result, size_t result_size);
+	
+	// Calls `proc` for runs of item slots, one bucket per batch. Use HT_MakeItemIndex(bucket, i) for i in [begin, end) to get the item indices.
+	// The order of the items in the group is not respected.
+	void (*ItemGroupParallelFor)(HT_ItemGroup* group, HT_ItemGroupParallelForProc proc, void* user_data);
+	
+	// -- Profiling ----------------------------------
+	
+	// The editor times every call into a plugin and shows the results in the Profiler tab, as a history of recent frames and
+	// a flame graph of the selected frame. These add zones of your own inside those calls. Zones nest, and each ProfileZoneBegin
+	// must be matched by a ProfileZoneEnd on the same thread; zones that are still open when the plugin call returns are
+	// ended with it. `label` is copied and truncated to 48 bytes, so it only needs to stay valid for the call. Can be called from jobs.
+	void (*ProfileZoneBegin)(const char* label);
+	void (*ProfileZoneEnd)();
+	
 	// -- Asset viewer -------------------------------
 	
 	// Returns the selected item handle in the properties panel for the selected asset or NULL if none
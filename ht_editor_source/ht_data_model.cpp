@@ -91,31 +91,16 @@ EXPORT void MoveAssetToInside(AssetTree* tree, Asset* asset, Asset* move_inside_
 }
 
 EXPORT Asset* GetAsset(AssetTree* tree, HT_Asset handle) {
-	DecodedHandle decoded = *(DecodedHandle*)&handle;
-	if (decoded.bucket_index < tree->assets.buckets_count) {
-		Asset* elems = tree->assets.buckets[decoded.bucket_index].elems;
-		Asset* asset = &elems[decoded.elem_index];
-		if (asset->handle == handle) {
-			return asset;
-		}
-	}
-	return NULL;
+	return (Asset*)DS_SlotMapGet(&tree->assets, (DS_SlotHandle)handle);
 }
 
 EXPORT Asset* MakeNewAsset(AssetTree* tree, AssetKind kind) {
-	DS_BucketArrayIndex index;
-	NEW_SLOT(&index, &tree->assets, &tree->first_free_asset, freelist_next);
-
-	Asset* asset = DS_BkArrGet(&tree->assets, index);
-
-	DecodedHandle asset_handle;
-	asset_handle.bucket_index = DS_BucketFromIndex(index);
-	asset_handle.elem_index = DS_SlotFromIndex(index);
-	asset_handle.generation = DecodeHandle(asset->handle).generation + 1; // first valid asset generation is always 1
-
-	memset(asset, 0, sizeof(*asset));
+	DS_SlotHandle handle;
+	Asset* asset = (Asset*)DS_SlotMapAdd(&tree->assets, &handle);
 	asset->kind = kind;
-	asset->handle = (HT_Asset)EncodeHandle(asset_handle);
+	asset->handle = (HT_Asset)handle;
+	DS_ArrInit(&asset->dependencies, HEAP);
+	DS_ArrInit(&asset->dependents, HEAP);
 	
 	STR_View name = "";
 	switch (kind) {
@@ -145,25 +130,89 @@ EXPORT Asset* MakeNewAsset(AssetTree* tree, AssetKind kind) {
 	//	name = "Untitled CPP File";
 	//}break;
 	}
-	StringInit(&asset->name, name);
+	asset->name = InternName(name);
 	
 	return asset;
 }
 
+// Makes the root asset and the built-in struct types
+EXPORT void InitAssetTree(AssetTree* tree) {
+	DS_SlotMapInit(&tree->assets, HEAP, 32);
+	tree->root = MakeNewAsset(tree, AssetKind_Root);
+	DS_MapInit(&tree->package_from_name, HEAP);
+	DS_ArrInit(&tree->struct_data_prefetch_queue, HEAP);
+
+	tree->name_and_type_struct_type = MakeNewAsset(tree, AssetKind_StructType);
+
+	StructMember name_member = {0};
+	name_member.name = InternName("Name");
+	name_member.type.kind = HT_TypeKind_String;
+	DS_ArrPush(&tree->name_and_type_struct_type->struct_type.members, name_member);
+
+	StructMember type_member = {0};
+	type_member.name = InternName("HT_Type");
+	type_member.type.kind = HT_TypeKind_Type;
+	DS_ArrPush(&tree->name_and_type_struct_type->struct_type.members, type_member);
+
+	ComputeStructLayout(tree, tree->name_and_type_struct_type);
+
+	tree->plugin_options_struct_type = MakeNewAsset(tree, AssetKind_StructType);
+
+	StructMember member_data = {0};
+	member_data.name = InternName("data_asset");
+	member_data.type.kind = HT_TypeKind_AssetRef;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_data);
+
+	StructMember member_source_files = {0};
+	member_source_files.name = InternName("code_files");
+	member_source_files.type.kind = HT_TypeKind_Array;
+	member_source_files.type.subkind = HT_TypeKind_AssetRef;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_source_files);
+
+	StructMember member_linker_inputs = {0};
+	member_linker_inputs.name = InternName("linker_inputs");
+	member_linker_inputs.type.kind = HT_TypeKind_Array;
+	member_linker_inputs.type.subkind = HT_TypeKind_AssetRef;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_linker_inputs);
+
+	StructMember member_unity_build = {0};
+	member_unity_build.name = InternName("unity_build");
+	member_unity_build.type.kind = HT_TypeKind_Bool;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_unity_build);
+
+	StructMember member_precompiled_header = {0};
+	member_precompiled_header.name = InternName("precompiled_header");
+	member_precompiled_header.type.kind = HT_TypeKind_Bool;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_precompiled_header);
+
+	StructMember member_update_after = {0};
+	member_update_after.name = InternName("update_after");
+	member_update_after.type.kind = HT_TypeKind_Array;
+	member_update_after.type.subkind = HT_TypeKind_AssetRef;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_update_after);
+
+	StructMember member_update_on_worker_thread = {0};
+	member_update_on_worker_thread.name = InternName("update_on_worker_thread");
+	member_update_on_worker_thread.type.kind = HT_TypeKind_Bool;
+	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_update_on_worker_thread);
+
+	ComputeStructLayout(tree, tree->plugin_options_struct_type);
+}
+
 EXPORT void StructTypeAddMember(AssetTree* tree, Asset* struct_type) {
 	// so we want to "rebuild" the struct datas. For that, we need a "lookup" into the old type  Making a destructive change to a type...!
 	// I guess we could serialize and deserialize everything...
 	// since we have an array, lets do the simplest thing and just array remove element/etc.
 
 	StructMember member = {0};
-	StringInit(&member.name, "Unnamed member");
+	member.name = InternName("Unnamed member");
 	DS_ArrPush(&struct_type->struct_type.members, member);
 	ComputeStructLayout(tree, struct_type);
 
 	// Sync all struct assets data to the new type layout
 	
-	for (DS_BkArrEach(&tree->assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&tree->assets, asset_i);
+	for (DS_SlotMapEach(&tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&tree->assets, asset_i);
 		if (asset->kind != AssetKind_StructData || asset->struct_data.struct_type != struct_type->handle) continue;
 		TODO();
 	}
@@ -319,13 +368,6 @@ EXPORT void ItemGroupInit(AssetTree* tree, HT_ItemGroup* group, HT_Type* item_ty
 }
 
 EXPORT void ItemGroupDeinit(HT_ItemGroup* group) {
-	HT_ItemIndex item_i = group->first;
-	while (item_i) {
-		HT_ItemHeader* item = GetItemFromIndex(group, item_i);
-		StringDeinit(&item->name);
-		item_i = item->next;
-	}
-	
 	for (int i = 0; i < group->buckets.count; i++) {
 		void* bucket = ((void**)group->buckets.data)[i];
 		DS_MemFree(HEAP, bucket);
@@ -375,8 +417,7 @@ EXPORT HT_ItemIndex ItemGroupAdd(HT_ItemGroup* group) {
 		item = GetItemFromIndex(group, index);
 		group->last_bucket_end += 1;
 	}
-	memset(item, 0, group->item_full_size);
-	StringInit(&item->name, "");
+	memset(item, 0, group->item_full_size); // this also sets the name to the empty name
 	item->prev = 0;
 	item->next = 0;
 	return index;
@@ -395,9 +436,7 @@ EXPORT void ItemGroupRemove(HT_ItemGroup* group, HT_ItemIndex item) {
 }
 
 EXPORT void StructMemberInit(StructMember* x) {} // placeholder for potential future changes
-EXPORT void StructMemberDeinit(StructMember* x) {
-	StringDeinit(&x->name);
-}
+EXPORT void StructMemberDeinit(StructMember* x) {}
 
 EXPORT void StringInit(HT_String* x, STR_View value) {
 	*x = {};
@@ -436,8 +475,6 @@ EXPORT void DeleteAssetIncludingChildren(AssetTree* tree, Asset* asset) {
 	if (asset->next) asset->next->prev = asset->prev;
 	else asset->parent->last_child = asset->prev;
 
-	StringDeinit(&asset->name);
-	
 	switch (asset->kind) {
 	case AssetKind_Root: break;
 	case AssetKind_Package: {
@@ -463,17 +500,13 @@ EXPORT void DeleteAssetIncludingChildren(AssetTree* tree, Asset* asset) {
 	}break;
 	}
 
-	// TODO: the handle generation must be incremented, because otherwise handles to this asset will remain "valid" even though the asset is destroyed.
-	__debugbreak();
-	//asset->handle
+	RemoveAssetDependencies(tree, asset);
+	DS_ArrDeinit(&asset->dependencies);
+	DS_ArrDeinit(&asset->dependents);
 
-	__debugbreak(); // TODO: use FREE_SLOT
-	asset->kind = AssetKind_FreeSlot;
-	asset->freelist_next = tree->first_free_asset;
-
-	
-	DecodedHandle asset_handle = DecodeHandle(asset->handle);
-	tree->first_free_asset = DS_EncodeBucketArrayIndex(asset_handle.bucket_index, asset_handle.elem_index);
+	// Removing the slot increments its generation, which invalidates any existing handles to this asset.
+	bool ok = DS_SlotMapRemove(&tree->assets, (DS_SlotHandle)asset->handle);
+	ASSERT(ok);
 }
 
 EXPORT STR_View GetPackageName(Asset* package) {
@@ -499,9 +532,12 @@ EXPORT Asset* FindAssetFromPath(AssetTree* tree, Asset* package, STR_View path)
 			continue;
 		}
 
+		HT_NameID folded_name;
+		if (!FindNameCaseInsensitive(name, &folded_name)) break;
+
 		Asset* new_parent = NULL;
 		for (Asset* asset = parent->first_child; asset; asset = asset->next) {
-			if (STR_MatchCaseInsensitive(asset->name, name)) {
+			if (asset->name.folded_id == folded_name) {
 				new_parent = asset;
 				break;
 			}
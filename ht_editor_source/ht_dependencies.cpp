@@ -0,0 +1,215 @@
+#include "include/ht_common.h"
+
+// The dependency graph of the asset tree. An asset depends on every asset that it refers to by handle:
+//   - struct types depend on the struct types of their members
+//   - struct data depends on its struct type, and on every asset and struct type referred to by its data
+//   - plugins depend on their data asset, code files and linker inputs
+// Each asset keeps both directions of its edges, `dependencies` and `dependents`, so that the assets affected by
+// a change can be found without looking at every other asset in the tree.
+//
+// The edges of an asset are recomputed with UpdateAssetDependencies whenever its contents may have changed: when it's
+// (re)loaded from its file or the project snapshot, when the data of a deferred struct data asset is loaded, and while
+// it's being edited in the properties tab. Until its data is loaded, a struct data asset only depends on its struct type.
+
+static void AddDependency(AssetTree* tree, Asset* asset, DS_DynArray(HT_Asset)* deps, HT_Asset handle) {
+	if (handle == NULL || handle == asset->handle) return;
+
+	Asset* dep = GetAsset(tree, handle);
+	if (dep == NULL || dep->parent == NULL) return; // deleted, or one of the built-in types
+
+	for (int i = 0; i < deps->count; i++) {
+		if (deps->data[i] == handle) return;
+	}
+	DS_ArrPush(deps, handle);
+}
+
+static void AddTypeDependencies(AssetTree* tree, Asset* asset, DS_DynArray(HT_Asset)* deps, HT_Type* type) {
+	// For arrays and item groups of structs, the struct is in `handle` as well
+	if (type->kind == HT_TypeKind_Struct || type->subkind == HT_TypeKind_Struct) {
+		AddDependency(tree, asset, deps, type->handle);
+	}
+}
+
+static void AddValueDependencies(AssetTree* tree, Asset* asset, DS_DynArray(HT_Asset)* deps, void* data, HT_Type* type);
+
+static void AddStructValueDependencies(AssetTree* tree, Asset* asset, DS_DynArray(HT_Asset)* deps, void* data, Asset* struct_asset) {
+	for (int i = 0; i < struct_asset->struct_type.members.count; i++) {
+		StructMember* member = &struct_asset->struct_type.members[i];
+		AddValueDependencies(tree, asset, deps, (char*)data + member->offset, &member->type);
+	}
+}
+
+static void AddValueDependencies(AssetTree* tree, Asset* asset, DS_DynArray(HT_Asset)* deps, void* data, HT_Type* type) {
+	switch (type->kind) {
+	case HT_TypeKind_Struct: {
+		AddDependency(tree, asset, deps, type->handle);
+		Asset* struct_asset = GetAsset(tree, type->handle);
+		if (struct_asset && struct_asset->kind == AssetKind_StructType) {
+			AddStructValueDependencies(tree, asset, deps, data, struct_asset);
+		}
+	}break;
+	case HT_TypeKind_Array: {
+		HT_Array* val = (HT_Array*)data;
+
+		HT_Type elem_type = *type;
+		elem_type.kind = type->subkind;
+		AddTypeDependencies(tree, asset, deps, type);
+
+		i32 elem_size, elem_align;
+		GetTypeSizeAndAlignment(tree, &elem_type, &elem_size, &elem_align);
+		for (int i = 0; i < val->count; i++) {
+			AddValueDependencies(tree, asset, deps, (char*)val->data + elem_size*i, &elem_type);
+		}
+	}break;
+	case HT_TypeKind_ItemGroup: {
+		HT_ItemGroup* val = (HT_ItemGroup*)data;
+
+		HT_Type item_type = *type;
+		item_type.kind = type->subkind;
+		AddTypeDependencies(tree, asset, deps, type);
+
+		for (HT_ItemGroupEach(val, item_idx)) {
+			void* item_data = (char*)HT_GetItemHeader(val, item_idx) + val->item_offset;
+			AddValueDependencies(tree, asset, deps, item_data, &item_type);
+		}
+	}break;
+	case HT_TypeKind_Any: {
+		HT_Any* val = (HT_Any*)data;
+		if (val->data) {
+			AddValueDependencies(tree, asset, deps, val->data, &val->type);
+		}
+	}break;
+	case HT_TypeKind_Type: {
+		AddTypeDependencies(tree, asset, deps, (HT_Type*)data);
+	}break;
+	case HT_TypeKind_AssetRef: {
+		AddDependency(tree, asset, deps, *(HT_Asset*)data);
+	}break;
+	case HT_TypeKind_Float: break;
+	case HT_TypeKind_Int: break;
+	case HT_TypeKind_Bool: break;
+	case HT_TypeKind_Vec2: break;
+	case HT_TypeKind_Vec3: break;
+	case HT_TypeKind_Vec4: break;
+	case HT_TypeKind_IVec2: break;
+	case HT_TypeKind_IVec3: break;
+	case HT_TypeKind_IVec4: break;
+	case HT_TypeKind_String: break;
+	case HT_TypeKind_COUNT: ASSERT(0); break;
+	case HT_TypeKind_INVALID: ASSERT(0); break;
+	}
+}
+
+static void RemoveHandle(DS_DynArray(HT_Asset)* handles, HT_Asset handle) {
+	for (int i = 0; i < handles->count; i++) {
+		if (handles->data[i] == handle) {
+			handles->data[i] = DS_ArrPop(handles);
+			return;
+		}
+	}
+}
+
+EXPORT void UpdateAssetDependencies(AssetTree* tree, Asset* asset) {
+	DS_Scope scope = DS_ScopePush(DS);
+
+	HT_Asset new_deps_buffer[16];
+	DS_DynArray(HT_Asset) new_deps;
+	DS_ArrInitBuffer(&new_deps, TEMP, new_deps_buffer);
+
+	switch (asset->kind) {
+	case AssetKind_Root: break;
+	case AssetKind_Package: break;
+	case AssetKind_Folder: break;
+	case AssetKind_File: break;
+	case AssetKind_Plugin: {
+		AddStructValueDependencies(tree, asset, &new_deps, &asset->plugin.options, tree->plugin_options_struct_type);
+	}break;
+	case AssetKind_StructType: {
+		for (int i = 0; i < asset->struct_type.members.count; i++) {
+			AddTypeDependencies(tree, asset, &new_deps, &asset->struct_type.members[i].type);
+		}
+	}break;
+	case AssetKind_StructData: {
+		AddDependency(tree, asset, &new_deps, asset->struct_data.struct_type);
+		if (!asset->struct_data.needs_load && asset->struct_data.data) {
+			HT_Type type = { HT_TypeKind_Struct };
+			type.handle = asset->struct_data.struct_type;
+			AddValueDependencies(tree, asset, &new_deps, asset->struct_data.data, &type);
+		}
+	}break;
+	}
+
+	// This runs every frame for the asset in the properties tab, so don't touch the graph if nothing changed
+	bool changed = new_deps.count != asset->dependencies.count;
+	for (int i = 0; i < new_deps.count && !changed; i++) {
+		changed = new_deps[i] != asset->dependencies[i];
+	}
+
+	if (changed) {
+		for (int i = 0; i < asset->dependencies.count; i++) {
+			Asset* dep = GetAsset(tree, asset->dependencies[i]);
+			if (dep) RemoveHandle(&dep->dependents, asset->handle);
+		}
+
+		DS_ArrClear(&asset->dependencies);
+		DS_ArrPushArr(&asset->dependencies, new_deps);
+
+		for (int i = 0; i < asset->dependencies.count; i++) {
+			Asset* dep = GetAsset(tree, asset->dependencies[i]);
+			DS_ArrPush(&dep->dependents, asset->handle);
+		}
+	}
+
+	DS_ScopePop(scope);
+}
+
+EXPORT void RemoveAssetDependencies(AssetTree* tree, Asset* asset) {
+	for (int i = 0; i < asset->dependencies.count; i++) {
+		Asset* dep = GetAsset(tree, asset->dependencies[i]);
+		if (dep) RemoveHandle(&dep->dependents, asset->handle);
+	}
+
+	// The dependents still refer to the handle, but it won't resolve to anything anymore
+	for (int i = 0; i < asset->dependents.count; i++) {
+		Asset* dependent = GetAsset(tree, asset->dependents[i]);
+		if (dependent) RemoveHandle(&dependent->dependencies, asset->handle);
+	}
+
+	DS_ArrClear(&asset->dependencies);
+	DS_ArrClear(&asset->dependents);
+}
+
+EXPORT void CollectDependents(AssetTree* tree, DS_ArrayView<Asset*> assets, DS_DynArray(Asset*)* out_dependents) {
+	int first_new = out_dependents->count;
+	for (int i = 0; i < assets.count; i++) {
+		assets[i]->collect_dependents_visited = true;
+	}
+
+	// Breadth-first, so that direct dependents come before indirect ones
+	for (int i = 0; i < assets.count; i++) {
+		for (int j = 0; j < assets[i]->dependents.count; j++) {
+			Asset* dependent = GetAsset(tree, assets[i]->dependents[j]);
+			if (dependent && !dependent->collect_dependents_visited) {
+				dependent->collect_dependents_visited = true;
+				DS_ArrPush(out_dependents, dependent);
+			}
+		}
+	}
+	for (int i = first_new; i < out_dependents->count; i++) {
+		Asset* asset = out_dependents->data[i];
+		for (int j = 0; j < asset->dependents.count; j++) {
+			Asset* dependent = GetAsset(tree, asset->dependents[j]);
+			if (dependent && !dependent->collect_dependents_visited) {
+				dependent->collect_dependents_visited = true;
+				DS_ArrPush(out_dependents, dependent);
+			}
+		}
+	}
+
+	for (int i = 0; i < assets.count; i++) {
+		assets[i]->collect_dependents_visited = false;
+	}
+	for (int i = first_new; i < out_dependents->count; i++) {
+		out_dependents->data[i]->collect_dependents_visited = false;
+	}
+}
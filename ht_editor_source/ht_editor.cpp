@@ -29,12 +29,24 @@ static const HT_StaticExports STATIC_EXPORTS[] = {{0} HT_ALL_STATIC_EXPORTS};
 struct PluginCallContext {
 	EditorState* s;
 	PluginInstance* plugin;
+	
+	// Set for HT_UpdatePlugin on a worker thread, where the asset tree can't be accessed
+	bool on_worker_thread;
+	void* plugin_data;
+
+	// The profiler zone of the custom tab returned by the last PollNextCustomTabUpdate, ended by the next poll
+	bool custom_tab_zone_open;
+	int custom_tab_zone;
 };
 
 // -- GLOBALS ------------------------------------------------------
 
-// Only valid while calling a plugin DLL function
-static PluginCallContext* g_plugin_call_ctx;
+// Only valid while calling a plugin DLL function. Plugins may update on worker threads, so each thread has its own.
+static thread_local PluginCallContext* g_plugin_call_ctx;
+
+// For the API functions that touch editor state. Plugins may not call them while updating on a worker thread, nor from
+// inside a job, where g_plugin_call_ctx isn't set.
+#define ASSERT_ON_MAIN_THREAD() ASSERT(g_plugin_call_ctx != NULL && !g_plugin_call_ctx->on_worker_thread)
 
 // -----------------------------------------------------------------
 
@@ -52,14 +64,11 @@ static void AssetTreeValueUI(UI_DataTree* tree, UI_Box* parent, UI_DataTreeNode*
 	UI_Box* text_box = UI_KBOX(key);
 	if (asset->kind != AssetKind_Package && UI_DoubleClicked(text_box)) {
 		*is_text_editing = true;
+		LoadAllStructData(&s->asset_tree); // so that the references to the asset are saved with its new name
 	}
 
 	if (*is_text_editing) {
-		UI_Text asset_name = StringToUIText(asset->name);
-
-		UI_ValTextState* val_text_state = UI_AddValText(text_box, UI_SizeFlex(1.f), UI_SizeFit(), &asset_name, NULL);
-
-		asset->name = UITextToString(asset_name);
+		UI_ValTextState* val_text_state = UIAddValName(text_box, UI_SizeFlex(1.f), UI_SizeFit(), &asset->name);
 
 		text_box->flags &= ~UI_BoxFlag_DrawBorder;
 		if (!val_text_state->is_editing) {
@@ -163,9 +172,8 @@ EXPORT void AddTopBar(EditorState* s) {
 		s->frame.window_dropdown->inner_padding = dropdown_padding;
 		
 		int i = 0;
-		for (DS_BkArrEach(&s->tab_classes, tab_i)) {
-			UI_Tab* tab = DS_BkArrGet(&s->tab_classes, tab_i);
-			if (tab->name.size == 0) continue; // free slot
+		for (DS_SlotMapEach(&s->tab_classes, tab_i)) {
+			UI_Tab* tab = DS_SlotMapAt(&s->tab_classes, tab_i);
 
 			UI_Box* button = UI_KBOX(UI_HashInt(UI_KEY(), i));
 			UI_AddLabel(button, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Clickable, tab->name);
@@ -266,7 +274,7 @@ struct StructMemberValNode {
 	void* data;
 	HT_Type type;
 	
-	HT_String* name_rw; // if NULL, `name_ro` is used
+	HT_Name* name_rw; // if NULL, `name_ro` is used
 	STR_View name_ro;
 };
 
@@ -420,11 +428,7 @@ static void UIStructMemberNodeAdd(UI_DataTree* tree, UI_Box* parent, UI_DataTree
 		}
 
 		if (*is_text_editing) {
-			UI_Text member_name = StringToUIText(member->name);
-
-			UI_ValTextState* text_edit = UI_AddValText(text_box, UI_SizeFlex(1.f), UI_SizeFit(), &member_name, NULL);
-			
-			member->name = UITextToString(member_name);
+			UI_ValTextState* text_edit = UIAddValName(text_box, UI_SizeFlex(1.f), UI_SizeFit(), &member->name);
 			
 			text_box->flags &= ~UI_BoxFlag_DrawBorder;
 			if (!text_edit->is_editing) {
@@ -449,9 +453,7 @@ static void UIAddStructDataNode(UI_DataTree* tree, UI_Box* parent, UI_DataTreeNo
 
 	if (column == 0) {
 		if (member_val->name_rw) {
-			UI_Text ui_val = StringToUIText(*member_val->name_rw);
-			UI_AddValText(UI_KBOX(key), UI_SizeFlex(1.f), UI_SizeFlex(1.f), &ui_val, NULL);
-			*member_val->name_rw = UITextToString(ui_val);
+			UIAddValName(UI_KBOX(key), UI_SizeFlex(1.f), UI_SizeFlex(1.f), member_val->name_rw);
 		}
 		else {
 			UI_AddLabel(UI_KBOX(key), UI_SizeFlex(1.f), UI_SizeFit(), 0, member_val->name_ro);
@@ -723,7 +725,7 @@ EXPORT void UpdateAndDrawPropertiesTab(EditorState* s, UI_Key key, UI_Rect area)
 			UI_AddLabel(UI_KBOX(key), UI_SizeFit(), UI_SizeFit(), 0, "The struct type has been destroyed!");
 		}
 		else {
-			UIAddStructValueEditTree(s, UI_KKEY(key), selected_asset->struct_data.data, struct_type);
+			UIAddStructValueEditTree(s, UI_KKEY(key), GetStructData(&s->asset_tree, selected_asset), struct_type);
 		}
 	}
 
@@ -760,6 +762,11 @@ EXPORT void UpdateAndDrawPropertiesTab(EditorState* s, UI_Key key, UI_Rect area)
 		UIAddStructValueEditTree(s, UI_KKEY(key), &selected_asset->plugin.options, s->asset_tree.plugin_options_struct_type);
 
 		PluginInstance* plugin_instance = GetPluginInstance(s, selected_asset->plugin.active_instance);
+		bool compiling = IsPluginCompiling(s, selected_asset);
+		if (compiling) {
+			// The old instance, if any, keeps running until the new one has compiled
+			UI_AddLabel(UI_KBOX(key), UI_SizeFit(), UI_SizeFit(), 0, "Compiling...");
+		}
 		if (plugin_instance) {
 			UI_Box* stop_button = UI_KBOX(key);
 			UI_AddButton(stop_button, UI_SizeFit(), UI_SizeFit(), 0, "Stop");
@@ -767,8 +774,18 @@ EXPORT void UpdateAndDrawPropertiesTab(EditorState* s, UI_Key key, UI_Rect area)
 				UnloadPlugin(s, selected_asset);
 				selected_asset->plugin.active_by_request = false;
 			}
+
+#ifdef HT_DYNAMIC
+			if (!compiling) {
+				UI_Box* recompile_button = UI_KBOX(key);
+				UI_AddButton(recompile_button, UI_SizeFit(), UI_SizeFit(), 0, "Recompile");
+				if (UI_Clicked(recompile_button)) {
+					RunPlugin(s, selected_asset);
+				}
+			}
+#endif
 		}
-		else {
+		else if (!compiling) {
 			UI_Box* run_button = UI_KBOX(key);
 			UI_AddButton(run_button, UI_SizeFit(), UI_SizeFit(), 0, "Run");
 			if (UI_Clicked(run_button)) {
@@ -778,6 +795,9 @@ EXPORT void UpdateAndDrawPropertiesTab(EditorState* s, UI_Key key, UI_Rect area)
 		}
 	}
 
+	// Any asset references that were just edited change the dependency graph
+	if (selected_asset) UpdateAssetDependencies(&s->asset_tree, selected_asset);
+
 	UI_PopBox(root_box);
 	UI_BoxComputeRects(root_box, area.min);
 	UI_DrawBox(root_box);
@@ -908,14 +928,14 @@ static void UpdateAndDrawRMBMenu(EditorState* s) {
 				STR_View load_package_path;
 				if (OS_FolderPicker(TEMP, &load_package_path)) {
 					//s->assets_tree_ui_state.selection = (UI_Key)...->handle
-					LoadPackages(&s->asset_tree, { &load_package_path, 1 });
+					LoadPackages(&s->asset_tree, { &load_package_path, 1 }, "");
 				}
 				s->rmb_menu_open = false;
 			}
 		}
 
 		if (selected_asset && selected_asset->kind == AssetKind_StructType) {
-			STR_View text = STR_Form(UI_TEMP, "New Struct Data (%v)", selected_asset->name);
+			STR_View text = STR_Form(UI_TEMP, "New Struct Data (%v)", selected_asset->name.view);
 
 			UI_Box* new_struct_data = UI_BOX();
 			UI_AddLabel(new_struct_data, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Clickable, text);
@@ -939,6 +959,7 @@ static void UpdateAndDrawRMBMenu(EditorState* s) {
 					selected_asset->prev ? selected_asset->prev :
 					selected_asset->parent != s->asset_tree.root ? selected_asset->parent : NULL;
 
+				LoadAllStructData(&s->asset_tree); // so that the references to the deleted assets are cleared on save
 				DeleteAssetIncludingChildren(&s->asset_tree, selected_asset);
 				s->assets_tree_ui_state.selection = (UI_Key)new_selection->handle; // TODO: here the selection should act as if moving up with keyboard instead
 				s->rmb_menu_open = false;
@@ -1030,15 +1051,7 @@ EXPORT void RemoveErrorsByAsset(ErrorList* error_list, HT_Asset asset) {
 }
 
 EXPORT PluginInstance* GetPluginInstance(EditorState* s, HT_PluginInstance handle) {
-	DecodedHandle decoded = *(DecodedHandle*)&handle;
-	if (decoded.bucket_index < s->plugin_instances.buckets_count) {
-		PluginInstance* elems = s->plugin_instances.buckets[decoded.bucket_index].elems;
-		PluginInstance* instance = &elems[decoded.elem_index];
-		if (instance->handle == handle) {
-			return instance;
-		}
-	}
-	return NULL;
+	return (PluginInstance*)DS_SlotMapGet(&s->plugin_instances, (DS_SlotHandle)handle);
 }
 
 EXPORT void UpdateAndDrawDropdowns(EditorState* s) {
@@ -1086,86 +1099,192 @@ EXPORT void UpdateAndDrawDropdowns(EditorState* s) {
 	}
 }
 
-static void* HT_AllocatorProc(void* ptr, size_t size) {
-	// We track all plugin allocations so that we can free them at once when the plugin is unloaded.
+static const u32 PLUGIN_HEAP_SIZE_CLASSES[PLUGIN_HEAP_SIZE_CLASS_COUNT] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
 
-	PluginInstance* plugin = g_plugin_call_ctx->plugin;
-	if (size == 0) {
-		if (ptr) {
-			// Move last allocation to the place of the allocation we want to free in the allocations array
-			PluginAllocationHeader* header = (PluginAllocationHeader*)((char*)ptr - 16);
-			PluginAllocationHeader* last_allocation = plugin->allocations[plugin->allocations.count - 1];
-		
-			last_allocation->allocation_index = header->allocation_index;
-			plugin->allocations[header->allocation_index] = last_allocation;
-		
-			DS_ArrPop(&plugin->allocations);
+static u32 PluginHeapSizeClass(size_t size) {
+	for (u32 i = 0; i < PLUGIN_HEAP_SIZE_CLASS_COUNT; i++) {
+		if (size <= PLUGIN_HEAP_SIZE_CLASSES[i]) return i;
+	}
+	return PLUGIN_HEAP_SIZE_CLASS_LARGE;
+}
 
-			DS_MemFree(HEAP, header);
-		}
-		return NULL;
+static PluginHeapBlock* PluginHeapBlockFromPtr(void* ptr) {
+	return (PluginHeapBlock*)((uintptr_t)ptr & ~(uintptr_t)(PLUGIN_HEAP_BLOCK_SIZE - 1));
+}
+
+static PluginHeapBlock* PluginHeapNewBlock(PluginHeap* heap, size_t size, u32 size_class) {
+	PluginHeapBlock* block = (PluginHeapBlock*)OS_VirtualAlloc(size);
+	EXPECT(block != NULL);
+	ASSERT(((uintptr_t)block & (PLUGIN_HEAP_BLOCK_SIZE - 1)) == 0);
+
+	block->heap = heap;
+	block->size_class = size_class;
+	block->next = heap->first_block;
+	if (heap->first_block) heap->first_block->prev = block;
+	heap->first_block = block;
+
+	heap->stats.bytes_reserved += size;
+	return block;
+}
+
+static void PluginHeapCountAlloc(PluginHeap* heap, size_t size) {
+	PluginMemoryStats* stats = &heap->stats;
+	stats->bytes_in_use += size;
+	stats->allocation_count++;
+	stats->total_allocations++;
+	if (stats->bytes_in_use > stats->bytes_in_use_peak) stats->bytes_in_use_peak = stats->bytes_in_use;
+	if (stats->allocation_count > stats->allocation_count_peak) stats->allocation_count_peak = stats->allocation_count;
+}
+
+static void* PluginHeapAlloc(PluginHeap* heap, size_t size) {
+	static_assert(sizeof(PluginHeapBlock) <= PLUGIN_HEAP_BLOCK_HEADER_SIZE, "");
+
+	u32 size_class = PluginHeapSizeClass(size);
+	if (size_class == PLUGIN_HEAP_SIZE_CLASS_LARGE) {
+		PluginHeapBlock* block = PluginHeapNewBlock(heap, PLUGIN_HEAP_BLOCK_HEADER_SIZE + size, size_class);
+		block->large_size = size;
+		PluginHeapCountAlloc(heap, size);
+		return (char*)block + PLUGIN_HEAP_BLOCK_HEADER_SIZE;
+	}
+
+	u32 slot_size = PLUGIN_HEAP_SIZE_CLASSES[size_class];
+	PluginHeapCountAlloc(heap, slot_size);
+
+	void* result = heap->first_free[size_class];
+	if (result) {
+		heap->first_free[size_class] = *(void**)result;
+		return result;
+	}
+
+	u32 slots_per_slab = (PLUGIN_HEAP_BLOCK_SIZE - PLUGIN_HEAP_BLOCK_HEADER_SIZE) / slot_size;
+
+	PluginHeapBlock* slab = heap->current_slab[size_class];
+	if (slab == NULL || slab->bump_count == slots_per_slab) {
+		slab = PluginHeapNewBlock(heap, PLUGIN_HEAP_BLOCK_SIZE, size_class);
+		heap->current_slab[size_class] = slab;
+	}
+
+	result = (char*)slab + PLUGIN_HEAP_BLOCK_HEADER_SIZE + slab->bump_count * slot_size;
+	slab->bump_count++;
+	return result;
+}
+
+static void PluginHeapFree(void* ptr) {
+	PluginHeapBlock* block = PluginHeapBlockFromPtr(ptr);
+	PluginHeap* heap = block->heap;
+	heap->stats.allocation_count--;
+
+	if (block->size_class == PLUGIN_HEAP_SIZE_CLASS_LARGE) {
+		heap->stats.bytes_in_use -= block->large_size;
+		heap->stats.bytes_reserved -= PLUGIN_HEAP_BLOCK_HEADER_SIZE + block->large_size;
+		if (block->prev) block->prev->next = block->next;
+		else heap->first_block = block->next;
+		if (block->next) block->next->prev = block->prev;
+		OS_VirtualFree(block);
 	}
 	else {
-		// Having a 16 byte header is quite a lot of overhead per allocation... but for now its ok.
+		heap->stats.bytes_in_use -= PLUGIN_HEAP_SIZE_CLASSES[block->size_class];
+		*(void**)ptr = heap->first_free[block->size_class];
+		heap->first_free[block->size_class] = ptr;
+	}
+}
 
-		PluginAllocationHeader* header;
-		if (ptr) {
-			char* allocation_base = (char*)ptr - 16;
-			size_t old_size = ptr ? ((PluginAllocationHeader*)allocation_base)->size : 0;
-			header = (PluginAllocationHeader*)DS_MemResizeAligned(HEAP, allocation_base, old_size, 16 + size, 16);
-		} else {
-			header = (PluginAllocationHeader*)DS_MemAllocAligned(HEAP, 16 + size, 16);
-		}
+static void* PluginHeapResize(PluginHeap* heap, void* ptr, size_t size) {
+	PluginHeapBlock* block = PluginHeapBlockFromPtr(ptr);
+	bool is_large = block->size_class == PLUGIN_HEAP_SIZE_CLASS_LARGE;
+	size_t old_size = is_large ? block->large_size : PLUGIN_HEAP_SIZE_CLASSES[block->size_class];
+
+	// Keep the allocation in place if it stays in the same size class. Large allocations are kept as long as they don't need to grow.
+	u32 new_size_class = PluginHeapSizeClass(size);
+	if (new_size_class == block->size_class && (!is_large || size <= old_size)) {
+		return ptr;
+	}
 
-		header->size = size;
-		header->allocation_index = plugin->allocations.count;
-		DS_ArrPush(&plugin->allocations, header);
+	void* result = PluginHeapAlloc(heap, size);
+	memcpy(result, ptr, old_size < size ? old_size : size);
+	PluginHeapFree(ptr);
+	return result;
+}
 
-		return (char*)header + 16;
+static void PluginHeapDeinit(PluginHeap* heap) {
+	for (PluginHeapBlock* block = heap->first_block; block;) {
+		PluginHeapBlock* next = block->next;
+		OS_VirtualFree(block);
+		block = next;
 	}
+	*heap = {};
 }
 
-static void* HT_TempArenaPush(size_t size, size_t align) {
-	return DS_ArenaPushAligned(TEMP, (int)size, (int)align);
+static void* HT_AllocatorProc(void* ptr, size_t size) {
+	// All plugin allocations are owned by the plugin's heap, so that we can free them at once when the plugin is unloaded.
+	PluginHeap* heap = &g_plugin_call_ctx->plugin->heap;
+	if (size == 0) {
+		if (ptr) PluginHeapFree(ptr);
+		return NULL;
+	}
+	return ptr ? PluginHeapResize(heap, ptr, size) : PluginHeapAlloc(heap, size);
 }
 
-static void* HT_GetPluginData_(/*AssetRef type_id*/) {
-	EditorState* s = g_plugin_call_ctx->s;
-	HT_Asset data = g_plugin_call_ctx->plugin->plugin_asset->plugin.options.data_asset;
+static void* HT_TempArenaPush(size_t size, size_t align) {
+	if (g_plugin_call_ctx) {
+		PluginMemoryStats* stats = &g_plugin_call_ctx->plugin->heap.stats;
+		stats->temp_bytes_this_frame += size;
+		if (stats->temp_bytes_this_frame > stats->temp_bytes_peak) stats->temp_bytes_peak = stats->temp_bytes_this_frame;
+	}
+	return DS_ArenaPushAligned(GetWorkerTempArena(), (int)size, (int)align);
+}
 
+static void* GetPluginData(EditorState* s, PluginInstance* plugin) {
+	HT_Asset data = plugin->plugin_asset->plugin.options.data_asset;
 	Asset* data_asset = GetAsset(&s->asset_tree, data);
-	return data_asset ? data_asset->struct_data.data : NULL;
+	return data_asset && data_asset->kind == AssetKind_StructData ? GetStructData(&s->asset_tree, data_asset) : NULL;
+}
+
+static void* HT_GetPluginData_(/*AssetRef type_id*/) {
+	if (g_plugin_call_ctx->on_worker_thread) return g_plugin_call_ctx->plugin_data;
+	return GetPluginData(g_plugin_call_ctx->s, g_plugin_call_ctx->plugin);
 }
 
 EXPORT UI_Tab* CreateTabClass(EditorState* s, STR_View name) {
-	UI_Tab* tab;
-	NEW_SLOT_PTR(&tab, &s->tab_classes, &s->first_free_tab_class, freelist_next);
-	*tab = {};
+	DS_SlotHandle handle;
+	UI_Tab* tab = (UI_Tab*)DS_SlotMapAdd(&s->tab_classes, &handle);
+	tab->handle = handle;
 	tab->name = STR_Clone(HEAP, name);
 	return tab;
 }
 
 EXPORT void DestroyTabClass(EditorState* s, UI_Tab* tab) {
 	STR_Free(HEAP, tab->name);
-	tab->name = {}; // mark free slot with this
-	FREE_SLOT_PTR(tab, &s->first_free_tab_class, freelist_next);
+	bool ok = DS_SlotMapRemove(&s->tab_classes, tab->handle);
+	ASSERT(ok);
 }
 
 static HT_TabClass* HT_CreateTabClass(STR_View name) {
+	ASSERT_ON_MAIN_THREAD();
 	UI_Tab* tab_class = CreateTabClass(g_plugin_call_ctx->s, name);
 	tab_class->owner_plugin = g_plugin_call_ctx->plugin->plugin_asset->handle;
 	return (HT_TabClass*)tab_class;
 }
 
 static void HT_DestroyTabClass(HT_TabClass* tab) {
+	ASSERT_ON_MAIN_THREAD();
 	UI_Tab* tab_class = (UI_Tab*)tab;
 	ASSERT(tab_class->owner_plugin == g_plugin_call_ctx->plugin->plugin_asset->handle); // a plugin may only destroy its own tab classes.
 	DestroyTabClass(g_plugin_call_ctx->s, tab_class);
 }
 
 static bool HT_PollNextCustomTabUpdate(HT_CustomTabUpdate* tab_update) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	
+	// The plugin updates the previous tab between the polls
+	if (g_plugin_call_ctx->custom_tab_zone_open) {
+		ProfilerEndZone(g_plugin_call_ctx->custom_tab_zone);
+		g_plugin_call_ctx->custom_tab_zone_open = false;
+	}
+
 	for (int i = 0; i < s->frame.queued_custom_tab_updates.count; i++) {
 		HT_CustomTabUpdate* update = &s->frame.queued_custom_tab_updates[i];
 		UI_Tab* tab = (UI_Tab*)update->tab_class;
@@ -1173,6 +1292,9 @@ static bool HT_PollNextCustomTabUpdate(HT_CustomTabUpdate* tab_update) {
 			// Remove from the queue
 			*tab_update = *update;
 			s->frame.queued_custom_tab_updates[i] = DS_ArrPop(&s->frame.queued_custom_tab_updates);
+
+			g_plugin_call_ctx->custom_tab_zone = ProfilerBeginZone({}, tab->name);
+			g_plugin_call_ctx->custom_tab_zone_open = true;
 			return true;
 		}
 	}
@@ -1203,16 +1325,46 @@ static bool HT_PollNextCustomTabUpdate(HT_CustomTabUpdate* tab_update) {
 }*/
 
 static STR_View HT_AssetGetFilepath(HT_Asset asset) {
+	ASSERT_ON_MAIN_THREAD();
 	Asset* ptr = GetAsset(&g_plugin_call_ctx->s->asset_tree, asset);
 	return ptr ? AssetGetAbsoluteFilepath(TEMP, ptr) : STR_View{};
 }
 
 static u64 HT_AssetGetModtime(HT_Asset asset) {
+	ASSERT_ON_MAIN_THREAD();
 	Asset* ptr = GetAsset(&g_plugin_call_ctx->s->asset_tree, asset);
 	return ptr ? ptr->modtime : 0;
 }
 
+static HT_Asset* HT_AssetGetDependencies(HT_Asset asset, int* out_count) {
+	ASSERT_ON_MAIN_THREAD();
+	Asset* ptr = GetAsset(&g_plugin_call_ctx->s->asset_tree, asset);
+	if (ptr == NULL) {
+		*out_count = 0;
+		return NULL;
+	}
+	*out_count = ptr->dependencies.count;
+	return (HT_Asset*)DS_MemClone(TEMP, ptr->dependencies.data, ptr->dependencies.count * sizeof(HT_Asset));
+}
+
+static HT_Asset* HT_AssetGetDependents(HT_Asset asset, int* out_count) {
+	ASSERT_ON_MAIN_THREAD();
+	EditorState* s = g_plugin_call_ctx->s;
+	Asset* ptr = GetAsset(&s->asset_tree, asset);
+
+	DS_DynArray(Asset*) dependents = {TEMP};
+	if (ptr) CollectDependents(&s->asset_tree, {&ptr, 1}, &dependents);
+
+	HT_Asset* result = (HT_Asset*)DS_ArenaPush(TEMP, dependents.count * sizeof(HT_Asset));
+	for (int i = 0; i < dependents.count; i++) {
+		result[i] = dependents[i]->handle;
+	}
+	*out_count = dependents.count;
+	return result;
+}
+
 static bool HT_RegisterAssetViewerForType(HT_Asset struct_type_asset, TabUpdateProc update_proc) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	Asset* asset = GetAsset(&s->asset_tree, struct_type_asset);
 	if (asset && asset->kind == AssetKind_StructType) {
@@ -1227,6 +1379,7 @@ static bool HT_RegisterAssetViewerForType(HT_Asset struct_type_asset, TabUpdateP
 }
 
 static void HT_DeregisterAssetViewerForType(HT_Asset struct_type_asset) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	Asset* asset = GetAsset(&s->asset_tree, struct_type_asset);
 	if (asset && asset->kind == AssetKind_StructType) {
@@ -1238,6 +1391,7 @@ static void HT_DeregisterAssetViewerForType(HT_Asset struct_type_asset) {
 }
 
 static HT_Asset* HT_GetAllOpenAssetsOfType(HT_Asset struct_type_asset, int* out_count) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	
 	HT_Asset* result = NULL;
@@ -1253,9 +1407,8 @@ static HT_Asset* HT_GetAllOpenAssetsOfType(HT_Asset struct_type_asset, int* out_
 	return result;
 
 	// TODO: loop through all tabs
-	/*for (DS_BkArrEach(&s->panel_tree.panels, panel_i)) {
-		UI_Panel* panel = DS_BkArrGet(&s->panel_tree.panels, panel_i);
-		if (!panel->is_alive) continue;
+	/*for (DS_SlotMapEach(&s->panel_tree.panels, panel_i)) {
+		UI_Panel* panel = DS_SlotMapAt(&s->panel_tree.panels, panel_i);
 
 		for (int tab_i = 0; tab_i < panel->tabs.count; tab_i++) {
 			UI_Tab* tab = panel->tabs[tab_i];
@@ -1282,6 +1435,12 @@ EXPORT void UpdateAndDrawTab(UI_PanelTree* tree, UI_Tab* tab, UI_Key key, UI_Rec
 	else if (tab == s->errors_tab_class) {
 		UpdateAndDrawErrorsTab(s, key, area_rect);
 	}
+	else if (tab == s->memory_tab_class) {
+		UpdateAndDrawMemoryTab(s, key, area_rect);
+	}
+	else if (tab == s->profiler_tab_class) {
+		UpdateAndDrawProfilerTab(s, key, area_rect);
+	}
 	else if (tab == s->asset_viewer_tab_class) {
 		HT_Asset selected_asset = (HT_Asset)s->assets_tree_ui_state.selection;
 		
@@ -1307,7 +1466,9 @@ EXPORT void UpdateAndDrawTab(UI_PanelTree* tree, UI_Tab* tab, UI_Key key, UI_Rec
 				
 				PluginCallContext ctx = {s, plugin};
 				g_plugin_call_ctx = &ctx;
+				int zone = ProfilerBeginZone(plugin->plugin_asset->name, type_asset->name.view);
 				type_asset->struct_type.asset_viewer_update_proc(s->api, &update);
+				ProfilerEndZone(zone);
 				g_plugin_call_ctx = NULL;
 				
 				UI_SetActiveScissorRect(parent_rect);
@@ -1326,15 +1487,23 @@ static HRESULT HT_D3DCompileFromFile(STR_View FileName, const D3D_SHADER_MACRO*
 	ID3DInclude* pInclude, const char* pEntrypoint, const char* pTarget, u32 Flags1,
 	u32 Flags2, ID3DBlob** ppCode, ID3DBlob** ppErrorMsgs)
 {
+	ASSERT_ON_MAIN_THREAD();
 	wchar_t* pFileName = OS_UTF8ToWide(TEMP, FileName, 1);
 	return D3DCompileFromFile(pFileName, pDefines, pInclude, pEntrypoint, pTarget, Flags1, Flags2, ppCode, ppErrorMsgs);
 }
 
+static u32 HT_AddVertices(UI_DrawVertex* vertices, int count) {
+	ASSERT_ON_MAIN_THREAD();
+	return UI_AddVertices(vertices, count);
+}
+
 static void HT_AddIndices(u32* indices, int count) {
+	ASSERT_ON_MAIN_THREAD();
 	UI_AddIndices(indices, count, NULL);
 }
 
 static HT_Asset HT_AssetGetType(HT_Asset asset) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	Asset* ptr = GetAsset(&s->asset_tree, asset);
 	if (ptr != NULL && ptr->kind == AssetKind_StructData) {
@@ -1344,10 +1513,11 @@ static HT_Asset HT_AssetGetType(HT_Asset asset) {
 }
 
 static void* HT_AssetGetData(HT_Asset asset) {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	Asset* ptr = GetAsset(&s->asset_tree, asset);
 	if (ptr != NULL && ptr->kind == AssetKind_StructData) {
-		return ptr->struct_data.data;
+		return GetStructData(&s->asset_tree, ptr);
 	}
 	return NULL;
 }
@@ -1358,6 +1528,7 @@ static void HT_D3DWaitForEvent(HANDLE event) { WaitForSingleObjectEx(event, INFI
 
 #ifdef HT_EDITOR_DX12
 static D3D12_CPU_DESCRIPTOR_HANDLE HT_D3D12_GetHatchRenderTargetView() {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	D3D12_CPU_DESCRIPTOR_HANDLE rtv_handle = s->render_state->rtv_heap->GetCPUDescriptorHandleForHeapStart();
 	rtv_handle.ptr += s->render_state->frame_index * s->render_state->rtv_descriptor_size;
@@ -1367,55 +1538,80 @@ static D3D12_CPU_DESCRIPTOR_HANDLE HT_D3D12_GetHatchRenderTargetView() {
 
 #ifdef HT_EDITOR_DX11
 static void D3D11_SetRenderProc(void (*render)(HT_API* ht)) {
+	ASSERT_ON_MAIN_THREAD();
 	g_plugin_call_ctx->plugin->HT_D3D11_Render = render;
 }
 
 static ID3D11RenderTargetView* HT_D3D11_GetHatchRenderTargetView() {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	return s->render_state->framebuffer_rtv;
 }
 #endif
 
 HT_IMPORT void HT_LogInfo(const char* fmt, ...) {
+	ASSERT_ON_MAIN_THREAD();
 	va_list args; va_start(args, fmt);
 	LogVArgs(&g_plugin_call_ctx->s->log, LogMessageKind_Info, fmt, args);
 	va_end(args);
 }
 
 HT_IMPORT void HT_LogWarning(const char* fmt, ...) {
+	ASSERT_ON_MAIN_THREAD();
 	va_list args; va_start(args, fmt);
 	LogVArgs(&g_plugin_call_ctx->s->log, LogMessageKind_Warning, fmt, args);
 	va_end(args);
 }
 
 HT_IMPORT void HT_LogError(const char* fmt, ...) {
+	ASSERT_ON_MAIN_THREAD();
 	va_list args; va_start(args, fmt);
 	LogVArgs(&g_plugin_call_ctx->s->log, LogMessageKind_Error, fmt, args);
 	va_end(args);
 }
 
 static HT_ItemHandle HT_GetSelectedItemHandle() {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	return (HT_ItemHandle)s->properties_tree_data_ui_state.selection;
 }
 
 static bool HT_IsSimulating() {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	return s->is_simulating;
 }
 
+static void HT_ProfileZoneBegin(const char* label) {
+	ProfilerBeginZone({}, STR_ToV(label));
+}
+
+static void HT_ProfileZoneEnd() {
+	ProfilerEndZone(-1);
+}
+
 static void* HT_GetOSWindowHandle() {
+	ASSERT_ON_MAIN_THREAD();
 	EditorState* s = g_plugin_call_ctx->s;
 	return s->window.handle;
 }
 
 EXPORT void InitAPI(EditorState* s) {
 	static HT_API api = {};
-	*(void**)&api.AddVertices = UI_AddVertices;
+	*(void**)&api.AddVertices = HT_AddVertices;
 	api.AddIndices = HT_AddIndices;
 	//*(void**)&api.DrawText = HT_DrawText;
 	api.AllocatorProc = HT_AllocatorProc;
 	api.TempArenaPush = HT_TempArenaPush;
+	api.GetWorkerCount = GetWorkerCount;
+	api.ParallelFor = ParallelFor;
+	api.ParallelReduce = ParallelReduce;
+	api.ItemGroupParallelFor = ItemGroupParallelFor;
+	api.SubmitJob = SubmitJob;
+	api.SubmitJobs = SubmitJobs;
+	api.WaitForCounter = WaitForCounter;
+	api.ProfileZoneBegin = HT_ProfileZoneBegin;
+	api.ProfileZoneEnd = HT_ProfileZoneEnd;
 	api.GetPluginData = HT_GetPluginData_;
 	api.RegisterAssetViewerForType = HT_RegisterAssetViewerForType;
 	api.UnregisterAssetViewerForType = HT_DeregisterAssetViewerForType;
@@ -1449,12 +1645,15 @@ EXPORT void InitAPI(EditorState* s) {
 	*(void**)&api.AssetGetType = HT_AssetGetType;
 	*(void**)&api.AssetGetData = HT_AssetGetData;
 	*(void**)&api.AssetGetModtime = HT_AssetGetModtime;
+	*(void**)&api.AssetGetDependencies = HT_AssetGetDependencies;
+	*(void**)&api.AssetGetDependents = HT_AssetGetDependents;
 	*(void**)&api.AssetGetFilepath = HT_AssetGetFilepath;
 	*(void**)&api.CreateTabClass = HT_CreateTabClass;
 	api.DestroyTabClass = HT_DestroyTabClass;
 	api.input_frame = &s->input_frame;
 
 	api.ItemGroupAdd = ItemGroupAdd;
+	api.InternName = InternName;
 	api.MoveItemToAfter = MoveItemToAfter;
 	api.ItemGroupRemove = ItemGroupRemove;
 
@@ -1462,7 +1661,8 @@ EXPORT void InitAPI(EditorState* s) {
 	s->api = &api;
 }
 
-EXPORT void RunPlugin(EditorState* s, Asset* plugin_asset) {
+// Loads a plugin that has been compiled
+static void StartPlugin(EditorState* s, Asset* plugin_asset) {
 	ASSERT(plugin_asset->plugin.active_instance == NULL);
 
 	Asset* package = plugin_asset;
@@ -1470,35 +1670,24 @@ EXPORT void RunPlugin(EditorState* s, Asset* plugin_asset) {
 	bool ok = OS_SetWorkingDir(DS, package->package.filesys_path);
 	ASSERT(ok);
 
-#ifdef HT_DYNAMIC
-	// TODO: only recompile if needs recompiling
-	ok = RecompilePlugin(s, plugin_asset);
-	if (!ok) return;
-#endif
-
 	// Allocate a plugin instance
-	DS_BucketArrayIndex plugin_instance_i;
-	NEW_SLOT(&plugin_instance_i, &s->plugin_instances, &s->first_free_plugin_instance, freelist_next);
-	PluginInstance* plugin_instance = DS_BkArrGet(&s->plugin_instances, plugin_instance_i);
-
-	DecodedHandle plugin_handle;
-	plugin_handle.bucket_index = DS_BucketFromIndex(plugin_instance_i);
-	plugin_handle.elem_index = DS_SlotFromIndex(plugin_instance_i);
-	
-	// keep the existing generation, except start from 1
-	plugin_handle.generation = DecodeHandle(plugin_instance->handle).generation;
-	if (plugin_handle.generation == 0) plugin_handle.generation = 1;
-	
-	*plugin_instance = {};
+	DS_SlotHandle plugin_handle;
+	PluginInstance* plugin_instance = (PluginInstance*)DS_SlotMapAdd(&s->plugin_instances, &plugin_handle);
+	plugin_instance->handle = (HT_PluginInstance)plugin_handle;
 	plugin_instance->plugin_asset = plugin_asset;
-	plugin_instance->handle = (HT_PluginInstance)EncodeHandle(plugin_handle);
-	DS_ArrInit(&plugin_instance->allocations, HEAP);
+	DS_ArenaInit(&plugin_instance->includes_arena, 4096, HEAP);
+	DS_ArrInit(&plugin_instance->includes, &plugin_instance->includes_arena);
 
 	STR_View plugin_name = plugin_asset->name;
 
 #ifdef HT_DYNAMIC
-	STR_View dll_path = STR_Form(TEMP, ".plugin_binaries\\%v.dll", plugin_name);
-	OS_DLL* dll = OS_LoadDLL(MEM_SCOPE_NONE, dll_path);
+	// Load a copy of the DLL, so that the compiler can write a new version of it while this instance is running
+	STR_View dll_path = GetPluginBinaryPath(TEMP, plugin_asset);
+	STR_View loaded_dll_path = STR_Form(TEMP, "%v.loaded.%v", STR_BeforeLast(dll_path, '.'), STR_AfterLast(dll_path, '.'));
+	ok = BUILD_CopyFile(STR_ToC(TEMP, dll_path), STR_ToC(TEMP, loaded_dll_path));
+	ASSERT(ok);
+
+	OS_DLL* dll = OS_LoadDLL(DS, loaded_dll_path);
 	ok = dll != NULL;
 	ASSERT(ok);
 
@@ -1525,7 +1714,9 @@ EXPORT void RunPlugin(EditorState* s, Asset* plugin_asset) {
 	{
 		PluginCallContext ctx = {s, plugin_instance};
 		g_plugin_call_ctx = &ctx;
+		int zone = ProfilerBeginZone(plugin_asset->name, STR_V("HT_LoadPlugin"));
 		plugin_instance->LoadPlugin(s->api);
+		ProfilerEndZone(zone);
 		g_plugin_call_ctx = NULL;
 	}
 
@@ -1534,6 +1725,139 @@ EXPORT void RunPlugin(EditorState* s, Asset* plugin_asset) {
 	OS_SetWorkingDir(DS, CURRENT_WORKING_DIRECTORY); // reset working directory
 }
 
+static bool HandleArrayContains(DS_ArrayView<HT_Asset> handles, HT_Asset handle) {
+	for (int i = 0; i < handles.count; i++) {
+		if (handles[i] == handle) return true;
+	}
+	return false;
+}
+
+EXPORT void RunPlugins(EditorState* s, DS_ArrayView<Asset*> plugins) {
+#ifdef HT_DYNAMIC
+	// The compile is started by UpdatePluginCompilation, which batches all plugins requested during the frame together
+	for (int i = 0; i < plugins.count; i++) {
+		if (!HandleArrayContains(s->plugins_to_compile, plugins[i]->handle)) {
+			DS_ArrPush(&s->plugins_to_compile, plugins[i]->handle);
+		}
+	}
+#else
+	for (int i = 0; i < plugins.count; i++) {
+		if (plugins[i]->plugin.active_instance) continue;
+		StartPlugin(s, plugins[i]);
+	}
+#endif
+}
+
+EXPORT bool IsPluginCompiling(EditorState* s, Asset* plugin) {
+	return HandleArrayContains(s->plugins_compiling, plugin->handle) || HandleArrayContains(s->plugins_to_compile, plugin->handle);
+}
+
+EXPORT void UpdatePluginCompilation(EditorState* s) {
+#ifdef HT_DYNAMIC
+	if (s->plugin_compile_job) {
+		bool finished = PollPluginCompileJob(s->plugin_compile_job, &s->error_list);
+		if (!finished) return;
+
+		PluginCompileStats stats;
+		DS_DynArray(CompiledPlugin) compiled = {TEMP};
+		FinishPluginCompileJob(s->plugin_compile_job, &s->error_list, &stats, &compiled);
+		s->plugin_compile_job = NULL;
+
+		LogF(&s->log, LogMessageKind_Info, "Compiled %d/%d plugins: %d translation units from the object cache, %d recompiled",
+			compiled.count, s->plugins_compiling.count, stats.cache_hits, stats.cache_misses);
+
+		// Swap in the new versions in the requested order, as that's their update order. A plugin that failed to
+		// compile keeps running its old version, and a plugin that was stopped during the compile stays stopped.
+		for (int i = 0; i < s->plugins_compiling.count; i++) {
+			Asset* plugin = GetAsset(&s->asset_tree, s->plugins_compiling[i]);
+			if (plugin == NULL || !plugin->plugin.active_by_request) continue;
+
+			CompiledPlugin* compiled_plugin = NULL;
+			for (int j = 0; j < compiled.count; j++) {
+				if (compiled[j].plugin == plugin->handle) compiled_plugin = &compiled[j];
+			}
+			if (compiled_plugin == NULL) continue;
+
+			if (plugin->plugin.active_instance) UnloadPlugin(s, plugin);
+			StartPlugin(s, plugin);
+
+			PluginInstance* instance = GetPluginInstance(s, plugin->plugin.active_instance);
+			for (int j = 0; j < compiled_plugin->includes.count; j++) {
+				PluginIncludeStamp stamp = compiled_plugin->includes[j];
+				stamp.file_path = STR_Clone(&instance->includes_arena, stamp.file_path);
+				DS_ArrPush(&instance->includes, stamp);
+			}
+		}
+		DS_ArrClear(&s->plugins_compiling);
+	}
+
+	if (s->plugins_to_compile.count > 0) {
+		DS_DynArray(Asset*) plugins = {TEMP};
+		for (int i = 0; i < s->plugins_to_compile.count; i++) {
+			Asset* plugin = GetAsset(&s->asset_tree, s->plugins_to_compile[i]);
+			if (plugin == NULL) continue;
+
+			RemoveErrorsByAsset(&s->error_list, plugin->handle);
+			DS_ArrPush(&plugins, plugin);
+			DS_ArrPush(&s->plugins_compiling, plugin->handle);
+		}
+		DS_ArrClear(&s->plugins_to_compile);
+
+		s->plugin_compile_job = StartPluginCompileJob(&s->asset_tree, plugins, &s->error_list);
+	}
+#endif
+}
+
+EXPORT void CheckPluginIncludes(EditorState* s, double budget_seconds) {
+#ifdef HT_DYNAMIC
+	int includes_count = 0;
+	for (DS_SlotMapEach(&s->plugin_instances, i)) {
+		includes_count += DS_SlotMapAt(&s->plugin_instances, i)->includes.count;
+	}
+
+	// Each include is checked at most once per call, so that a handful of includes doesn't use up the whole budget
+	u64 start_tick = OS_GetCPUTick();
+	for (int checked = 0; checked < includes_count;) {
+		if (s->include_check_instance >= s->plugin_instances.count) {
+			s->include_check_instance = 0;
+			s->include_check_index = 0;
+		}
+		PluginInstance* instance = DS_SlotMapAt(&s->plugin_instances, s->include_check_instance);
+		if (s->include_check_index >= instance->includes.count) {
+			s->include_check_instance++;
+			s->include_check_index = 0;
+			continue;
+		}
+
+		PluginIncludeStamp* stamp = &instance->includes[s->include_check_index++];
+		checked++;
+
+		u64 modtime = 0;
+		OS_FileGetModtime(DS, stamp->file_path, &modtime);
+		if (modtime != stamp->last_write_time) {
+			Asset* plugin = instance->plugin_asset;
+
+			// If the compiler is running for the plugin, it may have read the old version, so the stamp is kept and the
+			// change is seen again once the new version is swapped in. Otherwise, the stamp is updated right away, so that
+			// a plugin that fails to compile isn't recompiled every frame.
+			if (!HandleArrayContains(s->plugins_compiling, plugin->handle)) {
+				stamp->last_write_time = modtime;
+				if (!HandleArrayContains(s->plugins_to_compile, plugin->handle)) {
+					LogF(&s->log, LogMessageKind_Info, "Recompiling plugin \"%v\", because \"%v\" was modified", plugin->name.view, stamp->file_path);
+					RunPlugin(s, plugin);
+				}
+			}
+		}
+
+		if (OS_GetDuration(CPU_FREQUENCY, start_tick, OS_GetCPUTick()) >= budget_seconds) break;
+	}
+#endif
+}
+
+EXPORT void RunPlugin(EditorState* s, Asset* plugin_asset) {
+	RunPlugins(s, DS_ArrayView<Asset*>(&plugin_asset, 1));
+}
+
 EXPORT void UnloadPlugin(EditorState* s, Asset* plugin_asset) {
 	PluginInstance* plugin = GetPluginInstance(s, plugin_asset->plugin.active_instance);
 	ASSERT(plugin != NULL);
@@ -1541,15 +1865,19 @@ EXPORT void UnloadPlugin(EditorState* s, Asset* plugin_asset) {
 	{
 		PluginCallContext ctx = {s, plugin};
 		g_plugin_call_ctx = &ctx;
+		int zone = ProfilerBeginZone(plugin_asset->name, STR_V("HT_UnloadPlugin"));
 		plugin->UnloadPlugin(s->api);
+		ProfilerEndZone(zone);
 		g_plugin_call_ctx = NULL;
 	}
 
 #ifdef HT_DYNAMIC
 	OS_UnloadDLL(plugin->dll_handle);
 	
+#ifdef _WIN32
 	STR_View pdb_filepath = STR_Form(TEMP, ".plugin_binaries/%v.pdb", plugin_asset->name.view);
 	ForceVisualStudioToClosePDBFileHandle(pdb_filepath);
+#endif
 #endif
 
 	plugin->plugin_asset = NULL;
@@ -1558,20 +1886,16 @@ EXPORT void UnloadPlugin(EditorState* s, Asset* plugin_asset) {
 	plugin->UnloadPlugin = NULL;
 	plugin->UpdatePlugin = NULL;
 
-	for (int i = 0; i < plugin->allocations.count; i++) {
-		PluginAllocationHeader* allocation = plugin->allocations[i];
-		DS_MemFree(HEAP, allocation);
+	if (plugin->heap.stats.allocation_count > 0) {
+		LogF(&s->log, LogMessageKind_Info, "Unloading plugin \"%v\": releasing %llu allocations (%llu bytes) that were not freed by the plugin",
+			plugin_asset->name.view, plugin->heap.stats.allocation_count, plugin->heap.stats.bytes_in_use);
 	}
-	DS_ArrDeinit(&plugin->allocations);
-	plugin->allocations = {};
+	PluginHeapDeinit(&plugin->heap);
+	DS_ArenaDeinit(&plugin->includes_arena);
 
-	// increment the handle generation to invalidate any handles
-	DecodedHandle plugin_handle = DecodeHandle(plugin->handle);
-	plugin_handle.generation += 1;
-	plugin->handle = (HT_PluginInstance)EncodeHandle(plugin_handle);
-	
-	DS_BucketArrayIndex plugin_instance_i = DS_EncodeBucketArrayIndex(plugin_handle.bucket_index, plugin_handle.elem_index);
-	FREE_SLOT(plugin_instance_i, &s->plugin_instances, &s->first_free_plugin_instance, freelist_next);
+	// removing the slot increments its generation to invalidate any handles
+	bool ok = DS_SlotMapRemove(&s->plugin_instances, (DS_SlotHandle)plugin->handle);
+	ASSERT(ok);
 
 	plugin_asset->plugin.active_instance = NULL;
 }
@@ -1580,8 +1904,8 @@ EXPORT void UnloadPlugin(EditorState* s, Asset* plugin_asset) {
 EXPORT void D3D12_BuildPluginCommandLists(EditorState* s) {
 	// Then populate the command list for plugin defined things
 	
-	for (DS_BkArrEach(&s->asset_tree.assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&s->asset_tree.assets, asset_i);
+	for (DS_SlotMapEach(&s->asset_tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&s->asset_tree.assets, asset_i);
 		if (asset->kind != AssetKind_Plugin) continue;
 
 		PluginInstance* plugin_instance = GetPluginInstance(s, asset->plugin.active_instance);
@@ -1592,7 +1916,9 @@ EXPORT void D3D12_BuildPluginCommandLists(EditorState* s) {
 
 				PluginCallContext ctx = {s, plugin_instance};
 				g_plugin_call_ctx = &ctx;
+				int zone = ProfilerBeginZone(asset->name, STR_V("HT_D3D12_BuildPluginCommandList"));
 				BuildPluginD3DCommandList(s->api, s->render_state->command_list);
+				ProfilerEndZone(zone);
 				g_plugin_call_ctx = NULL;
 			}
 		}
@@ -1602,31 +1928,126 @@ EXPORT void D3D12_BuildPluginCommandLists(EditorState* s) {
 
 #ifdef HT_EDITOR_DX11
 EXPORT void D3D11_RenderPlugins(EditorState* s) {
-	for (DS_BkArrEach(&s->plugin_instances, i)) {
-		PluginInstance* plugin = DS_BkArrGet(&s->plugin_instances, i);
-		if (plugin->plugin_asset == NULL) continue; // empty slot
+	int render_zone = ProfilerBeginZone({}, STR_V("D3D11_RenderPlugins"));
+	for (DS_SlotMapEach(&s->plugin_instances, i)) {
+		PluginInstance* plugin = DS_SlotMapAt(&s->plugin_instances, i);
 
 		if (plugin->HT_D3D11_Render) {
 			PluginCallContext ctx = {s, plugin};
 			g_plugin_call_ctx = &ctx;
+			int zone = ProfilerBeginZone(plugin->plugin_asset->name, STR_V("HT_D3D11_Render"));
 			plugin->HT_D3D11_Render(s->api);
+			ProfilerEndZone(zone);
 			g_plugin_call_ctx = NULL;
 		}
 	}
+	ProfilerEndZone(render_zone);
 }
 #endif
 
+// The plugins of one level of the update order
+struct PluginUpdateStage {
+	EditorState* s;
+	DS_DynArray(HT_PluginInstance) main_thread_plugins;
+	DS_DynArray(PluginInstance*) worker_plugins;
+	DS_DynArray(void*) worker_plugin_data; // parallel to worker_plugins
+};
+
+static void UpdateMainThreadPlugins(void* user_data) {
+	PluginUpdateStage* stage = (PluginUpdateStage*)user_data;
+	for (int i = 0; i < stage->main_thread_plugins.count; i++) {
+		PluginInstance* plugin_instance = GetPluginInstance(stage->s, stage->main_thread_plugins[i]);
+		if (plugin_instance == NULL) continue;
+
+		PluginCallContext ctx = {stage->s, plugin_instance};
+		g_plugin_call_ctx = &ctx;
+		int zone = ProfilerBeginZone(plugin_instance->plugin_asset->name, STR_V("HT_UpdatePlugin"));
+		plugin_instance->UpdatePlugin(stage->s->api);
+		ProfilerEndZone(zone);
+		g_plugin_call_ctx = NULL;
+	}
+}
+
+static void UpdateWorkerPluginsBatch(void* user_data, int worker_index, int begin, int end) {
+	PluginUpdateStage* stage = (PluginUpdateStage*)user_data;
+
+	// A main thread plugin that waits for jobs may end up running this batch inside its own update
+	PluginCallContext* outer_ctx = g_plugin_call_ctx;
+	for (int i = begin; i < end; i++) {
+		PluginCallContext ctx = {stage->s, stage->worker_plugins[i]};
+		ctx.on_worker_thread = true;
+		ctx.plugin_data = stage->worker_plugin_data[i];
+		g_plugin_call_ctx = &ctx;
+		int zone = ProfilerBeginZone(stage->worker_plugins[i]->plugin_asset->name, STR_V("HT_UpdatePlugin"));
+		stage->worker_plugins[i]->UpdatePlugin(stage->s->api);
+		ProfilerEndZone(zone);
+	}
+	g_plugin_call_ctx = outer_ctx;
+}
+
+// Returns the length of the longest chain of `update_after` dependencies that leads to the plugin. A dependency that
+// would close a cycle is ignored. `levels` starts out as -2 for every plugin; -1 marks the plugins being visited.
+static int GetPluginUpdateLevel(DS_ArrayView<Asset*> plugins, int* levels, int index) {
+	if (levels[index] != -2) return levels[index];
+	levels[index] = -1;
+
+	int level = 0;
+	PluginOptions* opts = &plugins[index]->plugin.options;
+	for (int i = 0; i < opts->update_after.count; i++) {
+		HT_Asset dependency = *((HT_Asset*)opts->update_after.data + i);
+		for (int j = 0; j < plugins.count; j++) {
+			if (plugins[j]->handle != dependency) continue;
+			int dependency_level = GetPluginUpdateLevel(plugins, levels, j);
+			if (dependency_level >= 0) level = UI_Max(level, dependency_level + 1);
+		}
+	}
+	levels[index] = level;
+	return level;
+}
+
 EXPORT void UpdatePlugins(EditorState* s) {
-	for (DS_BkArrEach(&s->asset_tree.assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&s->asset_tree.assets, asset_i);
-		if (asset->kind != AssetKind_Plugin) continue;
-		
-		PluginInstance* plugin_instance = GetPluginInstance(s, asset->plugin.active_instance);
-		if (plugin_instance) {
-			PluginCallContext ctx = {s, plugin_instance};
-			g_plugin_call_ctx = &ctx;
-			plugin_instance->UpdatePlugin(s->api);
-			g_plugin_call_ctx = NULL;
+	PluginMemoryStatsBeginFrame(s);
+	int update_zone = ProfilerBeginZone({}, STR_V("UpdatePlugins"));
+
+	DS_DynArray(Asset*) plugins = {TEMP};
+	for (DS_SlotMapEach(&s->asset_tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&s->asset_tree.assets, asset_i);
+		if (asset->kind == AssetKind_Plugin && GetPluginInstance(s, asset->plugin.active_instance)) DS_ArrPush(&plugins, asset);
+	}
+
+	int* levels = (int*)DS_ArenaPush(TEMP, sizeof(int) * plugins.count);
+	for (int i = 0; i < plugins.count; i++) levels[i] = -2;
+
+	int levels_count = 0;
+	for (int i = 0; i < plugins.count; i++) {
+		levels_count = UI_Max(levels_count, GetPluginUpdateLevel(plugins, levels, i) + 1);
+	}
+
+	// Each level starts once the previous one is done. Within a level, the worker plugins run on the pool while the main
+	// thread updates the rest.
+	for (int level = 0; level < levels_count; level++) {
+		PluginUpdateStage stage = {};
+		stage.s = s;
+		DS_ArrInit(&stage.main_thread_plugins, TEMP);
+		DS_ArrInit(&stage.worker_plugins, TEMP);
+		DS_ArrInit(&stage.worker_plugin_data, TEMP);
+
+		for (int i = 0; i < plugins.count; i++) {
+			if (levels[i] != level) continue;
+			PluginInstance* plugin_instance = GetPluginInstance(s, plugins[i]->plugin.active_instance);
+
+			if (plugins[i]->plugin.options.update_on_worker_thread) {
+				// The data is looked up here, as loading it on first access isn't thread-safe
+				DS_ArrPush(&stage.worker_plugins, plugin_instance);
+				DS_ArrPush(&stage.worker_plugin_data, GetPluginData(s, plugin_instance));
+			}
+			else {
+				DS_ArrPush(&stage.main_thread_plugins, plugin_instance->handle);
+			}
 		}
+
+		ParallelForAlongside(stage.worker_plugins.count, 1, UpdateWorkerPluginsBatch, &stage, UpdateMainThreadPlugins);
 	}
+
+	ProfilerEndZone(update_zone);
 }
\ No newline at end of file
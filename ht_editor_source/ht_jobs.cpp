@@ -0,0 +1,454 @@
+#include "include/ht_common.h"
+
+// A pool of worker threads that's shared by the editor and all plugins. Each worker owns a queue of jobs; the owner pushes and
+// pops at the back, so it works on its most recently queued, cache-warm jobs, while workers that run out of work steal the oldest
+// jobs from the front of the other queues. The main thread is worker 0 and owns queue 0, which is also used by threads outside
+// the pool. Threads that wait for a job counter run queued jobs in the meantime, so waiting never leaves a core idle.
+//
+// A parallel-for queues one job per worker that grabs batches from a shared atomic counter, and the calling thread runs
+// batches as well. Nested parallel-fors, i.e. ones called from inside a job, are run on the calling thread.
+
+#define JOB_QUEUE_CAPACITY 4096 // must be a power of two
+
+struct Job {
+	HT_JobProc proc;
+	void* user_data;
+	HT_JobCounter* counter; // may be NULL
+};
+
+struct JobQueue {
+	OS_Mutex mutex;
+	Job* jobs; // ring buffer of JOB_QUEUE_CAPACITY jobs
+	u32 head; // the oldest job, taken by thieves
+	u32 tail; // one past the newest job, pushed and popped by the owner
+};
+
+struct WorkerThread {
+	OS_Thread thread;
+	i32 worker_index;
+
+	// Temporary memory for the plugins that update on this worker, reset each frame like TEMP. The editor's HEAP counts
+	// allocations without synchronization, so each worker has its own heap.
+	DS_AllocatorBase heap;
+	DS_Arena temp;
+};
+
+struct WorkerPool {
+	JobQueue* queues; // one per worker
+	volatile i32 queued_jobs_count;
+
+	// Workers sleep when there are no queued jobs, and so do threads waiting for a counter when there's nothing to steal.
+	// Sleepers are woken when a job is queued or a counter reaches zero.
+	OS_Mutex sleep_mutex;
+	OS_ConditionVar wake_up;
+	volatile i32 sleeping_count;
+	bool quit;
+
+	WorkerThread* threads;
+	i32 threads_count;
+};
+
+// Temporary memory for a thread that isn't in the pool, such as one started by a plugin. The main thread can't reset it
+// safely, so the thread resets it itself on its first use in each frame.
+struct OutsideThreadTemp {
+	DS_AllocatorBase heap;
+	DS_Arena arena;
+	bool initialized;
+	i32 frame; // value of g_temp_frame when the arena was last reset
+
+	~OutsideThreadTemp() {
+		if (initialized) DS_ArenaDeinit(&arena);
+	}
+};
+
+static WorkerPool g_worker_pool;
+static thread_local i32 g_worker_index = -1; // -1 on threads that are not in the pool. The main thread is worker 0.
+static thread_local i32 g_job_depth; // number of jobs that are running on this thread's stack
+static thread_local OutsideThreadTemp g_outside_thread_temp;
+static volatile i32 g_temp_frame; // incremented by ResetWorkerTempArenas
+
+static i32 GetOwnQueueIndex() {
+	return g_worker_index > 0 ? g_worker_index : 0;
+}
+
+static bool JobQueuePush(JobQueue* queue, Job job) {
+	OS_MutexLock(&queue->mutex);
+	bool ok = queue->tail - queue->head < JOB_QUEUE_CAPACITY;
+	if (ok) {
+		queue->jobs[queue->tail & (JOB_QUEUE_CAPACITY - 1)] = job;
+		queue->tail++;
+	}
+	OS_MutexUnlock(&queue->mutex);
+	return ok;
+}
+
+static bool JobQueueTake(JobQueue* queue, Job* out_job, bool steal) {
+	OS_MutexLock(&queue->mutex);
+	bool ok = queue->tail != queue->head;
+	if (ok) {
+		if (steal) {
+			*out_job = queue->jobs[queue->head & (JOB_QUEUE_CAPACITY - 1)];
+			queue->head++;
+		}
+		else {
+			queue->tail--;
+			*out_job = queue->jobs[queue->tail & (JOB_QUEUE_CAPACITY - 1)];
+		}
+	}
+	OS_MutexUnlock(&queue->mutex);
+	return ok;
+}
+
+static void WakeSleepers(bool all) {
+	WorkerPool* pool = &g_worker_pool;
+	// Sleepers register themselves before checking whether to sleep, so either they see the change that we're announcing,
+	// or we see them here.
+	if (OS_AtomicAddI32(&pool->sleeping_count, 0) == 0) return;
+
+	OS_MutexLock(&pool->sleep_mutex);
+	if (all) OS_ConditionVarBroadcast(&pool->wake_up);
+	else OS_ConditionVarSignal(&pool->wake_up);
+	OS_MutexUnlock(&pool->sleep_mutex);
+}
+
+static void RunJob(Job* job) {
+	g_job_depth++;
+	job->proc(job->user_data);
+	g_job_depth--;
+
+	if (job->counter && OS_AtomicAddI32(&job->counter->pending, -1) == 0) {
+		WakeSleepers(true);
+	}
+}
+
+static bool FindJob(Job* out_job) {
+	WorkerPool* pool = &g_worker_pool;
+	i32 queues_count = pool->threads_count + 1;
+	i32 own = GetOwnQueueIndex();
+
+	bool found = JobQueueTake(&pool->queues[own], out_job, false);
+	for (i32 i = 1; i < queues_count && !found; i++) {
+		found = JobQueueTake(&pool->queues[(own + i) % queues_count], out_job, true);
+	}
+	if (found) OS_AtomicAddI32(&pool->queued_jobs_count, -1);
+	return found;
+}
+
+// Queues a job without waking anyone up. Returns false if the job was run right away instead.
+static bool QueueJob(HT_JobProc proc, void* user_data, HT_JobCounter* counter) {
+	WorkerPool* pool = &g_worker_pool;
+	Job job = {proc, user_data, counter};
+	if (counter) OS_AtomicAddI32(&counter->pending, 1);
+
+	if (pool->threads_count == 0 || !JobQueuePush(&pool->queues[GetOwnQueueIndex()], job)) {
+		RunJob(&job);
+		return false;
+	}
+	OS_AtomicAddI32(&pool->queued_jobs_count, 1);
+	return true;
+}
+
+static void WorkerThreadProc(void* user_data) {
+	WorkerThread* thread = (WorkerThread*)user_data;
+	WorkerPool* pool = &g_worker_pool;
+	g_worker_index = thread->worker_index;
+
+	for (;;) {
+		Job job;
+		if (FindJob(&job)) {
+			RunJob(&job);
+			continue;
+		}
+
+		OS_MutexLock(&pool->sleep_mutex);
+		OS_AtomicAddI32(&pool->sleeping_count, 1);
+		while (!pool->quit && OS_AtomicAddI32(&pool->queued_jobs_count, 0) == 0) {
+			OS_ConditionVarWait(&pool->wake_up, &pool->sleep_mutex);
+		}
+		OS_AtomicAddI32(&pool->sleeping_count, -1);
+		bool quit = pool->quit;
+		OS_MutexUnlock(&pool->sleep_mutex);
+		if (quit) break;
+	}
+}
+
+EXPORT void InitWorkerPool() {
+	WorkerPool* pool = &g_worker_pool;
+	OS_MutexInit(&pool->sleep_mutex);
+	OS_ConditionVarInit(&pool->wake_up);
+	g_worker_index = 0;
+
+	pool->threads_count = OS_GetLogicalProcessorCount() - 1;
+	if (pool->threads_count < 0) pool->threads_count = 0;
+
+	// The queues must exist before any worker starts stealing from them
+	pool->queues = (JobQueue*)DS_MemAlloc(HEAP, sizeof(JobQueue) * (pool->threads_count + 1));
+	for (i32 i = 0; i < pool->threads_count + 1; i++) {
+		JobQueue* queue = &pool->queues[i];
+		OS_MutexInit(&queue->mutex);
+		queue->jobs = (Job*)DS_MemAlloc(HEAP, sizeof(Job) * JOB_QUEUE_CAPACITY);
+		queue->head = 0;
+		queue->tail = 0;
+	}
+
+	pool->threads = (WorkerThread*)DS_MemAlloc(HEAP, sizeof(WorkerThread) * pool->threads_count);
+	memset(pool->threads, 0, sizeof(WorkerThread) * pool->threads_count);
+	for (i32 i = 0; i < pool->threads_count; i++) {
+		WorkerThread* thread = &pool->threads[i];
+		thread->worker_index = i + 1;
+		thread->heap = { DS, DS_HeapAllocatorProc };
+		DS_ArenaInit(&thread->temp, 4096, (DS_Allocator*)&thread->heap);
+		OS_ThreadStart(&thread->thread, WorkerThreadProc, thread, STR_FormC(TEMP, "Hatch Worker %d", thread->worker_index));
+	}
+}
+
+EXPORT void DeinitWorkerPool() {
+	WorkerPool* pool = &g_worker_pool;
+
+	// Let the workers finish the jobs that are still queued
+	while (OS_AtomicAddI32(&pool->queued_jobs_count, 0) > 0) {
+		Job job;
+		if (FindJob(&job)) RunJob(&job);
+	}
+
+	OS_MutexLock(&pool->sleep_mutex);
+	pool->quit = true;
+	OS_ConditionVarBroadcast(&pool->wake_up);
+	OS_MutexUnlock(&pool->sleep_mutex);
+
+	for (i32 i = 0; i < pool->threads_count; i++) {
+		OS_ThreadJoin(&pool->threads[i].thread);
+		DS_ArenaDeinit(&pool->threads[i].temp);
+	}
+	DS_MemFree(HEAP, pool->threads);
+
+	for (i32 i = 0; i < pool->threads_count + 1; i++) {
+		OS_MutexDestroy(&pool->queues[i].mutex);
+		DS_MemFree(HEAP, pool->queues[i].jobs);
+	}
+	DS_MemFree(HEAP, pool->queues);
+
+	OS_ConditionVarDestroy(&pool->wake_up);
+	OS_MutexDestroy(&pool->sleep_mutex);
+	g_worker_pool = {};
+}
+
+EXPORT int GetWorkerCount() {
+	return g_worker_pool.threads_count + 1;
+}
+
+EXPORT int GetWorkerIndex() {
+	return g_worker_index;
+}
+
+EXPORT DS_Arena* GetWorkerTempArena() {
+	if (g_worker_index == 0) return TEMP;
+	if (g_worker_index > 0) return &g_worker_pool.threads[g_worker_index - 1].temp;
+
+	OutsideThreadTemp* temp = &g_outside_thread_temp;
+	i32 frame = OS_AtomicAddI32(&g_temp_frame, 0);
+	if (!temp->initialized) {
+		temp->heap = { DS, DS_HeapAllocatorProc };
+		DS_ArenaInit(&temp->arena, 4096, (DS_Allocator*)&temp->heap);
+		temp->initialized = true;
+	}
+	else if (temp->frame != frame) {
+		DS_ArenaReset(&temp->arena);
+	}
+	temp->frame = frame;
+	return &temp->arena;
+}
+
+EXPORT void ResetWorkerTempArenas() {
+	for (i32 i = 0; i < g_worker_pool.threads_count; i++) {
+		DS_ArenaReset(&g_worker_pool.threads[i].temp);
+	}
+	OS_AtomicAddI32(&g_temp_frame, 1);
+}
+
+EXPORT void SubmitJob(HT_JobProc proc, void* user_data, HT_JobCounter* counter) {
+	if (QueueJob(proc, user_data, counter)) WakeSleepers(false);
+}
+
+EXPORT void SubmitJobs(HT_JobProc proc, void** user_datas, int count, HT_JobCounter* counter) {
+	bool queued_any = false;
+	for (int i = 0; i < count; i++) {
+		queued_any |= QueueJob(proc, user_datas[i], counter);
+	}
+	if (queued_any) WakeSleepers(count > 1);
+}
+
+EXPORT void WaitForCounter(HT_JobCounter* counter) {
+	WorkerPool* pool = &g_worker_pool;
+	while (OS_AtomicAddI32(&counter->pending, 0) > 0) {
+		Job job;
+		if (FindJob(&job)) {
+			RunJob(&job);
+			continue;
+		}
+
+		// The remaining jobs are running on other threads
+		OS_MutexLock(&pool->sleep_mutex);
+		OS_AtomicAddI32(&pool->sleeping_count, 1);
+		if (OS_AtomicAddI32(&counter->pending, 0) > 0 && OS_AtomicAddI32(&pool->queued_jobs_count, 0) == 0) {
+			OS_ConditionVarWait(&pool->wake_up, &pool->sleep_mutex);
+		}
+		OS_AtomicAddI32(&pool->sleeping_count, -1);
+		OS_MutexUnlock(&pool->sleep_mutex);
+	}
+}
+
+struct ParallelJob {
+	HT_ParallelForProc proc;
+	void* user_data;
+	i32 count;
+	i32 batch_size;
+	i32 batches_count;
+	volatile i32 next_batch;
+};
+
+static void ParallelJobRunBatches(ParallelJob* job, i32 worker_index) {
+	for (;;) {
+		i32 batch = OS_AtomicAddI32(&job->next_batch, 1) - 1;
+		if (batch >= job->batches_count) break;
+
+		i32 begin = batch * job->batch_size;
+		i32 end = begin + job->batch_size;
+		if (end > job->count) end = job->count;
+		job->proc(job->user_data, worker_index, begin, end);
+	}
+}
+
+static void ParallelJobProc(void* user_data) {
+	ParallelJobRunBatches((ParallelJob*)user_data, GetOwnQueueIndex());
+}
+
+EXPORT void ParallelFor(int count, int batch_size, HT_ParallelForProc proc, void* user_data) {
+	ParallelForAlongside(count, batch_size, proc, user_data, NULL);
+}
+
+EXPORT void ParallelForAlongside(int count, int batch_size, HT_ParallelForProc proc, void* user_data, void (*caller_proc)(void* user_data)) {
+	ASSERT(batch_size > 0);
+	if (count <= 0) {
+		if (caller_proc) caller_proc(user_data);
+		return;
+	}
+
+	ParallelJob job = {};
+	job.proc = proc;
+	job.user_data = user_data;
+	job.count = count;
+	job.batch_size = batch_size;
+	job.batches_count = (count + batch_size - 1) / batch_size;
+
+	WorkerPool* pool = &g_worker_pool;
+	bool run_on_this_thread = g_worker_index != 0 || g_job_depth > 0 || pool->threads_count == 0 || (job.batches_count == 1 && caller_proc == NULL);
+	if (run_on_this_thread) {
+		if (caller_proc) caller_proc(user_data);
+		ParallelJobRunBatches(&job, GetOwnQueueIndex());
+		return;
+	}
+
+	// The calling thread takes batches too, so one job less than the batches is enough
+	i32 jobs_count = job.batches_count - (caller_proc ? 0 : 1);
+	if (jobs_count > pool->threads_count) jobs_count = pool->threads_count;
+
+	HT_JobCounter counter = {};
+	bool queued_any = false;
+	for (i32 i = 0; i < jobs_count; i++) {
+		queued_any |= QueueJob(ParallelJobProc, &job, &counter);
+	}
+	if (queued_any) WakeSleepers(true);
+
+	// Parallel-fors from inside caller_proc are run as separate jobs alongside this one
+	if (caller_proc) caller_proc(user_data);
+	ParallelJobRunBatches(&job, 0);
+
+	// All batches have been claimed at this point, but some workers may still be running theirs.
+	WaitForCounter(&counter);
+}
+
+struct ParallelReduceJob {
+	HT_ParallelReduceProc proc;
+	void* user_data;
+	char* partial_results;
+	size_t result_size;
+};
+
+static void ParallelReduceBatch(void* user_data, int worker_index, int begin, int end) {
+	ParallelReduceJob* job = (ParallelReduceJob*)user_data;
+	job->proc(job->user_data, job->partial_results + job->result_size * worker_index, begin, end);
+}
+
+EXPORT void ParallelReduce(int count, int batch_size, HT_ParallelReduceProc proc, HT_ReduceCombineProc combine, void* user_data, void* result, size_t result_size) {
+	int workers_count = GetWorkerCount();
+
+	// Partial results are padded to separate cache lines so that the workers don't fight over them.
+	size_t stride = DS_AlignUpPow2(result_size, 64);
+
+	ParallelReduceJob job = {};
+	job.proc = proc;
+	job.user_data = user_data;
+	job.result_size = stride;
+	// Arenas only align up to DS_ARENA_BLOCK_ALIGNMENT, so over-allocate and align by hand
+	char* partial_results = DS_ArenaPush(GetWorkerTempArena(), stride * workers_count + 63);
+	job.partial_results = (char*)DS_AlignUpPow2((intptr_t)partial_results, 64);
+	for (int i = 0; i < workers_count; i++) {
+		memcpy(job.partial_results + stride * i, result, result_size);
+	}
+
+	ParallelFor(count, batch_size, ParallelReduceBatch, &job);
+
+	for (int i = 0; i < workers_count; i++) {
+		combine(user_data, result, job.partial_results + stride * i);
+	}
+}
+
+struct ItemGroupParallelForJob {
+	HT_ItemGroup* group;
+	HT_ItemGroupParallelForProc proc;
+	void* user_data;
+	u8* slot_is_free; // NULL if the group has no free slots
+};
+
+static void ItemGroupParallelForBatch(void* user_data, int worker_index, int begin, int end) {
+	ItemGroupParallelForJob* job = (ItemGroupParallelForJob*)user_data;
+	HT_ItemGroup* group = job->group;
+
+	for (int bucket = begin; bucket < end; bucket++) {
+		u32 bucket_end = bucket == group->buckets.count - 1 ? (u32)group->last_bucket_end : (u32)group->elems_per_bucket;
+		if (job->slot_is_free == NULL) {
+			job->proc(job->user_data, worker_index, group, (u32)bucket, 0, bucket_end);
+			continue;
+		}
+
+		// Call the proc on each run of live slots
+		u8* slot_is_free = job->slot_is_free + bucket * group->elems_per_bucket;
+		for (u32 i = 0; i < bucket_end;) {
+			if (slot_is_free[i]) { i++; continue; }
+
+			u32 run_begin = i;
+			for (; i < bucket_end && !slot_is_free[i]; i++) {}
+			job->proc(job->user_data, worker_index, group, (u32)bucket, run_begin, i);
+		}
+	}
+}
+
+EXPORT void ItemGroupParallelFor(HT_ItemGroup* group, HT_ItemGroupParallelForProc proc, void* user_data) {
+	ItemGroupParallelForJob job = {};
+	job.group = group;
+	job.proc = proc;
+	job.user_data = user_data;
+
+	if (group->freelist_first) {
+		int slots_count = group->buckets.count * group->elems_per_bucket;
+		job.slot_is_free = (u8*)DS_ArenaPush(GetWorkerTempArena(), slots_count);
+		memset(job.slot_is_free, 0, slots_count);
+
+		for (HT_ItemIndex free_item = group->freelist_first; free_item; free_item = HT_NextItem(group, free_item)) {
+			job.slot_is_free[HT_ItemIndexBucket(free_item) * group->elems_per_bucket + HT_ItemIndexElem(free_item)] = 1;
+		}
+	}
+
+	ParallelFor(group->buckets.count, 1, ItemGroupParallelForBatch, &job);
+}
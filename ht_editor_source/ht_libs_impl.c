@@ -1,4 +1,5 @@
 #define _CRT_SECURE_NO_WARNINGS
+#define _GNU_SOURCE // for pthread_setname_np in fire_os_sync.h; must come before the first system header
 
 #define EXPORT
 
@@ -10,11 +11,18 @@
 #define FIRE_BUILD_IMPLEMENTATION
 #include <ht_utils/fire/fire_build.h>
 
+#ifndef HT_HEADLESS // the headless build has no window
 #define FIRE_OS_WINDOW_IMPLEMENTATION
 #include <ht_utils/fire/fire_os_window.h>
+#endif
 
 #define FIRE_OS_TIMING_IMPLEMENTATION
 #include <ht_utils/fire/fire_os_timing.h>
 
+#ifndef HT_HEADLESS
 #define FIRE_OS_CLIPBOARD_IMPLEMENTATION
 #include <ht_utils/fire/fire_os_clipboard.h>
+#endif
+
+#define FIRE_OS_SYNC_IMPLEMENTATION
+#include <ht_utils/fire/fire_os_sync.h>
@@ -0,0 +1,187 @@
+#define _CRT_SECURE_NO_WARNINGS // for fopen
+
+#include "include/ht_common.h"
+
+// Pull-style tokenizer for the Metadesk files of assets. Unlike md.c, no node tree is built: the file is read through
+// a window that only needs to be as big as the longest token, and the caller consumes the tokens as it goes.
+
+#define MD_READER_WINDOW_SIZE (64 * 1024)
+
+static bool IsAlpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+static bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Makes sure that at least `offset + 1` unread bytes are in the window, unless the file ends before that.
+// Moves the unread bytes to the start of the window, so any pointers into the window are invalidated.
+static bool MDReaderFill(MDReader* r, size_t offset) {
+	while (r->pos + offset >= r->end) {
+		if (r->file_ended) return false;
+
+		if (r->pos > 0) {
+			memmove(r->buffer, r->buffer + r->pos, r->end - r->pos);
+			r->end -= r->pos;
+			r->pos = 0;
+		}
+
+		if (r->end == r->buffer_capacity) { // a single token doesn't fit in the window
+			size_t new_capacity = r->buffer_capacity * 2;
+			r->buffer = (char*)DS_MemResize(HEAP, r->buffer, r->buffer_capacity, new_capacity);
+			r->buffer_capacity = new_capacity;
+		}
+
+		size_t read_size = fread(r->buffer + r->end, 1, r->buffer_capacity - r->end, r->file);
+		r->end += read_size;
+		r->bytes_read += read_size;
+		if (read_size == 0) r->file_ended = true;
+	}
+	return true;
+}
+
+// Returns 0 at the end of the file
+static inline char MDReaderPeek(MDReader* r, size_t offset) {
+	if (r->pos + offset < r->end || MDReaderFill(r, offset)) return r->buffer[r->pos + offset];
+	return 0;
+}
+
+EXPORT bool MDReaderOpen(MDReader* r, STR_View file_path) {
+	r->file = fopen(STR_ToC(TEMP, file_path), "rb");
+	if (r->file == NULL) return false;
+
+	if (r->buffer == NULL) {
+		r->buffer_capacity = MD_READER_WINDOW_SIZE;
+		r->buffer = (char*)DS_MemAlloc(HEAP, r->buffer_capacity);
+	}
+	r->file_path = file_path;
+	r->pos = 0;
+	r->end = 0;
+	r->file_ended = false;
+	r->line = 1;
+
+	MDReaderNext(r);
+	return true;
+}
+
+EXPORT void MDReaderClose(MDReader* r) {
+	if (r->file) fclose(r->file);
+	r->file = NULL;
+}
+
+EXPORT void MDReaderDeinit(MDReader* r) {
+	MDReaderClose(r);
+	if (r->buffer) DS_MemFree(HEAP, r->buffer);
+	r->buffer = NULL;
+	r->buffer_capacity = 0;
+}
+
+EXPORT void MDReaderError(MDReader* r, const char* fmt, ...) {
+	va_list args; va_start(args, fmt);
+	STR_Builder b = { TEMP };
+	STR_PrintVA(&b, fmt, args);
+	va_end(args);
+
+	printf("%.*s(%d): ERROR: %.*s\n", StrArg(r->file_path), r->token_line, StrArg(b.str));
+	if (OS_IsDebuggerPresent()) __debugbreak();
+	exit(1);
+}
+
+static void MDReaderSkipWhitespaceAndComments(MDReader* r) {
+	for (;;) {
+		char c = MDReaderPeek(r, 0);
+		if (c == '\n') {
+			r->line++;
+			r->pos++;
+		}
+		else if (c == ' ' || c == '\t' || c == '\r' || c == ',' || c == ';') { // separators are not needed to parse typed values
+			r->pos++;
+		}
+		else if (c == '/' && MDReaderPeek(r, 1) == '/') {
+			for (; (c = MDReaderPeek(r, 0)) != 0 && c != '\n'; r->pos++) {}
+		}
+		else if (c == '/' && MDReaderPeek(r, 1) == '*') { // block comments nest, like in md.c
+			r->pos += 2;
+			int depth = 1;
+			while (depth > 0) {
+				c = MDReaderPeek(r, 0);
+				if (c == 0) break;
+				if (c == '/' && MDReaderPeek(r, 1) == '*') { depth++; r->pos += 2; }
+				else if (c == '*' && MDReaderPeek(r, 1) == '/') { depth--; r->pos += 2; }
+				else {
+					if (c == '\n') r->line++;
+					r->pos++;
+				}
+			}
+		}
+		else break;
+	}
+}
+
+EXPORT void MDReaderNext(MDReader* r) {
+	MDReaderSkipWhitespaceAndComments(r);
+	r->token_line = r->line;
+
+	char c = MDReaderPeek(r, 0);
+	size_t size = 0;       // size of the token in the file
+	size_t string_start = 0, string_end = 0; // token string, relative to the start of the token
+
+	if (c == 0) {
+		r->token_kind = MDTokenKind_EOF;
+	}
+	else if (IsAlpha(c)) {
+		r->token_kind = MDTokenKind_Identifier;
+		for (size = 1; IsAlpha(c = MDReaderPeek(r, size)) || IsDigit(c); size++) {}
+		string_end = size;
+	}
+	else if (c == '@' && IsAlpha(MDReaderPeek(r, 1))) {
+		r->token_kind = MDTokenKind_Tag;
+		for (size = 2; IsAlpha(c = MDReaderPeek(r, size)) || IsDigit(c); size++) {}
+		string_start = 1;
+		string_end = size;
+	}
+	else if (IsDigit(c) || (c == '.' && IsDigit(MDReaderPeek(r, 1)))) {
+		// Same rules as md.c: letters, digits and dots, plus the sign of an exponent
+		r->token_kind = MDTokenKind_Numeric;
+		bool hex = c == '0' && (MDReaderPeek(r, 1) == 'x' || MDReaderPeek(r, 1) == 'X');
+		for (size = 1;; size++) {
+			c = MDReaderPeek(r, size);
+			if (IsAlpha(c) || IsDigit(c) || c == '.') continue;
+			char prev = r->buffer[r->pos + size - 1];
+			if ((c == '+' || c == '-') && !hex && (prev == 'e' || prev == 'E')) continue;
+			break;
+		}
+		string_end = size;
+	}
+	else if (c == '"' || c == '\'' || c == '`') {
+		r->token_kind = MDTokenKind_String;
+		char quote = c;
+		bool triple = MDReaderPeek(r, 1) == quote && MDReaderPeek(r, 2) == quote;
+		size_t quote_size = triple ? 3 : 1;
+
+		for (size = quote_size;; size++) {
+			c = MDReaderPeek(r, size);
+			if (c == 0) MDReaderError(r, "Unterminated string literal");
+			if (c == '\n') r->line++;
+			if (c == '\\' && !triple) { size++; continue; } // escaped characters are kept as they are, like in md.c
+			if (c == quote && (!triple || (MDReaderPeek(r, size + 1) == quote && MDReaderPeek(r, size + 2) == quote))) break;
+		}
+		string_start = quote_size;
+		string_end = size;
+		size += quote_size;
+	}
+	else {
+		r->token_kind = MDTokenKind_Symbol;
+		size = 1;
+		string_end = 1;
+	}
+
+	// MDReaderPeek may have moved the window, so only take pointers now
+	r->token = STR_View{r->buffer + r->pos + string_start, string_end - string_start};
+	r->pos += size;
+}
+
+EXPORT bool MDReaderIsSymbol(MDReader* r, char symbol) {
+	return r->token_kind == MDTokenKind_Symbol && r->token.data[0] == symbol;
+}
+
+EXPORT void MDReaderSkipSymbol(MDReader* r, char symbol) {
+	if (!MDReaderIsSymbol(r, symbol)) MDReaderError(r, "Expected '%v', got \"%v\"", STR_View{&symbol, 1}, r->token);
+	MDReaderNext(r);
+}
@@ -0,0 +1,120 @@
+#include "include/ht_common.h"
+
+// Per-plugin memory accounting. The counters themselves are updated by the plugin heap (see HT_AllocatorProc)
+// and by HT_TempArenaPush; this file presents them in the Memory tab and writes them into a report file.
+
+static const char* MEMORY_TAB_COLUMNS[] = {
+	"Plugin", "In use (KB)", "Peak (KB)", "Reserved (KB)", "Allocations", "Peak allocations", "Temp last frame (KB)", "Temp peak (KB)",
+};
+
+static u64 BytesToKB(u64 bytes) { return (bytes + 1023) / 1024; }
+
+EXPORT void PluginMemoryStatsBeginFrame(EditorState* s) {
+	for (DS_SlotMapEach(&s->plugin_instances, i)) {
+		PluginMemoryStats* stats = &DS_SlotMapAt(&s->plugin_instances, i)->heap.stats;
+		stats->temp_bytes_last_frame = stats->temp_bytes_this_frame;
+		stats->temp_bytes_this_frame = 0;
+	}
+}
+
+EXPORT bool DumpMemoryReport(EditorState* s, STR_View file_path) {
+	STR_Builder b = {TEMP};
+	STR_Print(&b, "plugin,bytes_in_use,bytes_in_use_peak,bytes_reserved,allocations,allocations_peak,total_allocations,temp_bytes_last_frame,temp_bytes_peak\n");
+	
+	for (DS_SlotMapEach(&s->plugin_instances, i)) {
+		PluginInstance* plugin = DS_SlotMapAt(&s->plugin_instances, i);
+		PluginMemoryStats* stats = &plugin->heap.stats;
+		STR_PrintF(&b, "%v,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n", plugin->plugin_asset->name.view,
+			stats->bytes_in_use, stats->bytes_in_use_peak, stats->bytes_reserved,
+			stats->allocation_count, stats->allocation_count_peak, stats->total_allocations,
+			stats->temp_bytes_last_frame, stats->temp_bytes_peak);
+	}
+	
+	STR_PrintF(&b, "(editor temp arena),%llu,,,,,,,\n", (u64)TEMP->total_mem_reserved);
+	STR_PrintF(&b, "(editor log),%llu,,,,,,,\n", (u64)s->log.arena.total_mem_reserved);
+	STR_PrintF(&b, "(editor heap last frame),,,,%llu,,,,\n", HEAP_ALLOCATIONS_LAST_FRAME);
+
+	int names_count;
+	size_t names_bytes = GetNameTableMemoryUsage(&names_count);
+	STR_PrintF(&b, "(interned names),%llu,,,%llu,,,,\n", (u64)names_bytes, (u64)names_count);
+
+	AssetLoadStats load_stats = GetLastAssetLoadStats();
+	STR_PrintF(&b, "(asset parser),%llu,,,,,,,\n", load_stats.parser_memory);
+
+	const char* file_path_cstr = STR_FormC(TEMP, "%v", file_path);
+	return OS_WriteEntireFile(DS, file_path_cstr, b.str);
+}
+
+static void AddMemoryTabRow(UI_Key key, STR_View* cells) {
+	UI_Box* row = UI_KBOX(key);
+	UI_AddBox(row, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Horizontal);
+	UI_PushBox(row);
+	for (int i = 0; i < DS_ArrayCount(MEMORY_TAB_COLUMNS); i++) {
+		UI_AddLabel(UI_KBOX(UI_HashInt(key, i)), i == 0 ? 200.f : 150.f, UI_SizeFit(), 0, cells[i]);
+	}
+	UI_PopBox(row);
+}
+
+EXPORT void UpdateAndDrawMemoryTab(EditorState* s, UI_Key key, UI_Rect area) {
+	vec2 area_size = UI_RectSize(area);
+	
+	UI_Box* root = UI_KBOX(key);
+	UI_InitRootBox(root, area_size.x, area_size.y, 0);
+	UIRegisterOrderedRoot(&s->dropdown_state, root);
+	UI_PushBox(root);
+
+	UI_Box* top_row = UI_KBOX(key);
+	UI_AddBox(top_row, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Horizontal);
+	UI_PushBox(top_row);
+
+	UI_Box* dump_button = UI_KBOX(key);
+	UI_AddButton(dump_button, UI_SizeFit(), UI_SizeFit(), 0, "Dump to file");
+	if (UI_Clicked(dump_button)) {
+		STR_View file_path = STR_Form(TEMP, "%v/memory_report.csv", s->project_directory);
+		if (DumpMemoryReport(s, file_path)) {
+			LogF(&s->log, LogMessageKind_Info, "Wrote memory report to \"%v\"", file_path);
+		} else {
+			LogF(&s->log, LogMessageKind_Error, "Failed to write memory report to \"%v\"", file_path);
+		}
+	}
+
+	int names_count;
+	size_t names_bytes = GetNameTableMemoryUsage(&names_count);
+	UI_AddFmt(UI_KBOX(key), "Editor temp arena: %llu KB, log: %llu KB, heap allocations last frame: %llu, interned names: %d (%llu KB)",
+		BytesToKB(TEMP->total_mem_reserved), BytesToKB(s->log.arena.total_mem_reserved), HEAP_ALLOCATIONS_LAST_FRAME,
+		names_count, BytesToKB(names_bytes));
+	UI_PopBox(top_row);
+
+	AssetLoadStats load_stats = GetLastAssetLoadStats();
+	UI_AddFmt(UI_KBOX(key), "Last asset load: %d files (%d unchanged files skipped, %d struct data assets deferred, %d assets from snapshot), %llu KB in %f ms, parser memory: %llu KB",
+		load_stats.files_count, load_stats.files_unchanged, load_stats.struct_data_deferred, load_stats.assets_from_snapshot, BytesToKB(load_stats.bytes_read), load_stats.seconds * 1000.0, BytesToKB(load_stats.parser_memory));
+
+	UI_Box* table = UI_KBOX(key);
+	UI_PushScrollArea(table, UI_SizeFlex(1.f), UI_SizeFlex(1.f), 0, 0, 0);
+
+	STR_View header[DS_ArrayCount(MEMORY_TAB_COLUMNS)];
+	for (int i = 0; i < DS_ArrayCount(MEMORY_TAB_COLUMNS); i++) header[i] = STR_ToV(MEMORY_TAB_COLUMNS[i]);
+	AddMemoryTabRow(UI_KKEY(key), header);
+
+	for (DS_SlotMapEach(&s->plugin_instances, i)) {
+		PluginInstance* plugin = DS_SlotMapAt(&s->plugin_instances, i);
+		PluginMemoryStats* stats = &plugin->heap.stats;
+
+		STR_View cells[DS_ArrayCount(MEMORY_TAB_COLUMNS)];
+		cells[0] = plugin->plugin_asset->name.view;
+		cells[1] = STR_Form(TEMP, "%llu", BytesToKB(stats->bytes_in_use));
+		cells[2] = STR_Form(TEMP, "%llu", BytesToKB(stats->bytes_in_use_peak));
+		cells[3] = STR_Form(TEMP, "%llu", BytesToKB(stats->bytes_reserved));
+		cells[4] = STR_Form(TEMP, "%llu", stats->allocation_count);
+		cells[5] = STR_Form(TEMP, "%llu", stats->allocation_count_peak);
+		cells[6] = STR_Form(TEMP, "%llu", BytesToKB(stats->temp_bytes_last_frame));
+		cells[7] = STR_Form(TEMP, "%llu", BytesToKB(stats->temp_bytes_peak));
+		AddMemoryTabRow(UI_HashPtr(key, plugin), cells);
+	}
+
+	UI_PopScrollArea(table);
+
+	UI_PopBox(root);
+	UI_BoxComputeRects(root, area.min);
+	UI_DrawBox(root);
+}
@@ -0,0 +1,146 @@
+#include "include/ht_common.h"
+
+// Asset names, struct member names and item names are interned into one global table. Every distinct name is stored once,
+// and names can be compared by ID instead of by contents. Interned names are never freed; renaming something just interns the new name.
+
+struct NameEntry {
+	STR_View string;
+	u64 hash;
+	HT_NameID folded_id;
+};
+
+struct NameTable {
+	OS_Mutex mutex;
+	DS_Arena arena; // string data
+	DS_DynArray(NameEntry) entries; // indexed by HT_NameID. Entry 0 is the empty name.
+	HT_NameID* slots; // open addressing hash table of IDs
+	u32 slots_count; // power of two
+};
+
+#define NAME_SLOT_EMPTY 0xFFFFFFFF
+
+static NameTable g_names;
+
+static bool IsLowercase(STR_View string) {
+	for (size_t i = 0; i < string.size; i++) {
+		if (string.data[i] >= 'A' && string.data[i] <= 'Z') return false;
+	}
+	return true;
+}
+
+// Returns the slot that holds the ID of `string`, or the empty slot where it should be inserted
+static u32 NameTableFindSlot(STR_View string, u64 hash) {
+	u32 mask = g_names.slots_count - 1;
+	for (u32 i = (u32)hash & mask;; i = (i + 1) & mask) {
+		HT_NameID id = g_names.slots[i];
+		if (id == NAME_SLOT_EMPTY) return i;
+
+		NameEntry* entry = &g_names.entries.data[id];
+		if (entry->hash == hash && STR_Match(entry->string, string)) return i;
+	}
+}
+
+static void NameTableGrow() {
+	DS_MemFree(HEAP, g_names.slots);
+	g_names.slots_count *= 2;
+	g_names.slots = (HT_NameID*)DS_MemAlloc(HEAP, sizeof(HT_NameID) * g_names.slots_count);
+	memset(g_names.slots, 0xFF, sizeof(HT_NameID) * g_names.slots_count);
+
+	for (int id = 1; id < g_names.entries.count; id++) {
+		NameEntry* entry = &g_names.entries.data[id];
+		g_names.slots[NameTableFindSlot(entry->string, entry->hash)] = (HT_NameID)id;
+	}
+}
+
+static HT_Name MakeName(HT_NameID id) {
+	NameEntry* entry = &g_names.entries.data[id];
+	HT_Name name = {};
+	name.data = (char*)entry->string.data;
+	name.size = entry->string.size;
+	name.id = id;
+	name.folded_id = entry->folded_id;
+	return name;
+}
+
+// The mutex must be held
+static HT_NameID InternNameLocked(STR_View string) {
+	if (string.size == 0) return 0;
+
+	u64 hash = DS_MurmurHash64A(string.data, string.size, 0);
+	u32 slot = NameTableFindSlot(string, hash);
+	if (g_names.slots[slot] != NAME_SLOT_EMPTY) return g_names.slots[slot];
+
+	// Intern the lowercase version first, so that its ID can be used as the folded ID of this name
+	HT_NameID folded_id = (HT_NameID)g_names.entries.count;
+	if (!IsLowercase(string)) {
+		char* lowercase = (char*)DS_MemAlloc(HEAP, string.size);
+		for (size_t i = 0; i < string.size; i++) lowercase[i] = (char)STR_CodepointToLower(string.data[i]);
+		folded_id = InternNameLocked(STR_View{lowercase, string.size});
+		DS_MemFree(HEAP, lowercase);
+
+		slot = NameTableFindSlot(string, hash); // the table may have grown
+	}
+
+	NameEntry entry = {};
+	entry.string = STR_Clone(&g_names.arena, string);
+	entry.hash = hash;
+	entry.folded_id = folded_id;
+
+	HT_NameID id = (HT_NameID)g_names.entries.count;
+	DS_ArrPush(&g_names.entries, entry);
+	g_names.slots[slot] = id;
+
+	if ((u32)g_names.entries.count * 2 > g_names.slots_count) NameTableGrow();
+	return id;
+}
+
+EXPORT void InitNameTable() {
+	OS_MutexInit(&g_names.mutex);
+	DS_ArenaInit(&g_names.arena, 16 * 1024, HEAP);
+	DS_ArrInit(&g_names.entries, HEAP);
+
+	NameEntry empty_entry = {};
+	DS_ArrPush(&g_names.entries, empty_entry);
+
+	g_names.slots_count = 1024;
+	g_names.slots = (HT_NameID*)DS_MemAlloc(HEAP, sizeof(HT_NameID) * g_names.slots_count);
+	memset(g_names.slots, 0xFF, sizeof(HT_NameID) * g_names.slots_count);
+}
+
+EXPORT HT_Name InternName(STR_View string) {
+	OS_MutexLock(&g_names.mutex);
+	HT_Name name = MakeName(InternNameLocked(string));
+	OS_MutexUnlock(&g_names.mutex);
+	return name;
+}
+
+EXPORT bool FindName(STR_View string, HT_Name* out_name) {
+	if (string.size == 0) {
+		*out_name = {};
+		return true;
+	}
+
+	u64 hash = DS_MurmurHash64A(string.data, string.size, 0);
+	OS_MutexLock(&g_names.mutex);
+	HT_NameID id = g_names.slots[NameTableFindSlot(string, hash)];
+	bool found = id != NAME_SLOT_EMPTY;
+	if (found) *out_name = MakeName(id);
+	OS_MutexUnlock(&g_names.mutex);
+	return found;
+}
+
+EXPORT bool FindNameCaseInsensitive(STR_View string, HT_NameID* out_folded_id) {
+	STR_View lowercase = STR_ToLower(TEMP, string);
+	HT_Name name = {};
+	bool found = FindName(lowercase, &name);
+	if (found) *out_folded_id = name.id;
+	return found;
+}
+
+EXPORT size_t GetNameTableMemoryUsage(int* out_names_count) {
+	OS_MutexLock(&g_names.mutex);
+	*out_names_count = g_names.entries.count - 1;
+	size_t bytes = g_names.arena.total_mem_reserved + sizeof(NameEntry) * g_names.entries.capacity + sizeof(HT_NameID) * g_names.slots_count;
+	OS_MutexUnlock(&g_names.mutex);
+	return bytes;
+}
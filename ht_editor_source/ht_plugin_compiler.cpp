@@ -2,20 +2,187 @@
 
 #include "include/ht_common.h"
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 
 #include <RestartManager.h>
 #include <winternl.h>
+#endif
 
 #include <stdio.h>
 
-EXPORT void RegeneratePluginHeader(AssetTree* tree, Asset* plugin) {
-	Asset* package = plugin;
+// Struct types are visible to plugin code as <package>__<struct>
+static STR_View GeneratedTypeName(Asset* struct_type) {
+	Asset* package = struct_type;
 	for (;package->kind != AssetKind_Package; package = package->parent) {}
 
-	bool ok = OS_SetWorkingDir(DS, package->package.filesys_path); // @speed: we're doing this a bunch unnecessarily
-	ASSERT(ok);
+	STR_View package_name = GetPackageName(package);
+	STR_CutStart(&package_name, "$");
+	return STR_Form(TEMP, "%v__%v", package_name, struct_type->name.view);
+}
+
+// Resolves `.` and `..` segments and backslashes without touching the filesystem
+static STR_View NormalizePath(STR_View path) {
+	DS_DynArray(STR_View) segments = {TEMP};
+	for (STR_View remaining = path; remaining.size > 0;) {
+		size_t end = 0;
+		for (; end < remaining.size && remaining.data[end] != '/' && remaining.data[end] != '\\'; end++) {}
+		STR_View segment = STR_SliceBefore(remaining, end);
+		remaining = STR_SliceAfter(remaining, end < remaining.size ? end + 1 : end);
+
+		if (STR_Match(segment, "..") && segments.count > 0 && !STR_Match(DS_ArrPeek(segments), "..")) {
+			DS_ArrPop(&segments);
+		}
+		else if (!STR_Match(segment, ".") && (segment.size > 0 || segments.count == 0)) {
+			DS_ArrPush(&segments, segment); // keep the empty first segment of a path starting with '/'
+		}
+	}
+
+	STR_Builder b = {TEMP};
+	for (int i = 0; i < segments.count; i++) {
+		if (i > 0) STR_Print(&b, "/");
+		STR_Print(&b, segments[i]);
+	}
+	return b.str;
+}
+
+// Finds the identifiers that plugin code can refer to the generated types with. The code files of the plugin and all source files
+// in its package are scanned, as well as every file they include from any package of the project. The whole package is scanned
+// because the statically linked editor build compiles every file in it.
+struct TypeNameScan {
+	DS_DynArray(STR_View) package_paths;
+	STR_View plugin_package_path;
+	DS_Set(u64) visited_files;
+	DS_Set(u64) identifiers; // hashes of the identifiers that contain "__"
+};
+
+static bool IsIdentifierChar(char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool ScanSourceFile(TypeNameScan* scan, STR_View file_path);
+
+static void ScanIncludedFile(TypeNameScan* scan, STR_View directory, STR_View include_path, bool is_quoted) {
+	if (STR_Contains(include_path, ".inc.ht")) return;
+
+	// Try the same include directories as the compiler; the including file's directory only for quoted includes
+	STR_View candidates[3];
+	int candidates_count = 0;
+	if (is_quoted) candidates[candidates_count++] = STR_Form(TEMP, "%v/%v", directory, include_path);
+	candidates[candidates_count++] = STR_Form(TEMP, "%v/%v", scan->plugin_package_path, include_path);
+	candidates[candidates_count++] = STR_Form(TEMP, "%s/%v", HATCH_DIR, include_path);
+
+	for (int i = 0; i < candidates_count; i++) {
+		STR_View path = NormalizePath(candidates[i]);
+
+		// Files outside of the packages, like the standard library or ht_utils, can't refer to generated types
+		bool in_package = false;
+		for (int j = 0; j < scan->package_paths.count; j++) {
+			in_package = in_package || STR_StartsWith(path, scan->package_paths[j]);
+		}
+		if (!in_package) continue;
+
+		if (ScanSourceFile(scan, path)) break;
+	}
+}
+
+// Returns false if the file doesn't exist
+static bool ScanSourceFile(TypeNameScan* scan, STR_View file_path) {
+	u64 path_hash = DS_MurmurHash64A(file_path.data, file_path.size, 0);
+	if (DS_SetContains(&scan->visited_files, path_hash)) return true;
+
+	STR_View text;
+	if (!OS_ReadEntireFile(TEMP, STR_ToC(TEMP, file_path), &text)) return false;
+	DS_SetAdd(&scan->visited_files, path_hash);
+
+	STR_View directory = STR_BeforeLast(file_path, '/');
+	const char* text_end = text.data + text.size;
+
+	// The files can be large third party headers, so only stop at the characters of interest and let memchr skip the rest
+	for (const char* p = text.data; (p = (const char*)memchr(p, '#', text_end - p)) != NULL;) {
+		// #include "path" or #include <path>
+		p++;
+		for (; p < text_end && (*p == ' ' || *p == '\t'); p++) {}
+		if (!STR_StartsWith(STR_View{p, (size_t)(text_end - p)}, "include")) continue;
+		p += 7;
+		for (; p < text_end && (*p == ' ' || *p == '\t'); p++) {}
+		if (p == text_end || (*p != '"' && *p != '<')) continue;
+
+		char close = *p == '"' ? '"' : '>';
+		const char* path_start = ++p;
+		for (; p < text_end && *p != close && *p != '\n'; p++) {}
+		ScanIncludedFile(scan, directory, STR_View{path_start, (size_t)(p - path_start)}, close == '"');
+	}
+
+	for (const char* p = text.data; (p = (const char*)memchr(p, '_', text_end - p)) != NULL;) {
+		if (p + 1 == text_end || p[1] != '_') {
+			p++;
+			continue;
+		}
+
+		const char* identifier_start = p;
+		for (; identifier_start > text.data && IsIdentifierChar(identifier_start[-1]); identifier_start--) {}
+		for (; p < text_end && IsIdentifierChar(*p); p++) {}
+
+		u64 hash = DS_MurmurHash64A(identifier_start, p - identifier_start, 0);
+		DS_SetAdd(&scan->identifiers, hash);
+	}
+	return true;
+}
+
+static void ScanSourceFilesInAsset(TypeNameScan* scan, Asset* asset) {
+	if (asset->kind == AssetKind_File) {
+		STR_View extension = STR_AfterLast(asset->name.view, '.');
+		if (STR_Match(extension, "c") || STR_Match(extension, "cpp") || STR_Match(extension, "h") || STR_Match(extension, "hpp") ||
+			STR_Match(extension, "inl"))
+		{
+			ScanSourceFile(scan, NormalizePath(AssetGetAbsoluteFilepath(TEMP, asset)));
+		}
+	}
+	for (Asset* child = asset->first_child; child; child = child->next) {
+		ScanSourceFilesInAsset(scan, child);
+	}
+}
+
+static void PrintStructTypeDefinition(STR_Builder* str, Asset* asset, STR_View name) {
+	STR_PrintF(str, "typedef struct %v {\n", name);
+
+	for (int i = 0; i < asset->struct_type.members.count; i++) {
+		StructMember member = asset->struct_type.members[i];
+		STR_Print(str, "\t");
+		switch (member.type.kind) {
+		case HT_TypeKind_Float: { STR_Print(str, "float"); }break;
+		case HT_TypeKind_Int: { STR_Print(str, "int"); }break;
+		case HT_TypeKind_Bool: { STR_Print(str, "bool"); }break;
+		case HT_TypeKind_String: { STR_Print(str, "string"); }break;
+		case HT_TypeKind_Type: { STR_Print(str, "HT_Type"); }break;
+		case HT_TypeKind_Array: { STR_Print(str, "HT_Array"); }break;
+		case HT_TypeKind_ItemGroup: { STR_Print(str, "HT_ItemGroup"); }break;
+		case HT_TypeKind_Struct: {
+			STR_Print(str, "long long");
+		}break;
+		case HT_TypeKind_AssetRef: { STR_Print(str, "HT_Asset"); }break;
+		case HT_TypeKind_Vec2: { STR_Print(str, "vec2"); }break;
+		case HT_TypeKind_Vec3: { STR_Print(str, "vec3"); }break;
+		case HT_TypeKind_Vec4: { STR_Print(str, "vec4"); }break;
+		case HT_TypeKind_IVec2: { STR_Print(str, "ivec2"); }break;
+		case HT_TypeKind_IVec3: { STR_Print(str, "ivec3"); }break;
+		case HT_TypeKind_IVec4: { STR_Print(str, "ivec4"); }break;
+		default: ASSERT(0); break;
+		}
+		STR_View member_name = member.name;
+		STR_PrintF(str, " %v;\n", member_name);
+	}
+
+	STR_PrintF(str, "} %v;\n", name);
+}
+
+EXPORT bool RegeneratePluginHeader(AssetTree* tree, Asset* plugin) {
+	DS_Scope scope = DS_ScopePush(DS);
+
+	Asset* package = plugin;
+	for (;package->kind != AssetKind_Package; package = package->parent) {}
 
 	STR_View plugin_name = plugin->name;
 
@@ -26,9 +193,7 @@ EXPORT void RegeneratePluginHeader(AssetTree* tree, Asset* plugin) {
 
 	STR_Builder str = {TEMP};
 
-	const char* header_filepath = STR_FormC(TEMP, "%v.inc.ht", plugin_name);
-	//FILE* header = fopen(header_name, "wb");
-	//ASSERT(header != NULL);
+	const char* header_filepath = STR_FormC(TEMP, "%v/%v.inc.ht", package->package.filesys_path, plugin_name);
 	
 	STR_Print(&str, "// This file is generated by Hatch. Do not edit by hand.\n");
 	STR_Print(&str, "#pragma once\n\n");
@@ -47,82 +212,62 @@ EXPORT void RegeneratePluginHeader(AssetTree* tree, Asset* plugin) {
 
 	// for now, do the simple way that doesn't work in many cases.
 	// see RegenerateTypeTable
+	// The table is filled by the editor and shared by all plugins, so it must list every struct type in the same order for every plugin
 	STR_Print(&str, "typedef struct HT_GeneratedTypeTable {\n");
-	for (DS_BkArrEach(&tree->assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&tree->assets, asset_i);
+	for (DS_SlotMapEach(&tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&tree->assets, asset_i);
 		if (asset->kind == AssetKind_StructType) {
-			STR_View name = asset->name.view;
-			if (STR_Match(name, "Untitled Struct")) continue; // temporary hack against builtin structures
-
-			Asset* asset_package = asset;
-			for (;asset_package->kind != AssetKind_Package; asset_package = asset_package->parent) {}
-
-			STR_View asset_package_name = GetPackageName(asset_package);
-			STR_CutStart(&asset_package_name, "$");
+			if (STR_Match(asset->name.view, "Untitled Struct")) continue; // temporary hack against builtin structures
 
-			STR_PrintF(&str, "\tHT_Asset %v__%v;\n", asset_package_name, name);
+			STR_PrintF(&str, "\tHT_Asset %v;\n", GeneratedTypeName(asset));
 		}
 	}
 	STR_Print(&str, "\tint _unused;\n");
 	STR_Print(&str, "} HT_GeneratedTypeTable;\n");
 
-	for (DS_BkArrEach(&tree->assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&tree->assets, asset_i);
+	// Only define the struct types that the plugin's code refers to. Every translation unit of the plugin includes this
+	// header, so this way editing the members of an unrelated struct type doesn't cause the plugin to be recompiled.
+	TypeNameScan scan = {};
+	DS_ArrInit(&scan.package_paths, TEMP);
+	DS_SetInit(&scan.visited_files, TEMP);
+	DS_SetInit(&scan.identifiers, TEMP);
+	scan.plugin_package_path = package->package.filesys_path;
+	for (Asset* p = tree->root->first_child; p; p = p->next) {
+		if (p->kind == AssetKind_Package) DS_ArrPush(&scan.package_paths, NormalizePath(p->package.filesys_path));
+	}
+	ScanSourceFilesInAsset(&scan, package);
+	for (int i = 0; i < plugin_opts->code_files.count; i++) {
+		Asset* code_file = GetAsset(tree, *((HT_Asset*)plugin_opts->code_files.data + i));
+		if (code_file) ScanSourceFilesInAsset(&scan, code_file); // may be a folder, or in another package
+	}
+
+	for (DS_SlotMapEach(&tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&tree->assets, asset_i);
 		if (asset->kind == AssetKind_StructType) {
-			STR_View name = asset->name.view;
-			if (STR_Match(name, "Untitled Struct")) continue; // temporary hack against builtin structures
-
-			Asset* asset_package = asset;
-			for (;asset_package->kind != AssetKind_Package; asset_package = asset_package->parent) {}
-
-			STR_View asset_package_name = GetPackageName(asset_package);
-			STR_CutStart(&asset_package_name, "$");
-
-			STR_PrintF(&str, "typedef struct %v__%v {\n", asset_package_name, name);
-
-			for (int i = 0; i < asset->struct_type.members.count; i++) {
-				StructMember member = asset->struct_type.members[i];
-				STR_Print(&str, "\t");
-				switch (member.type.kind) {
-				case HT_TypeKind_Float: { STR_Print(&str, "float"); }break;
-				case HT_TypeKind_Int: { STR_Print(&str, "int"); }break;
-				case HT_TypeKind_Bool: { STR_Print(&str, "bool"); }break;
-				case HT_TypeKind_String: { STR_Print(&str, "string"); }break;
-				case HT_TypeKind_Type: { STR_Print(&str, "HT_Type"); }break;
-				case HT_TypeKind_Array: { STR_Print(&str, "HT_Array"); }break;
-				case HT_TypeKind_ItemGroup: { STR_Print(&str, "HT_ItemGroup"); }break;
-				case HT_TypeKind_Struct: {
-					STR_Print(&str, "long long");
-				}break;
-				case HT_TypeKind_AssetRef: { STR_Print(&str, "HT_Asset"); }break;
-				case HT_TypeKind_Vec2: { STR_Print(&str, "vec2"); }break;
-				case HT_TypeKind_Vec3: { STR_Print(&str, "vec3"); }break;
-				case HT_TypeKind_Vec4: { STR_Print(&str, "vec4"); }break;
-				case HT_TypeKind_IVec2: { STR_Print(&str, "ivec2"); }break;
-				case HT_TypeKind_IVec3: { STR_Print(&str, "ivec3"); }break;
-				case HT_TypeKind_IVec4: { STR_Print(&str, "ivec4"); }break;
-				default: ASSERT(0); break;
-				}
-				STR_View member_name = member.name;
-				STR_PrintF(&str, " %v;\n", member_name);
-			}
+			if (STR_Match(asset->name.view, "Untitled Struct")) continue; // temporary hack against builtin structures
 
-			STR_PrintF(&str, "} %v__%v;\n", asset_package_name, name);
+			STR_View name = GeneratedTypeName(asset);
+			u64 name_hash = DS_MurmurHash64A(name.data, name.size, 0);
+			if (DS_SetContains(&scan.identifiers, name_hash)) {
+				PrintStructTypeDefinition(&str, asset, name);
+			}
 		}
 	}
 
+	// Rewriting the file with the same contents would still make it look changed to the compiler and to the directory watcher
 	STR_View existing_data;
 	bool has_existing_data = OS_ReadEntireFile(TEMP, header_filepath, &existing_data);
-	if (!has_existing_data || !STR_Match(existing_data, str.str)) {
+	bool changed = !has_existing_data || !STR_Match(existing_data, str.str);
+	if (changed) {
 		OS_WriteEntireFile(DS, header_filepath, str.str);
 	}
 
-	OS_SetWorkingDir(DS, CURRENT_WORKING_DIRECTORY); // reset working directory
+	DS_ScopePop(scope);
+	return changed;
 }
 
 EXPORT void GeneratePremakeAndVSProjects(AssetTree* asset_tree, STR_View project_directory) {
-	FILE* f = NULL;
-	fopen_s(&f, "premake5.lua", "wb");
+	FILE* f = fopen("premake5.lua", "wb");
 	ASSERT(f);
 
 	STR_View project_name = STR_AfterLast(project_directory, '/');
@@ -161,8 +306,8 @@ EXPORT void GeneratePremakeAndVSProjects(AssetTree* asset_tree, STR_View project
 	fprintf(f, "\tfiles \"%%{HATCH_DIR}/ht_editor_source/**\"\n");
 	fprintf(f, "\tfiles \"%%{HATCH_DIR}/ht_utils/**\"\n\n");
 
-	for (DS_BkArrEach(&asset_tree->assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&asset_tree->assets, asset_i);
+	for (DS_SlotMapEach(&asset_tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&asset_tree->assets, asset_i);
 
 		// should packages be able to contain C code that isn't built? maybe...
 		// for now, just include ALL files within each package
@@ -179,8 +324,8 @@ EXPORT void GeneratePremakeAndVSProjects(AssetTree* asset_tree, STR_View project
 	fprintf(f, "\n");
 
 	fprintf(f, "\tdefines { \"HT_ALL_STATIC_EXPORTS=\"\n");
-	for (DS_BkArrEach(&asset_tree->assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&asset_tree->assets, asset_i);
+	for (DS_SlotMapEach(&asset_tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&asset_tree->assets, asset_i);
 		if (asset->kind == AssetKind_Plugin) {
 			fprintf(f, "\t\t..\",HT_STATIC_EXPORTS__%.*s\"\n", StrArg(asset->name));
 		}
@@ -211,7 +356,7 @@ EXPORT void GeneratePremakeAndVSProjects(AssetTree* asset_tree, STR_View project
 	bool ok = OS_RunProcess(DS, "premake5 vs2022", &exit_code);
 }
 
-#ifdef HT_DYNAMIC
+#if defined(HT_DYNAMIC) && defined(_WIN32)
 EXPORT void ForceVisualStudioToClosePDBFileHandle(STR_View pdb_filepath) {
 	// This function follows the method described in the article:
 	// https://blog.molecular-matters.com/2017/05/09/deleting-pdb-files-locked-by-visual-studio/
@@ -348,9 +493,13 @@ EXPORT void ForceVisualStudioToClosePDBFileHandle(STR_View pdb_filepath) {
 	CloseHandle(h);
 }
 
+#endif
+
 struct BuildLog {
 	BUILD_Log base;
 	ErrorList* error_list;
+	void* error_allocator;       // for the error strings
+	OS_Mutex* error_mutex_or_null; // locked around adding errors when compiling on a background thread
 	HT_Asset plugin;
 	STR_Builder b;
 	size_t flushed_to;
@@ -368,13 +517,16 @@ static void FlushBuildLog(BuildLog* build_log) {
 
 		size_t _;
 		bool is_error = STR_Find(line, " error ", &_) || STR_Find(line, " warning ", &_); // can be `: error ` or `: fatal error `
+		is_error = is_error || STR_Find(line, " error: ", &_) || STR_Find(line, " warning: ", &_); // GCC and Clang
 		
 		if (is_error) {
+			if (build_log->error_mutex_or_null) OS_MutexLock(build_log->error_mutex_or_null);
 			Error error = {};
 			error.owner_asset = build_log->plugin;
-			error.string = STR_Clone(HEAP, line);
+			error.string = STR_Clone(build_log->error_allocator, line);
 			error.added_tick = OS_GetCPUTick();
 			DS_ArrPush(&build_log->error_list->errors, error);
+			if (build_log->error_mutex_or_null) OS_MutexUnlock(build_log->error_mutex_or_null);
 		}
 
 		//Log* log = build_log->log;
@@ -392,18 +544,174 @@ static void BuildLogFn(BUILD_Log* self, const char* message) {
 	FlushBuildLog(build_log);
 }
 
-EXPORT bool RecompilePlugin(EditorState* s, Asset* plugin) {
-	ASSERT(plugin->plugin.active_instance == NULL); // plugin must not be running
-	
-	RegeneratePluginHeader(&s->asset_tree, plugin);
+EXPORT STR_View GetPluginBinaryPath(DS_Arena* arena, Asset* plugin) {
+	Asset* package = plugin;
+	for (;package->kind != AssetKind_Package; package = package->parent) {}
 	
+#ifdef _WIN32
+	return STR_Form(arena, "%v/.plugin_binaries/%v.dll", package->package.filesys_path, plugin->name.view);
+#else
+	return STR_Form(arena, "%v/.plugin_binaries/%v.so", package->package.filesys_path, plugin->name.view);
+#endif
+}
+
+static STR_View TrimWhitespace(STR_View str) {
+	for (; str.size > 0 && (str.data[0] == ' ' || str.data[0] == '\t'); str.data++, str.size--) {}
+	for (; str.size > 0 && (str.data[str.size - 1] == ' ' || str.data[str.size - 1] == '\t' || str.data[str.size - 1] == '\r'); str.size--) {}
+	return str;
+}
+
+// Only the directives at the top of the file are looked at: #pragma once, or #ifndef X followed by #define X.
+static bool HasIncludeGuard(STR_View file_path) {
+	STR_View text;
+	if (!OS_ReadEntireFile(TEMP, STR_ToC(TEMP, file_path), &text)) return false;
+
+	STR_View guard_name = {};
+	int directives_count = 0;
+	for (STR_View line, remaining = text; STR_ParseToAndSkip(&remaining, '\n', &line);) {
+		line = TrimWhitespace(line);
+		if (line.size == 0 || STR_StartsWith(line, "//")) continue;
+		if (!STR_CutStart(&line, "#")) break;
+
+		line = TrimWhitespace(line);
+		if (STR_Match(line, "pragma once")) return true;
+		if (directives_count == 0 && STR_CutStart(&line, "ifndef")) guard_name = TrimWhitespace(line);
+		if (directives_count == 1 && guard_name.size > 0 && STR_CutStart(&line, "define")) {
+			return STR_Match(TrimWhitespace(line), guard_name);
+		}
+		directives_count++;
+	}
+	return false;
+}
+
+// Returns the #define, #undef and #include lines at the start of a source file, up to the first line of anything else.
+// Includes relative to the source file are made absolute, so that the lines can be compared between files and included
+// from anywhere. The source file still includes the same files after the precompiled header, so the lines also end at
+// a header without an include guard. Angle-bracket includes that aren't found in the package or HATCH_DIR are assumed
+// to be system headers.
+static void GetSourceFilePrefix(STR_View file_path, STR_View package_path, DS_DynArray(STR_View)* out_lines) {
+	STR_View text;
+	if (!OS_ReadEntireFile(TEMP, STR_ToC(TEMP, file_path), &text)) return;
+
+	STR_View directory = STR_BeforeLast(file_path, '/');
+	for (STR_View line, remaining = text; STR_ParseToAndSkip(&remaining, '\n', &line);) {
+		line = TrimWhitespace(line);
+		if (line.size == 0 || STR_StartsWith(line, "//")) continue;
+
+		STR_View directive = line;
+		if (!STR_CutStart(&directive, "#") || STR_EndsWith(line, "\\")) break; // also stop at multi-line macros
+		directive = TrimWhitespace(directive);
+
+		if (STR_StartsWith(directive, "define") || STR_StartsWith(directive, "undef")) {
+			DS_ArrPush(out_lines, line);
+			continue;
+		}
+		if (!STR_CutStart(&directive, "include")) break;
+
+		directive = TrimWhitespace(directive);
+		bool is_quoted = STR_CutStart(&directive, "\"");
+		if (!is_quoted && !STR_CutStart(&directive, "<")) break;
+		STR_View include_path = STR_BeforeFirst(directive, is_quoted ? '"' : '>');
+
+		STR_View candidates[3];
+		int candidates_count = 0;
+		if (is_quoted) candidates[candidates_count++] = STR_Form(TEMP, "%v/%v", directory, include_path);
+		candidates[candidates_count++] = STR_Form(TEMP, "%v/%v", package_path, include_path);
+		candidates[candidates_count++] = STR_Form(TEMP, "%s/%v", HATCH_DIR, include_path);
+
+		int resolved_candidate = -1;
+		STR_View resolved = {};
+		for (int i = 0; i < candidates_count && resolved_candidate == -1; i++) {
+			resolved = NormalizePath(candidates[i]);
+			u64 modtime;
+			if (OS_FileGetModtime(DS, resolved, &modtime)) resolved_candidate = i;
+		}
+		if (resolved_candidate != -1 && !HasIncludeGuard(resolved)) break;
+
+		if (is_quoted && resolved_candidate == 0) {
+			DS_ArrPush(out_lines, STR_Form(TEMP, "#include \"%v\"", resolved));
+		}
+		else if (resolved_candidate != -1 || !is_quoted) {
+			// Found in an include directory, so keep it that way. HATCH_DIR is a system include directory on Linux,
+			// which wouldn't apply to the same file included by an absolute path.
+			DS_ArrPush(out_lines, STR_Form(TEMP, "#include <%v>", NormalizePath(include_path)));
+		}
+		else break;
+	}
+}
+
+// Each translation unit of a plugin starts by including mostly the same headers: hatch_api.h, the generated .inc.ht header,
+// fire and math headers and so on. The lines that all C++ code files of the plugin start with are written into a header,
+// which is precompiled once and then reused until the headers change. Only used if the plugin's `precompiled_header` option
+// is set. Returns NULL if there's nothing to precompile.
+static const char* WritePluginPrecompiledHeader(DS_Arena* arena, BUILD_Project* project, STR_View package_path, STR_View plugin_name) {
+	DS_DynArray(STR_View) common_lines = {TEMP};
+	bool first = true;
+	for (int i = 0; i < project->code_files.count; i++) {
+		STR_View code_file = STR_ToV(project->code_files.data[i]);
+		if (!STR_EndsWith(code_file, ".cpp")) continue;
+
+		DS_DynArray(STR_View) lines = {TEMP};
+		GetSourceFilePrefix(code_file, package_path, &lines);
+		if (first) {
+			DS_ArrPushArr(&common_lines, lines);
+			first = false;
+		}
+		else {
+			int common_count = 0;
+			for (; common_count < common_lines.count && common_count < lines.count; common_count++) {
+				if (!STR_Match(common_lines[common_count], lines[common_count])) break;
+			}
+			common_lines.count = common_count;
+		}
+	}
+
+	// Defines after the last include wouldn't affect anything in the precompiled header
+	for (; common_lines.count > 0 && !STR_StartsWith(DS_ArrPeek(common_lines), "#include"); common_lines.count--) {}
+	if (common_lines.count == 0) return NULL;
+
+	STR_Builder str = {TEMP};
+	STR_Print(&str, "// This file is generated by Hatch. Do not edit by hand.\n");
+	STR_Print(&str, "#pragma once\n\n");
+	for (int i = 0; i < common_lines.count; i++) {
+		STR_Print(&str, common_lines[i]);
+		STR_Print(&str, "\n");
+	}
+
+	const char* header_filepath = STR_FormC(arena, "%v/.plugin_binaries/%v.pch.h", package_path, plugin_name);
+	STR_View existing_data;
+	if (!OS_ReadEntireFile(TEMP, header_filepath, &existing_data) || !STR_Match(existing_data, str.str)) {
+		OS_WriteEntireFile(DS, header_filepath, str.str);
+	}
+	return header_filepath;
+}
+
+struct PluginBuild {
+	Asset* plugin;
+	BUILD_Project project;
+	BuildLog log;
+};
+
+static Asset* GetPluginPackage(Asset* plugin) {
 	Asset* package = plugin;
 	for (;package->kind != AssetKind_Package; package = package->parent) {}
-	bool ok = OS_SetWorkingDir(DS, package->package.filesys_path);
-	ASSERT(ok);
+	return package;
+}
+
+// Paths are absolute, so that the plugins of every package can be compiled at the same time regardless of the working directory.
+// Everything the project refers to is allocated from `arena`, so the build doesn't depend on TEMP or the asset tree afterwards.
+static bool SetupPluginBuild(AssetTree* tree, DS_Arena* arena, PluginBuild* build, const char* working_directory,
+	const char* object_cache_directory, ErrorList* error_list)
+{
+	Asset* plugin = build->plugin;
+	STR_View package_path = GetPluginPackage(plugin)->package.filesys_path;
+
+	RegeneratePluginHeader(tree, plugin);
 
 	BUILD_ProjectOptions opts = {};
 	opts.target = BUILD_Target_DynamicLibrary;
+	opts.object_cache_directory = object_cache_directory;
+	opts.working_directory = working_directory;
 	
 	// When running inside visual studio's debugger, VS keeps the DLL pdb file open even after unloading the DLL.
 	// For now, just disable debug info.
@@ -411,45 +719,271 @@ EXPORT bool RecompilePlugin(EditorState* s, Asset* plugin) {
 	opts.debug_info = true;
 
 	// TODO: it would be nice to make this folder at the root of the package. That way, you could more easily delete the binaries or gitignore them.
-	ok = BUILD_CreateDirectory(".plugin_binaries");
+	bool ok = BUILD_CreateDirectory(STR_FormC(TEMP, "%v/.plugin_binaries", package_path));
 	ASSERT(ok);
 
-	BUILD_Project project;
-	BUILD_ProjectInit(&project, STR_ToC(TEMP, plugin->name.view), &opts);
+	BUILD_Project* project = &build->project;
+	BUILD_ProjectInit(project, STR_ToC(arena, plugin->name.view), &opts);
 
-	BUILD_AddIncludeDir(&project, STR_FormC(TEMP, "%s/plugin_include", HATCH_DIR));
+#ifdef _WIN32
+	BUILD_AddIncludeDir(project, HATCH_DIR);
+#else
+	// Hatch's own headers are written against MSVC, so don't fail the build on the warnings that GCC/Clang give for them
+	BUILD_AddExtraCompilerArg(project, STR_FormC(arena, "-isystem%s", HATCH_DIR));
+#endif
+	BUILD_AddIncludeDir(project, STR_ToC(arena, package_path)); // for the generated .inc.ht headers
+	BUILD_AddDefine(project, "HT_DYNAMIC_PLUGIN");
 
 	PluginOptions* plugin_opts = &plugin->plugin.options;
 	for (int i = 0; i < plugin_opts->code_files.count; i++) {
 		HT_Asset code_file = *((HT_Asset*)plugin_opts->code_files.data + i);
-		Asset* code_file_asset = GetAsset(&s->asset_tree, code_file);
+		Asset* code_file_asset = GetAsset(tree, code_file);
 		if (code_file_asset) {
-			STR_View file_name = AssetGetPackageRelativeFilepath(TEMP, code_file_asset);
+			STR_View file_name = AssetGetAbsoluteFilepath(TEMP, code_file_asset);
 			STR_View file_extension = STR_AfterLast(file_name, '.');
 			
 			// Only add .c and .cpp files as translation units and not header files for example
+			const char* file_name_c = STR_ToC(arena, file_name);
 			if (STR_Match(file_extension, "c") || STR_Match(file_extension, "cpp")) {
-				const char* file_name_c = STR_ToC(TEMP, file_name);
-				BUILD_AddSourceFile(&project, file_name_c);
+				BUILD_AddSourceFile(project, file_name_c);
+			}
+			else {
+				BUILD_AddCacheInput(project, file_name_c);
 			}
 		}
 	}
-	if (project.code_files.count == 0) TODO();
 
-	RemoveErrorsByAsset(&s->error_list, plugin->handle);
+	project->opts.unity_build = plugin_opts->unity_build;
+	if (plugin_opts->precompiled_header) {
+		project->opts.precompiled_header = WritePluginPrecompiledHeader(arena, project, package_path, plugin->name.view);
+	}
 
-	BuildLog build_log = {0};
-	build_log.base.print = BuildLogFn;
-	build_log.plugin = plugin->handle;
-	build_log.error_list = &s->error_list;
-	build_log.b = {TEMP};
-	ok = BUILD_CompileProject(&project, ".plugin_binaries", ".", &build_log.base);
-	
-	FlushBuildLog(&build_log);
+	for (int i = 0; i < plugin_opts->linker_inputs.count; i++) {
+		HT_Asset linker_input = *((HT_Asset*)plugin_opts->linker_inputs.data + i);
+		Asset* linker_input_asset = GetAsset(tree, linker_input);
+		if (linker_input_asset && linker_input_asset->kind == AssetKind_File) {
+			BUILD_AddLinkerInput(project, STR_ToC(arena, AssetGetAbsoluteFilepath(TEMP, linker_input_asset)));
+		}
+		// Other plugins are added as link dependencies by SetupPluginBatchBuild
+	}
 
-	BUILD_ProjectDeinit(&project);
-	OS_SetWorkingDir(DS, DEFAULT_WORKING_DIRECTORY); // reset working directory
-	return ok;
+	// The headers that the code files include, such as the generated .inc.ht, hatch_api.h and ht_utils, don't need to be
+	// cache inputs: the compiler reports them, and only the object files whose headers changed are recompiled.
+
+	build->log.base.print = BuildLogFn;
+	build->log.plugin = plugin->handle;
+	build->log.error_list = error_list;
+	build->log.error_allocator = HEAP;
+	build->log.b = {arena};
+
+	if (project->code_files.count == 0) {
+		Error error = {};
+		error.owner_asset = plugin->handle;
+		error.string = STR_Form(HEAP, "Plugin \"%v\" has no .c or .cpp code files", plugin->name.view);
+		error.added_tick = OS_GetCPUTick();
+		DS_ArrPush(&error_list->errors, error);
+		return false;
+	}
+	return true;
 }
 
-#endif
+// The projects of a set of plugins that are compiled together
+struct PluginBatchBuild {
+	DS_DynArray(PluginBuild) builds;
+	DS_DynArray(BUILD_ProjectBuild) project_builds;
+	DS_DynArray(PluginBuild*) project_build_plugins; // parallel to project_builds
+	u64 start_time; // in the units of OS_FileGetModtime
+	bool ok;
+};
+
+static void SetupPluginBatchBuild(AssetTree* tree, DS_Arena* arena, PluginBatchBuild* batch, DS_ArrayView<Asset*> plugins, ErrorList* error_list) {
+	// Object files are cached by content in the project directory, so that only the translation units that changed are
+	// recompiled. The cache can be shared between all plugins of the project.
+	const char* object_cache_directory = STR_FormC(arena, "%v/.plugin_object_cache", CURRENT_WORKING_DIRECTORY);
+
+	// The build may run on a worker thread while the main thread changes the working directory of the process, e.g. in
+	// ReloadPackages, so the compiler gets its working directory from here instead.
+	const char* working_directory = STR_ToC(arena, CURRENT_WORKING_DIRECTORY);
+	bool ok = BUILD_CreateDirectory(object_cache_directory);
+	ASSERT(ok);
+
+	// Plugins that are linker inputs of the requested plugins are built too, as they need to be linked first
+	DS_ArrInit(&batch->builds, arena);
+	for (int i = 0; i < plugins.count; i++) {
+		PluginBuild build = {};
+		build.plugin = plugins[i];
+		DS_ArrPush(&batch->builds, build);
+	}
+	for (int i = 0; i < batch->builds.count; i++) {
+		PluginOptions* plugin_opts = &batch->builds[i].plugin->plugin.options;
+		for (int j = 0; j < plugin_opts->linker_inputs.count; j++) {
+			Asset* dep = GetAsset(tree, *((HT_Asset*)plugin_opts->linker_inputs.data + j));
+			if (dep == NULL || dep->kind != AssetKind_Plugin) continue;
+
+			bool already_added = false;
+			for (int k = 0; k < batch->builds.count; k++) already_added = already_added || batch->builds[k].plugin == dep;
+			if (!already_added) {
+				PluginBuild build = {};
+				build.plugin = dep;
+				DS_ArrPush(&batch->builds, build);
+			}
+		}
+	}
+
+	// The array doesn't grow anymore, so pointers to the projects stay valid
+	DS_ArrInit(&batch->project_builds, arena);
+	DS_ArrInit(&batch->project_build_plugins, arena);
+	for (int i = 0; i < batch->builds.count; i++) {
+		PluginBuild* build = &batch->builds[i];
+		bool can_build = SetupPluginBuild(tree, arena, build, working_directory, object_cache_directory, error_list);
+		if (!can_build) continue;
+
+		BUILD_ProjectBuild project_build = {};
+		project_build.project = &build->project;
+		project_build.build_directory = STR_FormC(arena, "%v/.plugin_binaries", GetPluginPackage(build->plugin)->package.filesys_path);
+		project_build.log_or_null = &build->log.base;
+		DS_ArrPush(&batch->project_builds, project_build);
+		DS_ArrPush(&batch->project_build_plugins, build);
+	}
+	for (int i = 0; i < batch->builds.count; i++) {
+		PluginOptions* plugin_opts = &batch->builds[i].plugin->plugin.options;
+		for (int j = 0; j < plugin_opts->linker_inputs.count; j++) {
+			Asset* dep = GetAsset(tree, *((HT_Asset*)plugin_opts->linker_inputs.data + j));
+			for (int k = 0; dep && k < batch->builds.count; k++) {
+				if (batch->builds[k].plugin == dep) BUILD_AddLinkDependency(&batch->builds[i].project, &batch->builds[k].project);
+			}
+		}
+	}
+}
+
+// Doesn't touch the asset tree, so this may run on any thread
+static void RunPluginBatchBuild(PluginBatchBuild* batch) {
+	// Taken after SetupPluginBatchBuild has written the generated headers, so that they don't count as modified
+	batch->start_time = OS_GetCurrentFileTime();
+	batch->ok = BUILD_CompileProjects(batch->project_builds.data, batch->project_builds.count, 0) &&
+		batch->project_builds.count == batch->builds.count;
+
+	for (int i = 0; i < batch->project_builds.count; i++) {
+		FlushBuildLog(&batch->project_build_plugins[i]->log);
+	}
+}
+
+static void FinishPluginBatchBuild(PluginBatchBuild* batch, PluginCompileStats* out_stats, DS_DynArray(CompiledPlugin)* out_compiled_or_null) {
+	if (out_stats) *out_stats = {};
+	for (int i = 0; i < batch->project_builds.count; i++) {
+		BUILD_Project* project = batch->project_builds[i].project;
+		if (out_stats) {
+			out_stats->cache_hits += project->cache_hits;
+			out_stats->cache_misses += project->cache_misses;
+		}
+		if (out_compiled_or_null && batch->project_builds[i].ok) {
+			// A file that was modified after the compile started may have been read in its old version, so its stamp is
+			// left at 0. CheckPluginIncludes then sees it as modified and recompiles the plugin. The unity build file and
+			// the precompiled header wrapper are written by the build itself, after the start time.
+			STR_View build_directory = STR_ToV(batch->project_builds[i].build_directory);
+			STR_View object_cache_directory = STR_ToV(project->opts.object_cache_directory);
+			DS_DynArray(PluginIncludeStamp) includes = {out_compiled_or_null->allocator};
+			for (int j = 0; j < project->dependencies.count; j++) {
+				PluginIncludeStamp stamp = {};
+				stamp.file_path = STR_Clone(out_compiled_or_null->allocator, STR_ToV(project->dependencies.data[j]));
+				OS_FileGetModtime(DS, stamp.file_path, &stamp.last_write_time); // 0 if the file is gone
+
+				bool written_by_build = STR_StartsWith(stamp.file_path, build_directory) || STR_StartsWith(stamp.file_path, object_cache_directory);
+				if (stamp.last_write_time >= batch->start_time && !written_by_build) stamp.last_write_time = 0;
+				DS_ArrPush(&includes, stamp);
+			}
+
+			CompiledPlugin compiled = {};
+			compiled.plugin = batch->project_build_plugins[i]->log.plugin;
+			compiled.includes = DS_ArrayView<PluginIncludeStamp>(includes.data, includes.count);
+			DS_ArrPush(out_compiled_or_null, compiled);
+		}
+	}
+
+	for (int i = 0; i < batch->builds.count; i++) {
+		BUILD_ProjectDeinit(&batch->builds[i].project);
+	}
+}
+
+EXPORT bool CompilePlugins(AssetTree* tree, DS_ArrayView<Asset*> plugins, ErrorList* error_list, PluginCompileStats* out_stats,
+	DS_DynArray(Asset*)* out_compiled_or_null)
+{
+	PluginBatchBuild batch = {};
+	SetupPluginBatchBuild(tree, TEMP, &batch, plugins, error_list);
+	RunPluginBatchBuild(&batch);
+
+	DS_DynArray(CompiledPlugin) compiled = {TEMP};
+	FinishPluginBatchBuild(&batch, out_stats, &compiled);
+	if (out_compiled_or_null) {
+		for (int i = 0; i < compiled.count; i++) DS_ArrPush(out_compiled_or_null, GetAsset(tree, compiled[i].plugin));
+	}
+	return batch.ok;
+}
+
+EXPORT bool CompilePlugin(AssetTree* tree, Asset* plugin, ErrorList* error_list, PluginCompileStats* out_stats) {
+	return CompilePlugins(tree, DS_ArrayView<Asset*>(&plugin, 1), error_list, out_stats, NULL);
+}
+
+struct PluginCompileJob {
+	DS_AllocatorBase heap; // the editor's HEAP counts allocations without synchronization, so it can't be used from the compile thread
+	DS_Arena arena;
+	PluginBatchBuild batch;
+	OS_Thread thread;
+
+	OS_Mutex mutex;
+	ErrorList errors; // compile errors that haven't been taken by PollPluginCompileJob yet, protected by `mutex`
+	bool finished;    // protected by `mutex`
+};
+
+static void PluginCompileThreadProc(void* user_data) {
+	PluginCompileJob* job = (PluginCompileJob*)user_data;
+	RunPluginBatchBuild(&job->batch);
+
+	OS_MutexLock(&job->mutex);
+	job->finished = true;
+	OS_MutexUnlock(&job->mutex);
+}
+
+EXPORT PluginCompileJob* StartPluginCompileJob(AssetTree* tree, DS_ArrayView<Asset*> plugins, ErrorList* error_list) {
+	PluginCompileJob* job = (PluginCompileJob*)DS_MemAlloc(HEAP, sizeof(PluginCompileJob));
+	memset(job, 0, sizeof(*job));
+	job->heap = { DS, DS_HeapAllocatorProc };
+	DS_ArenaInit(&job->arena, 4096, (DS_Allocator*)&job->heap);
+	OS_MutexInit(&job->mutex);
+	DS_ArrInit(&job->errors.errors, &job->arena);
+
+	// Errors found while setting up the build are reported right away, compile errors once they're polled
+	SetupPluginBatchBuild(tree, &job->arena, &job->batch, plugins, error_list);
+	for (int i = 0; i < job->batch.builds.count; i++) {
+		BuildLog* log = &job->batch.builds[i].log;
+		log->error_list = &job->errors;
+		log->error_allocator = &job->arena;
+		log->error_mutex_or_null = &job->mutex;
+	}
+
+	OS_ThreadStart(&job->thread, PluginCompileThreadProc, job, "Hatch Plugin Compiler");
+	return job;
+}
+
+EXPORT bool PollPluginCompileJob(PluginCompileJob* job, ErrorList* error_list) {
+	OS_MutexLock(&job->mutex);
+	for (int i = 0; i < job->errors.errors.count; i++) {
+		Error error = job->errors.errors[i];
+		error.string = STR_Clone(HEAP, error.string);
+		DS_ArrPush(&error_list->errors, error);
+	}
+	DS_ArrClear(&job->errors.errors);
+	bool finished = job->finished;
+	OS_MutexUnlock(&job->mutex);
+	return finished;
+}
+
+EXPORT void FinishPluginCompileJob(PluginCompileJob* job, ErrorList* error_list, PluginCompileStats* out_stats, DS_DynArray(CompiledPlugin)* out_compiled_or_null) {
+	OS_ThreadJoin(&job->thread);
+	PollPluginCompileJob(job, error_list);
+	FinishPluginBatchBuild(&job->batch, out_stats, out_compiled_or_null);
+
+	OS_MutexDestroy(&job->mutex);
+	DS_ArenaDeinit(&job->arena);
+	DS_MemFree(HEAP, job);
+}
@@ -0,0 +1,436 @@
+#include "include/ht_common.h"
+
+// Frame profiler. The editor opens a zone around every call into a plugin, and plugins can open zones of their own through
+// HT_API. Each thread of the worker pool writes its finished zones into a ring buffer of its own, which the main thread
+// drains at the start of the next frame into a history of recent frames. The Profiler tab draws the history and a flame
+// graph of the selected frame.
+
+#define PROFILER_MAX_DEPTH 32
+#define PROFILER_RING_CAPACITY 8192 // finished zones per thread, must be a power of two
+#define PROFILER_HISTORY_FRAMES 240
+#define PROFILER_FRAME_BUDGET_SECONDS (1.0 / 60.0)
+#define PROFILER_LABEL_CAPACITY 48 // longer labels are truncated
+
+// The label is copied into the zone, as it may point into a plugin DLL that is unloaded before the record is read
+struct ProfilerOpenZone {
+	char label[PROFILER_LABEL_CAPACITY];
+	int label_size;
+	HT_Name plugin;
+	u64 begin_tick;
+	bool plugin_root; // the outermost zone of `plugin` on this thread, so its time counts toward the plugin's total
+};
+
+struct ProfilerRecord {
+	char label[PROFILER_LABEL_CAPACITY];
+	int label_size;
+	HT_Name plugin;
+	u64 begin_tick;
+	u64 end_tick;
+	int depth;
+	bool plugin_root;
+};
+
+// Zones are only opened and recorded by the owning thread. The main thread reads the records.
+struct ProfilerThread {
+	ProfilerOpenZone open_zones[PROFILER_MAX_DEPTH];
+	int depth; // may exceed PROFILER_MAX_DEPTH, in which case the deeper zones aren't recorded
+
+	ProfilerRecord* records; // ring buffer of PROFILER_RING_CAPACITY records
+	volatile i32 write_count; // incremented after writing a record
+	volatile i32 read_count;  // incremented by the main thread after reading records
+	volatile i32 dropped_count; // records that didn't fit into the ring buffer
+};
+
+struct ProfilerZone {
+	STR_View label; // allocated from the frame's `labels` arena
+	HT_Name plugin; // empty for the editor's own zones
+	u64 begin_tick;
+	u64 end_tick;
+	int thread;
+	int depth;
+};
+
+struct ProfilerPluginTime {
+	HT_Name plugin;
+	u64 ticks; // summed over all threads
+};
+
+struct ProfilerFrame {
+	u64 begin_tick;
+	u64 end_tick;
+	DS_DynArray(ProfilerZone) zones;
+	DS_DynArray(ProfilerPluginTime) plugin_times; // most time first
+	DS_Arena labels;
+	int dropped_count;
+};
+
+struct Profiler {
+	ProfilerThread* threads; // indexed by worker index
+	int threads_count;
+
+	ProfilerFrame frames[PROFILER_HISTORY_FRAMES]; // ring buffer
+	int frames_count;
+	int newest_frame;
+	u64 frame_begin_tick;
+
+	bool paused;
+	int selected_frame; // number of frames back from the newest one
+};
+
+static Profiler g_profiler;
+
+static const UI_Color PROFILER_PLUGIN_COLORS[] = {
+	UI_SKYBLUE, UI_ORANGE, UI_LIME, UI_PURPLE, UI_GOLD, UI_PINK, UI_BEIGE, UI_BLUE, UI_VIOLET, UI_BROWN,
+};
+
+static const char* PROFILER_TABLE_COLUMNS[] = {"Plugin", "Time (ms)", "Share of frame (%)"};
+
+static ProfilerThread* GetProfilerThread() {
+	int worker_index = GetWorkerIndex();
+	return worker_index >= 0 && worker_index < g_profiler.threads_count ? &g_profiler.threads[worker_index] : NULL;
+}
+
+EXPORT void InitProfiler() {
+	Profiler* p = &g_profiler;
+	p->threads_count = GetWorkerCount();
+	p->threads = (ProfilerThread*)DS_MemAlloc(HEAP, sizeof(ProfilerThread) * p->threads_count);
+	memset(p->threads, 0, sizeof(ProfilerThread) * p->threads_count);
+	for (int i = 0; i < p->threads_count; i++) {
+		p->threads[i].records = (ProfilerRecord*)DS_MemAlloc(HEAP, sizeof(ProfilerRecord) * PROFILER_RING_CAPACITY);
+	}
+
+	for (int i = 0; i < PROFILER_HISTORY_FRAMES; i++) {
+		DS_ArrInit(&p->frames[i].zones, HEAP);
+		DS_ArrInit(&p->frames[i].plugin_times, HEAP);
+		DS_ArenaInit(&p->frames[i].labels, 4096, HEAP);
+	}
+}
+
+EXPORT void DeinitProfiler() {
+	Profiler* p = &g_profiler;
+	for (int i = 0; i < p->threads_count; i++) {
+		DS_MemFree(HEAP, p->threads[i].records);
+	}
+	DS_MemFree(HEAP, p->threads);
+
+	for (int i = 0; i < PROFILER_HISTORY_FRAMES; i++) {
+		DS_ArrDeinit(&p->frames[i].zones);
+		DS_ArrDeinit(&p->frames[i].plugin_times);
+		DS_ArenaDeinit(&p->frames[i].labels);
+	}
+	g_profiler = {};
+}
+
+EXPORT int ProfilerBeginZone(HT_Name plugin, STR_View label) {
+	ProfilerThread* thread = GetProfilerThread();
+	if (thread == NULL) return -1;
+
+	if (thread->depth < PROFILER_MAX_DEPTH) {
+		HT_Name outer_plugin = thread->depth > 0 ? thread->open_zones[thread->depth - 1].plugin : HT_Name{};
+
+		ProfilerOpenZone* zone = &thread->open_zones[thread->depth];
+		zone->label_size = (int)UI_Min(label.size, (size_t)PROFILER_LABEL_CAPACITY);
+		memcpy(zone->label, label.data, zone->label_size);
+		zone->plugin = plugin.id ? plugin : outer_plugin;
+		zone->plugin_root = zone->plugin.id != 0 && zone->plugin.id != outer_plugin.id;
+		zone->begin_tick = OS_GetCPUTick();
+	}
+	return thread->depth++;
+}
+
+EXPORT void ProfilerEndZone(int zone) {
+	u64 end_tick = OS_GetCPUTick();
+	ProfilerThread* thread = GetProfilerThread();
+	if (thread == NULL) return;
+	if (zone < 0) zone = thread->depth - 1;
+
+	// Zones that a plugin left open are ended along with the zone around the plugin call
+	for (; thread->depth > zone && thread->depth > 0;) {
+		thread->depth--;
+		if (thread->depth >= PROFILER_MAX_DEPTH) continue;
+
+		u32 write_count = (u32)thread->write_count;
+		if (write_count - (u32)OS_AtomicAddI32(&thread->read_count, 0) >= PROFILER_RING_CAPACITY) {
+			OS_AtomicAddI32(&thread->dropped_count, 1);
+			continue;
+		}
+
+		ProfilerOpenZone* open_zone = &thread->open_zones[thread->depth];
+		ProfilerRecord* record = &thread->records[write_count & (PROFILER_RING_CAPACITY - 1)];
+		memcpy(record->label, open_zone->label, open_zone->label_size);
+		record->label_size = open_zone->label_size;
+		record->plugin = open_zone->plugin;
+		record->begin_tick = open_zone->begin_tick;
+		record->end_tick = end_tick;
+		record->depth = thread->depth;
+		record->plugin_root = open_zone->plugin_root;
+		OS_AtomicAddI32(&thread->write_count, 1); // publishes the record to the main thread
+	}
+}
+
+static void AddPluginTime(ProfilerFrame* frame, HT_Name plugin, u64 ticks) {
+	for (int i = 0; i < frame->plugin_times.count; i++) {
+		if (frame->plugin_times[i].plugin.id == plugin.id) {
+			frame->plugin_times[i].ticks += ticks;
+			return;
+		}
+	}
+	ProfilerPluginTime plugin_time = {plugin, ticks};
+	DS_ArrPush(&frame->plugin_times, plugin_time);
+}
+
+EXPORT void ProfilerBeginFrame() {
+	Profiler* p = &g_profiler;
+	u64 tick = OS_GetCPUTick();
+
+	// While paused, the zones are still drained so that the ring buffers don't fill up
+	ProfilerFrame* frame = NULL;
+	if (!p->paused && p->frame_begin_tick != 0) {
+		p->newest_frame = (p->newest_frame + 1) % PROFILER_HISTORY_FRAMES;
+		p->frames_count = UI_Min(p->frames_count + 1, PROFILER_HISTORY_FRAMES);
+
+		frame = &p->frames[p->newest_frame];
+		frame->begin_tick = p->frame_begin_tick;
+		frame->end_tick = tick;
+		frame->dropped_count = 0;
+		DS_ArrClear(&frame->zones);
+		DS_ArrClear(&frame->plugin_times);
+		DS_ArenaReset(&frame->labels);
+	}
+	p->frame_begin_tick = tick;
+
+	for (int i = 0; i < p->threads_count; i++) {
+		ProfilerThread* thread = &p->threads[i];
+		u32 read_count = (u32)thread->read_count;
+		u32 write_count = (u32)OS_AtomicAddI32(&thread->write_count, 0);
+
+		for (u32 j = read_count; j != write_count && frame; j++) {
+			ProfilerRecord* record = &thread->records[j & (PROFILER_RING_CAPACITY - 1)];
+			ProfilerZone zone = {};
+			zone.label = STR_Clone(&frame->labels, STR_View{record->label, record->label_size});
+			zone.plugin = record->plugin;
+			zone.begin_tick = record->begin_tick;
+			zone.end_tick = record->end_tick;
+			zone.thread = i;
+			zone.depth = record->depth;
+			DS_ArrPush(&frame->zones, zone);
+
+			if (record->plugin_root) AddPluginTime(frame, record->plugin, record->end_tick - record->begin_tick);
+		}
+		OS_AtomicAddI32(&thread->read_count, (i32)(write_count - read_count));
+
+		i32 dropped_count = OS_AtomicAddI32(&thread->dropped_count, 0);
+		OS_AtomicAddI32(&thread->dropped_count, -dropped_count);
+		if (frame) frame->dropped_count += dropped_count;
+	}
+
+	if (frame) {
+		// Insertion sort, there are only a handful of plugins
+		for (int i = 1; i < frame->plugin_times.count; i++) {
+			ProfilerPluginTime plugin_time = frame->plugin_times[i];
+			int j = i;
+			for (; j > 0 && frame->plugin_times[j - 1].ticks < plugin_time.ticks; j--) {
+				frame->plugin_times[j] = frame->plugin_times[j - 1];
+			}
+			frame->plugin_times[j] = plugin_time;
+		}
+	}
+}
+
+static ProfilerFrame* GetProfilerFrame(int frames_back) {
+	Profiler* p = &g_profiler;
+	if (frames_back < 0 || frames_back >= p->frames_count) return NULL;
+	return &p->frames[(p->newest_frame - frames_back + PROFILER_HISTORY_FRAMES) % PROFILER_HISTORY_FRAMES];
+}
+
+static double TicksToMs(u64 ticks) {
+	double ms = OS_GetDuration(CPU_FREQUENCY, 0, ticks) * 1000.0;
+	return (double)(i64)(ms * 100.0 + 0.5) / 100.0; // two decimals are enough, and the string formatter has no precision option
+}
+
+static UI_Color GetPluginColor(HT_Name plugin) {
+	return plugin.id ? PROFILER_PLUGIN_COLORS[plugin.id % DS_ArrayCount(PROFILER_PLUGIN_COLORS)] : UI_DARKGRAY;
+}
+
+// One bar per frame, newest on the right. Clicking a bar pauses the profiler and selects the frame.
+static void DrawProfilerHistory(UI_Box* box) {
+	Profiler* p = &g_profiler;
+	UI_Rect rect = box->computed_rect;
+	float bar_width = (rect.max.x - rect.min.x) / (float)PROFILER_HISTORY_FRAMES;
+	float height = rect.max.y - rect.min.y;
+
+	// The graph is scaled so that the budget line sits in the middle
+	float seconds_to_height = height * 0.5f / (float)PROFILER_FRAME_BUDGET_SECONDS;
+
+	if (UI_IsHovered(box) && UI_InputWasPressed(UI_Input_MouseLeft)) {
+		int frames_back = (int)((rect.max.x - UI_STATE.mouse_pos.x) / bar_width);
+		if (GetProfilerFrame(frames_back)) {
+			p->paused = true;
+			p->selected_frame = frames_back;
+		}
+	}
+
+	for (int i = 0; i < p->frames_count; i++) {
+		ProfilerFrame* frame = GetProfilerFrame(i);
+		float seconds = (float)OS_GetDuration(CPU_FREQUENCY, frame->begin_tick, frame->end_tick);
+
+		UI_Rect bar;
+		bar.max.x = rect.max.x - bar_width * (float)i;
+		bar.min.x = bar.max.x - bar_width + 1.f;
+		bar.max.y = rect.max.y;
+		bar.min.y = UI_Max(rect.max.y - seconds * seconds_to_height, rect.min.y);
+
+		UI_Color color = seconds > PROFILER_FRAME_BUDGET_SECONDS ? UI_RED : UI_GRAY;
+		if (i == p->selected_frame) color = UI_WHITE;
+		UI_DrawRect(bar, color);
+	}
+
+	float budget_y = rect.max.y - (float)PROFILER_FRAME_BUDGET_SECONDS * seconds_to_height;
+	UI_DrawLine(UI_VEC2{rect.min.x, budget_y}, UI_VEC2{rect.max.x, budget_y}, 1.f, UI_GOLD);
+}
+
+// Each thread that recorded zones gets a lane, with nested zones stacked below their parents.
+static void DrawFlameGraph(ProfilerFrame* frame, UI_Box* box) {
+	UI_Rect rect = box->computed_rect;
+	UI_Font font = UI_STATE.default_font;
+	float row_height = (float)font.size + 4.f;
+	float ticks_to_x = (rect.max.x - rect.min.x) / (float)(frame->end_tick - frame->begin_tick);
+
+	int threads_count = g_profiler.threads_count;
+	int* lane_depth = (int*)DS_ArenaPush(TEMP, sizeof(int) * threads_count);
+	float* lane_y = (float*)DS_ArenaPush(TEMP, sizeof(float) * threads_count);
+	memset(lane_depth, 0, sizeof(int) * threads_count);
+	for (int i = 0; i < frame->zones.count; i++) {
+		ProfilerZone* zone = &frame->zones[i];
+		lane_depth[zone->thread] = UI_Max(lane_depth[zone->thread], zone->depth + 1);
+	}
+
+	float y = rect.min.y;
+	for (int i = 0; i < threads_count; i++) {
+		lane_y[i] = y;
+		if (lane_depth[i] == 0) continue;
+
+		STR_View lane_name = i == 0 ? STR_V("Main thread") : STR_Form(TEMP, "Worker %d", i);
+		UI_DrawText(lane_name, font, UI_VEC2{rect.min.x + 4.f, y + 2.f}, UI_AlignH_Left, UI_LIGHTGRAY, &rect);
+		lane_y[i] = y + row_height;
+		y += row_height * (float)(lane_depth[i] + 1);
+	}
+
+	ProfilerZone* hovered_zone = NULL;
+	for (int i = 0; i < frame->zones.count; i++) {
+		ProfilerZone* zone = &frame->zones[i];
+
+		// Zones that began in an earlier frame are clipped to this one
+		u64 begin_tick = zone->begin_tick > frame->begin_tick ? zone->begin_tick : frame->begin_tick;
+		UI_Rect zone_rect;
+		zone_rect.min.x = rect.min.x + (float)(begin_tick - frame->begin_tick) * ticks_to_x;
+		zone_rect.max.x = UI_Max(rect.min.x + (float)(zone->end_tick - frame->begin_tick) * ticks_to_x, zone_rect.min.x + 1.f);
+		zone_rect.min.y = lane_y[zone->thread] + row_height * (float)zone->depth;
+		zone_rect.max.y = zone_rect.min.y + row_height - 1.f;
+		if (zone_rect.min.y >= rect.max.y) continue;
+
+		UI_DrawRect(zone_rect, GetPluginColor(zone->plugin));
+		if (zone_rect.max.x - zone_rect.min.x > 20.f) {
+			UI_Rect text_scissor = {{UI_Max(zone_rect.min.x, rect.min.x), zone_rect.min.y}, {UI_Min(zone_rect.max.x, rect.max.x), UI_Min(zone_rect.max.y, rect.max.y)}};
+			UI_DrawText(zone->label, font, UI_VEC2{zone_rect.min.x + 2.f, zone_rect.min.y + 2.f}, UI_AlignH_Left, UI_BLACK, &text_scissor);
+		}
+		if (UI_IsHovered(box) && UI_PointIsInRect(zone_rect, UI_STATE.mouse_pos)) hovered_zone = zone;
+	}
+
+	if (hovered_zone) {
+		STR_View text = hovered_zone->plugin.id ?
+			STR_Form(TEMP, "%v: %v, %f ms", hovered_zone->plugin.view, hovered_zone->label, TicksToMs(hovered_zone->end_tick - hovered_zone->begin_tick)) :
+			STR_Form(TEMP, "%v, %f ms", hovered_zone->label, TicksToMs(hovered_zone->end_tick - hovered_zone->begin_tick));
+
+		UI_Vec2 text_pos = {UI_STATE.mouse_pos.x + 12.f, UI_STATE.mouse_pos.y + 12.f};
+		UI_Rect text_rect = {{text_pos.x - 4.f, text_pos.y - 2.f}, {text_pos.x + UI_TextWidth(text, font) + 4.f, text_pos.y + row_height}};
+		UI_DrawRect(text_rect, UI_COLOR{0, 0, 0, 220});
+		UI_DrawText(text, font, text_pos, UI_AlignH_Left, UI_WHITE, NULL);
+	}
+}
+
+static void AddProfilerTableRow(UI_Key key, STR_View* cells, UI_Color color) {
+	UI_Box* row = UI_KBOX(key);
+	UI_AddBox(row, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Horizontal);
+	UI_PushBox(row);
+	for (int i = 0; i < DS_ArrayCount(PROFILER_TABLE_COLUMNS); i++) {
+		UI_Box* cell = UI_KBOX(UI_HashInt(key, i));
+		UI_AddLabel(cell, i == 0 ? 200.f : 180.f, UI_SizeFit(), 0, cells[i]);
+		if (i == 0) {
+			cell->draw_opts = DS_New(UI_BoxDrawOptArgs, UI_TEMP);
+			cell->draw_opts->text_color = DS_Dup(UI_TEMP, color);
+		}
+	}
+	UI_PopBox(row);
+}
+
+EXPORT void UpdateAndDrawProfilerTab(EditorState* s, UI_Key key, UI_Rect area) {
+	Profiler* p = &g_profiler;
+	vec2 area_size = UI_RectSize(area);
+
+	UI_Box* root = UI_KBOX(key);
+	UI_InitRootBox(root, area_size.x, area_size.y, 0);
+	UIRegisterOrderedRoot(&s->dropdown_state, root);
+	UI_PushBox(root);
+
+	if (!p->paused) p->selected_frame = 0;
+	ProfilerFrame* frame = GetProfilerFrame(p->selected_frame);
+	double frame_ms = frame ? TicksToMs(frame->end_tick - frame->begin_tick) : 0.0;
+
+	UI_Box* top_row = UI_KBOX(key);
+	UI_AddBox(top_row, UI_SizeFlex(1.f), UI_SizeFit(), UI_BoxFlag_Horizontal);
+	UI_PushBox(top_row);
+
+	UI_Box* pause_button = UI_KBOX(key);
+	UI_AddButton(pause_button, UI_SizeFit(), UI_SizeFit(), 0, p->paused ? "Resume" : "Pause");
+	if (UI_Clicked(pause_button)) {
+		p->paused = !p->paused;
+	}
+
+	if (frame) {
+		STR_Builder b = {TEMP};
+		STR_View frame_name = p->paused ? STR_Form(TEMP, "Frame -%d", p->selected_frame) : STR_V("Last frame");
+		STR_PrintF(&b, "%v: %f ms (budget %f ms)", frame_name, frame_ms, TicksToMs((u64)(PROFILER_FRAME_BUDGET_SECONDS * (double)CPU_FREQUENCY)));
+		if (frame->plugin_times.count > 0) {
+			STR_PrintF(&b, ", slowest plugin: %v (%f ms)", frame->plugin_times[0].plugin.view, TicksToMs(frame->plugin_times[0].ticks));
+		}
+		if (frame->dropped_count > 0) {
+			STR_PrintF(&b, ", %d zones dropped", frame->dropped_count);
+		}
+		UI_AddLabel(UI_KBOX(key), UI_SizeFlex(1.f), UI_SizeFit(), 0, b.str);
+	}
+	UI_PopBox(top_row);
+
+	UI_Box* history_box = UI_KBOX(key);
+	UI_AddBox(history_box, UI_SizeFlex(1.f), 80.f, UI_BoxFlag_Clickable | UI_BoxFlag_DrawBorder);
+
+	UI_Box* flame_box = UI_KBOX(key);
+	UI_AddBox(flame_box, UI_SizeFlex(1.f), UI_SizeFlex(2.f), UI_BoxFlag_Clickable | UI_BoxFlag_DrawBorder);
+
+	UI_Box* table = UI_KBOX(key);
+	UI_PushScrollArea(table, UI_SizeFlex(1.f), UI_SizeFlex(1.f), 0, 0, 0);
+
+	STR_View header[DS_ArrayCount(PROFILER_TABLE_COLUMNS)];
+	for (int i = 0; i < DS_ArrayCount(PROFILER_TABLE_COLUMNS); i++) header[i] = STR_ToV(PROFILER_TABLE_COLUMNS[i]);
+	AddProfilerTableRow(UI_KKEY(key), header, UI_WHITE);
+
+	for (int i = 0; frame && i < frame->plugin_times.count; i++) {
+		ProfilerPluginTime* plugin_time = &frame->plugin_times[i];
+		double ms = TicksToMs(plugin_time->ticks);
+
+		STR_View cells[DS_ArrayCount(PROFILER_TABLE_COLUMNS)];
+		cells[0] = plugin_time->plugin.view;
+		cells[1] = STR_Form(TEMP, "%f", ms);
+		cells[2] = STR_Form(TEMP, "%d", frame_ms > 0.0 ? (int)(100.0 * ms / frame_ms + 0.5) : 0);
+		AddProfilerTableRow(UI_HashInt(key, plugin_time->plugin.id), cells, GetPluginColor(plugin_time->plugin));
+	}
+
+	UI_PopScrollArea(table);
+
+	UI_PopBox(root);
+	UI_BoxComputeRects(root, area.min);
+	UI_DrawBox(root);
+
+	DrawProfilerHistory(history_box);
+	if (frame) DrawFlameGraph(frame, flame_box);
+}
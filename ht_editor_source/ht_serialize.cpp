@@ -18,10 +18,12 @@ static STR_View GetAssetExt(AssetKind kind) {
 }
 
 EXPORT STR_View AssetGetFilename(DS_Arena* arena, Asset* asset) {
-	STR_View result = STR_Form(arena, "%v%v", asset->name, GetAssetExt(asset->kind));
+	STR_View result = STR_Form(arena, "%v%v", asset->name.view, GetAssetExt(asset->kind));
 	return result;
 }
 
+#ifndef HT_HEADLESS // the editor layout and the type table only exist in the editor
+
 struct MDParser {
 	MD_Node* node;
 };
@@ -39,9 +41,9 @@ static bool ParseMetadeskFloat(MDParser* p, float *out_value) {
 		*out_value = sign * (float)MD_CStyleIntFromString(p->node->string);
 	}
 	else {
-		double value;
-		if (!STR_ParseFloat(StrFromMD(p->node->string), &value)) return false;
-		*out_value = sign * (float)value;
+		float value;
+		if (!STR_ParseFloat32(StrFromMD(p->node->string), &value)) return false;
+		*out_value = sign * value;
 	}
 
 	p->node = p->node->next;
@@ -81,6 +83,8 @@ static void LoadEditorPanel(EditorState* s, MD_Node* node, UI_Panel* panel) {
 	}
 	else if (MD_S8Match(node->string, MD_S8Lit("log"), 0))            DS_ArrPush(&panel->tabs, s->log_tab_class);
 	else if (MD_S8Match(node->string, MD_S8Lit("errors"), 0))         DS_ArrPush(&panel->tabs, s->errors_tab_class);
+	else if (MD_S8Match(node->string, MD_S8Lit("memory"), 0))         DS_ArrPush(&panel->tabs, s->memory_tab_class);
+	else if (MD_S8Match(node->string, MD_S8Lit("profiler"), 0))       DS_ArrPush(&panel->tabs, s->profiler_tab_class);
 	else if (MD_S8Match(node->string, MD_S8Lit("assets"), 0))         DS_ArrPush(&panel->tabs, s->assets_tab_class);
 	else if (MD_S8Match(node->string, MD_S8Lit("properties"), 0))     DS_ArrPush(&panel->tabs, s->properties_tab_class);
 	else if (MD_S8Match(node->string, MD_S8Lit("asset_viewer"), 0))   DS_ArrPush(&panel->tabs, s->asset_viewer_tab_class);
@@ -88,8 +92,8 @@ static void LoadEditorPanel(EditorState* s, MD_Node* node, UI_Panel* panel) {
 
 EXPORT void RegenerateTypeTable(EditorState* s) {
 	DS_ArrClear(&s->type_table);
-	for (DS_BkArrEach(&s->asset_tree.assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&s->asset_tree.assets, asset_i);
+	for (DS_SlotMapEach(&s->asset_tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&s->asset_tree.assets, asset_i);
 		if (asset->kind == AssetKind_StructType) {
 			if (STR_Match(asset->name, "Untitled Struct")) continue; // temporary hack against builtin structures
 			
@@ -99,6 +103,8 @@ EXPORT void RegenerateTypeTable(EditorState* s) {
 	s->api->types = (HT_GeneratedTypeTable*)s->type_table.data;
 }
 
+#endif // HT_HEADLESS
+
 // NOTE: modifies the metadesk path in-place to use / instead of the \\ separator
 //static STR_View PathFromMDAndConvertSlashes(MD_String8 path) {
 //	for (int i = 0; i < path.size; i++) {
@@ -107,7 +113,7 @@ EXPORT void RegenerateTypeTable(EditorState* s) {
 //	return {(char*)path.str, path.size};
 //}
 
-static void LoadProjectFromParsedNode(AssetTree* tree, MD_Node* root) {
+static void LoadProjectFromParsedNode(AssetTree* tree, MD_Node* root, STR_View snapshot_path) {
 	MD_Node* packages = MD_ChildFromString(root, MD_S8Lit("packages"), 0);
 	if (!MD_NodeIsNil(packages)) {
 		DS_DynArray(STR_View) package_paths = {TEMP};
@@ -126,10 +132,11 @@ static void LoadProjectFromParsedNode(AssetTree* tree, MD_Node* root) {
 			DS_ArrPush(&package_paths, path);
 		}
 
-		LoadPackages(tree, package_paths);
+		LoadPackages(tree, package_paths, snapshot_path);
 	}
 }
 
+#ifndef HT_HEADLESS
 EXPORT void LoadProjectIncludingEditorLayout(EditorState* s, STR_View project_directory) {
 	bool ok = OS_SetWorkingDir(DS, project_directory);
 	CURRENT_WORKING_DIRECTORY = project_directory;
@@ -140,7 +147,8 @@ EXPORT void LoadProjectIncludingEditorLayout(EditorState* s, STR_View project_di
 	ASSERT(!MD_NodeIsNil(parse.node));
 	ASSERT(parse.errors.node_count == 0);
 
-	LoadProjectFromParsedNode(&s->asset_tree, parse.node);
+	STR_View snapshot_path = STR_Form(TEMP, "%v/%s", project_directory, PROJECT_SNAPSHOT_FILE);
+	LoadProjectFromParsedNode(&s->asset_tree, parse.node, snapshot_path);
 
 	MD_Node* editor_layout = MD_ChildFromString(parse.node, MD_S8Lit("editor_layout"), 0);
 	if (!MD_NodeIsNil(editor_layout)) {
@@ -152,20 +160,23 @@ EXPORT void LoadProjectIncludingEditorLayout(EditorState* s, STR_View project_di
 
 	MD_Node* run_plugins = MD_ChildFromString(parse.node, MD_S8Lit("run_plugins"), 0);
 	if (!MD_NodeIsNil(run_plugins)) {
+		DS_DynArray(Asset*) plugins = {TEMP};
 		for (MD_Node* child = run_plugins->first_child; !MD_NodeIsNil(child); child = child->next) {
 			STR_View path = StrFromMD(child->string);
 			Asset* plugin_asset = FindAssetFromPath(&s->asset_tree, NULL, path);
 			ASSERT(plugin_asset->kind == AssetKind_Plugin);
 			
 			plugin_asset->plugin.active_by_request = true;
-			RunPlugin(s, plugin_asset);
+			DS_ArrPush(&plugins, plugin_asset);
 		}
+		RunPlugins(s, plugins); // compiles all of them at once
 	}
 	
 	MD_ArenaRelease(md_arena);
 }
+#endif
 
-EXPORT void LoadProject(AssetTree* tree, STR_View project_directory) {
+EXPORT void LoadProject(AssetTree* tree, STR_View project_directory, bool use_snapshot) {
 	bool ok = OS_SetWorkingDir(DS, project_directory);
 	CURRENT_WORKING_DIRECTORY = project_directory;
 	ASSERT(ok);
@@ -178,7 +189,8 @@ EXPORT void LoadProject(AssetTree* tree, STR_View project_directory) {
 		exit(1);
 	}
 	
-	LoadProjectFromParsedNode(tree, parse.node);
+	STR_View snapshot_path = use_snapshot ? STR_Form(TEMP, "%v/%s", project_directory, PROJECT_SNAPSHOT_FILE) : "";
+	LoadProjectFromParsedNode(tree, parse.node, snapshot_path);
 
 	MD_ArenaRelease(md_arena);
 }
@@ -195,7 +207,7 @@ EXPORT STR_View AssetGetTextPath(DS_Arena* arena, Asset* current_package, Asset*
 			break;
 		}
 		else {
-			result = STR_Form(TEMP, "%v/%v", p->name, result);
+			result = STR_Form(TEMP, "%v/%v", p->name.view, result);
 		}
 	}
 
@@ -207,7 +219,7 @@ EXPORT STR_View AssetGetPackageRelativeFilepath(DS_Arena* arena, Asset* asset) {
 
 	STR_View result = AssetGetFilename(TEMP, asset);
 	for (Asset* p = asset->parent; p->kind != AssetKind_Package; p = p->parent) {
-		result = STR_Form(TEMP, "%v/%v", p->name, result);
+		result = STR_Form(TEMP, "%v/%v", p->name.view, result);
 	}
 	return result;
 }
@@ -221,47 +233,73 @@ EXPORT STR_View AssetGetAbsoluteFilepath(DS_Arena* arena, Asset* asset) {
 	for (Asset* p = asset->parent; p->kind != AssetKind_Root; p = p->parent) {
 		result = p->kind == AssetKind_Package ?
 			STR_Form(arena, "%v/%v", p->package.filesys_path, result) :
-			STR_Form(TEMP, "%v/%v", p->name, result);
+			STR_Form(TEMP, "%v/%v", p->name.view, result);
 	}
 	return result;
 }
 
 EXPORT STR_View AssetGetFilepathUsingParentDirectory(DS_Arena* arena, STR_View directory, Asset* asset) {
-	STR_View result = STR_Form(arena, "%v/%v%v", directory, asset->name, GetAssetExt(asset->kind));
+	STR_View result = STR_Form(arena, "%v/%v%v", directory, asset->name.view, GetAssetExt(asset->kind));
 	return result;
 }
 
+static AssetLoadStats g_last_asset_load_stats;
+
 struct ReloadAssetsContext {
 	AssetTree* tree;
-	MD_Arena* md_arena;
+	MDReader reader; // reused for all files
+	int files_count;
+	int files_unchanged;
+	int struct_data_deferred;
+	DS_DynArray(Asset*) reloaded_code_and_types; // files and struct types that were loaded, see ReloadAssetsUpdateDependencies
 	DS_DynArray(Asset*) queue_recompile_plugins;
 };
 
-static void SerializeType(FILE* file, AssetTree* tree, Asset* package, HT_Type type) {
+static void SerializeType(STR_Builder* b, AssetTree* tree, Asset* package, HT_Type type) {
 	if (type.kind == HT_TypeKind_Array) {
 		HT_Type elem_type = type;
 		elem_type.kind = elem_type.subkind;
-		fprintf(file, "@Array ");
-		SerializeType(file, tree, package, elem_type);
+		STR_Print(b, "@Array ");
+		SerializeType(b, tree, package, elem_type);
 	}
 	else if (type.kind == HT_TypeKind_Struct) {
 		Asset* struct_type = GetAsset(tree, type.handle);
 		STR_View struct_type_path = AssetGetTextPath(TEMP, package, struct_type);
-		fprintf(file, "\"%.*s\"", StrArg(struct_type_path));
+		STR_Print(b, "\"");
+		STR_Print(b, struct_type_path);
+		STR_Print(b, "\"");
 	}
 	else if (type.kind == HT_TypeKind_ItemGroup) {
 		HT_Type elem_type = type;
 		elem_type.kind = elem_type.subkind;
-		fprintf(file, "@ItemGroup ");
-		SerializeType(file, tree, package, elem_type);
+		STR_Print(b, "@ItemGroup ");
+		SerializeType(b, tree, package, elem_type);
 	}
 	else {
-		STR_View type_string = HT_TypeKindToString(type.kind);
-		fprintf(file, "%.*s", StrArg(type_string));
+		STR_Print(b, HT_TypeKindToString(type.kind));
+	}
+}
+
+static void SerializeIndent(STR_Builder* b, int indent_level) {
+	static const char TABS[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+	for (; indent_level > 16; indent_level -= 16) STR_Print(b, STR_View{TABS, 16});
+	STR_Print(b, STR_View{TABS, (size_t)indent_level});
+}
+
+// Floats are written in the shortest form that parses back to the exact same value, e.g. "0.1" instead of "0.100000".
+// A single float is written as-is, multiple floats are written as "{ a, b, ... }"
+static void SerializeFloats(STR_Builder* b, float* values, int count) {
+	char buffer[STR_FLOAT32_MAX_SIZE];
+	if (count > 1) STR_Print(b, "{ ");
+	for (int i = 0; i < count; i++) {
+		if (i > 0) STR_Print(b, ", ");
+		size_t size = STR_Float32ToStrBufShortest(buffer, values[i]);
+		STR_Print(b, STR_View{buffer, size});
 	}
+	if (count > 1) STR_Print(b, " }");
 }
 
-static void SerializeValue(FILE* file, AssetTree* tree, Asset* package, void* data, HT_Type type, int indent_level) {
+static void SerializeValue(STR_Builder* b, AssetTree* tree, Asset* package, void* data, HT_Type type, int indent_level) {
 	switch (type.kind) {
 	case HT_TypeKind_ItemGroup: {
 		HT_ItemGroup* val = (HT_ItemGroup*)(data);
@@ -269,22 +307,24 @@ static void SerializeValue(FILE* file, AssetTree* tree, Asset* package, void* da
 		HT_Type elem_type = type;
 		elem_type.kind = elem_type.subkind;
 		
-		fprintf(file, "{\n");
+		STR_Print(b, "{\n");
 
 		for (HT_ItemGroupEach(val, item_idx)) {
-			for (int j = 0; j < indent_level + 1; j++) fprintf(file, "\t");
+			SerializeIndent(b, indent_level + 1);
 
 			HT_ItemHeader* item_header = HT_GetItemHeader(val, item_idx);
-			fprintf(file, "\"%.*s\": ", StrArg(item_header->name.view));
+			STR_Print(b, "\"");
+			STR_Print(b, item_header->name.view);
+			STR_Print(b, "\": ");
 
 			void* item_data = (char*)HT_GetItemHeader(val, item_idx) + val->item_offset;
-			SerializeValue(file, tree, package, item_data, elem_type, indent_level + 1);
+			SerializeValue(b, tree, package, item_data, elem_type, indent_level + 1);
 			
-			fprintf(file, ",\n");
+			STR_Print(b, ",\n");
 		}
 
-		for (int i = 0; i < indent_level; i++) fprintf(file, "\t");
-		fprintf(file, "}");
+		SerializeIndent(b, indent_level);
+		STR_Print(b, "}");
 	}break;
 	case HT_TypeKind_Array: {
 		HT_Array val = *(HT_Array*)(data);
@@ -295,82 +335,164 @@ static void SerializeValue(FILE* file, AssetTree* tree, Asset* package, void* da
 		i32 elem_size, elem_align;
 		GetTypeSizeAndAlignment(tree, &elem_type, &elem_size, &elem_align);
 
-		fprintf(file, "{\n");
+		STR_Print(b, "{\n");
 
 		for (int i = 0; i < val.count; i++) {
-			for (int j = 0; j < indent_level + 1; j++) fprintf(file, "\t");
-			
-			SerializeValue(file, tree, package, (char*)val.data + elem_size*i, elem_type, indent_level + 1);
-			
-			fprintf(file, ",\n");
+			SerializeIndent(b, indent_level + 1);
+			SerializeValue(b, tree, package, (char*)val.data + elem_size*i, elem_type, indent_level + 1);
+			STR_Print(b, ",\n");
 		}
 		
-		for (int i = 0; i < indent_level; i++) fprintf(file, "\t");
-		fprintf(file, "}");
+		SerializeIndent(b, indent_level);
+		STR_Print(b, "}");
 	}break;
 	case HT_TypeKind_Struct: {
-		fprintf(file, "{\n");
+		STR_Print(b, "{\n");
 		
 		Asset* type_asset = GetAsset(tree, type.handle);
 		for (int i = 0; i < type_asset->struct_type.members.count; i++) {
-			for (int j = 0; j < indent_level + 1; j++) fprintf(file, "\t");
+			SerializeIndent(b, indent_level + 1);
 			
 			StructMember* member = &type_asset->struct_type.members.data[i];
-			fprintf(file, "%.*s: ", StrArg(member->name));
-			SerializeValue(file, tree, package, (char*)data + member->offset, member->type, indent_level + 1);
-			fprintf(file, ",\n");
+			STR_Print(b, member->name.view);
+			STR_Print(b, ": ");
+			SerializeValue(b, tree, package, (char*)data + member->offset, member->type, indent_level + 1);
+			STR_Print(b, ",\n");
 		}
 		
-		for (int j = 0; j < indent_level; j++) fprintf(file, "\t");
-		fprintf(file, "}");
+		SerializeIndent(b, indent_level);
+		STR_Print(b, "}");
 	}break;
 	case HT_TypeKind_Any: {
 		HT_Any val = *(HT_Any*)(data);
-		fprintf(file, "@Type(");
-		SerializeType(file, tree, package, val.type);
-		fprintf(file, ") ");
-		SerializeValue(file, tree, package, val.data, val.type, indent_level);
+		STR_Print(b, "@Type(");
+		SerializeType(b, tree, package, val.type);
+		STR_Print(b, ") ");
+		SerializeValue(b, tree, package, val.data, val.type, indent_level);
 	}break;
 	case HT_TypeKind_AssetRef: {
 		HT_Asset val = *(HT_Asset*)(data);
 		STR_View val_path = AssetGetTextPath(TEMP, package, GetAsset(tree, val));
-		fprintf(file, "\"%.*s\"", StrArg(val_path));
+		STR_Print(b, "\"");
+		STR_Print(b, val_path);
+		STR_Print(b, "\"");
 	} break;
-	case HT_TypeKind_Float: { fprintf(file, "%f", *(float*)(data)); }break;
-	case HT_TypeKind_Vec2: { fprintf(file, "{ %f, %f }", ((vec2*)data)->x, ((vec2*)data)->y); }break;
-	case HT_TypeKind_Vec3: { fprintf(file, "{ %f, %f, %f }", ((vec3*)data)->x, ((vec3*)data)->y, ((vec3*)data)->z); }break;
-	case HT_TypeKind_Vec4: { fprintf(file, "{ %f, %f, %f, %f }", ((vec4*)data)->x, ((vec4*)data)->y, ((vec4*)data)->z, ((vec4*)data)->w); }break;
+	case HT_TypeKind_Float: { SerializeFloats(b, (float*)data, 1); }break;
+	case HT_TypeKind_Vec2: { SerializeFloats(b, (float*)data, 2); }break;
+	case HT_TypeKind_Vec3: { SerializeFloats(b, (float*)data, 3); }break;
+	case HT_TypeKind_Vec4: { SerializeFloats(b, (float*)data, 4); }break;
 	case HT_TypeKind_Int: {
-		fprintf(file, "%d", *(int*)(data));
+		STR_PrintF(b, "%d", *(int*)(data));
 	}break;
 	case HT_TypeKind_Bool: {
-		fprintf(file, "%s", *(bool*)(data) ? "true" : "false");
+		STR_Print(b, *(bool*)(data) ? "true" : "false");
 	}break;
 	default: {
 		ASSERT(0);
-		fprintf(file, "TODO");
+		STR_Print(b, "TODO");
 	}break;
 	}
 }
 
-static void SaveAsset(AssetTree* tree, Asset* package, Asset* asset, STR_View filesys_path) {
-	if (asset->kind == AssetKind_Folder || asset->kind == AssetKind_Package) {
-		bool ok = OS_MakeDirectory(DS, filesys_path);
-		ASSERT(ok);
+// Replaces the contents of a file with `data`. The data is first written into a temporary file which is then renamed
+// over the file, so a crash in the middle of saving can't leave a half-written file behind. If the file already has
+// exactly this content, nothing is written and its modtime stays the same. Returns true if the file was written.
+static bool WriteFileIfChanged(STR_View filesys_path, STR_View data) {
+	DS_Scope scope = DS_ScopePush(DS);
+	
+	STR_View old_data;
+	bool unchanged = OS_ReadEntireFile(TEMP, STR_ToC(TEMP, filesys_path), &old_data) && STR_Match(old_data, data);
+	
+	bool written = false;
+	if (!unchanged) {
+		STR_View temp_path = STR_Form(TEMP, "%v.tmp", filesys_path);
+		bool ok = OS_WriteEntireFile(DS, STR_ToC(TEMP, temp_path), data);
+		if (ok) ok = OS_MoveFile(DS, temp_path, filesys_path);
+		if (!ok) printf("Failed to save '%.*s'\n", StrArg(filesys_path)); // TODO: use log window
+		written = ok;
+	}
+	
+	DS_ScopePop(scope);
+	return written;
+}
+
+// DS_MurmurHash64A of file contents. Never returns 0, which means unknown.
+static u64 ContentHash(STR_View data) {
+	u64 hash = DS_MurmurHash64A(data.data, data.size, 0);
+	return hash == 0 ? 1 : hash;
+}
+
+// Writes the file contents of a struct type, plugin or struct data asset into `b`, replacing what was in it
+static void SerializeAssetFile(STR_Builder* b, AssetTree* tree, Asset* package, Asset* asset) {
+	b->str.size = 0;
+
+	if (asset->kind == AssetKind_StructType) {
+		STR_Print(b, "struct: {\n");
+		for (int i = 0; i < asset->struct_type.members.count; i++) {
+			StructMember* member = &asset->struct_type.members.data[i];
+			STR_Print(b, "\t");
+			STR_Print(b, member->name.view);
+			STR_Print(b, ": ");
+			SerializeType(b, tree, package, member->type);
+			STR_Print(b, ",\n");
+		}
+		STR_Print(b, "}\n");
+	}
+
+	if (asset->kind == AssetKind_Plugin) {
+		HT_Type type = {};
+		type.kind = HT_TypeKind_Struct;
+		type.handle = tree->plugin_options_struct_type->handle;
+		void* data = &asset->plugin.options;
 
+		Asset* type_asset = GetAsset(tree, type.handle);
+		for (int i = 0; i < type_asset->struct_type.members.count; i++) {
+			StructMember* member = &type_asset->struct_type.members.data[i];
+			STR_Print(b, member->name.view);
+			STR_Print(b, ": ");
+			SerializeValue(b, tree, package, (char*)data + member->offset, member->type, 0);
+			STR_Print(b, "\n");
+		}
+	}
+
+	if (asset->kind == AssetKind_StructData) {
+		Asset* type_asset = GetAsset(tree, asset->struct_data.struct_type);
+		STR_View type_asset_path = AssetGetTextPath(TEMP, package, type_asset);
+		STR_Print(b, "type: \"");
+		STR_Print(b, type_asset_path);
+		STR_Print(b, "\"\n");
+		
+		STR_Print(b, "data: ");
+
+		HT_Type type = {};
+		type.kind = HT_TypeKind_Struct;
+		type.handle = type_asset->handle;
+		SerializeValue(b, tree, package, asset->struct_data.data, type, 0);
+	}
+}
+
+// `b` is a scratch builder for the file contents. Returns true if any file or directory was written or deleted.
+static bool SaveAsset(AssetTree* tree, Asset* package, Asset* asset, STR_View filesys_path, STR_Builder* b) {
+	bool changed = false;
+
+	if (asset->kind == AssetKind_Folder || asset->kind == AssetKind_Package) {
 		OS_FileInfoArray files;
-		ok = OS_GetAllFilesInDirectory(TEMP, filesys_path, &files);
+		bool exists = OS_GetAllFilesInDirectory(TEMP, filesys_path, &files);
+		if (!exists) {
+			bool ok = OS_MakeDirectory(DS, filesys_path);
+			ASSERT(ok);
+			changed = true;
+		}
 
-		DS_Map(uint64_t, Asset*) asset_from_name;
+		DS_Map(HT_NameID, Asset*) asset_from_name;
 		DS_MapInit(&asset_from_name, TEMP);
 
 		for (Asset* child = asset->first_child; child; child = child->next) {
-			uint64_t hash = DS_MurmurHash64A(child->name.data, child->name.size, 0);
-			DS_MapInsert(&asset_from_name, hash, child);
+			DS_MapInsert(&asset_from_name, child->name.id, child);
 		}
 
 		// Delete files which exist in the filesystem, but aren't part of the asset tree
-		for (int i = 0; i < files.count; i++) {
+		for (int i = 0; exists && i < files.count; i++) {
 			OS_FileInfo* info = &files.data[i];
 			if (info->is_directory && STR_Match(info->name, ".plugin_binaries")) continue;
 
@@ -379,88 +501,49 @@ static void SaveAsset(AssetTree* tree, Asset* package, Asset* asset, STR_View fi
 
 			if (STR_Match(ext, "inc.ht")) continue;
 
-			uint64_t hash = DS_MurmurHash64A(stem.data, stem.size, 0);
+			// File assets are named with their extension, the others without
+			HT_Name stem_name = {}, full_name = {};
+			bool is_in_tree = FindName(stem, &stem_name) && DS_MapFindPtr(&asset_from_name, stem_name.id) != NULL;
+			if (!is_in_tree) is_in_tree = FindName(info->name, &full_name) && DS_MapFindPtr(&asset_from_name, full_name.id) != NULL;
+			if (STR_EndsWith(ext, ".ht.tmp")) is_in_tree = false; // left behind by an interrupted WriteFileIfChanged
 
-			if (DS_MapFindPtr(&asset_from_name, hash) == NULL) {
+			if (!is_in_tree) {
 				if (info->is_directory) {
 					OS_DeleteDirectory(DS, info->name);
 				} else {
 					OS_DeleteFile(DS, info->name);
 				}
+				changed = true;
 			}
 		}
 
 		for (Asset* child = asset->first_child; child; child = child->next) {
 			STR_View child_filesys_path = AssetGetFilepathUsingParentDirectory(TEMP, filesys_path, child);
-			SaveAsset(tree, package, child, child_filesys_path);
+			changed |= SaveAsset(tree, package, child, child_filesys_path, b);
 		}
 	}
+	else if (asset->kind == AssetKind_File) {
+		// only write file assets when they don't exist already
+		uint64_t modtime;
+		bool file_exists = OS_FileGetModtime(DS, filesys_path, &modtime);
+		if (!file_exists) {
+			changed = OS_WriteEntireFile(DS, STR_ToC(TEMP, filesys_path), "");
+		}
+	}
+	else if (asset->kind == AssetKind_StructData && asset->struct_data.needs_load) {
+		// The data hasn't been loaded, so it can't have been edited either and the file already has it. Its asset references
+		// are still up to date too, as LoadAllStructData is called before any asset is renamed or deleted.
+	}
 	else {
-		bool write = true;
-
-		if (asset->kind == AssetKind_File) { // only write file assets when they don't exist already
-			uint64_t modtime;
-			bool file_exists = OS_FileGetModtime(DS, filesys_path, &modtime);
-			write = file_exists == false;
-		}
-
-		FILE* file = NULL;
-		if (write) file = fopen(STR_ToC(TEMP, filesys_path), "wb");
-		if (file) {
-			// Serialize file
-			if (asset->kind == AssetKind_StructType) {
-				fprintf(file, "struct: {\n");
-				for (int i = 0; i < asset->struct_type.members.count; i++) {
-					StructMember* member = &asset->struct_type.members.data[i];
-					fprintf(file, "\t%.*s: ", StrArg(member->name.view));
-					SerializeType(file, tree, package, member->type);
-					fprintf(file, ",\n");
-				}
-				fprintf(file, "}\n");
-			}
+		SerializeAssetFile(b, tree, package, asset);
 
-			if (asset->kind == AssetKind_Plugin) {
-				HT_Type type = {};
-				type.kind = HT_TypeKind_Struct;
-				type.handle = tree->plugin_options_struct_type->handle;
-				void* data = &asset->plugin.options;
-				//SerializeValue(file, tree, package, &asset->plugin.options, type, 0);
-
-				Asset* type_asset = GetAsset(tree, type.handle);
-				for (int i = 0; i < type_asset->struct_type.members.count; i++) {
-					StructMember* member = &type_asset->struct_type.members.data[i];
-					fprintf(file, "%.*s: ", StrArg(member->name));
-					SerializeValue(file, tree, package, (char*)data + member->offset, member->type, 0);
-					fprintf(file, "\n");
-				}
-
-				//STR_View data_asset_path = AssetGetTextPath(TEMP, package, GetAsset(tree, asset->plugin.options.data_asset));
-				//fprintf(file, "data_asset: \"%.*s\"\n", StrArg(data_asset_path));
-				//fprintf(file, "code_files: {\n");
-				//for (int i = 0; i < asset->plugin.options.code_files.count; i++) {
-				//	HT_Asset code_file_handle = ((HT_Asset*)asset->plugin.options.code_files.data)[i];
-				//	STR_View code_file_path = AssetGetTextPath(TEMP, package, GetAsset(tree, code_file_handle));
-				//	fprintf(file, "\t\"%.*s\",\n", StrArg(code_file_path));
-				//}
-				//fprintf(file, "}\n");
-			}
+		changed = WriteFileIfChanged(filesys_path, b->str);
 
-			if (asset->kind == AssetKind_StructData) {
-				Asset* type_asset = GetAsset(tree, asset->struct_data.struct_type);
-				STR_View type_asset_path = AssetGetTextPath(TEMP, package, type_asset);
-				fprintf(file, "type: \"%.*s\"\n", StrArg(type_asset_path));
-				
-				fprintf(file, "data: ");
-
-				HT_Type type = {};
-				type.kind = HT_TypeKind_Struct;
-				type.handle = type_asset->handle;
-				SerializeValue(file, tree, package, asset->struct_data.data, type, 0);
-			}
-
-			fclose(file);
-		}
+		// The file now has exactly these contents, so reloading it later can be skipped if they stay the same
+		asset->content_hash = ContentHash(b->str);
 	}
+
+	return changed;
 }
 
 EXPORT void SavePackageToDisk(AssetTree* tree, Asset* package) {
@@ -476,16 +559,44 @@ EXPORT void SavePackageToDisk(AssetTree* tree, Asset* package) {
 		package->package.filesys_path = STR_Clone(HEAP, filesys_path);
 	}
 
-	package->package.dir_watch_will_have_hatch_written_changes = true;
-
 	OS_SetWorkingDir(DS, package->package.filesys_path);
 
-	SaveAsset(tree, package, package, package->package.filesys_path);
+	// The same builder is reused for every file, so its memory is only allocated once per save
+	STR_Builder b = {HEAP};
+	bool changed = SaveAsset(tree, package, package, package->package.filesys_path, &b);
+	if (b.capacity > 0) DS_MemFree(HEAP, (void*)b.str.data);
+
+	// The directory watch only sees changes if something was actually written
+	if (changed) package->package.dir_watch_will_have_hatch_written_changes = true;
 
 	OS_SetWorkingDir(DS, CURRENT_WORKING_DIRECTORY); // reset working directory
 }
 
-static void ReloadAssetsPass1(AssetTree* tree, Asset* parent, STR_View parent_full_path, bool force_reload) {
+EXPORT bool AssetMatchesFile(AssetTree* tree, Asset* package, Asset* asset, STR_Builder* b) {
+	// Only these are parsed into memory, other assets are just their files
+	if (asset->kind != AssetKind_StructType && asset->kind != AssetKind_Plugin && asset->kind != AssetKind_StructData) return true;
+	if (asset->kind == AssetKind_StructData && asset->struct_data.needs_load) return true;
+	if (asset->content_hash == 0) return false;
+
+	SerializeAssetFile(b, tree, package, asset);
+	return ContentHash(b->str) == asset->content_hash;
+}
+
+// Returns 0 if the file can't be read
+static u64 HashFileContents(STR_View filesys_path) {
+	DS_Scope scope = DS_ScopePush(DS);
+	STR_View data;
+	u64 hash = 0;
+	if (OS_ReadEntireFile(TEMP, STR_ToC(TEMP, filesys_path), &data)) {
+		hash = ContentHash(data);
+	}
+	DS_ScopePop(scope);
+	return hash;
+}
+
+static void ReloadAssetsPass1(ReloadAssetsContext* ctx, Asset* parent, STR_View parent_full_path, bool force_reload) {
+	AssetTree* tree = ctx->tree;
+
 	OS_FileInfoArray files = {0};
 	OS_GetAllFilesInDirectory(TEMP, parent_full_path, &files);
 
@@ -500,6 +611,7 @@ static void ReloadAssetsPass1(AssetTree* tree, Asset* parent, STR_View parent_fu
 
 	DS_DynArray(Asset*) asset_from_file_idx;
 	DS_ArrInit(&asset_from_file_idx, TEMP);
+	DS_ArrReserveExact(&asset_from_file_idx, files.count);
 
 	Asset* null_asset = NULL;
 	DS_ArrResize(&asset_from_file_idx, null_asset, files.count);
@@ -536,6 +648,7 @@ static void ReloadAssetsPass1(AssetTree* tree, Asset* parent, STR_View parent_fu
 			STR_SplitByFirst(name, '.', &stem, &ext);
 
 			if (STR_Match(ext, "inc.ht")) continue;
+			if (STR_EndsWith(ext, ".ht.tmp")) continue; // see WriteFileIfChanged
 
 			AssetKind asset_kind = AssetKind_Folder;
 			if (!info.is_directory) {
@@ -547,142 +660,164 @@ static void ReloadAssetsPass1(AssetTree* tree, Asset* parent, STR_View parent_fu
 
 			asset = MakeNewAsset(tree, asset_kind);
 
-			StringSetValue(&asset->name, asset_kind == AssetKind_File ? name : stem);
+			asset->name = InternName(asset_kind == AssetKind_File ? name : stem);
 
 			MoveAssetToInside(tree, asset, parent);
 		}
 
-		ASSERT(info.last_write_time >= asset->modtime); // modtime should never decrease on windows
-		asset->reload_assets_pass2_needs_load = info.last_write_time != asset->modtime || force_reload;
+		// The modtime may decrease if the asset was restored from a snapshot and the file was then replaced with an older copy
+		bool modified = info.last_write_time != asset->modtime;
 		asset->modtime = info.last_write_time;
 
+		STR_View full_path = STR_Form(TEMP, "%v/%v", parent_full_path, file_name);
+		asset->reload_assets_filesys_path = full_path;
+
+		if (info.is_directory) {
+			asset->reload_assets_pass2_needs_load = modified || force_reload;
+		}
+		else if (modified || force_reload) {
+			// A new modtime doesn't mean new contents, e.g. after saving or switching branches, so compare the bytes.
+			// When forced, assets parsed from .ht files are always reloaded, because their in-memory values may have been
+			// changed without touching the file (e.g. by plugins during simulation). Other files only have their contents on disk.
+			u64 hash = HashFileContents(full_path);
+			bool changed = hash == 0 || hash != asset->content_hash;
+			asset->reload_assets_pass2_needs_load = changed || (force_reload && asset->kind != AssetKind_File);
+			asset->content_hash = hash;
+
+			if (!asset->reload_assets_pass2_needs_load) ctx->files_unchanged++;
+		}
+		else {
+			asset->reload_assets_pass2_needs_load = false;
+		}
+
 		if (info.last_write_time != asset->modtime) { // propagate modtime up through the parent folders
 			for (Asset* p = parent; p; p = p->parent) {
 				if (info.last_write_time > p->modtime) p->modtime = info.last_write_time;
 			}
 		}
 
-		STR_View full_path = STR_Form(TEMP, "%v/%v", parent_full_path, file_name);
-		asset->reload_assets_filesys_path = full_path;
-
 		if (info.is_directory) {
-			ReloadAssetsPass1(tree, asset, full_path, force_reload);
+			ReloadAssetsPass1(ctx, asset, full_path, force_reload);
 		}
 	}
 }
 
-static bool ParseMetadeskInt(MDParser* p, int *out_value) {
-	int sign = 1;
-	if (p->node->flags & MD_NodeFlag_Symbol && MD_S8Match(p->node->string, MD_S8Lit("-"), 0)) {
-		p->node = p->node->next;
-		sign = -1;
-	}
-	if (MD_NodeIsNil(p->node)) return false;
-	if (!(p->node->flags & MD_NodeFlag_Numeric)) return false;
-	if (!MD_StringIsCStyleInt(p->node->string)) return false;
+// -- Typed parsing ---------------------------------------------------
+// Asset files are parsed straight into the memory described by an HT_Type while reading tokens with an MDReader,
+// so no Metadesk node tree is built for them. Only the .htproject file with the editor layout goes through md.c.
 
-	*out_value = sign * (int)MD_CStyleIntFromString(p->node->string);
+static bool ReadMetadeskInt(MDReader* r, int* out_value) {
+	bool negative = MDReaderIsSymbol(r, '-');
+	if (negative) MDReaderNext(r);
+	if (r->token_kind != MDTokenKind_Numeric) return false;
 
-	p->node = p->node->next;
+	STR_View digits = r->token;
+	int base = 10;
+	/**/ if (STR_CutStart(&digits, "0x") || STR_CutStart(&digits, "0X")) base = 16;
+	else if (STR_CutStart(&digits, "0b") || STR_CutStart(&digits, "0B")) base = 2;
+	else if (STR_CutStart(&digits, "0o") || STR_CutStart(&digits, "0O")) base = 8;
+
+	u64 value;
+	if (!STR_ParseU64Ex(digits, base, &value)) return false;
+	*out_value = negative ? -(int)value : (int)value;
+
+	MDReaderNext(r);
 	return true;
 }
 
-static HT_Type ParseMetadeskType(AssetTree* tree, Asset* package, MDParser* p) {
-	ASSERT(!MD_NodeIsNil(p->node));
+static bool ReadMetadeskFloat(MDReader* r, float* out_value) {
+	bool negative = MDReaderIsSymbol(r, '-');
+	if (negative) MDReaderNext(r);
+	if (r->token_kind != MDTokenKind_Numeric && r->token_kind != MDTokenKind_Identifier) return false; // identifiers for inf and nan
 
-	HT_Type result = {};
-	STR_View type_name = StrFromMD(p->node->string);
+	float value;
+	if (!STR_ParseFloat32(r->token, &value)) return false;
+	*out_value = negative ? -value : value;
 
-	HT_TypeKind builtin_type = StringToTypeKind(type_name);
+	MDReaderNext(r);
+	return true;
+}
+
+static HT_Type ReadMetadeskType(AssetTree* tree, Asset* package, MDReader* r) {
+	bool is_array = false, is_item_group = false;
+	for (; r->token_kind == MDTokenKind_Tag; MDReaderNext(r)) {
+		/**/ if (STR_Match(r->token, "Array")) is_array = true;
+		else if (STR_Match(r->token, "ItemGroup")) is_item_group = true;
+	}
+
+	if (r->token_kind != MDTokenKind_Identifier && r->token_kind != MDTokenKind_String) {
+		MDReaderError(r, "Expected a type, got \"%v\"", r->token);
+	}
+
+	HT_Type result = {};
+	HT_TypeKind builtin_type = r->token_kind == MDTokenKind_Identifier ? StringToTypeKind(r->token) : HT_TypeKind_INVALID;
 	if (builtin_type != HT_TypeKind_INVALID) {
 		result.kind = builtin_type;
 	}
 	else {
 		// Must be a user-defined type
-		Asset* struct_type = FindAssetFromPath(tree, package, type_name);
-		ASSERT(struct_type);
+		Asset* struct_type = FindAssetFromPath(tree, package, r->token);
+		if (struct_type == NULL || struct_type->kind != AssetKind_StructType) {
+			MDReaderError(r, "Type asset not found: \"%v\"", r->token);
+		}
 		result.kind = HT_TypeKind_Struct;
 		result.handle = struct_type->handle;
 	}
 
-	if (MD_NodeHasTag(p->node, MD_S8Lit("Array"), 0)) {
+	if (is_array) {
 		result.subkind = result.kind;
 		result.kind = HT_TypeKind_Array;
 	}
 
-	if (MD_NodeHasTag(p->node, MD_S8Lit("ItemGroup"), 0)) {
+	if (is_item_group) {
 		result.subkind = result.kind;
 		result.kind = HT_TypeKind_ItemGroup;
 	}
 
-	p->node = p->node->next;
+	MDReaderNext(r);
 	return result;
 }
 
-static void ReloadAssetsPass2(ReloadAssetsContext* ctx, Asset* package, Asset* parent) {
-	for (Asset* asset = parent->first_child; asset; asset = asset->next) {
-		if (asset->reload_assets_pass2_needs_load) {
-			MD_ParseResult parse;
-			if (asset->kind == AssetKind_StructType)
-			{
-				MD_String8 md_filepath = {(MD_u8*)asset->reload_assets_filesys_path.data, (MD_u64)asset->reload_assets_filesys_path.size};
-
-				MD_ArenaClear(ctx->md_arena);
-				parse = MD_ParseWholeFile(ctx->md_arena, md_filepath);
-				ASSERT(!MD_NodeIsNil(parse.node));
-				ASSERT(parse.errors.node_count == 0);
-			}
-
-			if (asset->kind == AssetKind_StructType) {
-				MD_Node* struct_node = MD_ChildFromString(parse.node, MD_S8Lit("struct"), 0);
-				for (int i = 0; i < asset->struct_type.members.count; i++) {
-					StructMemberDeinit(&asset->struct_type.members[i]);
-				}
-				DS_ArrClear(&asset->struct_type.members);
-
-				//DS_ArrClear(&asset->struct_members);
-				ASSERT(!MD_NodeIsNil(struct_node));
-				for (MD_EachNode(it, struct_node->first_child)) {
-					StructMember member = {0};
-					StructMemberInit(&member);
+static void ReadMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Type* type, MDReader* r);
 
-					STR_View name = StrFromMD(it->string);
-					StringSetValue(&member.name, name);
+// Reads "name: value" pairs until a closing brace or the end of the file. Members may be in any order, and
+// members that are missing keep their current value, so files written before a member was added can still be loaded.
+static void ReadMetadeskStructMembers(AssetTree* tree, Asset* package, void* dst, Asset* struct_asset, MDReader* r) {
+	DS_DynArray(StructMember)* members = &struct_asset->struct_type.members;
 
-					MDParser child_p = {it->first_child};
-					member.type = ParseMetadeskType(ctx->tree, package, &child_p);
-
-					DS_ArrPush(&asset->struct_type.members, member);
-				}
+	int expected_member = 0;
+	while (r->token_kind != MDTokenKind_EOF && !MDReaderIsSymbol(r, '}')) {
+		if (r->token_kind != MDTokenKind_Identifier && r->token_kind != MDTokenKind_String) {
+			MDReaderError(r, "Expected a struct member, got \"%v\"", r->token);
+		}
 
-				ComputeStructLayout(ctx->tree, asset);
+		// Members are usually in order, so try the next one first
+		int member_idx = -1;
+		for (int i = 0; i < members->count; i++) {
+			int idx = (expected_member + i) % members->count;
+			if (STR_Match(members->data[idx].name.view, r->token)) {
+				member_idx = idx;
+				break;
 			}
 		}
+		if (member_idx == -1) MDReaderError(r, "Unexpected struct member \"%v\"", r->token);
+		expected_member = member_idx + 1;
 
-		ReloadAssetsPass2(ctx, package, asset);
+		MDReaderNext(r);
+		MDReaderSkipSymbol(r, ':');
+
+		StructMember* member = &members->data[member_idx];
+		ReadMetadeskValue(tree, package, (char*)dst + member->offset, &member->type, r);
 	}
 }
 
-// `dst` is expected to be zero-initialized.
-static void ParseMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Type* type, MDParser* p) {
-	// if the child is an array, struct or ItemGroup, then `node` is actually the first child in that container. Otherwise it's the value node itself.
-
+// `dst` is expected to be constructed.
+static void ReadMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Type* type, MDReader* r) {
 	switch (type->kind) {
 	case HT_TypeKind_Struct: {
-		Asset* struct_asset = GetAsset(tree, type->handle);
-
-		for (int i = 0; i < struct_asset->struct_type.members.count; i++) {
-			StructMember member = struct_asset->struct_type.members[i];
-
-			STR_View node_str = StrFromMD(p->node->string);
-			STR_View member_name = member.name.view;
-			EXPECT_OR_USER_ERROR(MD_S8Match(p->node->string, StrToMD(member.name), 0), "Unexpected end of struct, expected member: \"%.*s\"", StrArg(member_name));
-			EXPECT_OR_USER_ERROR(MD_S8Match(p->node->string, StrToMD(member.name), 0), "Unexpected struct member \"%.*s\", expected \"%.*s\"", StrArg(node_str), StrArg(member_name));
-			
-			MDParser child_p = {p->node->first_child};
-			ParseMetadeskValue(tree, package, (char*)dst + member.offset, &member.type, &child_p);
-			p->node = p->node->next;
-		}
+		MDReaderSkipSymbol(r, '{');
+		ReadMetadeskStructMembers(tree, package, dst, GetAsset(tree, type->handle), r);
+		MDReaderSkipSymbol(r, '}');
 	}break;
 	case HT_TypeKind_ItemGroup: {
 		HT_ItemGroup* val = (HT_ItemGroup*)dst;
@@ -693,7 +828,6 @@ static void ParseMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Ty
 		// reset item group
 		{
 			for (HT_ItemGroupEach(val, item_idx)) {
-				HT_ItemHeader* item_header = HT_GetItemHeader(val, item_idx);
 				void* item_data = (char*)HT_GetItemHeader(val, item_idx) + val->item_offset;
 				Destruct(tree, item_data, &item_type);
 			}
@@ -701,22 +835,27 @@ static void ParseMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Ty
 			ItemGroupInit(tree, val, &item_type);
 		}
 
-		for (; !MD_NodeIsNil(p->node); p->node = p->node->next) {
+		MDReaderSkipSymbol(r, '{');
+		while (!MDReaderIsSymbol(r, '}')) {
+			if (r->token_kind != MDTokenKind_String && r->token_kind != MDTokenKind_Identifier) {
+				MDReaderError(r, "Expected an item name, got \"%v\"", r->token);
+			}
+
 			HT_ItemIndex item_i = ItemGroupAdd(val);
 
 			HT_ItemHeader* item = GetItemFromIndex(val, item_i);
-			
-			STR_View name = StrFromMD(p->node->string);
-			StringSetValue(&item->name, name);
+			item->name = InternName(r->token);
 
 			MoveItemToAfter(val, item_i, val->last);
 
 			void* item_data = (char*)GetItemFromIndex(val, item_i) + val->item_offset;
 			Construct(tree, item_data, &item_type);
 
-			MDParser child_p = {p->node->first_child};
-			ParseMetadeskValue(tree, package, item_data, &item_type, &child_p);
+			MDReaderNext(r);
+			MDReaderSkipSymbol(r, ':');
+			ReadMetadeskValue(tree, package, item_data, &item_type, r);
 		}
+		MDReaderNext(r);
 	}break;
 	case HT_TypeKind_Array: {
 		HT_Array* val = (HT_Array*)dst;
@@ -736,43 +875,42 @@ static void ParseMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Ty
 			ArrayClear(val, elem_size);
 		}
 
-		int i = 0;
-		while (!MD_NodeIsNil(p->node)) {
+		MDReaderSkipSymbol(r, '{');
+		for (int i = 0; !MDReaderIsSymbol(r, '}'); i++) {
+			if (r->token_kind == MDTokenKind_EOF) MDReaderError(r, "Unexpected end of file, expected '}'");
+
 			ArrayPush(val, elem_size);
 			char* elem_data = (char*)val->data + elem_size*i;
 			Construct(tree, elem_data, &elem_type);
-			ParseMetadeskValue(tree, package, elem_data, &elem_type, p);
-			i++;
+			ReadMetadeskValue(tree, package, elem_data, &elem_type, r);
 		}
+		MDReaderNext(r);
 	}break;
 	case HT_TypeKind_Int: {
-		int* val = (int*)dst;
-		bool ok = ParseMetadeskInt(p, val);
-		ASSERT(ok);
+		if (!ReadMetadeskInt(r, (int*)dst)) MDReaderError(r, "Expected an integer, got \"%v\"", r->token);
 	}break;
 	case HT_TypeKind_Float: {
-		float* val = (float*)dst;
-		bool ok = ParseMetadeskFloat(p, val);
-		ASSERT(ok);
+		if (!ReadMetadeskFloat(r, (float*)dst)) MDReaderError(r, "Expected a float, got \"%v\"", r->token);
 	}break;
-	case HT_TypeKind_Vec2: TODO(); break;
-	case HT_TypeKind_Vec3: {
-		for (int i = 0; i < 3; i++) {
-			ASSERT(!MD_NodeIsNil(p->node));
-			bool ok = ParseMetadeskFloat(p, &((float*)dst)[i]);
-			ASSERT(ok);
+	case HT_TypeKind_Vec2: // fallthrough
+	case HT_TypeKind_Vec3: // fallthrough
+	case HT_TypeKind_Vec4: {
+		int count = type->kind == HT_TypeKind_Vec2 ? 2 : type->kind == HT_TypeKind_Vec3 ? 3 : 4;
+		MDReaderSkipSymbol(r, '{');
+		for (int i = 0; i < count; i++) {
+			if (!ReadMetadeskFloat(r, &((float*)dst)[i])) MDReaderError(r, "Expected a float, got \"%v\"", r->token);
 		}
+		MDReaderSkipSymbol(r, '}');
 	}break;
-	case HT_TypeKind_Vec4: TODO(); break;
 	case HT_TypeKind_IVec2: TODO(); break;
 	case HT_TypeKind_IVec3: TODO(); break;
 	case HT_TypeKind_IVec4: TODO(); break;
 	case HT_TypeKind_Bool: {
 		bool* val = (bool*)dst;
-		/**/ if (MD_S8Match(p->node->string, MD_S8Lit("true"), 0)) *val = true;
-		else if (MD_S8Match(p->node->string, MD_S8Lit("false"), 0)) *val = false;
-		else ASSERT(0);
-		p->node = p->node->next;
+		/**/ if (STR_Match(r->token, "true")) *val = true;
+		else if (STR_Match(r->token, "false")) *val = false;
+		else MDReaderError(r, "Expected true or false, got \"%v\"", r->token);
+		MDReaderNext(r);
 	}break;
 	case HT_TypeKind_String: {
 		TODO();
@@ -782,112 +920,151 @@ static void ParseMetadeskValue(AssetTree* tree, Asset* package, void* dst, HT_Ty
 	}break;
 	case HT_TypeKind_Any: {
 		HT_Any* val = (HT_Any*)dst;
-		MD_Node* type_tag = MD_TagFromString(p->node, MD_S8Lit("Type"), 0);
-		ASSERT(!MD_NodeIsNil(type_tag));
+		if (r->token_kind != MDTokenKind_Tag || !STR_Match(r->token, "Type")) {
+			MDReaderError(r, "Expected @Type for a value of type Any, got \"%v\"", r->token);
+		}
+		MDReaderNext(r);
 
-		MDParser type_tag_child_p = {type_tag->first_child};
-		HT_Type type = ParseMetadeskType(tree, package, &type_tag_child_p);
+		MDReaderSkipSymbol(r, '(');
+		HT_Type type = ReadMetadeskType(tree, package, r);
+		MDReaderSkipSymbol(r, ')');
 		AnyChangeType(tree, val, &type);
 
-		MDParser child_p = {p->node->first_child};
-		ParseMetadeskValue(tree, package, val->data, &type, &child_p);
-		p->node = p->node->next;
+		ReadMetadeskValue(tree, package, val->data, &type, r);
 	}break;
 	case HT_TypeKind_AssetRef: {
 		HT_Asset* val = (HT_Asset*)dst;
-		Asset* found_asset = FindAssetFromPath(tree, package, StrFromMD(p->node->string));
+		if (r->token_kind != MDTokenKind_String) MDReaderError(r, "Expected an asset path, got \"%v\"", r->token);
+		Asset* found_asset = FindAssetFromPath(tree, package, r->token);
 		*val = found_asset ? found_asset->handle : NULL;
-		p->node = p->node->next;
+		MDReaderNext(r);
 	}break;
 	case HT_TypeKind_COUNT: ASSERT(0); break;
 	case HT_TypeKind_INVALID: ASSERT(0); break;
 	}
 }
 
-static void ReloadAssetsPass3(ReloadAssetsContext* ctx, Asset* package, Asset* parent) {
+// Reads a struct data file, which has the path of its type asset and then the data. With `type_only`, reading stops after the type
+// and the asset is left with `needs_load` set. Otherwise the data is parsed as well.
+static void ReadStructDataFile(AssetTree* tree, Asset* package, Asset* asset, MDReader* r, bool type_only) {
+	if (!STR_Match(r->token, "type")) MDReaderError(r, "Expected \"type\", got \"%v\"", r->token);
+	MDReaderNext(r);
+	MDReaderSkipSymbol(r, ':');
+	if (r->token_kind != MDTokenKind_String) MDReaderError(r, "Expected a type asset path, got \"%v\"", r->token);
+
+	Asset* type_asset = FindAssetFromPath(tree, package, r->token);
+	if (type_asset == NULL) MDReaderError(r, "Type asset not found: \"%v\"", r->token);
+	if (type_asset->kind != AssetKind_StructType) MDReaderError(r, "Type asset is not a type: \"%v\"", r->token);
+	MDReaderNext(r);
+
+	DeinitStructDataAssetIfInitialized(tree, asset);
+	if (type_only) {
+		asset->struct_data.struct_type = type_asset->handle;
+		asset->struct_data.needs_load = true;
+		return;
+	}
+
+	InitStructDataAsset(tree, asset, type_asset);
+	asset->struct_data.needs_load = false;
+
+	if (r->token_kind == MDTokenKind_EOF) return; // no data means default values
+	if (!STR_Match(r->token, "data")) MDReaderError(r, "Unexpected \"%v\", expected \"data\"", r->token);
+	MDReaderNext(r);
+	MDReaderSkipSymbol(r, ':');
+
+	HT_Type type = { HT_TypeKind_Struct };
+	type.handle = type_asset->handle;
+	ReadMetadeskValue(tree, package, asset->struct_data.data, &type, r);
+	if (r->token_kind != MDTokenKind_EOF) MDReaderError(r, "Expected the end of the file, got \"%v\"", r->token);
+}
+
+// Opens the file of `asset` for reading with the context's reader
+static MDReader* OpenAssetFile(ReloadAssetsContext* ctx, Asset* asset) {
+	bool ok = MDReaderOpen(&ctx->reader, asset->reload_assets_filesys_path);
+	EXPECT_OR_USER_ERROR(ok, "ERROR: failed to open '%.*s'\n", StrArg(asset->reload_assets_filesys_path));
+	ctx->files_count++;
+	return &ctx->reader;
+}
+
+static void ReloadAssetsPass2(ReloadAssetsContext* ctx, Asset* package, Asset* parent) {
 	for (Asset* asset = parent->first_child; asset; asset = asset->next) {
-		if (asset->reload_assets_pass2_needs_load) {
-			MD_ParseResult parse;
-			if (asset->kind == AssetKind_StructData || asset->kind == AssetKind_Plugin) {
-				MD_String8 md_filepath = {(MD_u8*)asset->reload_assets_filesys_path.data, (MD_u64)asset->reload_assets_filesys_path.size};
-
-				MD_ArenaClear(ctx->md_arena);
-				parse = MD_ParseWholeFile(ctx->md_arena, md_filepath);
-				ASSERT(!MD_NodeIsNil(parse.node));
-				ASSERT(parse.errors.node_count == 0);
-			}
+		if (asset->reload_assets_pass2_needs_load && asset->kind == AssetKind_StructType) {
+			MDReader* r = OpenAssetFile(ctx, asset);
 
-			if (asset->kind == AssetKind_Plugin) {
-				HT_Type type = { HT_TypeKind_Struct };
-				type.handle = ctx->tree->plugin_options_struct_type->handle;
-				MDParser child_p = {parse.node->first_child};
-				ParseMetadeskValue(ctx->tree, package, &asset->plugin.options, &type, &child_p);
-				//HT_Array* code_files = &asset->plugin.options.code_files;
-				//ArrayClear(code_files, sizeof(HT_Asset));
-
-				//MD_Node* data_node = MD_ChildFromString(parse.node, MD_S8Lit("data_asset"), 0);
-				//
-				//Asset* data_asset = NULL;
-				//if (!MD_NodeIsNil(data_node)) {
-				//	data_asset = FindAssetFromPath(ctx->tree, package, StrFromMD(data_node->first_child->string));
-				//}
-				//asset->plugin.options.data = data_asset ? data_asset->handle : NULL;
-
-				//MD_Node* source_files_node = MD_ChildFromString(parse.node, MD_S8Lit("code_files"), 0);
-				//if (!MD_NodeIsNil(source_files_node)) {
-				//	for (MD_EachNode(it, source_files_node->first_child)) {
-				//		STR_View path = StrFromMD(it->string);
-				//		Asset* elem = FindAssetFromPath(ctx->tree, package, path);
-				//		HT_Asset elem_ref = elem ? elem->handle : NULL;
-				//
-				//		ArrayPush(code_files, sizeof(HT_Asset));
-				//		((HT_Asset*)code_files->data)[code_files->count - 1] = elem_ref;
-				//	}
-				//}
+			for (int i = 0; i < asset->struct_type.members.count; i++) {
+				StructMemberDeinit(&asset->struct_type.members[i]);
 			}
+			DS_ArrClear(&asset->struct_type.members);
 
-			if (asset->kind == AssetKind_StructData) {
-				MD_Node* type_node = MD_ChildFromString(parse.node, MD_S8Lit("type"), 0);
-				STR_View str = StrFromMD(type_node->first_child->string);
-				Asset* type_asset = FindAssetFromPath(ctx->tree, package, str);
-				EXPECT_OR_USER_ERROR(type_asset != NULL, "ERROR: Type asset not found: '%.*s'\n", StrArg(str));
-				EXPECT_OR_USER_ERROR(type_asset->kind == AssetKind_StructType, "ERROR: Type asset is not a type: '%.*s'\n", StrArg(str));
+			if (!STR_Match(r->token, "struct")) MDReaderError(r, "Expected \"struct\", got \"%v\"", r->token);
+			MDReaderNext(r);
+			MDReaderSkipSymbol(r, ':');
+			MDReaderSkipSymbol(r, '{');
 
-				DeinitStructDataAssetIfInitialized(ctx->tree, asset);
-				InitStructDataAsset(ctx->tree, asset, type_asset);
+			while (!MDReaderIsSymbol(r, '}')) {
+				if (r->token_kind != MDTokenKind_Identifier && r->token_kind != MDTokenKind_String) {
+					MDReaderError(r, "Expected a struct member name, got \"%v\"", r->token);
+				}
+
+				StructMember member = {0};
+				StructMemberInit(&member);
+				member.name = InternName(r->token);
 
-				MD_Node* data_node = MD_ChildFromString(parse.node, MD_S8Lit("data"), 0);
+				MDReaderNext(r);
+				MDReaderSkipSymbol(r, ':');
+				member.type = ReadMetadeskType(ctx->tree, package, r);
 
-				HT_Type type = { HT_TypeKind_Struct };
-				type.handle = type_asset->handle;
-				MDParser child_p = {data_node->first_child};
-				ParseMetadeskValue(ctx->tree, package, asset->struct_data.data, &type, &child_p);
+				DS_ArrPush(&asset->struct_type.members, member);
 			}
+
+			MDReaderClose(r);
+			ComputeStructLayout(ctx->tree, asset);
 		}
 
-		// queue plugin for recompilation if any of its source files has changed
-		if (asset->kind == AssetKind_Plugin) {
-			bool code_file_was_loaded = false;
+		ReloadAssetsPass2(ctx, package, asset);
+	}
+}
 
-			HT_Array code_files = asset->plugin.options.code_files;
-			for (int i = 0; i < code_files.count; i++) {
-				HT_Asset code_file_handle = ((HT_Asset*)code_files.data)[i];
-				Asset* code_file = GetAsset(ctx->tree, code_file_handle);
-				if (code_file && code_file->reload_assets_pass2_needs_load) {
-					code_file_was_loaded = true;
-					break;
-				}
-			}
+static void ReloadAssetsPass3(ReloadAssetsContext* ctx, Asset* package, Asset* parent) {
+	for (Asset* asset = parent->first_child; asset; asset = asset->next) {
+		if (asset->reload_assets_pass2_needs_load && asset->kind == AssetKind_Plugin) {
+			MDReader* r = OpenAssetFile(ctx, asset);
 
-			if (code_file_was_loaded) {
-				DS_ArrPush(&ctx->queue_recompile_plugins, asset);
-			}
+			// The whole file is the member list of the plugin options struct
+			ReadMetadeskStructMembers(ctx->tree, package, &asset->plugin.options, ctx->tree->plugin_options_struct_type, r);
+			if (r->token_kind != MDTokenKind_EOF) MDReaderError(r, "Expected the end of the file, got \"%v\"", r->token);
+
+			MDReaderClose(r);
+		}
+
+		if (asset->reload_assets_pass2_needs_load && asset->kind == AssetKind_StructData) {
+			// Only the type is read here; the data is parsed when it's first needed
+			MDReader* r = OpenAssetFile(ctx, asset);
+			ReadStructDataFile(ctx->tree, package, asset, r, true);
+			MDReaderClose(r);
+
+			DS_ArrPush(&ctx->tree->struct_data_prefetch_queue, asset->handle);
+			ctx->struct_data_deferred++;
 		}
 
 		ReloadAssetsPass3(ctx, package, asset);
 	}
 }
 
+static void ReloadAssetsUpdateDependencies(ReloadAssetsContext* ctx, Asset* parent) {
+	for (Asset* asset = parent->first_child; asset; asset = asset->next) {
+		if (asset->reload_assets_pass2_needs_load) {
+			UpdateAssetDependencies(ctx->tree, asset);
+
+			if (asset->kind == AssetKind_File || asset->kind == AssetKind_StructType) {
+				DS_ArrPush(&ctx->reloaded_code_and_types, asset);
+			}
+		}
+
+		ReloadAssetsUpdateDependencies(ctx, asset);
+	}
+}
+
 EXPORT void ReloadPackages(AssetTree* tree, DS_ArrayView<Asset*> packages, bool force_reload) {
 	// We do loading in two passes.
 	// 1. pass: delete assets which don't exist in the filesystem and make empty assets for those which do exist and we don't have as assets yet
@@ -896,16 +1073,19 @@ EXPORT void ReloadPackages(AssetTree* tree, DS_ArrayView<Asset*> packages, bool
 	// but in runtime representation those need to be resolved into asset handles. We must be able to refer
 	// to other not-yet-loaded assets when loading an asset.
 	// 3. pass: load struct data assets. This needs to be done as a separate pass AFTER all struct types have been loaded.
+	//    Only their types are read here, the data itself is parsed on first use or by PrefetchStructData.
+
+	u64 start_tick = OS_GetCPUTick();
 
 	ReloadAssetsContext ctx = {0};
 	ctx.tree = tree;
-	ctx.md_arena = MD_ArenaAlloc();
+	DS_ArrInit(&ctx.reloaded_code_and_types, TEMP);
 	DS_ArrInit(&ctx.queue_recompile_plugins, TEMP);
 
 	for (int i = 0; i < packages.count; i++) {
 		Asset* package = packages[i];
 		OS_SetWorkingDir(DS, package->package.filesys_path);
-		ReloadAssetsPass1(tree, package, package->package.filesys_path, force_reload);
+		ReloadAssetsPass1(&ctx, package, package->package.filesys_path, force_reload);
 	}
 
 	for (int i = 0; i < packages.count; i++) {
@@ -920,6 +1100,19 @@ EXPORT void ReloadPackages(AssetTree* tree, DS_ArrayView<Asset*> packages, bool
 		ReloadAssetsPass3(&ctx, package, package);
 	}
 
+	// The edges of the loaded assets are updated only once every asset has been loaded, since they may refer to each other
+	for (int i = 0; i < packages.count; i++) {
+		ReloadAssetsUpdateDependencies(&ctx, packages[i]);
+	}
+
+	// Queue the plugins whose code or generated header is affected for recompilation. Plugins only see data assets at runtime,
+	// so a changed data asset doesn't need a recompile.
+	DS_DynArray(Asset*) dependents = {TEMP};
+	CollectDependents(tree, ctx.reloaded_code_and_types, &dependents);
+	for (int i = 0; i < dependents.count; i++) {
+		if (dependents[i]->kind == AssetKind_Plugin) DS_ArrPush(&ctx.queue_recompile_plugins, dependents[i]);
+	}
+
 	/*for (int i = 0; i < ctx.queue_recompile_plugins.count; i++) {
 		Asset* plugin_asset = ctx.queue_recompile_plugins[i];
 		RegeneratePluginHeader(tree, plugin_asset);
@@ -946,12 +1139,80 @@ EXPORT void ReloadPackages(AssetTree* tree, DS_ArrayView<Asset*> packages, bool
 	}
 #endif
 
-	MD_ArenaRelease(ctx.md_arena);
+	g_last_asset_load_stats.files_count = ctx.files_count;
+	g_last_asset_load_stats.files_unchanged = ctx.files_unchanged;
+	g_last_asset_load_stats.bytes_read = ctx.reader.bytes_read;
+	g_last_asset_load_stats.parser_memory = ctx.reader.buffer_capacity;
+	g_last_asset_load_stats.seconds = OS_GetDuration(CPU_FREQUENCY, start_tick, OS_GetCPUTick());
+	g_last_asset_load_stats.struct_data_deferred = ctx.struct_data_deferred;
+	g_last_asset_load_stats.assets_from_snapshot = 0;
+
+	MDReaderDeinit(&ctx.reader);
 	OS_SetWorkingDir(DS, CURRENT_WORKING_DIRECTORY); // reset working directory
 }
 
-EXPORT void LoadPackages(AssetTree* tree, DS_ArrayView<STR_View> paths) {
-	DS_DynArray(Asset*) packages = {TEMP};
+EXPORT AssetLoadStats GetLastAssetLoadStats() {
+	return g_last_asset_load_stats;
+}
+
+// Reader for loading deferred struct data. Only used on the main thread, like the rest of the asset tree.
+static MDReader g_struct_data_reader;
+
+EXPORT void* GetStructData(AssetTree* tree, Asset* asset) {
+	ASSERT(asset->kind == AssetKind_StructData);
+	if (asset->struct_data.needs_load) {
+		Asset* package = asset->parent;
+		while (package->kind != AssetKind_Package) package = package->parent;
+
+		DS_Scope scope = DS_ScopePush(DS);
+		STR_View filesys_path = AssetGetAbsoluteFilepath(TEMP, asset);
+		bool ok = MDReaderOpen(&g_struct_data_reader, filesys_path);
+		EXPECT_OR_USER_ERROR(ok, "ERROR: failed to open '%.*s'\n", StrArg(filesys_path));
+
+		ReadStructDataFile(tree, package, asset, &g_struct_data_reader, false);
+		MDReaderClose(&g_struct_data_reader);
+		DS_ScopePop(scope);
+
+		UpdateAssetDependencies(tree, asset); // until now, only the struct type was known
+	}
+	return asset->struct_data.data;
+}
+
+EXPORT void PrefetchStructData(AssetTree* tree, double budget_seconds) {
+	if (tree->struct_data_prefetch_queue.count == 0) return;
+
+	u64 start_tick = OS_GetCPUTick();
+	while (tree->struct_data_prefetch_queue.count > 0) {
+		HT_Asset handle = DS_ArrPop(&tree->struct_data_prefetch_queue);
+
+		// The asset may have been deleted or loaded on demand since it was queued
+		Asset* asset = GetAsset(tree, handle);
+		if (asset && asset->kind == AssetKind_StructData && asset->struct_data.needs_load) {
+			GetStructData(tree, asset);
+		}
+
+		if (OS_GetDuration(CPU_FREQUENCY, start_tick, OS_GetCPUTick()) >= budget_seconds) break;
+	}
+
+	// Everything is loaded, so the window isn't needed anymore until the next reload
+	if (tree->struct_data_prefetch_queue.count == 0) MDReaderDeinit(&g_struct_data_reader);
+}
+
+EXPORT void LoadAllStructData(AssetTree* tree) {
+	for (DS_SlotMapEach(&tree->assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&tree->assets, asset_i);
+		if (asset->kind == AssetKind_StructData && asset->struct_data.needs_load) {
+			GetStructData(tree, asset);
+		}
+	}
+	DS_ArrClear(&tree->struct_data_prefetch_queue);
+	MDReaderDeinit(&g_struct_data_reader);
+}
+
+EXPORT void LoadPackages(AssetTree* tree, DS_ArrayView<STR_View> paths, STR_View snapshot_path) {
+	Asset* packages_buffer[16];
+	DS_DynArray(Asset*) packages;
+	DS_ArrInitBuffer(&packages, TEMP, packages_buffer);
 
 	for (int i = 0; i < paths.count; i++) {
 		STR_View path = paths[i];
@@ -975,8 +1236,12 @@ EXPORT void LoadPackages(AssetTree* tree, DS_ArrayView<STR_View> paths) {
 
 		DS_ArrPush(&packages, package);
 	}
+
+	int assets_from_snapshot = 0;
+	if (snapshot_path.size > 0) assets_from_snapshot = LoadAssetTreeSnapshot(tree, packages, snapshot_path);
 	
 	ReloadPackages(tree, packages, false);
+	g_last_asset_load_stats.assets_from_snapshot = assets_from_snapshot;
 }
 
 EXPORT void HotreloadPackages(AssetTree* tree) {
@@ -0,0 +1,584 @@
+#include "include/ht_common.h"
+
+// The snapshot is a binary copy of the asset tree that the editor writes when it closes, so that the next launch doesn't
+// need to parse every asset file again. It has the struct layouts and the data of every asset whose in-memory state is
+// exactly what its file contains; assets with unsaved changes are written without their data and get reparsed.
+//
+// Assets refer to each other by index instead of by handle, so the snapshot doesn't depend on where anything was in memory:
+//   0 is the built-in plugin options type, 1 is the built-in NameAndType type, then the packages, then the assets in
+//   the order of their records. -1 is a null reference.
+//
+// Layout: SnapshotHeader, the package paths, the records (one per asset below the packages, in depth-first order),
+// the payloads of the struct types, and then the payloads of the other records.
+//
+// LoadAssetTreeSnapshot only restores the assets. ReloadPackages then compares the modtimes and content hashes of the
+// restored assets with the files on disk as usual, and parses only the files that changed.
+
+#define SNAPSHOT_MAGIC 0x50414E5354484148 // "HATHSNAP"
+#define SNAPSHOT_VERSION 4
+
+#define SNAPSHOT_INDEX_PLUGIN_OPTIONS_TYPE 0
+#define SNAPSHOT_INDEX_NAME_AND_TYPE_TYPE 1
+#define SNAPSHOT_INDEX_FIRST_PACKAGE 2
+
+struct SnapshotHeader {
+	u64 magic;
+	u32 version;
+	u32 packages_count;
+	u32 records_count;
+	u32 pad;
+	u64 body_size;
+	u64 body_hash; // DS_MurmurHash64A of everything after the header
+};
+
+struct SnapshotWriter {
+	AssetTree* tree;
+	STR_Builder b;
+	DS_Map(u64, i32) index_from_handle;
+};
+
+struct SnapshotReader {
+	AssetTree* tree;
+	STR_View data;
+	size_t pos;
+	bool error; // set if anything is read past the end or doesn't make sense. Reads after an error return zeroes.
+	DS_DynArray(HT_Asset) handle_from_index;
+};
+
+// Snapshot record of an asset, as read before any assets are made
+struct SnapshotRecord {
+	AssetKind kind;
+	bool matches_file; // if false, the record has no payload and modtime and content_hash are 0, so the file is reparsed
+	i32 parent; // index of the parent asset
+	STR_View name;
+	u64 modtime;
+	u64 content_hash;
+	STR_View filesys_path; // only made for struct types
+};
+
+// -- Writing ---------------------------------------------------------
+
+static void SnapshotWrite(SnapshotWriter* w, const void* data, size_t size) {
+	STR_View bytes = {(char*)data, size};
+	STR_Print(&w->b, bytes);
+}
+
+static void SnapshotWriteU8(SnapshotWriter* w, u8 value)   { SnapshotWrite(w, &value, sizeof(value)); }
+static void SnapshotWriteI32(SnapshotWriter* w, i32 value) { SnapshotWrite(w, &value, sizeof(value)); }
+static void SnapshotWriteU64(SnapshotWriter* w, u64 value) { SnapshotWrite(w, &value, sizeof(value)); }
+
+static void SnapshotWriteString(SnapshotWriter* w, STR_View value) {
+	SnapshotWriteI32(w, (i32)value.size);
+	SnapshotWrite(w, value.data, value.size);
+}
+
+static void SnapshotAddIndex(SnapshotWriter* w, HT_Asset handle, i32 index) {
+	u64 key = (u64)handle;
+	DS_MapInsert(&w->index_from_handle, key, index);
+}
+
+static void SnapshotWriteAssetRef(SnapshotWriter* w, HT_Asset handle) {
+	u64 key = (u64)handle;
+	i32 index = -1;
+	if (handle) DS_MapFind(&w->index_from_handle, key, &index);
+	SnapshotWriteI32(w, index);
+}
+
+static void SnapshotWriteType(SnapshotWriter* w, HT_Type type) {
+	SnapshotWriteU8(w, (u8)type.kind);
+	SnapshotWriteU8(w, (u8)type.subkind);
+	SnapshotWriteAssetRef(w, type.handle);
+}
+
+static void SnapshotWriteValue(SnapshotWriter* w, void* data, HT_Type type) {
+	AssetTree* tree = w->tree;
+	switch (type.kind) {
+	case HT_TypeKind_Struct: {
+		Asset* type_asset = GetAsset(tree, type.handle);
+		for (int i = 0; i < type_asset->struct_type.members.count; i++) {
+			StructMember* member = &type_asset->struct_type.members.data[i];
+			SnapshotWriteValue(w, (char*)data + member->offset, member->type);
+		}
+	}break;
+	case HT_TypeKind_Array: {
+		HT_Array val = *(HT_Array*)data;
+
+		HT_Type elem_type = type;
+		elem_type.kind = elem_type.subkind;
+
+		i32 elem_size, elem_align;
+		GetTypeSizeAndAlignment(tree, &elem_type, &elem_size, &elem_align);
+
+		SnapshotWriteI32(w, val.count);
+		for (int i = 0; i < val.count; i++) {
+			SnapshotWriteValue(w, (char*)val.data + elem_size*i, elem_type);
+		}
+	}break;
+	case HT_TypeKind_ItemGroup: {
+		HT_ItemGroup* val = (HT_ItemGroup*)data;
+
+		HT_Type item_type = type;
+		item_type.kind = item_type.subkind;
+
+		i32 count = 0;
+		for (HT_ItemGroupEach(val, item_idx)) count++;
+
+		SnapshotWriteI32(w, count);
+		for (HT_ItemGroupEach(val, item_idx)) {
+			HT_ItemHeader* item_header = HT_GetItemHeader(val, item_idx);
+			SnapshotWriteString(w, item_header->name.view);
+			SnapshotWriteValue(w, (char*)item_header + val->item_offset, item_type);
+		}
+	}break;
+	case HT_TypeKind_Any: {
+		HT_Any val = *(HT_Any*)data;
+		SnapshotWriteU8(w, val.data != NULL);
+		if (val.data) {
+			SnapshotWriteType(w, val.type);
+			SnapshotWriteValue(w, val.data, val.type);
+		}
+	}break;
+	case HT_TypeKind_AssetRef: { SnapshotWriteAssetRef(w, *(HT_Asset*)data); }break;
+	case HT_TypeKind_String:   { SnapshotWriteString(w, ((HT_String*)data)->view); }break;
+	case HT_TypeKind_Type:     { SnapshotWriteType(w, *(HT_Type*)data); }break;
+	case HT_TypeKind_Float: // fallthrough
+	case HT_TypeKind_Int:   // fallthrough
+	case HT_TypeKind_Bool:  // fallthrough
+	case HT_TypeKind_Vec2:  // fallthrough
+	case HT_TypeKind_Vec3:  // fallthrough
+	case HT_TypeKind_Vec4:  // fallthrough
+	case HT_TypeKind_IVec2: // fallthrough
+	case HT_TypeKind_IVec3: // fallthrough
+	case HT_TypeKind_IVec4: {
+		i32 size, align;
+		GetTypeSizeAndAlignment(tree, &type, &size, &align);
+		SnapshotWrite(w, data, size);
+	}break;
+	case HT_TypeKind_COUNT: ASSERT(0); break;
+	case HT_TypeKind_INVALID: ASSERT(0); break;
+	}
+}
+
+static void SnapshotGetAssets(Asset* parent, DS_DynArray(Asset*)* out_assets) {
+	for (Asset* asset = parent->first_child; asset; asset = asset->next) {
+		DS_ArrPush(out_assets, asset);
+		SnapshotGetAssets(asset, out_assets);
+	}
+}
+
+static Asset* SnapshotGetPackage(Asset* asset) {
+	Asset* package = asset->parent;
+	while (package->kind != AssetKind_Package) package = package->parent;
+	return package;
+}
+
+EXPORT bool SaveAssetTreeSnapshot(AssetTree* tree, STR_View file_path) {
+	DS_Scope scope = DS_ScopePush(DS);
+
+	SnapshotWriter w = {};
+	w.tree = tree;
+	w.b.allocator = TEMP;
+	DS_MapInit(&w.index_from_handle, TEMP);
+
+	DS_DynArray(Asset*) packages = {TEMP};
+	DS_DynArray(Asset*) assets = {TEMP};
+	for (Asset* package = tree->root->first_child; package; package = package->next) {
+		if (package->kind != AssetKind_Package) continue;
+		DS_ArrPush(&packages, package);
+		SnapshotGetAssets(package, &assets);
+	}
+
+	SnapshotAddIndex(&w, tree->plugin_options_struct_type->handle, SNAPSHOT_INDEX_PLUGIN_OPTIONS_TYPE);
+	SnapshotAddIndex(&w, tree->name_and_type_struct_type->handle, SNAPSHOT_INDEX_NAME_AND_TYPE_TYPE);
+	for (int i = 0; i < packages.count; i++) {
+		SnapshotAddIndex(&w, packages[i]->handle, SNAPSHOT_INDEX_FIRST_PACKAGE + i);
+	}
+	i32 first_asset_index = SNAPSHOT_INDEX_FIRST_PACKAGE + packages.count;
+	for (int i = 0; i < assets.count; i++) {
+		SnapshotAddIndex(&w, assets[i]->handle, first_asset_index + i);
+	}
+
+	// Only assets that are exactly what their files contain can be restored; the others are reparsed on load
+	DS_DynArray(bool) matches_file = {TEMP};
+	DS_ArrResizeUndef(&matches_file, assets.count);
+	STR_Builder scratch = {TEMP};
+	for (int i = 0; i < assets.count; i++) {
+		Asset* asset = assets[i];
+		matches_file[i] = AssetMatchesFile(tree, SnapshotGetPackage(asset), asset, &scratch);
+	}
+
+	SnapshotHeader header = {};
+	header.magic = SNAPSHOT_MAGIC;
+	header.version = SNAPSHOT_VERSION;
+	header.packages_count = packages.count;
+	header.records_count = assets.count;
+	SnapshotWrite(&w, &header, sizeof(header));
+
+	for (int i = 0; i < packages.count; i++) {
+		SnapshotWriteString(&w, packages[i]->package.filesys_path);
+	}
+
+	for (int i = 0; i < assets.count; i++) {
+		Asset* asset = assets[i];
+		SnapshotWriteU8(&w, (u8)asset->kind);
+		SnapshotWriteU8(&w, matches_file[i]);
+		SnapshotWriteAssetRef(&w, asset->parent->handle);
+		SnapshotWriteString(&w, asset->name.view);
+		SnapshotWriteU64(&w, matches_file[i] ? asset->modtime : 0);
+		SnapshotWriteU64(&w, matches_file[i] ? asset->content_hash : 0);
+	}
+
+	// Struct types go first, because the data of the other assets can't be made without knowing the layouts
+	for (int i = 0; i < assets.count; i++) {
+		Asset* asset = assets[i];
+		if (asset->kind != AssetKind_StructType || !matches_file[i]) continue;
+
+		SnapshotWriteI32(&w, asset->struct_type.size);
+		SnapshotWriteI32(&w, asset->struct_type.alignment);
+		SnapshotWriteI32(&w, asset->struct_type.members.count);
+		for (int j = 0; j < asset->struct_type.members.count; j++) {
+			StructMember* member = &asset->struct_type.members[j];
+			SnapshotWriteString(&w, member->name.view);
+			SnapshotWriteType(&w, member->type);
+			SnapshotWriteI32(&w, member->offset);
+		}
+	}
+
+	for (int i = 0; i < assets.count; i++) {
+		Asset* asset = assets[i];
+		if (!matches_file[i]) continue;
+
+		if (asset->kind == AssetKind_Plugin) {
+			HT_Type type = { HT_TypeKind_Struct };
+			type.handle = tree->plugin_options_struct_type->handle;
+			SnapshotWriteValue(&w, &asset->plugin.options, type);
+		}
+		if (asset->kind == AssetKind_StructData) {
+			SnapshotWriteAssetRef(&w, asset->struct_data.struct_type);
+			SnapshotWriteU8(&w, !asset->struct_data.needs_load);
+			if (!asset->struct_data.needs_load) {
+				HT_Type type = { HT_TypeKind_Struct };
+				type.handle = asset->struct_data.struct_type;
+				SnapshotWriteValue(&w, asset->struct_data.data, type);
+			}
+		}
+	}
+
+	header.body_size = w.b.str.size - sizeof(SnapshotHeader);
+	header.body_hash = DS_MurmurHash64A(w.b.str.data + sizeof(SnapshotHeader), header.body_size, 0);
+	memcpy((char*)w.b.str.data, &header, sizeof(header));
+
+	bool ok = OS_WriteEntireFile(DS, STR_ToC(TEMP, file_path), w.b.str);
+
+	DS_ScopePop(scope);
+	return ok;
+}
+
+// -- Reading ---------------------------------------------------------
+
+static void SnapshotRead(SnapshotReader* r, void* dst, size_t size) {
+	if (r->error || size > r->data.size - r->pos) {
+		r->error = true;
+		memset(dst, 0, size);
+		return;
+	}
+	memcpy(dst, r->data.data + r->pos, size);
+	r->pos += size;
+}
+
+static u8  SnapshotReadU8(SnapshotReader* r)  { u8 value;  SnapshotRead(r, &value, sizeof(value)); return value; }
+static i32 SnapshotReadI32(SnapshotReader* r) { i32 value; SnapshotRead(r, &value, sizeof(value)); return value; }
+static u64 SnapshotReadU64(SnapshotReader* r) { u64 value; SnapshotRead(r, &value, sizeof(value)); return value; }
+
+// The result points into the snapshot data
+static STR_View SnapshotReadString(SnapshotReader* r) {
+	i32 size = SnapshotReadI32(r);
+	if (r->error || size < 0 || (size_t)size > r->data.size - r->pos) {
+		r->error = true;
+		return {};
+	}
+	STR_View result = {r->data.data + r->pos, (size_t)size};
+	r->pos += size;
+	return result;
+}
+
+static HT_Asset SnapshotReadAssetRef(SnapshotReader* r) {
+	i32 index = SnapshotReadI32(r);
+	if (index == -1) return NULL;
+	if (index < 0 || index >= r->handle_from_index.count) {
+		r->error = true;
+		return NULL;
+	}
+	return r->handle_from_index[index];
+}
+
+static HT_Type SnapshotReadType(SnapshotReader* r) {
+	HT_Type type = {};
+	type.kind = (HT_TypeKind)SnapshotReadU8(r);
+	type.subkind = (HT_TypeKind)SnapshotReadU8(r);
+	type.handle = SnapshotReadAssetRef(r);
+	if (type.kind >= HT_TypeKind_COUNT || type.subkind >= HT_TypeKind_COUNT) r->error = true;
+
+	bool has_struct = type.kind == HT_TypeKind_Struct ||
+		((type.kind == HT_TypeKind_Array || type.kind == HT_TypeKind_ItemGroup) && type.subkind == HT_TypeKind_Struct);
+	if (has_struct) {
+		Asset* type_asset = GetAsset(r->tree, type.handle);
+		if (type_asset == NULL || type_asset->kind != AssetKind_StructType) r->error = true;
+	}
+	if (r->error) type = {}; // a valid type, so that the value can still be constructed and destructed
+	return type;
+}
+
+// `dst` is expected to be constructed. Like ReadMetadeskValue, but for the binary values of SnapshotWriteValue.
+static void SnapshotReadValue(SnapshotReader* r, void* dst, HT_Type* type) {
+	AssetTree* tree = r->tree;
+	if (r->error) return;
+
+	switch (type->kind) {
+	case HT_TypeKind_Struct: {
+		Asset* type_asset = GetAsset(tree, type->handle);
+		for (int i = 0; i < type_asset->struct_type.members.count; i++) {
+			StructMember* member = &type_asset->struct_type.members.data[i];
+			SnapshotReadValue(r, (char*)dst + member->offset, &member->type);
+		}
+	}break;
+	case HT_TypeKind_Array: {
+		HT_Array* val = (HT_Array*)dst;
+
+		HT_Type elem_type = *type;
+		elem_type.kind = type->subkind;
+
+		i32 elem_size, elem_align;
+		GetTypeSizeAndAlignment(tree, &elem_type, &elem_size, &elem_align);
+
+		i32 count = SnapshotReadI32(r);
+		for (int i = 0; i < count && !r->error; i++) {
+			ArrayPush(val, elem_size);
+			char* elem_data = (char*)val->data + elem_size*i;
+			Construct(tree, elem_data, &elem_type);
+			SnapshotReadValue(r, elem_data, &elem_type);
+		}
+	}break;
+	case HT_TypeKind_ItemGroup: {
+		HT_ItemGroup* val = (HT_ItemGroup*)dst;
+
+		HT_Type item_type = *type;
+		item_type.kind = type->subkind;
+
+		i32 count = SnapshotReadI32(r);
+		for (int i = 0; i < count && !r->error; i++) {
+			HT_ItemIndex item_i = ItemGroupAdd(val);
+
+			HT_ItemHeader* item = GetItemFromIndex(val, item_i);
+			item->name = InternName(SnapshotReadString(r));
+
+			MoveItemToAfter(val, item_i, val->last);
+
+			void* item_data = (char*)GetItemFromIndex(val, item_i) + val->item_offset;
+			Construct(tree, item_data, &item_type);
+			SnapshotReadValue(r, item_data, &item_type);
+		}
+	}break;
+	case HT_TypeKind_Any: {
+		HT_Any* val = (HT_Any*)dst;
+		if (SnapshotReadU8(r)) {
+			HT_Type any_type = SnapshotReadType(r);
+			AnyChangeType(tree, val, &any_type);
+			SnapshotReadValue(r, val->data, &any_type);
+		}
+	}break;
+	case HT_TypeKind_AssetRef: { *(HT_Asset*)dst = SnapshotReadAssetRef(r); }break;
+	case HT_TypeKind_String:   { StringInit((HT_String*)dst, SnapshotReadString(r)); }break;
+	case HT_TypeKind_Type:     { *(HT_Type*)dst = SnapshotReadType(r); }break;
+	case HT_TypeKind_Float: // fallthrough
+	case HT_TypeKind_Int:   // fallthrough
+	case HT_TypeKind_Bool:  // fallthrough
+	case HT_TypeKind_Vec2:  // fallthrough
+	case HT_TypeKind_Vec3:  // fallthrough
+	case HT_TypeKind_Vec4:  // fallthrough
+	case HT_TypeKind_IVec2: // fallthrough
+	case HT_TypeKind_IVec3: // fallthrough
+	case HT_TypeKind_IVec4: {
+		i32 size, align;
+		GetTypeSizeAndAlignment(tree, type, &size, &align);
+		SnapshotRead(r, dst, size);
+	}break;
+	case HT_TypeKind_COUNT: ASSERT(0); break;
+	case HT_TypeKind_INVALID: ASSERT(0); break;
+	}
+}
+
+// A restored struct type would keep its old layout even if its file is parsed again, and the restored data that uses it
+// wouldn't match the new layout. So if any struct type changed, the snapshot isn't used at all.
+static bool SnapshotStructTypesAreUnchanged(DS_ArrayView<SnapshotRecord> records) {
+	for (int i = 0; i < records.count; i++) {
+		SnapshotRecord* record = &records[i];
+		if (record->kind != AssetKind_StructType) continue;
+		if (!record->matches_file) return false;
+
+		u64 modtime;
+		if (!OS_FileGetModtime(DS, record->filesys_path, &modtime)) return false;
+		if (modtime == record->modtime) continue;
+
+		// A new modtime doesn't mean new contents, e.g. after switching branches
+		STR_View data;
+		if (!OS_ReadEntireFile(TEMP, STR_ToC(TEMP, record->filesys_path), &data)) return false;
+		u64 hash = DS_MurmurHash64A(data.data, data.size, 0);
+		if (hash == 0) hash = 1;
+		if (hash != record->content_hash) return false;
+	}
+	return true;
+}
+
+EXPORT int LoadAssetTreeSnapshot(AssetTree* tree, DS_ArrayView<Asset*> packages, STR_View file_path) {
+	DS_Scope scope = DS_ScopePush(DS);
+	int restored_count = 0;
+
+	STR_View data;
+	bool ok = OS_ReadEntireFile(TEMP, STR_ToC(TEMP, file_path), &data);
+
+	SnapshotHeader header = {};
+	if (ok) ok = data.size >= sizeof(SnapshotHeader);
+	if (ok) {
+		memcpy(&header, data.data, sizeof(header));
+		ok = header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION &&
+			header.body_size == data.size - sizeof(SnapshotHeader) &&
+			header.body_hash == DS_MurmurHash64A(data.data + sizeof(SnapshotHeader), header.body_size, 0);
+	}
+
+	SnapshotReader r = {};
+	r.tree = tree;
+	r.data = data;
+	r.pos = sizeof(SnapshotHeader);
+	DS_ArrInit(&r.handle_from_index, TEMP);
+
+	// The snapshot is only valid for the same packages in the same order
+	if (ok) ok = header.packages_count == (u32)packages.count;
+	for (int i = 0; ok && i < packages.count; i++) {
+		ok = STR_Match(SnapshotReadString(&r), packages[i]->package.filesys_path) && !r.error;
+	}
+
+	DS_DynArray(SnapshotRecord) records = {TEMP};
+	DS_DynArray(STR_View) directory_from_index = {TEMP}; // filesystem path of each package and folder
+	if (ok) {
+		DS_ArrPush(&r.handle_from_index, tree->plugin_options_struct_type->handle);
+		DS_ArrPush(&r.handle_from_index, tree->name_and_type_struct_type->handle);
+		STR_View no_directory = {};
+		DS_ArrResize(&directory_from_index, no_directory, SNAPSHOT_INDEX_FIRST_PACKAGE);
+		for (int i = 0; i < packages.count; i++) {
+			DS_ArrPush(&r.handle_from_index, packages[i]->handle);
+			DS_ArrPush(&directory_from_index, packages[i]->package.filesys_path);
+		}
+
+		for (u32 i = 0; i < header.records_count && !r.error; i++) {
+			i32 index = SNAPSHOT_INDEX_FIRST_PACKAGE + packages.count + i;
+
+			SnapshotRecord record = {};
+			record.kind = (AssetKind)SnapshotReadU8(&r);
+			record.matches_file = SnapshotReadU8(&r) != 0;
+			record.parent = SnapshotReadI32(&r);
+			record.name = SnapshotReadString(&r);
+			record.modtime = SnapshotReadU64(&r);
+			record.content_hash = SnapshotReadU64(&r);
+
+			// Records come after their parent, which must be a package or a folder
+			bool valid_kind = record.kind >= AssetKind_Folder && record.kind <= AssetKind_StructData;
+			bool valid_parent = record.parent >= SNAPSHOT_INDEX_FIRST_PACKAGE && record.parent < index &&
+				directory_from_index[record.parent].size > 0;
+			if (!valid_kind || !valid_parent) r.error = true;
+			if (r.error) break;
+
+			STR_View directory = {};
+			if (record.kind == AssetKind_Folder || record.kind == AssetKind_StructType) {
+				// Same as AssetGetFilename
+				STR_View ext = record.kind == AssetKind_StructType ? ".struct.ht" : "";
+				directory = STR_Form(TEMP, "%v/%v%v", directory_from_index[record.parent], record.name, ext);
+			}
+			if (record.kind == AssetKind_StructType) record.filesys_path = directory;
+
+			DS_ArrPush(&records, record);
+			DS_ArrPush(&directory_from_index, record.kind == AssetKind_Folder ? directory : STR_View{});
+		}
+		ok = !r.error && SnapshotStructTypesAreUnchanged(records);
+	}
+
+	if (ok) {
+		for (int i = 0; i < records.count; i++) {
+			SnapshotRecord* record = &records[i];
+			Asset* asset = MakeNewAsset(tree, record->kind);
+			asset->name = InternName(record->name);
+			asset->modtime = record->modtime;
+			asset->content_hash = record->content_hash;
+			MoveAssetToInside(tree, asset, GetAsset(tree, r.handle_from_index[record->parent]));
+			DS_ArrPush(&r.handle_from_index, asset->handle);
+		}
+
+		i32 first_asset_index = SNAPSHOT_INDEX_FIRST_PACKAGE + packages.count;
+		for (int i = 0; i < records.count && !r.error; i++) {
+			if (records[i].kind != AssetKind_StructType || !records[i].matches_file) continue;
+			Asset* asset = GetAsset(tree, r.handle_from_index[first_asset_index + i]);
+
+			asset->struct_type.size = SnapshotReadI32(&r);
+			asset->struct_type.alignment = SnapshotReadI32(&r);
+			i32 members_count = SnapshotReadI32(&r);
+			for (int j = 0; j < members_count && !r.error; j++) {
+				StructMember member = {0};
+				StructMemberInit(&member);
+				member.name = InternName(SnapshotReadString(&r));
+				member.type = SnapshotReadType(&r);
+				member.offset = SnapshotReadI32(&r);
+				DS_ArrPush(&asset->struct_type.members, member);
+			}
+		}
+
+		for (int i = 0; i < records.count && !r.error; i++) {
+			if (!records[i].matches_file) continue;
+			Asset* asset = GetAsset(tree, r.handle_from_index[first_asset_index + i]);
+
+			if (asset->kind == AssetKind_Plugin) {
+				HT_Type type = { HT_TypeKind_Struct };
+				type.handle = tree->plugin_options_struct_type->handle;
+				SnapshotReadValue(&r, &asset->plugin.options, &type);
+			}
+			if (asset->kind == AssetKind_StructData) {
+				Asset* type_asset = GetAsset(tree, SnapshotReadAssetRef(&r));
+				bool has_data = SnapshotReadU8(&r) != 0;
+				if (type_asset == NULL || type_asset->kind != AssetKind_StructType) r.error = true;
+				if (r.error) break;
+
+				if (has_data) {
+					InitStructDataAsset(tree, asset, type_asset);
+					HT_Type type = { HT_TypeKind_Struct };
+					type.handle = type_asset->handle;
+					SnapshotReadValue(&r, asset->struct_data.data, &type);
+				}
+				else {
+					asset->struct_data.struct_type = type_asset->handle;
+					asset->struct_data.needs_load = true;
+					DS_ArrPush(&tree->struct_data_prefetch_queue, asset->handle);
+				}
+			}
+		}
+
+		ok = !r.error && r.pos == r.data.size;
+		if (ok) {
+			restored_count = records.count;
+			for (int i = 0; i < records.count; i++) {
+				UpdateAssetDependencies(tree, GetAsset(tree, r.handle_from_index[first_asset_index + i]));
+			}
+		}
+		else {
+			// Undo everything, the packages are then loaded from their files
+			for (int i = 0; i < packages.count; i++) {
+				for (Asset* child = packages[i]->first_child; child;) {
+					Asset* next = child->next;
+					DeleteAssetIncludingChildren(tree, child);
+					child = next;
+				}
+			}
+		}
+	}
+
+	DS_ScopePop(scope);
+	return restored_count;
+}
@@ -45,7 +45,7 @@ EXPORT void UI_AddDropdownButton(UI_Box* box, UI_Size w, UI_Size h, UI_BoxFlags
 
 EXPORT void UI_PanelTreeInit(UI_PanelTree* tree, DS_Allocator* allocator) {
 	*tree = {};
-	DS_BkArrInit(&tree->panels, allocator, 8);
+	DS_SlotMapInit(&tree->panels, allocator, 8);
 }
 
 EXPORT void UIDropdownStateBeginFrame(UIDropdownState* s) {
@@ -67,15 +67,9 @@ EXPORT void UIRegisterOrderedRoot(UIDropdownState* s, UI_Box* root) {
 }
 
 EXPORT UI_Panel* NewUIPanel(UI_PanelTree* tree) {
-	UI_Panel* panel;
-	if (tree->first_free_panel) {
-		panel = tree->first_free_panel;
-		tree->first_free_panel = tree->first_free_panel->freelist_next;
-	}
-	else {
-		panel = (UI_Panel*)DS_BkArrPushUndef(&tree->panels);
-	}
-	*panel = UI_Panel{0};
+	DS_SlotHandle handle;
+	UI_Panel* panel = (UI_Panel*)DS_SlotMapAdd(&tree->panels, &handle);
+	panel->handle = handle;
 	DS_ArrInit(&panel->tabs, HEAP);
 	return panel;
 }
@@ -97,10 +91,39 @@ EXPORT UI_Text StringToUIText(HT_String string) {
 	return result;
 }
 
+struct UIValNameEdit {
+	bool is_editing;
+	STR_View text; // allocated from the UI frame arena and copied into the next one, like in UI_AddValNumeric
+};
+
+EXPORT UI_ValTextState* UIAddValName(UI_Box* box, UI_Size w, UI_Size h, HT_Name* name) {
+	// Interned names are immutable and never freed, so the text is edited in a buffer of the box. It's only interned
+	// once the edit is committed with Enter or by moving the focus away, and Escape discards it.
+	UIValNameEdit* edit;
+	UI_BoxGetRetainedVar(box, UI_KEY(), &edit);
+
+	UI_Text text;
+	UI_TextInit(UI_TEMP, &text, edit->is_editing ? edit->text : name->view);
+	UI_ValTextState* state = UI_AddValText(box, w, h, &text, NULL);
+
+	STR_View new_value = UI_TextToStr(text);
+	if (state->is_editing) {
+		edit->is_editing = true;
+		edit->text = new_value;
+	}
+	else if (edit->is_editing) {
+		edit->is_editing = false;
+		if (!UI_InputWasPressed(UI_Input_Escape) && !STR_Match(new_value, name->view)) {
+			*name = InternName(new_value);
+		}
+	}
+	return state;
+}
+
 EXPORT void FreeUIPanel(UI_PanelTree* tree, UI_Panel* panel) {
 	DS_ArrDeinit(&panel->tabs);
-	panel->freelist_next = tree->first_free_panel;
-	tree->first_free_panel = panel;
+	bool ok = DS_SlotMapRemove(&tree->panels, panel->handle);
+	ASSERT(ok);
 }
 
 EXPORT void UI_PanelTreeUpdateAndDraw(UIDropdownState* s, UI_PanelTree* tree, UI_Panel* panel, UI_Rect area_rect, bool splitter_is_hovered, UI_Font icons_font, UI_Panel** out_hovered) {
@@ -3,6 +3,8 @@
 
 #ifdef HT_DYNAMIC
 #define HT_IMPORT extern "C" __declspec(dllexport)
+#elif defined(HT_HEADLESS)
+#define HT_IMPORT extern "C" // plugins compiled by hatch-headless look these up from the executable
 #endif // otherwise HT_IMPORT is defined to be empty in the project file defines list
 
 #include "hatch_api.h"
@@ -50,6 +52,9 @@ typedef vec2 UI_Vec2;
 #define OS_CLIPBOARD_API extern "C"
 #include <ht_utils/fire/fire_os_clipboard.h>
 
+#define OS_SYNC_API extern "C"
+#include <ht_utils/fire/fire_os_sync.h>
+
 #define BUILD_API extern "C"
 #include <ht_utils/fire/fire_build.h>
 
@@ -61,39 +66,6 @@ typedef vec2 UI_Vec2;
 
 #include <stdio.h> // for printf, this should be removed in the final product
 
-// -- Utility macros --------------------------------------------------
-
-// Allocate a slot from a bucket array with an index-based freelist.
-// Zero-initializes new elements, but keeps old data on reuse.
-#define NEW_SLOT(OUT_INDEX, BUCKET_ARRAY, FIRST_FREE_SLOT, NEXT) \
-	if (*FIRST_FREE_SLOT) { \
-		*OUT_INDEX = *FIRST_FREE_SLOT; \
-		*FIRST_FREE_SLOT = DS_BkArrGet(BUCKET_ARRAY, *FIRST_FREE_SLOT)->NEXT; \
-	} else { \
-		DS_BkArrPushZero(BUCKET_ARRAY); \
-		*OUT_INDEX = DS_BkArrLast(BUCKET_ARRAY); \
-	}
-
-// Free a slot from a bucket array with an index-based freelist
-#define FREE_SLOT(INDEX, BUCKET_ARRAY, FIRST_FREE_INDEX, NEXT) \
-	DS_BkArrGet(BUCKET_ARRAY, INDEX)->NEXT = *FIRST_FREE_INDEX; \
-	*FIRST_FREE_INDEX = INDEX;
-
-// Allocate a slot from a bucket array with a pointer-based freelist
-// Zero-initializes new elements, but keeps old data on reuse.
-#define NEW_SLOT_PTR(OUT_SLOT, BUCKET_ARRAY, FIRST_FREE_SLOT, NEXT) \
-	if (*FIRST_FREE_SLOT) { \
-		*OUT_SLOT = *FIRST_FREE_SLOT; \
-		*FIRST_FREE_SLOT = (*FIRST_FREE_SLOT)->NEXT; \
-	} else { \
-		*(void**)OUT_SLOT = DS_BkArrPushZero(BUCKET_ARRAY); \
-	}
-
-// Free a slot from a bucket array with a pointer-based freelist
-#define FREE_SLOT_PTR(SLOT, FIRST_FREE_INDEX, NEXT) \
-	SLOT->NEXT = *FIRST_FREE_INDEX; \
-	*FIRST_FREE_INDEX = SLOT;
-
 // -- Globals ---------------------------------------------------------
 
 extern DS_Arena* TEMP;
@@ -102,6 +74,8 @@ extern DS_Info* DS;
 //extern DS_MemScopeNone MEM_SCOPE_NONE_;
 extern uint64_t CPU_FREQUENCY;
 extern STR_View CURRENT_WORKING_DIRECTORY; // cache the current working directory to avoid having to query for it every time we want to temporarily change it
+extern u64 HEAP_ALLOCATIONS_THIS_FRAME; // number of allocations and reallocations done through HEAP, including the blocks of TEMP
+extern u64 HEAP_ALLOCATIONS_LAST_FRAME;
 
 //#define MEM_SCOPE_TEMP   (DS_MemScope*)&MEM_SCOPE_TEMP_
 //#define MEM_SCOPE(ARENA) DS_MemScope{ ARENA, TEMP }
@@ -112,35 +86,20 @@ static const float TOP_BAR_HEIGHT = 28.f;
 static const UI_Color ACTIVE_COLOR = {180, 120, 50, 230};
 static const vec2 DEFAULT_UI_INNER_PADDING = {12.f, 12.f};
 static const float VAR_SPLITTER_AREA_HALF_WIDTH = 5.f;
+static const double STRUCT_DATA_PREFETCH_SECONDS_PER_FRAME = 0.002;
+static const double PLUGIN_INCLUDE_CHECK_SECONDS_PER_FRAME = 0.0005;
+static const char* PROJECT_SNAPSHOT_FILE = ".htsnapshot"; // in the project directory, next to .htproject
 
 // -- ht_data_model.cpp -----------------------------------------------
 
+// A file that the compiler read when compiling a plugin, and its modification time when the compile finished
 struct PluginIncludeStamp {
 	u64 last_write_time;
 	STR_View file_path;
 };
 
-struct ActivePluginData {
-	DS_Arena arena;
-	//Asset* plugin_asset;
-	DS_Map(uint64_t, PluginIncludeStamp) includes;
-};
-
 struct Asset;
 
-union DecodedHandle {
-	struct {
-		u16 bucket_index;
-		u16 elem_index;
-		u32 generation;
-	};
-	u64 val;
-};
-
-static inline void* EncodeHandle(DecodedHandle handle) { return *(void**)&handle; }
-static inline DecodedHandle DecodeHandle(void* handle) { return *(DecodedHandle*)&handle; }
-
-#define AssetKind_FreeSlot (AssetKind)0
 enum AssetKind {
 	AssetKind_Root = 1,
 	AssetKind_Package, // Packages are root-level folders. Packages can be saved to disk. Packages cannot contain other packages.
@@ -154,7 +113,7 @@ enum AssetKind {
 };
 
 struct StructMember {
-	HT_String name;
+	HT_Name name;
 	HT_Type type;
 	i32 offset;
 };
@@ -178,12 +137,12 @@ struct PluginOptions {
 	HT_Asset data_asset;
 	HT_Array code_files; // Array<AssetRef>
 	HT_Array linker_inputs; // Array<AssetRef>
+	bool unity_build; // compile the .cpp code files as one translation unit
+	bool precompiled_header; // precompile the includes that all .cpp code files start with, see WritePluginPrecompiledHeader
+	HT_Array update_after; // Array<AssetRef>: running plugins whose HT_UpdatePlugin must return before this plugin's is called
+	bool update_on_worker_thread; // see UpdatePlugins
 };
 
-struct PluginAllocationHeader {
-	u32 allocation_index;
-	size_t size;
-};
 
 struct Asset_Plugin {
 	PluginOptions options; // a value of type g_plugin_options_struct_type
@@ -200,13 +159,18 @@ struct Asset_StructData {
 	//     But we don't want to destroy the data. TODO: we should have an additional array of "stale_members" which stores the name, type and value of old members.
 	//     The stale array could then be serialized as regular.
 	void* data;
+
+	// True if only the type has been read from the file so far. The data is parsed on first access with GetStructData,
+	// or earlier by PrefetchStructData. `data` is NULL until then.
+	bool needs_load;
 };
 
 struct Asset {
 	AssetKind kind;
-	HT_String name; // not used for AssetKind_Package
+	HT_Name name; // not used for AssetKind_Package
 	HT_Asset handle;
 	u64 modtime;
+	u64 content_hash; // DS_MurmurHash64A of the file contents when it was last loaded or saved, 0 if unknown. Not used for folders
 
 	Asset* parent;
 	Asset* prev;
@@ -215,15 +179,19 @@ struct Asset {
 	Asset* last_child;
 
 	union {
-		DS_BucketArrayIndex freelist_next;
 		Asset_StructType struct_type;
 		Asset_StructData struct_data;
 		Asset_Plugin plugin;
 		Asset_Package package;
 	};
 
+	// Edges of the dependency graph, see ht_dependencies.cpp. A handle appears at most once in each.
+	DS_DynArray(HT_Asset) dependencies; // assets that this asset refers to
+	DS_DynArray(HT_Asset) dependents;   // assets that refer to this asset
+
 	STR_View reload_assets_filesys_path; // temporary variable
 	bool reload_assets_pass2_needs_load; // temporary variable
+	bool collect_dependents_visited; // temporary variable
 
 	bool ui_state_is_open; // for the Assets panel
 };
@@ -231,14 +199,15 @@ struct Asset {
 struct AssetTree {
 	DS_Map(u64, Asset*) package_from_name; // key is the DS_MurmurHash64A(0) of the package name (excluding the $)
 
-	DS_BucketArray(Asset) assets;
-	DS_BucketArrayIndex first_free_asset;
+	DS_SlotMap(Asset) assets; // HT_Asset handles are DS_SlotHandles into this map
 
 	Asset* root;
 
 	// built-in types
 	Asset* plugin_options_struct_type;  // built-in custom struct type for PluginOptions
 	Asset* name_and_type_struct_type;   // built-in custom struct type for NameAndType
+
+	DS_DynArray(HT_Asset) struct_data_prefetch_queue; // struct data assets that may still need loading, see PrefetchStructData
 };
 
 // Pass STR_View into printf-style %.*s arguments
@@ -251,6 +220,8 @@ EXPORT Asset* GetAsset(AssetTree* tree, HT_Asset handle); // returns NULL if the
 
 EXPORT Asset* MakeNewAsset(AssetTree* tree, AssetKind kind);
 
+EXPORT void InitAssetTree(AssetTree* tree);
+
 EXPORT void InitStructDataAsset(AssetTree* tree, Asset* asset, Asset* struct_type);
 EXPORT void DeinitStructDataAssetIfInitialized(AssetTree* tree, Asset* asset);
 
@@ -310,11 +281,8 @@ EXPORT STR_View GetPackageName(Asset* package); // cleanup: remove this
 struct UI_Tab; // Placeholder for the user
 
 struct UI_Panel {
-	bool is_alive; // todo: cleanup
-	union {
-		UI_Panel* parent;
-		UI_Panel* freelist_next;
-	};
+	DS_SlotHandle handle;
+	UI_Panel* parent;
 	UI_Panel* end_child[2]; // 0 is first, 1 is last
 	UI_Panel* link[2];      // 0 is prev, 1 is next
 
@@ -330,8 +298,7 @@ struct UI_Panel {
 };
 
 struct UI_PanelTree {
-	DS_BucketArray(UI_Panel) panels;
-	UI_Panel* first_free_panel;
+	DS_SlotMap(UI_Panel) panels;
 	UI_Panel* root;
 	UI_Panel* active_panel; // NULL by default
 
@@ -358,6 +325,9 @@ EXPORT void FreeUIPanel(UI_PanelTree* tree, UI_Panel* panel);
 EXPORT HT_String UITextToString(UI_Text text);
 EXPORT UI_Text StringToUIText(HT_String string);
 
+// Text edit for an interned name. The name is re-interned whenever the text changes.
+EXPORT UI_ValTextState* UIAddValName(UI_Box* box, UI_Size w, UI_Size h, HT_Name* name);
+
 EXPORT void UIDropdownStateBeginFrame(UIDropdownState* s);
 
 EXPORT bool UIOrderedDropdownShouldClose(UIDropdownState* s, UI_Box* box);
@@ -411,14 +381,52 @@ struct ErrorList {
 	DS_DynArray(Error) errors;
 };
 
+// Plugin allocations are served from per-plugin size-class slabs. Each slab, and each allocation that is too large
+// for a slab, lives in its own block allocated directly from the OS. Blocks are aligned to PLUGIN_HEAP_BLOCK_SIZE,
+// so the block header of any allocation can be found by masking off the low bits of the pointer. There's no per-allocation header.
+// When a plugin is unloaded, all of its blocks are released at once.
+#define PLUGIN_HEAP_BLOCK_SIZE        DS_KIB(64)
+#define PLUGIN_HEAP_BLOCK_HEADER_SIZE 64
+#define PLUGIN_HEAP_SIZE_CLASS_COUNT  16
+#define PLUGIN_HEAP_SIZE_CLASS_LARGE  0xFFFFFFFF
+
+struct PluginHeap;
+
+struct PluginHeapBlock {
+	PluginHeap* heap;
+	PluginHeapBlock* prev;
+	PluginHeapBlock* next;
+	u32 size_class; // PLUGIN_HEAP_SIZE_CLASS_LARGE if this block holds a single large allocation
+	u32 bump_count; // number of slots handed out from this slab so far, not counting the slots reused from the freelist
+	size_t large_size;
+};
+
+// Live counters of a plugin's memory use, shown in the Memory tab (see ht_memory.cpp).
+// Heap sizes are counted in whole slots, so they include the size class rounding.
+struct PluginMemoryStats {
+	u64 bytes_in_use;
+	u64 bytes_in_use_peak;
+	u64 bytes_reserved; // total size of the blocks requested from the OS
+	u64 allocation_count;
+	u64 allocation_count_peak;
+	u64 total_allocations;
+	u64 temp_bytes_this_frame;
+	u64 temp_bytes_last_frame;
+	u64 temp_bytes_peak; // largest amount of temp memory used by the plugin in a single frame
+};
+
+struct PluginHeap {
+	PluginMemoryStats stats;
+	PluginHeapBlock* first_block; // list of all slabs and large allocations
+	PluginHeapBlock* current_slab[PLUGIN_HEAP_SIZE_CLASS_COUNT];
+	void* first_free[PLUGIN_HEAP_SIZE_CLASS_COUNT]; // freed slots of each size class. The first 8 bytes of a free slot point to the next one.
+};
+
 struct PluginInstance {
 	HT_PluginInstance handle;
 	Asset* plugin_asset; // NULL if unloaded
 
-	union {
-		DS_BucketArrayIndex freelist_next;
-		OS_DLL* dll_handle;
-	};
+	OS_DLL* dll_handle;
 
 	void (*UpdatePlugin)(HT_API* HT);
 	void (*LoadPlugin)(HT_API* HT);
@@ -428,14 +436,19 @@ struct PluginInstance {
 	void (*HT_D3D11_Render)(HT_API* ht);
 #endif
 
-	DS_DynArray(PluginAllocationHeader*) allocations;
+	PluginHeap heap;
+
+	// The files that this version of the plugin was compiled from, i.e. its source files and every header they include,
+	// as reported by the compiler. Checked by CheckPluginIncludes. Allocated from `includes_arena`.
+	DS_Arena includes_arena;
+	DS_DynArray(PluginIncludeStamp) includes;
 };
 
 // TODO: special tab data for per-tab data like which asset an asset viewer is looking at
 struct UI_Tab {
-	STR_View name; // empty string means free slot
+	DS_SlotHandle handle;
+	STR_View name;
 	HT_Asset owner_plugin;
-	UI_Tab* freelist_next;
 };
 
 struct PerFrameState {
@@ -455,6 +468,8 @@ struct PerFrameState {
 	DS_DynArray(HT_CustomTabUpdate) queued_custom_tab_updates;
 };
 
+struct PluginCompileJob; // ht_plugin_compiler.cpp
+
 struct EditorState {
 	HT_API* api;
 
@@ -469,8 +484,7 @@ struct EditorState {
 
 	STR_View project_directory;
 
-	DS_BucketArray(PluginInstance) plugin_instances;
-	DS_BucketArrayIndex first_free_plugin_instance;
+	DS_SlotMap(PluginInstance) plugin_instances; // HT_PluginInstance handles are DS_SlotHandles into this map
 
 	Log log;
 
@@ -485,14 +499,15 @@ struct EditorState {
 
 	UIDropdownState dropdown_state;
 
-	DS_BucketArray(UI_Tab) tab_classes;
-	UI_Tab* first_free_tab_class;
+	DS_SlotMap(UI_Tab) tab_classes;
 	
 	UI_Tab* properties_tab_class;
 	UI_Tab* assets_tab_class;
 	UI_Tab* asset_viewer_tab_class;
 	UI_Tab* log_tab_class;
 	UI_Tab* errors_tab_class;
+	UI_Tab* memory_tab_class;
+	UI_Tab* profiler_tab_class;
 	
 	UI_PanelTree panel_tree;
 
@@ -516,12 +531,34 @@ struct EditorState {
 
 	RenderState* render_state;
 
+	// -- background plugin compilation (HT_DYNAMIC) --
+	
+	PluginCompileJob* plugin_compile_job; // NULL if the compiler isn't running
+	DS_DynArray(HT_Asset) plugins_compiling;  // the plugins requested in plugin_compile_job, in the order to start them
+	DS_DynArray(HT_Asset) plugins_to_compile; // requested while plugin_compile_job was running
+	u32 include_check_instance; // dense index into plugin_instances where CheckPluginIncludes continues
+	int include_check_index;    // index into the includes of that instance
+	
+	// ------------------
+
 	PerFrameState frame; // cleared at the beginning of a frame
 };
 
+// With HT_DYNAMIC, the plugins are compiled in the background first and started by UpdatePluginCompilation once they're done.
+// Running a plugin that is already running recompiles it, and the new version replaces the old one when the compile succeeds.
 EXPORT void RunPlugin(EditorState* s, Asset* plugin);
+EXPORT void RunPlugins(EditorState* s, DS_ArrayView<Asset*> plugins);
 EXPORT void UnloadPlugin(EditorState* s, Asset* plugin);
 
+// Called at the beginning of a frame, before any plugins are updated. Takes the errors from the running plugin compile, swaps
+// in the plugins once it's finished and starts compiling any plugins that were requested meanwhile.
+EXPORT void UpdatePluginCompilation(EditorState* s);
+
+// Stats the includes of the running plugins for up to `budget_seconds`, continuing where the previous call left off, and
+// recompiles the plugins whose includes have been modified since they were compiled (HT_DYNAMIC).
+EXPORT void CheckPluginIncludes(EditorState* s, double budget_seconds);
+EXPORT bool IsPluginCompiling(EditorState* s, Asset* plugin);
+
 EXPORT UI_Tab* CreateTabClass(EditorState* s, STR_View name);
 EXPORT void DestroyTabClass(EditorState* s, UI_Tab* tab);
 
@@ -535,6 +572,10 @@ EXPORT void UpdateAndDrawErrorsTab(EditorState* s, UI_Key key, UI_Rect area);
 
 EXPORT void InitAPI(EditorState* s);
 
+// Calls HT_UpdatePlugin of every running plugin, in the order of the asset tree, except that a plugin waits for the plugins in
+// its `update_after` option. Plugins with `update_on_worker_thread` are updated on the worker pool, in parallel with each other
+// and with the plugins that update on the main thread. Such a plugin may only call the memory, multithreading and GetPluginData
+// functions of the API during its update.
 EXPORT void UpdatePlugins(EditorState* s);
 
 #ifdef HT_EDITOR_DX12
@@ -551,8 +592,72 @@ EXPORT PluginInstance* GetPluginInstance(EditorState* s, HT_PluginInstance handl
 
 EXPORT void RemoveErrorsByAsset(ErrorList* error_list, HT_Asset asset);
 
+// -- ht_md_reader.cpp ------------------------------------------------
+
+enum MDTokenKind {
+	MDTokenKind_EOF,
+	MDTokenKind_Identifier,
+	MDTokenKind_Numeric,
+	MDTokenKind_String, // `token` is the contents without the quotes
+	MDTokenKind_Tag,    // `token` is the name without the @
+	MDTokenKind_Symbol, // a single character. Separators (, and ;) are skipped like whitespace
+};
+
+// Reads the tokens of a Metadesk file one at a time. The token string is only valid until the next call to MDReaderNext.
+// The window buffer is kept when a reader is reopened, so one reader can be used for many files.
+struct MDReader {
+	FILE* file;
+	STR_View file_path;
+	char* buffer;
+	size_t buffer_capacity;
+	size_t pos, end; // unread bytes in the window
+	bool file_ended;
+	int line;
+	u64 bytes_read; // total over all files opened with this reader
+
+	MDTokenKind token_kind;
+	STR_View token;
+	int token_line;
+};
+
+// Returns false if the file couldn't be opened. On success, the first token is already read.
+EXPORT bool MDReaderOpen(MDReader* r, STR_View file_path);
+EXPORT void MDReaderClose(MDReader* r);
+EXPORT void MDReaderDeinit(MDReader* r);
+
+EXPORT void MDReaderNext(MDReader* r);
+EXPORT bool MDReaderIsSymbol(MDReader* r, char symbol);
+EXPORT void MDReaderSkipSymbol(MDReader* r, char symbol); // gives a user error if the current token isn't `symbol`
+
+// Gives a user error at the line of the current token
+EXPORT void MDReaderError(MDReader* r, const char* fmt, ...);
+
 // -- ht_serialize.cpp ------------------------------------------------
 
+// Statistics of the latest ReloadPackages call, shown in the memory tab
+struct AssetLoadStats {
+	int files_count;
+	int files_unchanged; // files with a new modtime, but the same content hash, that weren't parsed again
+	u64 bytes_read;
+	u64 parser_memory; // size of the reader window, which is all the memory needed for parsing on top of the loaded data
+	double seconds;
+	int struct_data_deferred; // struct data files of which only the type was read. Their data is loaded on first use.
+	int assets_from_snapshot; // assets restored from the project snapshot by LoadPackages, see ht_snapshot.cpp
+};
+
+EXPORT AssetLoadStats GetLastAssetLoadStats();
+
+// Returns the data of a struct data asset, parsing it from the file first if it hasn't been loaded yet
+EXPORT void* GetStructData(AssetTree* tree, Asset* asset);
+
+// Loads queued struct data assets until `budget_seconds` have passed, so that they're ready before anything asks for them
+EXPORT void PrefetchStructData(AssetTree* tree, double budget_seconds);
+
+// Loads every struct data asset that hasn't been loaded yet. Asset references are stored as paths, which are only resolved
+// when the data is parsed, so this must be called before an asset is renamed or deleted. Otherwise the unloaded data would
+// keep the old path, both in memory and in the file that SaveAsset leaves untouched.
+EXPORT void LoadAllStructData(AssetTree* tree);
+
 // Returns an empty string if `asset` is null
 EXPORT STR_View AssetGetTextPath(DS_Arena* arena, Asset* current_package, Asset* asset);
 
@@ -566,15 +671,44 @@ EXPORT STR_View GetAssetFileExtension(Asset* asset);
 
 EXPORT void SavePackageToDisk(AssetTree* tree, Asset* package);
 
+// Returns true if saving `asset` wouldn't change its file, i.e. nothing has been edited since it was loaded or saved.
+// `b` is a scratch builder.
+EXPORT bool AssetMatchesFile(AssetTree* tree, Asset* package, Asset* asset, STR_Builder* b);
+
 EXPORT void RegenerateTypeTable(EditorState* s);
 
-EXPORT void LoadProject(AssetTree* tree, STR_View project_directory);
+// With `use_snapshot`, the assets are restored from the project snapshot where possible instead of being parsed.
+// LoadProjectIncludingEditorLayout always uses it.
+EXPORT void LoadProject(AssetTree* tree, STR_View project_directory, bool use_snapshot);
 EXPORT void LoadProjectIncludingEditorLayout(EditorState* s, STR_View project_directory);
 EXPORT void ReloadPackages(AssetTree* tree, DS_ArrayView<Asset*> packages, bool force_reload);
 
 // Gives a user error if a package doesn't exist at the specified path.
 // The path string is however expected to not include backslashes.
-EXPORT void LoadPackages(AssetTree* tree, DS_ArrayView<STR_View> paths);
+// If `snapshot_path` is not empty, the packages start from the snapshot there if it's valid for them.
+EXPORT void LoadPackages(AssetTree* tree, DS_ArrayView<STR_View> paths, STR_View snapshot_path);
+
+// -- ht_snapshot.cpp -------------------------------------------------
+
+// Writes a snapshot of all packages, to make loading them faster next time. Assets with unsaved changes aren't included.
+EXPORT bool SaveAssetTreeSnapshot(AssetTree* tree, STR_View file_path);
+
+// Restores the assets of freshly made, empty `packages` from a snapshot, which must have been saved with the same packages.
+// Nothing is restored if the snapshot is missing or invalid, or if any struct type file has changed since.
+// The restored assets still need a ReloadPackages call to pick up files that changed. Returns the number of restored assets.
+EXPORT int LoadAssetTreeSnapshot(AssetTree* tree, DS_ArrayView<Asset*> packages, STR_View file_path);
+
+// -- ht_dependencies.cpp --------------------------------------------
+
+// Recomputes the assets that `asset` refers to from its current contents, and updates the graph if they changed.
+EXPORT void UpdateAssetDependencies(AssetTree* tree, Asset* asset);
+
+// Removes all edges to and from `asset`. Called when the asset is deleted.
+EXPORT void RemoveAssetDependencies(AssetTree* tree, Asset* asset);
+
+// Pushes every asset that depends on any of `assets`, directly or indirectly, to `out_dependents`.
+// Each asset is pushed once, direct dependents first. `assets` themselves aren't included.
+EXPORT void CollectDependents(AssetTree* tree, DS_ArrayView<Asset*> assets, DS_DynArray(Asset*)* out_dependents);
 
 // -- ht_log.cpp ------------------------------------------------------
 
@@ -583,15 +717,118 @@ EXPORT void LogVArgs(Log* log, LogMessageKind kind, const char* fmt, va_list arg
 
 EXPORT void UpdateAndDrawLogTab(EditorState* s, UI_Key key, UI_Rect area);
 
+// -- ht_memory.cpp ---------------------------------------------------
+
+// Moves the per-frame temp memory counters of each plugin instance to the previous frame. Called at the start of UpdatePlugins.
+EXPORT void PluginMemoryStatsBeginFrame(EditorState* s);
+
+// Writes the memory stats of all plugin instances into a CSV file.
+EXPORT bool DumpMemoryReport(EditorState* s, STR_View file_path);
+
+EXPORT void UpdateAndDrawMemoryTab(EditorState* s, UI_Key key, UI_Rect area);
+
+// -- ht_profiler.cpp -------------------------------------------------
+
+// Allocates a zone buffer for each thread of the worker pool, so it's called after InitWorkerPool.
+EXPORT void InitProfiler();
+EXPORT void DeinitProfiler();
+
+// Opens a zone on the calling thread and returns its depth for ProfilerEndZone. The zone's time is attributed to `plugin`,
+// or to the plugin of the enclosing zone if `plugin` is empty. `label` is copied, truncated to 48 bytes.
+// Calls from threads outside the worker pool are ignored.
+EXPORT int ProfilerBeginZone(HT_Name plugin, STR_View label);
+
+// Ends `zone` along with any zones that were left open inside it. If `zone` is negative, the innermost zone is ended.
+EXPORT void ProfilerEndZone(int zone);
+
+// Moves the zones recorded during the previous frame into the frame history. Called at the start of each frame.
+EXPORT void ProfilerBeginFrame();
+
+EXPORT void UpdateAndDrawProfilerTab(EditorState* s, UI_Key key, UI_Rect area);
+
+// -- ht_names.cpp ----------------------------------------------------
+
+EXPORT void InitNameTable();
+EXPORT HT_Name InternName(STR_View string);
+EXPORT bool FindName(STR_View string, HT_Name* out_name); // returns false if `string` hasn't been interned
+
+// Looks up the folded ID of `string` without interning it. Returns false if no name matches `string` case-insensitively.
+EXPORT bool FindNameCaseInsensitive(STR_View string, HT_NameID* out_folded_id);
+
+EXPORT size_t GetNameTableMemoryUsage(int* out_names_count);
+
+// -- ht_jobs.cpp -----------------------------------------------------
+
+// Starts a worker thread for each logical processor except the one running the main thread.
+EXPORT void InitWorkerPool();
+
+// Runs the jobs that are still queued, then stops the workers.
+EXPORT void DeinitWorkerPool();
+
+// See the multithreading section in HT_API
+EXPORT int GetWorkerCount();
+EXPORT int GetWorkerIndex(); // -1 on threads that are not in the pool. The main thread is worker 0.
+EXPORT void ParallelFor(int count, int batch_size, HT_ParallelForProc proc, void* user_data);
+EXPORT void ParallelReduce(int count, int batch_size, HT_ParallelReduceProc proc, HT_ReduceCombineProc combine, void* user_data, void* result, size_t result_size);
+EXPORT void ItemGroupParallelFor(HT_ItemGroup* group, HT_ItemGroupParallelForProc proc, void* user_data);
+EXPORT void SubmitJob(HT_JobProc proc, void* user_data, HT_JobCounter* counter);
+EXPORT void SubmitJobs(HT_JobProc proc, void** user_datas, int count, HT_JobCounter* counter);
+EXPORT void WaitForCounter(HT_JobCounter* counter);
+
+// Like ParallelFor, but the calling thread runs `caller_proc(user_data)` while the workers start on the batches, and then
+// joins them. Waiting inside caller_proc may run the batches on the calling thread. For work that has to stay on the calling thread, but can overlap with the parallel work.
+EXPORT void ParallelForAlongside(int count, int batch_size, HT_ParallelForProc proc, void* user_data, void (*caller_proc)(void* user_data));
+
+// TEMP on the main thread, and the worker's own temporary arena on worker threads. The worker arenas are reset by
+// ResetWorkerTempArenas, which the main thread calls at the start of each frame along with resetting TEMP. A thread outside
+// the pool gets an arena of its own, which it resets when it first asks for it in a new frame.
+EXPORT DS_Arena* GetWorkerTempArena();
+EXPORT void ResetWorkerTempArenas();
+
 // -- ht_plugin_compiler.cpp ------------------------------------------
 
 // Assumes current working directory to be the project directory
 EXPORT void GeneratePremakeAndVSProjects(AssetTree* asset_tree, STR_View project_directory);
 
-EXPORT void RegeneratePluginHeader(AssetTree* tree, Asset* plugin);
+// Writes <plugin>.inc.ht into the plugin's package. The header defines only the struct types that the plugin's code, or the
+// package files it includes, mention by name. The file is left untouched if its contents wouldn't change, in which case this returns false.
+EXPORT bool RegeneratePluginHeader(AssetTree* tree, Asset* plugin);
+
+// Absolute path of the .dll / .so that CompilePlugin outputs
+EXPORT STR_View GetPluginBinaryPath(DS_Arena* arena, Asset* plugin);
+
+struct PluginCompileStats {
+	int cache_hits;   // translation units whose object file was reused from the object cache
+	int cache_misses; // translation units that were compiled
+};
+
+struct CompiledPlugin {
+	HT_Asset plugin;
+	DS_ArrayView<PluginIncludeStamp> includes; // allocated with the allocator of the output array
+};
+
+// Compiles the plugin into a dynamic library with MSVC on Windows and GCC/Clang elsewhere. Build errors are added to the error list.
+// `out_stats` may be NULL.
+EXPORT bool CompilePlugin(AssetTree* tree, Asset* plugin, ErrorList* error_list, PluginCompileStats* out_stats);
+
+// Compiles the translation units of all plugins in parallel and links each plugin when its objects are done. Plugins that are
+// linker inputs of the given plugins are compiled too, and linked before them. Successfully compiled plugins are added to
+// `out_compiled_or_null`. Returns true if every plugin compiled.
+EXPORT bool CompilePlugins(AssetTree* tree, DS_ArrayView<Asset*> plugins, ErrorList* error_list, PluginCompileStats* out_stats,
+	DS_DynArray(Asset*)* out_compiled_or_null);
+
+// CompilePlugins on a background thread. The build is set up from the asset tree when the job is started, and after that
+// the job doesn't touch the tree, so the editor and the running plugins can keep going while the compiler runs.
+// Errors in setting up the build are added to `error_list` right away.
+EXPORT PluginCompileJob* StartPluginCompileJob(AssetTree* tree, DS_ArrayView<Asset*> plugins, ErrorList* error_list);
+
+// Moves the compile errors produced so far into `error_list`. Returns true once the compiler is done.
+EXPORT bool PollPluginCompileJob(PluginCompileJob* job, ErrorList* error_list);
+
+// Waits for the compiler to finish and frees the job. Successfully compiled plugins are added to `out_compiled_or_null`,
+// along with the files that the compiler read for them. `out_stats` may be NULL.
+EXPORT void FinishPluginCompileJob(PluginCompileJob* job, ErrorList* error_list, PluginCompileStats* out_stats, DS_DynArray(CompiledPlugin)* out_compiled_or_null);
 
 #ifdef HT_DYNAMIC
 EXPORT void ForceVisualStudioToClosePDBFileHandle(STR_View pdb_filepath);
-
-EXPORT bool RecompilePlugin(EditorState* s, Asset* plugin);
 #endif
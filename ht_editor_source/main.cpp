@@ -19,6 +19,8 @@ EXPORT DS_Allocator* HEAP;
 EXPORT DS_Info* DS;
 EXPORT uint64_t CPU_FREQUENCY;
 EXPORT STR_View CURRENT_WORKING_DIRECTORY;
+EXPORT u64 HEAP_ALLOCATIONS_THIS_FRAME;
+EXPORT u64 HEAP_ALLOCATIONS_LAST_FRAME;
 
 extern "C" {
 	EXPORT UI_State UI_STATE;
@@ -38,48 +40,6 @@ static STR_View QueryTabName(UI_PanelTree* tree, UI_Tab* tab) {
 	return tab->name;
 }
 
-static void InitAssetTree(AssetTree* tree) {
-	DS_BkArrInit(&tree->assets, HEAP, 32);
-	tree->root = MakeNewAsset(tree, AssetKind_Root);
-	DS_MapInit(&tree->package_from_name, HEAP);
-
-	tree->name_and_type_struct_type = MakeNewAsset(tree, AssetKind_StructType);
-
-	StructMember name_member = {0};
-	StringInit(&name_member.name, "Name");
-	name_member.type.kind = HT_TypeKind_String;
-	DS_ArrPush(&tree->name_and_type_struct_type->struct_type.members, name_member);
-
-	StructMember type_member = {0};
-	StringInit(&type_member.name, "HT_Type");
-	type_member.type.kind = HT_TypeKind_Type;
-	DS_ArrPush(&tree->name_and_type_struct_type->struct_type.members, type_member);
-
-	ComputeStructLayout(tree, tree->name_and_type_struct_type);
-
-	tree->plugin_options_struct_type = MakeNewAsset(tree, AssetKind_StructType);
-
-	StructMember member_data = {0};
-	StringInit(&member_data.name, "data_asset");
-	member_data.type.kind = HT_TypeKind_AssetRef;
-	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_data);
-
-	StructMember member_source_files = {0};
-	StringInit(&member_source_files.name, "code_files");
-	member_source_files.type.kind = HT_TypeKind_Array;
-	member_source_files.type.subkind = HT_TypeKind_AssetRef;
-	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_source_files);
-
-	StructMember member_linker_inputs = {0};
-	StringInit(&member_linker_inputs.name, "linker_inputs");
-	member_linker_inputs.type.kind = HT_TypeKind_Array;
-	member_linker_inputs.type.subkind = HT_TypeKind_AssetRef;
-	DS_ArrPush(&tree->plugin_options_struct_type->struct_type.members, member_linker_inputs);
-
-
-	ComputeStructLayout(tree, tree->plugin_options_struct_type);
-}
-
 static void EditorInit(DS_Arena* persist, EditorState* s) {
 	InitAssetTree(&s->asset_tree);
 
@@ -110,6 +70,9 @@ static void EditorInit(DS_Arena* persist, EditorState* s) {
 
 	// -- Hatch stuff ---------------------------------------------------------------------------
 
+	InitWorkerPool();
+	InitProfiler();
+
 	{
 		DS_ArenaInit(&s->log.arena, 4096, HEAP);
 		DS_ArrInit(&s->log.messages, &s->log.arena);
@@ -124,12 +87,16 @@ static void EditorInit(DS_Arena* persist, EditorState* s) {
 	s->panel_tree.update_and_draw_tab = UpdateAndDrawTab;
 	s->panel_tree.user_data = s;
 	
-	DS_BkArrInit(&s->plugin_instances, HEAP, 32);
+	DS_SlotMapInit(&s->plugin_instances, HEAP, 32);
+	DS_ArrInit(&s->plugins_compiling, HEAP);
+	DS_ArrInit(&s->plugins_to_compile, HEAP);
 
-	DS_BkArrInit(&s->tab_classes, persist, 16);
+	DS_SlotMapInit(&s->tab_classes, persist, 16);
 	s->assets_tab_class = CreateTabClass(s, "Assets");
 	s->log_tab_class = CreateTabClass(s, "Log");
 	s->errors_tab_class = CreateTabClass(s, "Errors");
+	s->memory_tab_class = CreateTabClass(s, "Memory");
+	s->profiler_tab_class = CreateTabClass(s, "Profiler");
 	s->properties_tab_class = CreateTabClass(s, "Properties");
 	s->asset_viewer_tab_class = CreateTabClass(s, "Asset Viewer");
 
@@ -154,7 +121,9 @@ static void UpdateAndDraw(EditorState* s) {
 		s->pending_stop_simulation = false;
 		s->is_simulating = false;
 
-		DS_DynArray(Asset*) packages = {TEMP};
+		Asset* packages_buffer[16];
+		DS_DynArray(Asset*) packages;
+		DS_ArrInitBuffer(&packages, TEMP, packages_buffer);
 		for (Asset* asset = s->asset_tree.root->first_child; asset; asset = asset->next) {
 			if (asset->kind != AssetKind_Package) continue;
 			DS_ArrPush(&packages, asset);
@@ -173,6 +142,11 @@ static void UpdateAndDraw(EditorState* s) {
 	//if (UI_InputIsDown(UI_Input_Shift)) __debugbreak();
 
 	HotreloadPackages(&s->asset_tree);
+	PrefetchStructData(&s->asset_tree, STRUCT_DATA_PREFETCH_SECONDS_PER_FRAME);
+	CheckPluginIncludes(s, PLUGIN_INCLUDE_CHECK_SECONDS_PER_FRAME);
+
+	// Plugins that finished compiling in the background are swapped in here, between their updates
+	UpdatePluginCompilation(s);
 
 	// we want Update to be called on plugins before any custom tab updates - Update should be the first thing that can be called during a frame, there we can reset a temp allocator for example.
 	UpdatePlugins(s);
@@ -271,16 +245,22 @@ static void HT_OS_AddEvent(HT_OS_Events* s, const OS_Event* event) {
 	}
 }
 
+static void* CountingHeapAllocatorProc(DS_AllocatorBase* allocator, void* ptr, size_t old_size, size_t size, size_t align) {
+	if (size != 0) HEAP_ALLOCATIONS_THIS_FRAME++;
+	return DS_HeapAllocatorProc(allocator, ptr, old_size, size, align);
+}
+
 int main(int argc, char** argv) {
 	DS_Arena temp_arena = {0};
 	DS_Info ds = { &temp_arena };
-	DS_AllocatorBase heap = { &ds, DS_HeapAllocatorProc };
+	DS_AllocatorBase heap = { &ds, CountingHeapAllocatorProc };
 	DS_ArenaInit(&temp_arena, 4096, (DS_Allocator*)&heap);
 	
 	DS = &ds;
 	HEAP = (DS_Allocator*)&heap;
 	TEMP = &temp_arena;
 	CPU_FREQUENCY = OS_GetCPUFrequency();
+	InitNameTable();
 
 #ifdef HT_GEN
 	// The `hatch-gen` command regenerates the visual studio solution for the project in the
@@ -292,10 +272,10 @@ int main(int argc, char** argv) {
 
 	AssetTree tree = {};
 	InitAssetTree(&tree);
-	LoadProject(&tree, cwd);
+	LoadProject(&tree, cwd, false);
 
-	for (DS_BkArrEach(&tree.assets, asset_i)) {
-		Asset* asset = DS_BkArrGet(&tree.assets, asset_i);
+	for (DS_SlotMapEach(&tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&tree.assets, asset_i);
 		if (asset->kind == AssetKind_Plugin) {
 			RegeneratePluginHeader(&tree, asset);
 		}
@@ -322,7 +302,11 @@ int main(int argc, char** argv) {
 	LoadProjectIncludingEditorLayout(&editor_state, project_dir);
 
 	for (;;) {
+		ProfilerBeginFrame();
 		DS_ArenaReset(TEMP);
+		ResetWorkerTempArenas();
+		HEAP_ALLOCATIONS_LAST_FRAME = HEAP_ALLOCATIONS_THIS_FRAME;
+		HEAP_ALLOCATIONS_THIS_FRAME = 0;
 		UI_OS_ResetFrameInputs(&editor_state.window, &editor_state.ui_inputs);
 
 		OS_Event event;
@@ -342,6 +326,16 @@ int main(int argc, char** argv) {
 
 		UpdateAndDraw(&editor_state);
 	}
+
+	if (editor_state.plugin_compile_job) {
+		FinishPluginCompileJob(editor_state.plugin_compile_job, &editor_state.error_list, NULL, NULL);
+	}
+
+	// Lets the next launch skip parsing the assets that don't change in the meantime
+	SaveAssetTreeSnapshot(&editor_state.asset_tree, STR_Form(TEMP, "%v/%s", project_dir, PROJECT_SNAPSHOT_FILE));
+
+	DeinitProfiler();
+	DeinitWorkerPool();
 #endif
 
 	return 0;
@@ -0,0 +1,344 @@
+#ifdef HT_HEADLESS
+
+// The `hatch-headless` command runs the asset pipeline on a project without a window or a GPU, so that it can be used on
+// build and CI machines, including Linux. It loads the project and reloads every package. With --save it also saves every
+// package, regenerates the plugin headers, writes a project snapshot and loads the project from it. It then prints the
+// time taken by each phase and the peak memory usage as JSON.
+//
+// usage: hatch-headless <project directory> [--iterations N] [--save] [--compile-plugins] [--output FILE]
+//
+// Reload, save and regenerate are repeated N times and the fastest time of each is reported. Saving only writes files whose
+// contents change, so on a project that was saved by Hatch, any written file means that a load/save round trip isn't stable.
+// Without --save no project files are written, so the save, regenerate and snapshot phases are skipped.
+//
+// With --compile-plugins all plugins are also compiled in parallel into dynamic libraries and loaded, the same way as the editor does when
+// hot-reloading a plugin, to measure the reload latency. Build errors are printed to stderr. Like in the editor, compiling a
+// plugin regenerates its header and writes its binaries, even without --save. Object files are cached in the project
+// directory, so only the first iteration on a fresh project compiles every translation unit.
+
+#include "include/ht_common.h"
+
+#include <math.h> // for INFINITY
+#include <stdarg.h>
+
+// -- Globals -----------------------------
+
+EXPORT DS_Arena* TEMP;
+EXPORT DS_Allocator* HEAP;
+EXPORT DS_Info* DS;
+EXPORT uint64_t CPU_FREQUENCY;
+EXPORT STR_View CURRENT_WORKING_DIRECTORY;
+EXPORT u64 HEAP_ALLOCATIONS_THIS_FRAME;
+EXPORT u64 HEAP_ALLOCATIONS_LAST_FRAME;
+
+// ----------------------------------------
+
+enum Phase {
+	Phase_Load,            // LoadProject, which only reads the types of struct data assets
+	Phase_LoadStructData,  // parse the data of all struct data assets
+	Phase_Reload,          // forced ReloadPackages followed by parsing all struct data again
+	Phase_Save,            // SavePackageToDisk on every package
+	Phase_Regenerate,      // RegeneratePluginHeader on every plugin
+	Phase_SaveSnapshot,    // SaveAssetTreeSnapshot
+	Phase_LoadSnapshot,    // LoadProject into a new asset tree, starting from the snapshot
+	Phase_CompilePlugins,  // CompilePlugins on all plugins at once
+	Phase_LoadPlugins,     // load every compiled plugin binary and look up its exports
+	Phase_COUNT,
+};
+
+static const char* PHASE_NAMES[] = { "load", "load_struct_data", "reload", "save", "regenerate_headers", "save_snapshot", "load_snapshot", "compile_plugins", "load_plugins" };
+
+struct PhaseResult {
+	bool ran;
+	double seconds; // fastest iteration
+	double total_seconds;
+	u64 heap_allocations; // during the fastest iteration
+	AssetLoadStats load_stats; // for Phase_Load, Phase_Reload and Phase_LoadSnapshot
+};
+
+struct HeadlessState {
+	AssetTree tree;
+	PhaseResult phases[Phase_COUNT];
+	int packages_changed_by_save;
+	int headers_written; // by Phase_Regenerate, summed over all iterations
+	int plugins_compiled;
+	int plugins_failed;
+	PluginCompileStats compile_stats; // summed over all iterations
+};
+
+static void* CountingHeapAllocatorProc(DS_AllocatorBase* allocator, void* ptr, size_t old_size, size_t size, size_t align) {
+	if (size != 0) HEAP_ALLOCATIONS_THIS_FRAME++;
+	return DS_HeapAllocatorProc(allocator, ptr, old_size, size, align);
+}
+
+static u64 g_phase_start_tick;
+
+static void BeginPhase() {
+	HEAP_ALLOCATIONS_THIS_FRAME = 0;
+	g_phase_start_tick = OS_GetCPUTick();
+}
+
+static void EndPhase(HeadlessState* s, Phase phase) {
+	double seconds = OS_GetDuration(CPU_FREQUENCY, g_phase_start_tick, OS_GetCPUTick());
+
+	PhaseResult* result = &s->phases[phase];
+	if (!result->ran || seconds < result->seconds) {
+		result->seconds = seconds;
+		result->heap_allocations = HEAP_ALLOCATIONS_THIS_FRAME;
+		if (phase == Phase_Load || phase == Phase_Reload || phase == Phase_LoadSnapshot) result->load_stats = GetLastAssetLoadStats();
+	}
+	result->total_seconds += seconds;
+	result->ran = true;
+}
+
+static void GetPackages(AssetTree* tree, DS_DynArray(Asset*)* out_packages) {
+	for (Asset* asset = tree->root->first_child; asset; asset = asset->next) {
+		if (asset->kind == AssetKind_Package) DS_ArrPush(out_packages, asset);
+	}
+}
+
+static void PrintResults(HeadlessState* s, FILE* f, STR_View project_directory, int iterations) {
+	int assets_count[AssetKind_StructData + 1] = {};
+	int dependency_edges_count = 0;
+	for (DS_SlotMapEach(&s->tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&s->tree.assets, asset_i);
+		assets_count[asset->kind]++;
+		dependency_edges_count += asset->dependencies.count;
+	}
+
+	fprintf(f, "{\n");
+	fprintf(f, "\t\"project\": \"%.*s\",\n", StrArg(project_directory));
+	fprintf(f, "\t\"iterations\": %d,\n", iterations);
+	fprintf(f, "\t\"assets\": {\"packages\": %d, \"folders\": %d, \"files\": %d, \"plugins\": %d, \"struct_types\": %d, \"struct_data\": %d},\n",
+		assets_count[AssetKind_Package], assets_count[AssetKind_Folder], assets_count[AssetKind_File],
+		assets_count[AssetKind_Plugin], assets_count[AssetKind_StructType], assets_count[AssetKind_StructData]);
+	fprintf(f, "\t\"dependency_edges\": %d,\n", dependency_edges_count);
+
+	fprintf(f, "\t\"phases\": [\n");
+	bool first = true;
+	for (int i = 0; i < Phase_COUNT; i++) {
+		PhaseResult* result = &s->phases[i];
+		if (!result->ran) continue;
+
+		if (!first) fprintf(f, ",\n");
+		first = false;
+
+		fprintf(f, "\t\t{\"name\": \"%s\", \"seconds\": %.6f, \"total_seconds\": %.6f, \"heap_allocations\": %llu",
+			PHASE_NAMES[i], result->seconds, result->total_seconds, (unsigned long long)result->heap_allocations);
+		if (i == Phase_Load || i == Phase_Reload || i == Phase_LoadSnapshot) {
+			AssetLoadStats* stats = &result->load_stats;
+			fprintf(f, ", \"files_parsed\": %d, \"files_unchanged\": %d, \"struct_data_deferred\": %d, \"assets_from_snapshot\": %d, \"bytes_read\": %llu",
+				stats->files_count, stats->files_unchanged, stats->struct_data_deferred, stats->assets_from_snapshot, (unsigned long long)stats->bytes_read);
+		}
+		if (i == Phase_Save) {
+			fprintf(f, ", \"packages_changed\": %d", s->packages_changed_by_save);
+		}
+		if (i == Phase_Regenerate) {
+			fprintf(f, ", \"headers_written\": %d", s->headers_written);
+		}
+		if (i == Phase_CompilePlugins) {
+			fprintf(f, ", \"plugins_compiled\": %d, \"plugins_failed\": %d, \"object_cache_hits\": %d, \"object_cache_misses\": %d",
+				s->plugins_compiled, s->plugins_failed, s->compile_stats.cache_hits, s->compile_stats.cache_misses);
+		}
+		fprintf(f, "}");
+	}
+	fprintf(f, "\n\t],\n");
+
+	fprintf(f, "\t\"peak_memory_bytes\": %llu\n", (unsigned long long)OS_GetPeakMemoryUsage());
+	fprintf(f, "}\n");
+}
+
+// Plugins import these from the executable
+HT_IMPORT void HT_LogInfo(const char* fmt, ...) {
+	va_list args; va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+HT_IMPORT void HT_LogWarning(const char* fmt, ...) {
+	va_list args; va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+HT_IMPORT void HT_LogError(const char* fmt, ...) {
+	va_list args; va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	fprintf(stderr, "\n");
+	va_end(args);
+}
+
+static void CompileAndLoadPlugins(HeadlessState* s, bool count_results) {
+	DS_DynArray(Asset*) compiled = {TEMP};
+	ErrorList error_list = {};
+	DS_ArrInit(&error_list.errors, TEMP);
+
+	DS_DynArray(Asset*) plugins = {TEMP};
+	for (DS_SlotMapEach(&s->tree.assets, asset_i)) {
+		Asset* asset = DS_SlotMapAt(&s->tree.assets, asset_i);
+		if (asset->kind == AssetKind_Plugin) DS_ArrPush(&plugins, asset);
+	}
+
+	BeginPhase();
+	PluginCompileStats stats;
+	CompilePlugins(&s->tree, plugins, &error_list, &stats, &compiled);
+	s->compile_stats.cache_hits += stats.cache_hits;
+	s->compile_stats.cache_misses += stats.cache_misses;
+	if (count_results) {
+		s->plugins_compiled += compiled.count;
+		s->plugins_failed += plugins.count - compiled.count;
+	}
+	EndPhase(s, Phase_CompilePlugins);
+
+	for (int i = 0; i < error_list.errors.count; i++) {
+		fprintf(stderr, "%.*s\n", StrArg(error_list.errors[i].string));
+	}
+
+	BeginPhase();
+	for (int i = 0; i < compiled.count; i++) {
+		STR_View dll_path = GetPluginBinaryPath(TEMP, compiled[i]);
+		OS_DLL* dll = OS_LoadDLL(DS, dll_path);
+		bool ok = dll != NULL && OS_GetProcAddress(dll, "HT_LoadPlugin") && OS_GetProcAddress(dll, "HT_UnloadPlugin") &&
+			OS_GetProcAddress(dll, "HT_UpdatePlugin");
+		EXPECT_OR_USER_ERROR(ok, "ERROR: failed to load plugin '%.*s'\n", StrArg(dll_path));
+		OS_UnloadDLL(dll);
+	}
+	EndPhase(s, Phase_LoadPlugins);
+}
+
+int main(int argc, char** argv) {
+	DS_Arena temp_arena = {0};
+	DS_Info ds = { &temp_arena };
+	DS_AllocatorBase heap = { &ds, CountingHeapAllocatorProc };
+	DS_ArenaInit(&temp_arena, 4096, (DS_Allocator*)&heap);
+
+	DS = &ds;
+	HEAP = (DS_Allocator*)&heap;
+	TEMP = &temp_arena;
+	CPU_FREQUENCY = OS_GetCPUFrequency();
+	InitNameTable();
+
+	const char* project_arg = NULL;
+	const char* output_path = NULL;
+	int iterations = 1;
+	bool save = false;
+	bool compile_plugins = false;
+	for (int i = 1; i < argc; i++) {
+		STR_View arg = STR_ToV(argv[i]);
+		if (STR_Match(arg, "--iterations") && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		}
+		else if (STR_Match(arg, "--output") && i + 1 < argc) {
+			output_path = argv[++i];
+		}
+		else if (STR_Match(arg, "--save")) {
+			save = true;
+		}
+		else if (STR_Match(arg, "--compile-plugins")) {
+			compile_plugins = true;
+		}
+		else if (project_arg == NULL) {
+			project_arg = argv[i];
+		}
+		else {
+			project_arg = NULL;
+			break;
+		}
+	}
+
+	if (project_arg == NULL || iterations < 1) {
+		printf("usage: hatch-headless <project directory> [--iterations N] [--save] [--compile-plugins] [--output FILE]\n");
+		return 1;
+	}
+
+	STR_View project_directory;
+	bool ok = OS_PathToAbsolute(TEMP, STR_ToV(project_arg), &project_directory);
+	EXPECT_OR_USER_ERROR(ok, "ERROR: project directory not found: '%s'\n", project_arg);
+	project_directory = STR_Clone(HEAP, project_directory); // LoadProject keeps it as CURRENT_WORKING_DIRECTORY
+
+	// Open the output file before LoadProject changes the working directory
+	FILE* output = stdout;
+	if (output_path) {
+		output = fopen(output_path, "wb");
+		EXPECT_OR_USER_ERROR(output != NULL, "ERROR: failed to open '%s' for writing\n", output_path);
+	}
+
+	HeadlessState* s = (HeadlessState*)DS_MemAlloc(HEAP, sizeof(HeadlessState));
+	memset(s, 0, sizeof(*s));
+
+	BeginPhase();
+	InitAssetTree(&s->tree);
+	LoadProject(&s->tree, project_directory, false);
+	EndPhase(s, Phase_Load);
+
+	BeginPhase();
+	PrefetchStructData(&s->tree, INFINITY);
+	EndPhase(s, Phase_LoadStructData);
+
+	for (int iteration = 0; iteration < iterations; iteration++) {
+		DS_ArenaReset(TEMP);
+
+		DS_DynArray(Asset*) packages = {TEMP};
+		GetPackages(&s->tree, &packages);
+
+		BeginPhase();
+		ReloadPackages(&s->tree, packages, true);
+		PrefetchStructData(&s->tree, INFINITY);
+		EndPhase(s, Phase_Reload);
+
+		if (save) {
+			BeginPhase();
+			for (int i = 0; i < packages.count; i++) {
+				Asset* package = packages[i];
+				package->package.dir_watch_will_have_hatch_written_changes = false;
+				SavePackageToDisk(&s->tree, package);
+				if (package->package.dir_watch_will_have_hatch_written_changes) s->packages_changed_by_save++;
+			}
+			EndPhase(s, Phase_Save);
+
+			BeginPhase();
+			for (DS_SlotMapEach(&s->tree.assets, asset_i)) {
+				Asset* asset = DS_SlotMapAt(&s->tree.assets, asset_i);
+				if (asset->kind == AssetKind_Plugin && RegeneratePluginHeader(&s->tree, asset)) s->headers_written++;
+			}
+			EndPhase(s, Phase_Regenerate);
+		}
+	}
+
+	if (save) {
+		STR_View snapshot_path = STR_Form(HEAP, "%v/%s", project_directory, PROJECT_SNAPSHOT_FILE);
+		for (int iteration = 0; iteration < iterations; iteration++) {
+			DS_ArenaReset(TEMP);
+
+			BeginPhase();
+			bool ok = SaveAssetTreeSnapshot(&s->tree, snapshot_path);
+			EndPhase(s, Phase_SaveSnapshot);
+			EXPECT_OR_USER_ERROR(ok, "ERROR: failed to write '%.*s'\n", StrArg(snapshot_path));
+
+			// Each load needs an empty tree
+			AssetTree* snapshot_tree = (AssetTree*)DS_MemAlloc(HEAP, sizeof(AssetTree));
+			memset(snapshot_tree, 0, sizeof(*snapshot_tree));
+
+			BeginPhase();
+			InitAssetTree(snapshot_tree);
+			LoadProject(snapshot_tree, project_directory, true);
+			EndPhase(s, Phase_LoadSnapshot);
+		}
+	}
+
+	if (compile_plugins) {
+		for (int iteration = 0; iteration < iterations; iteration++) {
+			DS_ArenaReset(TEMP);
+			CompileAndLoadPlugins(s, iteration == 0);
+		}
+	}
+
+	PrintResults(s, output, project_directory, iterations);
+	if (output != stdout) fclose(output);
+
+	return 0;
+}
+
+#endif // HT_HEADLESS
@@ -0,0 +1,30 @@
+// POSIX version of os_directory_watch.h. Changes are not detected yet, so packages are never hotreloaded;
+// the headless build loads each project once and doesn't need it.
+#ifndef _WIN32
+
+#define DS_NO_MALLOC
+#include <ht_utils/fire/fire_ds.h>
+#include <ht_utils/fire/fire_string.h>
+
+#include "os_misc.h"
+#include "os_directory_watch.h"
+
+#include <dirent.h>
+
+OS_API bool OS_InitDirectoryWatch(DS_Info* ds, OS_DirectoryWatch* watch, STR_View directory) {
+	DS_Scope scope = DS_ScopePush(ds);
+	DIR* dir = opendir(STR_ToC(ds->temp_arena, directory));
+	if (dir) closedir(dir);
+	DS_ScopePop(scope);
+
+	watch->handle = NULL;
+	return dir != NULL;
+}
+
+OS_API void OS_DeinitDirectoryWatch(OS_DirectoryWatch* watch) {}
+
+OS_API bool OS_DirectoryWatchHasChanges(OS_DirectoryWatch* watch) {
+	return false;
+}
+
+#endif // _WIN32
@@ -5,6 +5,7 @@
 #include "os_misc.h"
 
 #include <shobjidl_core.h> // required for OS_FolderPicker
+#include <psapi.h> // required for OS_GetPeakMemoryUsage
 
 #include <stdio.h> // for fopen
 
@@ -35,7 +36,8 @@ OS_API bool OS_WriteEntireFile(DS_Info* ds, const char* file, STR_View data) {
 	FILE* f = NULL;
 	errno_t err = fopen_s(&f, file, "wb");
 	if (f) {
-		bool ok = fwrite(data.data, data.size, 1, f) == data.size;
+		bool ok = data.size == 0 || fwrite(data.data, data.size, 1, f) == 1;
+		fclose(f);
 		return ok;
 	}
 	return false;
@@ -82,6 +84,17 @@ OS_API bool OS_DeleteFile(DS_Info* ds, STR_View file_path) {
 	return ok;
 }
 
+OS_API bool OS_MoveFile(DS_Info* ds, STR_View from_path, STR_View to_path) {
+	DS_Scope scope = DS_ScopePush(ds);
+
+	wchar_t* from_wide = OS_UTF8ToWide(ds->temp_arena, from_path, 1);
+	wchar_t* to_wide = OS_UTF8ToWide(ds->temp_arena, to_path, 1);
+	bool ok = MoveFileExW(from_wide, to_wide, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+
+	DS_ScopePop(scope);
+	return ok;
+}
+
 OS_API bool OS_FileGetModtime(DS_Info* ds, STR_View file_path, uint64_t* out_modtime) {
 	DS_Scope scope = DS_ScopePush(ds);
 	wchar_t* file_path_wide = OS_UTF8ToWide(ds->temp_arena, file_path, 1);
@@ -97,6 +110,12 @@ OS_API bool OS_FileGetModtime(DS_Info* ds, STR_View file_path, uint64_t* out_mod
 	return h != INVALID_HANDLE_VALUE;
 }
 
+OS_API uint64_t OS_GetCurrentFileTime(void) {
+	uint64_t now;
+	GetSystemTimeAsFileTime((FILETIME*)&now);
+	return now;
+}
+
 // NOTE: CreateProcessW may write to the command_string in-place! CreateProcessW requires that.
 OS_API bool OS_RunProcess(DS_Info* ds, STR_View command_string, uint32_t* out_exit_code) {
 	DS_Scope scope = DS_ScopePush(ds);
@@ -334,6 +353,22 @@ OS_API bool OS_FilePicker(DS_Arena* arena, STR_View* out_path) {
 	return out_path->size > 0;
 }
 
+OS_API void* OS_VirtualAlloc(size_t size) {
+	return VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+OS_API void OS_VirtualFree(void* ptr) {
+	bool ok = VirtualFree(ptr, 0, MEM_RELEASE);
+	assert(ok);
+}
+
+OS_API uint64_t OS_GetPeakMemoryUsage(void) {
+	PROCESS_MEMORY_COUNTERS counters = {0};
+	counters.cb = sizeof(counters);
+	bool ok = GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return ok ? counters.PeakWorkingSetSize : 0;
+}
+
 OS_API void OS_GetThisExecutablePath(DS_Arena* arena, STR_View* out_path) {
 	wchar_t buf[MAX_PATH];
 	uint32_t n = GetModuleFileNameW(NULL, buf, MAX_PATH);
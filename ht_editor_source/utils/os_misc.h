@@ -20,8 +20,14 @@ OS_API void OS_WideToUTF8(DS_Arena* arena, const wchar_t* wstr, STR_View* out_st
 
 OS_API bool OS_DeleteFile(DS_Info* ds, STR_View file_path);
 
+// Replaces `to_path` if it exists
+OS_API bool OS_MoveFile(DS_Info* ds, STR_View from_path, STR_View to_path);
+
 OS_API bool OS_FileGetModtime(DS_Info* ds, STR_View file_path, uint64_t* out_modtime);
 
+// The current time, in the same units as OS_FileGetModtime
+OS_API uint64_t OS_GetCurrentFileTime(void);
+
 OS_API bool OS_RunProcess(DS_Info* ds, STR_View command_string, uint32_t* out_exit_code);
 
 OS_API void OS_DeleteDirectory(DS_Info* ds, STR_View directory_path);
@@ -39,6 +45,15 @@ OS_API bool OS_FilePicker(DS_Arena* arena, STR_View* out_path);
 
 OS_API bool OS_FolderPicker(DS_Arena* arena, STR_View* out_path);
 
+// Allocates committed, zero-initialized pages directly from the OS. The returned address is aligned to the
+// OS allocation granularity, which is 64 KiB on Windows. Returns NULL on failure.
+OS_API void* OS_VirtualAlloc(size_t size);
+
+OS_API void OS_VirtualFree(void* ptr);
+
+// Returns the largest amount of physical memory this process has used so far, in bytes
+OS_API uint64_t OS_GetPeakMemoryUsage(void);
+
 typedef struct OS_FileInfo {
 	bool is_directory;
 	STR_View name; // includes the file extension if there is one
@@ -0,0 +1,296 @@
+// POSIX versions of the functions in os_misc.h, for the headless build on Linux. See os_misc.c for the Windows versions.
+// Functions that need a desktop (file and folder pickers) always fail here.
+#ifndef _WIN32
+
+#define _GNU_SOURCE // for realpath, nftw
+
+#define DS_NO_MALLOC
+#include <ht_utils/fire/fire_ds.h>
+#include <ht_utils/fire/fire_string.h>
+
+#include "os_misc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+OS_API bool OS_IsDebuggerPresent() {
+	// A traced process has a nonzero TracerPid in its status
+	FILE* f = fopen("/proc/self/status", "rb");
+	if (f == NULL) return false;
+
+	bool result = false;
+	char line[256];
+	while (fgets(line, sizeof(line), f)) {
+		if (strncmp(line, "TracerPid:", 10) == 0) {
+			result = atoi(line + 10) != 0;
+			break;
+		}
+	}
+	fclose(f);
+	return result;
+}
+
+OS_API bool OS_ReadEntireFile(DS_Arena* arena, const char* file, STR_View* out_data) {
+	FILE* f = fopen(file, "rb");
+	if (f) {
+		fseek(f, 0, SEEK_END);
+		long fsize = ftell(f);
+		fseek(f, 0, SEEK_SET);
+
+		char* data = DS_ArenaPush(arena, fsize);
+		size_t read_size = fread(data, 1, fsize, f);
+
+		fclose(f);
+		STR_View result = {data, read_size};
+		*out_data = result;
+		return true;
+	}
+	return false;
+}
+
+OS_API bool OS_WriteEntireFile(DS_Info* ds, const char* file, STR_View data) {
+	FILE* f = fopen(file, "wb");
+	if (f) {
+		bool ok = data.size == 0 || fwrite(data.data, data.size, 1, f) == 1;
+		fclose(f);
+		return ok;
+	}
+	return false;
+}
+
+OS_API bool OS_PathIsAbsolute(STR_View path) {
+	return path.size > 0 && path.data[0] == '/';
+}
+
+OS_API bool OS_DeleteFile(DS_Info* ds, STR_View file_path) {
+	DS_Scope scope = DS_ScopePush(ds);
+	bool ok = unlink(STR_ToC(ds->temp_arena, file_path)) == 0;
+	DS_ScopePop(scope);
+	return ok;
+}
+
+OS_API bool OS_MoveFile(DS_Info* ds, STR_View from_path, STR_View to_path) {
+	DS_Scope scope = DS_ScopePush(ds);
+	bool ok = rename(STR_ToC(ds->temp_arena, from_path), STR_ToC(ds->temp_arena, to_path)) == 0; // replaces atomically
+	DS_ScopePop(scope);
+	return ok;
+}
+
+// Modtimes are in nanoseconds
+static uint64_t OS_StatModtime(const struct stat* st) {
+	return (uint64_t)st->st_mtim.tv_sec * 1000000000 + (uint64_t)st->st_mtim.tv_nsec;
+}
+
+OS_API bool OS_FileGetModtime(DS_Info* ds, STR_View file_path, uint64_t* out_modtime) {
+	DS_Scope scope = DS_ScopePush(ds);
+	struct stat st;
+	bool ok = stat(STR_ToC(ds->temp_arena, file_path), &st) == 0;
+	if (ok) *out_modtime = OS_StatModtime(&st);
+	DS_ScopePop(scope);
+	return ok;
+}
+
+OS_API uint64_t OS_GetCurrentFileTime(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+	return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+OS_API bool OS_FileLastModificationTime(DS_Info* ds, STR_View filepath, uint64_t* out_modtime) {
+	return OS_FileGetModtime(ds, filepath, out_modtime);
+}
+
+OS_API bool OS_RunProcess(DS_Info* ds, STR_View command_string, uint32_t* out_exit_code) {
+	DS_Scope scope = DS_ScopePush(ds);
+
+	// Like CreateProcessW, the child inherits the standard handles
+	pid_t pid = fork();
+	if (pid == 0) {
+		execl("/bin/sh", "sh", "-c", STR_ToC(ds->temp_arena, command_string), (char*)NULL);
+		_exit(127);
+	}
+
+	bool ok = pid > 0;
+	if (ok) {
+		int status;
+		ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status);
+		if (ok && out_exit_code) *out_exit_code = (uint32_t)WEXITSTATUS(status);
+	}
+
+	DS_ScopePop(scope);
+	return ok;
+}
+
+static int OS_DeleteDirectoryEntry(const char* path, const struct stat* st, int type, struct FTW* ftw) {
+	return remove(path);
+}
+
+OS_API void OS_DeleteDirectory(DS_Info* ds, STR_View directory_path) {
+	DS_Scope scope = DS_ScopePush(ds);
+	nftw(STR_ToC(ds->temp_arena, directory_path), OS_DeleteDirectoryEntry, 16, FTW_DEPTH | FTW_PHYS);
+	DS_ScopePop(scope);
+}
+
+OS_API bool OS_PathToAbsolute(DS_Arena* arena, STR_View path, STR_View* out_path) {
+	DS_Scope scope = DS_ScopePushWithOut(arena);
+
+	char* result = realpath(STR_ToC(scope.temp_arena, path), NULL);
+	bool ok = result != NULL;
+	if (ok) {
+		*out_path = STR_Clone(arena, STR_ToV(result));
+		free(result);
+	}
+
+	DS_ScopePop(scope);
+	return ok;
+}
+
+OS_API bool OS_MakeDirectory(DS_Info* ds, STR_View directory) {
+	DS_Scope scope = DS_ScopePush(ds);
+	bool created = mkdir(STR_ToC(ds->temp_arena, directory), 0777) == 0;
+	bool ok = created || errno == EEXIST;
+	DS_ScopePop(scope);
+	return ok;
+}
+
+OS_API bool OS_SetWorkingDir(DS_Info* ds, STR_View directory) {
+	assert(OS_PathIsAbsolute(directory));
+
+	DS_Scope scope = DS_ScopePush(ds);
+	bool ok = chdir(STR_ToC(ds->temp_arena, directory)) == 0;
+	DS_ScopePop(scope);
+	return ok;
+}
+
+OS_API void OS_GetWorkingDir(DS_Arena* arena, STR_View* directory) {
+	char buf[4096];
+	bool ok = getcwd(buf, sizeof(buf)) != NULL;
+	assert(ok);
+	*directory = STR_Clone(arena, STR_ToV(buf));
+}
+
+OS_API bool OS_FilePicker(DS_Arena* arena, STR_View* out_path) {
+	return false;
+}
+
+OS_API bool OS_FolderPicker(DS_Arena* arena, STR_View* out_path) {
+	return false;
+}
+
+// The mapping's base address and size are stored right before the returned address, because munmap needs both
+typedef struct OS_VirtualAllocHeader {
+	void* base;
+	size_t size;
+} OS_VirtualAllocHeader;
+
+OS_API void* OS_VirtualAlloc(size_t size) {
+	// Match the 64 KiB alignment of VirtualAlloc
+	size_t granularity = 64 * 1024;
+	size_t mapping_size = size + granularity + sizeof(OS_VirtualAllocHeader);
+	char* base = (char*)mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) return NULL;
+
+	char* result = (char*)(((uintptr_t)base + sizeof(OS_VirtualAllocHeader) + granularity - 1) & ~(uintptr_t)(granularity - 1));
+	OS_VirtualAllocHeader* header = (OS_VirtualAllocHeader*)result - 1;
+	header->base = base;
+	header->size = mapping_size;
+	return result;
+}
+
+OS_API void OS_VirtualFree(void* ptr) {
+	OS_VirtualAllocHeader header = *((OS_VirtualAllocHeader*)ptr - 1);
+	int err = munmap(header.base, header.size);
+	assert(err == 0);
+}
+
+// NTFS lists directory entries sorted by name, case-insensitively. Sort the same way so that assets load in the same order on both.
+static int OS_CompareFileInfoNames(const void* a, const void* b) {
+	STR_View a_name = ((const OS_FileInfo*)a)->name;
+	STR_View b_name = ((const OS_FileInfo*)b)->name;
+	size_t min_size = a_name.size < b_name.size ? a_name.size : b_name.size;
+	for (size_t i = 0; i < min_size; i++) {
+		int a_c = toupper((unsigned char)a_name.data[i]);
+		int b_c = toupper((unsigned char)b_name.data[i]);
+		if (a_c != b_c) return a_c - b_c;
+	}
+	return (a_name.size > b_name.size) - (a_name.size < b_name.size);
+}
+
+OS_API bool OS_GetAllFilesInDirectory(DS_Arena* arena, STR_View directory, OS_FileInfoArray* out_files) {
+	DS_Scope scope = DS_ScopePushWithOut(arena);
+
+	DS_DynArray(OS_FileInfo) file_infos = { arena };
+
+	DIR* dir = opendir(STR_ToC(scope.temp_arena, directory));
+	bool ok = dir != NULL;
+	if (ok) {
+		for (struct dirent* entry; (entry = readdir(dir));) {
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+			struct stat st;
+			if (fstatat(dirfd(dir), entry->d_name, &st, 0) != 0) continue; // e.g. a broken symlink
+
+			OS_FileInfo info = {0};
+			info.name = STR_Clone(arena, STR_ToV(entry->d_name));
+			info.is_directory = S_ISDIR(st.st_mode);
+			info.last_write_time = OS_StatModtime(&st);
+			DS_ArrPush(&file_infos, info);
+		}
+		closedir(dir);
+		qsort(file_infos.data, file_infos.count, sizeof(OS_FileInfo), OS_CompareFileInfoNames);
+	}
+
+	DS_ScopePop(scope);
+
+	out_files->data = file_infos.data;
+	out_files->count = file_infos.count;
+	return ok;
+}
+
+OS_API uint64_t OS_GetPeakMemoryUsage(void) {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return (uint64_t)usage.ru_maxrss; // bytes on macOS
+#else
+	return (uint64_t)usage.ru_maxrss * 1024; // kilobytes on Linux
+#endif
+}
+
+OS_API void OS_GetThisExecutablePath(DS_Arena* arena, STR_View* out_path) {
+	char buf[4096];
+	ssize_t n = readlink("/proc/self/exe", buf, sizeof(buf));
+	assert(n > 0 && n < (ssize_t)sizeof(buf));
+	STR_View path = {buf, (size_t)n};
+	*out_path = STR_Clone(arena, path);
+}
+
+OS_API void OS_UnloadDLL(OS_DLL* dll) {
+	int err = dlclose(dll);
+	assert(err == 0);
+}
+
+OS_API OS_DLL* OS_LoadDLL(DS_Info* ds, STR_View dll_path) {
+	DS_Scope scope = DS_ScopePush(ds);
+	void* handle = dlopen(STR_ToC(ds->temp_arena, dll_path), RTLD_NOW | RTLD_LOCAL);
+	DS_ScopePop(scope);
+	return (OS_DLL*)handle;
+}
+
+OS_API void* OS_GetProcAddress(OS_DLL* dll, const char* name) {
+	return dlsym(dll, name);
+}
+
+#endif // _WIN32
@@ -0,0 +1,102 @@
+#define HT_STATIC_PLUGIN_ID allocator_benchmark
+#include <hatch_api.h>
+
+#define OS_TIMING_API static
+#define FIRE_OS_TIMING_IMPLEMENTATION
+#include <ht_utils/fire/fire_os_timing.h>
+
+#include <string.h>
+
+// Stress test for HT_API::AllocatorProc. Every frame, a pool of live allocations is churned with a mix of
+// small allocations, frees and resizes (with a few large allocations mixed in), and the average cost is logged every few seconds.
+// The live allocations are intentionally left alive on unload, because the editor is supposed to release them in bulk.
+
+#define LIVE_ALLOCATIONS_COUNT 4096
+#define OPERATIONS_PER_FRAME   20000
+#define FRAMES_PER_REPORT      120
+
+// -----------------------------------------------------
+
+struct Allocation {
+	void* ptr;
+	size_t size;
+};
+
+struct Globals {
+	u64 cpu_frequency;
+	u32 random_state;
+	Allocation allocations[LIVE_ALLOCATIONS_COUNT];
+	
+	int frames_measured;
+	u64 ticks_measured;
+	u64 operations_measured;
+};
+
+// -----------------------------------------------------
+
+static Globals GLOBALS;
+
+// -----------------------------------------------------
+
+static u32 RandomU32() {
+	// xorshift32
+	u32 x = GLOBALS.random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	GLOBALS.random_state = x;
+	return x;
+}
+
+static size_t RandomAllocationSize() {
+	u32 r = RandomU32();
+	if ((r & 1023) == 0) return 8192 + (r >> 10) % 65536; // rare large allocation
+	if ((r & 7) == 0) return 256 + (r >> 10) % 1792;
+	return 8 + (r >> 10) % 120; // most allocations are small
+}
+
+HT_EXPORT void HT_LoadPlugin(HT_API* ht) {
+	GLOBALS = {};
+	GLOBALS.cpu_frequency = OS_GetCPUFrequency();
+	GLOBALS.random_state = 0x12345678;
+}
+
+HT_EXPORT void HT_UnloadPlugin(HT_API* ht) {
+}
+
+HT_EXPORT void HT_UpdatePlugin(HT_API* ht) {
+	u64 start = OS_GetCPUTick();
+
+	for (int i = 0; i < OPERATIONS_PER_FRAME; i++) {
+		Allocation* allocation = &GLOBALS.allocations[RandomU32() % LIVE_ALLOCATIONS_COUNT];
+		u32 op = RandomU32() % 4;
+		
+		if (allocation->ptr == NULL) {
+			allocation->size = RandomAllocationSize();
+			allocation->ptr = ht->AllocatorProc(NULL, allocation->size);
+			memset(allocation->ptr, 0, allocation->size < 16 ? allocation->size : 16);
+		}
+		else if (op == 0) {
+			allocation->size = RandomAllocationSize();
+			allocation->ptr = ht->AllocatorProc(allocation->ptr, allocation->size);
+		}
+		else {
+			ht->AllocatorProc(allocation->ptr, 0);
+			allocation->ptr = NULL;
+		}
+	}
+
+	GLOBALS.ticks_measured += OS_GetCPUTick() - start;
+	GLOBALS.operations_measured += OPERATIONS_PER_FRAME;
+	GLOBALS.frames_measured += 1;
+
+	if (GLOBALS.frames_measured == FRAMES_PER_REPORT) {
+		double seconds = OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.ticks_measured);
+		double ns_per_op = 1000000000.0 * seconds / (double)GLOBALS.operations_measured;
+		HT_LogInfo("AllocatorProc: %f ns per operation (%f ms per frame)", ns_per_op, 1000.0 * seconds / (double)FRAMES_PER_REPORT);
+		
+		GLOBALS.frames_measured = 0;
+		GLOBALS.ticks_measured = 0;
+		GLOBALS.operations_measured = 0;
+	}
+}
@@ -1,4 +1,4 @@
-
+#pragma once
 
 #include <hatch_api.h>
 
@@ -16,8 +16,6 @@
 #include <sstream>
 #include <vector>
 
-#include <Windows.h> // for GlobalMemoryStatus
-
 MeshManager MeshManager::instance{};
 
 void MeshManager::Init() {
@@ -212,7 +210,9 @@ static RenderMesh* ImportMesh(HT_API* ht, DS_Allocator* allocator, HT_StringView
 		u32 num_indices;
 	};
 
-	DS_DynArray(TempMeshPart) temp_parts = {FG::mem.temp};
+	TempMeshPart temp_parts_buffer[4];
+	DS_DynArray(TempMeshPart) temp_parts;
+	DS_ArrInitBuffer(&temp_parts, FG::mem.temp, temp_parts_buffer);
 	u32 total_num_vertices = 0;
 	u32 total_num_indices = 0;
 
@@ -334,13 +334,10 @@ RenderMesh* MeshManager::GetMeshFromMeshAsset(HT_Asset mesh_asset) {
 			//*cached = ImportMesh(FG::ht, FG::mem.heap, mesh_source_file);
 		}
 
-		MEMORYSTATUS mem_status;
-		GlobalMemoryStatus(&mem_status);
-		HT_LogInfo("Loading mesh \"%s\" - using memory %f MB (avail: %f MB, total: %f MB)",
+		// The plugin's total memory use is shown in the editor's Memory tab.
+		HT_LogInfo("Loading mesh \"%s\" - using memory %f MB",
 			mesh_source_file_str.c_str(),
-			(float)(*cached)->memory_usage / (1024.f*1024.f),
-			(float)mem_status.dwAvailPhys / (1024.f*1024.f),
-			(float)mem_status.dwTotalPhys / (1024.f*1024.f));
+			(float)(*cached)->memory_usage / (1024.f*1024.f));
 	}
 	return *cached;
 }
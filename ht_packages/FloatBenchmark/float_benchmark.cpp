@@ -0,0 +1,200 @@
+#define HT_STATIC_PLUGIN_ID float_benchmark
+#include <hatch_api.h>
+
+#define OS_TIMING_API static
+#define FIRE_OS_TIMING_IMPLEMENTATION
+#include <ht_utils/fire/fire_os_timing.h>
+
+#include <ht_utils/fire/fire_string.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Benchmark and correctness check for the float parsing and printing in fire_string.
+// Every frame, a fixed set of random floats is printed with STR_Float32ToStrBufShortest and parsed back with STR_ParseFloat32,
+// and the same is done with snprintf("%.9g") and strtof for comparison. The average costs are logged every few seconds.
+// In addition, every float32 bit pattern is checked to round-trip through the shortest printer and the parser, a chunk per frame.
+
+#define VALUES_COUNT              4096
+#define FRAMES_PER_REPORT         120
+#define ROUND_TRIP_CHUNK_SIZE     (1 << 20) // bit patterns checked per frame
+#define ROUND_TRIP_BATCH_SIZE     (1 << 14)
+
+// -----------------------------------------------------
+
+struct RoundTripResult {
+	u64 mismatches;
+	u32 first_mismatch; // bit pattern of the first mismatching float in the chunk
+};
+
+struct Globals {
+	u64 cpu_frequency;
+	u32 random_state;
+	float values[VALUES_COUNT];
+	char strings[VALUES_COUNT][STR_FLOAT32_MAX_SIZE];
+
+	int frames_measured;
+	u64 print_ticks;
+	u64 parse_ticks;
+	u64 crt_print_ticks;
+	u64 crt_parse_ticks;
+
+	u64 round_trip_next; // next bit pattern to check, or 2^32 when done
+	u64 round_trip_mismatches;
+	u64 round_trip_start_tick;
+};
+
+// -----------------------------------------------------
+
+static Globals GLOBALS;
+static volatile float g_sink; // keeps the compiler from optimizing away the benchmarked work
+
+// -----------------------------------------------------
+
+static u32 RandomU32() {
+	// xorshift32
+	u32 x = GLOBALS.random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	GLOBALS.random_state = x;
+	return x;
+}
+
+static float RandomFloat() {
+	for (;;) {
+		u32 bits = RandomU32();
+		if (((bits >> 23) & 0xFF) == 0xFF) continue; // skip NaNs and infinities
+
+		float value;
+		memcpy(&value, &bits, 4);
+		return value;
+	}
+}
+
+static bool FloatBitsEqual(float a, float b) {
+	u32 a_bits, b_bits;
+	memcpy(&a_bits, &a, 4);
+	memcpy(&b_bits, &b, 4);
+	return a_bits == b_bits;
+}
+
+static void RoundTripCheck(void* user_data, void* partial_result, int begin, int end) {
+	u64 base = *(u64*)user_data;
+	RoundTripResult* result = (RoundTripResult*)partial_result;
+
+	char buffer[STR_FLOAT32_MAX_SIZE];
+	for (int i = begin; i < end; i++) {
+		u32 bits = (u32)(base + (u64)i);
+		float value;
+		memcpy(&value, &bits, 4);
+
+		size_t size = STR_Float32ToStrBufShortest(buffer, value);
+		float parsed;
+		bool ok = STR_ParseFloat32(STR_View(buffer, size), &parsed);
+
+		bool match = ok && (value != value ? parsed != parsed : FloatBitsEqual(value, parsed));
+		if (!match) {
+			if (result->mismatches == 0) result->first_mismatch = bits;
+			result->mismatches += 1;
+		}
+	}
+}
+
+static void RoundTripCombine(void* user_data, void* result, const void* partial_result) {
+	RoundTripResult* a = (RoundTripResult*)result;
+	const RoundTripResult* b = (const RoundTripResult*)partial_result;
+	if (a->mismatches == 0) a->first_mismatch = b->first_mismatch;
+	a->mismatches += b->mismatches;
+}
+
+HT_EXPORT void HT_LoadPlugin(HT_API* ht) {
+	GLOBALS = {};
+	GLOBALS.cpu_frequency = OS_GetCPUFrequency();
+	GLOBALS.random_state = 0x12345678;
+	GLOBALS.round_trip_start_tick = OS_GetCPUTick();
+
+	for (int i = 0; i < VALUES_COUNT; i++) {
+		// Mix in some short decimals, since those are common in asset files
+		GLOBALS.values[i] = (i & 3) == 0 ? (float)(int)(RandomU32() % 20001 - 10000) / 100.f : RandomFloat();
+		size_t size = STR_Float32ToStrBufShortest(GLOBALS.strings[i], GLOBALS.values[i]);
+		GLOBALS.strings[i][size] = 0;
+	}
+}
+
+HT_EXPORT void HT_UnloadPlugin(HT_API* ht) {
+}
+
+HT_EXPORT void HT_UpdatePlugin(HT_API* ht) {
+	char buffer[STR_FLOAT32_MAX_SIZE];
+	float sum = 0.f;
+
+	u64 start = OS_GetCPUTick();
+	for (int i = 0; i < VALUES_COUNT; i++) {
+		sum += (float)STR_Float32ToStrBufShortest(buffer, GLOBALS.values[i]);
+	}
+	u64 end = OS_GetCPUTick();
+	GLOBALS.print_ticks += end - start;
+
+	start = end;
+	for (int i = 0; i < VALUES_COUNT; i++) {
+		float value;
+		STR_ParseFloat32(GLOBALS.strings[i], &value);
+		sum += value;
+	}
+	end = OS_GetCPUTick();
+	GLOBALS.parse_ticks += end - start;
+
+	start = end;
+	for (int i = 0; i < VALUES_COUNT; i++) {
+		sum += (float)snprintf(buffer, sizeof(buffer), "%.9g", GLOBALS.values[i]);
+	}
+	end = OS_GetCPUTick();
+	GLOBALS.crt_print_ticks += end - start;
+
+	start = end;
+	for (int i = 0; i < VALUES_COUNT; i++) {
+		sum += strtof(GLOBALS.strings[i], NULL);
+	}
+	end = OS_GetCPUTick();
+	GLOBALS.crt_parse_ticks += end - start;
+
+	g_sink = sum;
+	GLOBALS.frames_measured += 1;
+
+	if (GLOBALS.frames_measured == FRAMES_PER_REPORT) {
+		double ns_per_value = 1000000000.0 / (double)(FRAMES_PER_REPORT * VALUES_COUNT);
+		HT_LogInfo("Float32 print: %f ns (snprintf: %f ns), parse: %f ns (strtof: %f ns)",
+			ns_per_value * OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.print_ticks),
+			ns_per_value * OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.crt_print_ticks),
+			ns_per_value * OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.parse_ticks),
+			ns_per_value * OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.crt_parse_ticks));
+
+		GLOBALS.frames_measured = 0;
+		GLOBALS.print_ticks = 0;
+		GLOBALS.parse_ticks = 0;
+		GLOBALS.crt_print_ticks = 0;
+		GLOBALS.crt_parse_ticks = 0;
+	}
+
+	if (GLOBALS.round_trip_next < (1ull << 32)) {
+		u64 base = GLOBALS.round_trip_next;
+		RoundTripResult result = {};
+		ht->ParallelReduce(ROUND_TRIP_CHUNK_SIZE, ROUND_TRIP_BATCH_SIZE, RoundTripCheck, RoundTripCombine, &base, &result, sizeof(result));
+		GLOBALS.round_trip_next += ROUND_TRIP_CHUNK_SIZE;
+
+		if (result.mismatches > 0) {
+			float value;
+			memcpy(&value, &result.first_mismatch, 4);
+			size_t size = STR_Float32ToStrBufShortest(buffer, value);
+			buffer[size] = 0;
+			HT_LogInfo("Float32 round-trip mismatch: 0x%x printed as \"%s\" (%llu mismatches in this chunk)", result.first_mismatch, buffer, result.mismatches);
+			GLOBALS.round_trip_mismatches += result.mismatches;
+		}
+
+		if (GLOBALS.round_trip_next == (1ull << 32)) {
+			double seconds = OS_GetDuration(GLOBALS.cpu_frequency, GLOBALS.round_trip_start_tick, OS_GetCPUTick());
+			HT_LogInfo("Float32 round-trip check done in %f s: %llu mismatches out of 2^32 bit patterns", seconds, GLOBALS.round_trip_mismatches);
+		}
+	}
+}
@@ -36,6 +36,7 @@ static DS_Allocator* HEAP;
 static DS_Map(HT_Asset, MeshCollisionData) meshes_data;
 
 static JPH_JobSystem* jolt_jobSystem;
+static HT_JobCounter jolt_jobs_counter;
 static JPH_PhysicsSystem* jolt_system;
 static JPH_BodyInterface* jolt_bodyInterface;
 
@@ -138,6 +139,17 @@ static JPH_Quat EulerAnglesXYZToQuat(vec3 xyz) {
 	};
 }
 
+// Jolt's jobs run on the editor's worker pool, shared with the other plugins, rather than on a thread pool of its own.
+static void JoltQueueJob(void* context, JPH_JobFunction* job, void* arg) {
+	HT_API* ht = (HT_API*)context;
+	ht->SubmitJob(job, arg, &jolt_jobs_counter);
+}
+
+static void JoltQueueJobs(void* context, JPH_JobFunction* job, void** args, uint32_t count) {
+	HT_API* ht = (HT_API*)context;
+	ht->SubmitJobs(job, args, (int)count, &jolt_jobs_counter);
+}
+
 static void StartSimulation(HT_API* ht, Scene__Scene* scene) {
 #ifdef HAS_JOLT
 	bool ok = JPH_Init();
@@ -146,7 +158,13 @@ static void StartSimulation(HT_API* ht, Scene__Scene* scene) {
 	JPH_SetTraceHandler(JoltTraceHandler);
 	//JPH_SetAssertFailureHandler(JPH_AssertFailureFunc handler);
 
-	jolt_jobSystem = JPH_JobSystemThreadPool_Create(NULL);
+	JPH_JobSystemConfig job_system_config = {};
+	job_system_config.context = ht;
+	job_system_config.queueJob = JoltQueueJob;
+	job_system_config.queueJobs = JoltQueueJobs;
+	job_system_config.maxConcurrency = (uint32_t)ht->GetWorkerCount();
+	job_system_config.maxBarriers = 8;
+	jolt_jobSystem = JPH_JobSystemCallback_Create(&job_system_config);
 
 	JPH_ObjectLayerPairFilter* objectLayerPairFilterTable;
 	JPH_BroadPhaseLayerInterface* broadPhaseLayerInterfaceTable;
@@ -229,6 +247,8 @@ static void StartSimulation(HT_API* ht, Scene__Scene* scene) {
 
 static void EndSimulation(HT_API* ht, Scene__Scene* scene) {
 #ifdef HAS_JOLT
+	// A job that a barrier already ran itself may still be queued on the pool, so let the pool finish with them first
+	ht->WaitForCounter(&jolt_jobs_counter);
 	JPH_JobSystem_Destroy(jolt_jobSystem);
 	JPH_PhysicsSystem_Destroy(jolt_system);
 	JPH_Shutdown();
@@ -0,0 +1,271 @@
+#define HT_STATIC_PLUGIN_ID string_benchmark
+#include <hatch_api.h>
+
+#define OS_TIMING_API static
+#define FIRE_OS_TIMING_IMPLEMENTATION
+#include <ht_utils/fire/fire_os_timing.h>
+
+#include <ht_utils/fire/fire_string.h>
+
+#include <stdlib.h>
+
+// Benchmark for the search functions in fire_string. A source-file-sized and a log-sized text are generated on load,
+// and every frame the same searches are done with fire_string and with plain byte-by-byte loops for comparison.
+// The results of both are checked to be equal, and the throughput is logged every few seconds.
+
+#define SOURCE_LINES_COUNT 2000    // roughly 70 KB
+#define LOG_LINES_COUNT    20000   // roughly 1 MB
+#define FRAMES_PER_REPORT  120
+
+// -----------------------------------------------------
+
+enum Test {
+	Test_FindInSource,     // STR_Find of an identifier that appears near the end of the source
+	Test_SplitLogLines,    // STR_FindFirst('\n') over the whole log, then STR_Find(" error ") on each line
+	Test_ReplaceInSource,  // STR_Replace of a common prefix
+	Test_CodepointCount,   // STR_CodepointCount over the log
+	Test_ValidateUTF8,     // STR_IsValidUTF8 over the log
+	Test_COUNT,
+};
+
+static const char* TEST_NAMES[] = {
+	"Find in source",
+	"Split log lines",
+	"Replace in source",
+	"Codepoint count",
+	"Validate UTF-8",
+};
+
+struct Globals {
+	u64 cpu_frequency;
+	u32 random_state;
+
+	char* source;
+	size_t source_size;
+	char* log;
+	size_t log_size;
+
+	int frames_measured;
+	u64 ticks[Test_COUNT];
+	u64 reference_ticks[Test_COUNT];
+	u64 bytes[Test_COUNT];
+	int mismatches;
+};
+
+// -----------------------------------------------------
+
+static Globals GLOBALS;
+
+// -----------------------------------------------------
+
+static u32 RandomU32() {
+	// xorshift32
+	u32 x = GLOBALS.random_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	GLOBALS.random_state = x;
+	return x;
+}
+
+static const char* SOURCE_LINES[] = {
+	"static void UpdateAndDrawTab(EditorState* s, UI_Tab* tab, UI_Rect area) {\n",
+	"\tfor (int i = 0; i < s->plugins.count; i++) {\n",
+	"\t\tHT_Asset asset = s->plugins[i].asset; // the plugin asset\n",
+	"\tif (!STR_Find(remaining, \"\\n\", &at)) break;\n",
+	"\tDS_ArrPush(&result, HT_StringView{name.data, name.size});\n",
+	"}\n",
+	"\n",
+	"// Returns the asset at `path`, or NULL if there is no such asset.\n",
+	"\tHT_ItemGroup* group = (HT_ItemGroup*)data; u32 bucket = HT_ItemIndexBucket(item);\n",
+	"\tOS_MutexLock(&pool->mutex);\n",
+};
+
+static const char* LOG_LINES[] = {
+	"Loaded package \"Core\" in 1.25 ms\n",
+	"Compiling plugin C:/Hatch/ht_packages/Example/example.plugin.ht\n",
+	"example.cpp(120): warning C4101: 'i': unreferenced local variable\n",
+	"example.cpp(133): error C2065: 'vec5': undeclared identifier\n",
+	"Allocated 4096 bytes for asset \xE2\x80\x9C" "default\xE2\x80\x9D \xE2\x9C\x93\n", // non-ASCII quotes and a check mark
+	"Saved project to C:/Users/me/Documents/Hatch projects/Projekt \xC3\xA4\xC3\xB6/\n",
+};
+
+static char* GenerateText(const char** lines, int lines_count, int count, size_t* out_size) {
+	size_t capacity = 0;
+	for (int i = 0; i < lines_count; i++) capacity += strlen(lines[i]);
+	capacity = capacity * count + 64;
+
+	char* text = (char*)malloc(capacity);
+	size_t size = 0;
+	for (int i = 0; i < count; i++) {
+		const char* line = lines[RandomU32() % lines_count];
+		size_t line_size = strlen(line);
+		memcpy(text + size, line, line_size);
+		size += line_size;
+	}
+	*out_size = size;
+	return text;
+}
+
+// -- Reference implementations ----------------------------
+
+static bool ReferenceFind(STR_View str, STR_View substr, size_t* out_offset) {
+	for (size_t i = 0; i + substr.size <= str.size; i++) {
+		if (memcmp(str.data + i, substr.data, substr.size) == 0) {
+			*out_offset = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ReferenceFindFirst(STR_View str, uint32_t codepoint, size_t* out_offset) {
+	size_t i = 0, i_next = 0;
+	for (uint32_t r; r = STR_NextCodepoint(str, &i_next); i = i_next) {
+		if (r == codepoint) {
+			*out_offset = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static size_t ReferenceCodepointCount(STR_View str) {
+	size_t count = 0;
+	size_t i = 0;
+	for (uint32_t r; r = STR_NextCodepoint(str, &i);) count++;
+	return count;
+}
+
+static STR_View ReferenceReplace(STR_View str, STR_View search_for, STR_View replace_with) {
+	STR_Builder builder = {};
+	for (size_t i = 0; i < str.size;) {
+		if (i + search_for.size <= str.size && memcmp(str.data + i, search_for.data, search_for.size) == 0) {
+			STR_Print(&builder, replace_with);
+			i += search_for.size;
+		}
+		else {
+			STR_Print(&builder, STR_View(&str.data[i], 1));
+			i++;
+		}
+	}
+	return builder.str;
+}
+
+static bool ReferenceIsValidUTF8(STR_View str) {
+	const u8* data = (const u8*)str.data;
+	for (size_t i = 0; i < str.size;) {
+		u8 c = data[i];
+		size_t size;
+		u32 codepoint, min_codepoint;
+		if (c < 0x80)                { size = 1; codepoint = c; min_codepoint = 0; }
+		else if ((c & 0xE0) == 0xC0) { size = 2; codepoint = c & 0x1F; min_codepoint = 0x80; }
+		else if ((c & 0xF0) == 0xE0) { size = 3; codepoint = c & 0x0F; min_codepoint = 0x800; }
+		else if ((c & 0xF8) == 0xF0) { size = 4; codepoint = c & 0x07; min_codepoint = 0x10000; }
+		else return false;
+
+		if (i + size > str.size) return false;
+		for (size_t j = 1; j < size; j++) {
+			if ((data[i + j] & 0xC0) != 0x80) return false;
+			codepoint = (codepoint << 6) | (data[i + j] & 0x3F);
+		}
+		if (codepoint < min_codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) return false;
+		i += size;
+	}
+	return true;
+}
+
+// -----------------------------------------------------
+
+// Runs one test, either with fire_string or with the reference implementation, and returns a value that depends on the result.
+static u64 RunTest(Test test, bool reference) {
+	STR_View source = { GLOBALS.source, GLOBALS.source_size };
+	STR_View log = { GLOBALS.log, GLOBALS.log_size };
+	u64 result = 0;
+
+	switch (test) {
+	case Test_FindInSource: {
+		STR_View needle = "HT_ItemIndexBucket(item)";
+		STR_View remaining = source;
+		size_t offset;
+		while (reference ? ReferenceFind(remaining, needle, &offset) : STR_Find(remaining, needle, &offset)) {
+			result += offset;
+			remaining = STR_SliceAfter(remaining, offset + 1);
+		}
+	}break;
+	case Test_SplitLogLines: {
+		STR_View remaining = log;
+		for (;;) {
+			size_t at;
+			if (!(reference ? ReferenceFindFirst(remaining, '\n', &at) : STR_FindFirst(remaining, '\n', &at))) break;
+
+			STR_View line = STR_SliceBefore(remaining, at);
+			size_t error_at;
+			if (reference ? ReferenceFind(line, " error ", &error_at) : STR_Find(line, " error ", &error_at)) result++;
+			remaining = STR_SliceAfter(remaining, at + 1);
+		}
+	}break;
+	case Test_ReplaceInSource: {
+		STR_View replaced = reference ? ReferenceReplace(source, "HT_", "HT_Old") : STR_Replace(NULL, source, "HT_", "HT_Old");
+		for (size_t i = 0; i < replaced.size; i += 64) result = result * 31 + (u8)replaced.data[i];
+		result += replaced.size;
+		free((void*)replaced.data);
+	}break;
+	case Test_CodepointCount: {
+		result = reference ? ReferenceCodepointCount(log) : STR_CodepointCount(log);
+	}break;
+	case Test_ValidateUTF8: {
+		result = reference ? ReferenceIsValidUTF8(log) : STR_IsValidUTF8(log);
+	}break;
+	case Test_COUNT: break;
+	}
+	return result;
+}
+
+HT_EXPORT void HT_LoadPlugin(HT_API* ht) {
+	GLOBALS = {};
+	GLOBALS.cpu_frequency = OS_GetCPUFrequency();
+	GLOBALS.random_state = 0x12345678;
+	GLOBALS.source = GenerateText(SOURCE_LINES, sizeof(SOURCE_LINES) / sizeof(SOURCE_LINES[0]), SOURCE_LINES_COUNT, &GLOBALS.source_size);
+	GLOBALS.log = GenerateText(LOG_LINES, sizeof(LOG_LINES) / sizeof(LOG_LINES[0]), LOG_LINES_COUNT, &GLOBALS.log_size);
+}
+
+HT_EXPORT void HT_UnloadPlugin(HT_API* ht) {
+	free(GLOBALS.source);
+	free(GLOBALS.log);
+}
+
+HT_EXPORT void HT_UpdatePlugin(HT_API* ht) {
+	for (int i = 0; i < Test_COUNT; i++) {
+		Test test = (Test)i;
+		u64 start = OS_GetCPUTick();
+		u64 result = RunTest(test, false);
+		u64 mid = OS_GetCPUTick();
+		u64 reference_result = RunTest(test, true);
+		u64 end = OS_GetCPUTick();
+
+		GLOBALS.ticks[i] += mid - start;
+		GLOBALS.reference_ticks[i] += end - mid;
+		GLOBALS.bytes[i] += test == Test_FindInSource || test == Test_ReplaceInSource ? GLOBALS.source_size : GLOBALS.log_size;
+
+		if (result != reference_result && GLOBALS.mismatches < 10) {
+			HT_LogInfo("%s: result mismatch (%llu, expected %llu)", TEST_NAMES[i], result, reference_result);
+			GLOBALS.mismatches++;
+		}
+	}
+	GLOBALS.frames_measured += 1;
+
+	if (GLOBALS.frames_measured == FRAMES_PER_REPORT) {
+		for (int i = 0; i < Test_COUNT; i++) {
+			double megabytes = (double)GLOBALS.bytes[i] / (1024.0 * 1024.0);
+			double seconds = OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.ticks[i]);
+			double reference_seconds = OS_GetDuration(GLOBALS.cpu_frequency, 0, GLOBALS.reference_ticks[i]);
+			HT_LogInfo("%s: %f MB/s (byte loop: %f MB/s)", TEST_NAMES[i], megabytes / seconds, megabytes / reference_seconds);
+
+			GLOBALS.ticks[i] = 0;
+			GLOBALS.reference_ticks[i] = 0;
+			GLOBALS.bytes[i] = 0;
+		}
+		GLOBALS.frames_measured = 0;
+	}
+}
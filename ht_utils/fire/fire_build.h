@@ -1,7 +1,8 @@
 // fire_build.h - by Eero Mutka (https://eeromutka.github.io/)
 //
 // This library lets you build C/C++ code or generate Visual Studio projects directly from code.
-// Only Windows and MSVC are supported targets for time being.
+// On Windows, code is built with MSVC. On Linux and other POSIX systems, it's built with GCC or Clang.
+// Visual Studio solutions can only be generated on Windows.
 // 
 // This code is released under the MIT license (https://opensource.org/licenses/MIT).
 // 
@@ -9,6 +10,11 @@
 #ifndef FIRE_BUILD_INCLUDED
 #define FIRE_BUILD_INCLUDED
 
+// The implementation needs posix_spawn_file_actions_addchdir_np. Only has an effect if no system header was included before this one.
+#if (defined(FIRE_BUILD_IMPLEMENTATION) || !defined(BUILD_API)) && !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -25,6 +31,11 @@ typedef enum BUILD_Target {
 	// TODO: BUILD_Target_StaticLibrary,
 } BUILD_Target;
 
+// Source files larger than this are left out of unity builds, see `unity_build`
+#ifndef BUILD_UNITY_BUILD_MAX_FILE_SIZE
+#define BUILD_UNITY_BUILD_MAX_FILE_SIZE (256 * 1024)
+#endif
+
 typedef struct BUILD_ProjectOptions {
 	BUILD_Target target;
 
@@ -37,6 +48,28 @@ typedef struct BUILD_ProjectOptions {
 
 	bool disable_aslr; // Disable address-space layout randomization
 
+	// If set, object files are cached in this directory, named by a hash of the compiler arguments, the source file and
+	// the files added with BUILD_AddCacheInput. A source file whose hash matches a cached object file isn't recompiled,
+	// unless a header that it included has been modified since, according to the dependency file that the compiler wrote
+	// next to the object file. The directory must exist and can be shared between projects.
+	const char* object_cache_directory;
+
+	// If set, this header is precompiled once and force-included at the start of every C++ source file, so it should
+	// contain what the source files include first anyway. The headers in it need include guards or #pragma once, as the
+	// source files may include them again. It's only used with `object_cache_directory`, where the precompiled header is
+	// cached like an object file, keyed by the compiler arguments, the cache inputs and the contents of this header.
+	const char* precompiled_header;
+
+	// Compile the C++ source files as a single translation unit that includes them all. The file is written to the build
+	// directory. C files and C++ files larger than BUILD_UNITY_BUILD_MAX_FILE_SIZE are still compiled on their own, so
+	// that large libraries that rarely change are compiled once and then come from the object cache. The source files
+	// must not define static functions or macros with conflicting names.
+	bool unity_build;
+
+	// Relative paths in the project are relative to this directory, and the compiler and linker run in it. If NULL, the
+	// working directory of the process is used, which then must not change while the project is being built.
+	const char* working_directory;
+
 	// By default, these are false, and thus will be set to /MT
 	// https://learn.microsoft.com/en-us/cpp/build/reference/md-mt-ld-use-run-time-library
 	bool c_runtime_library_debug;
@@ -46,6 +79,16 @@ typedef struct BUILD_ProjectOptions {
 		bool disable_console; // Corresponds to /SUBSYSTEM:WINDOWS
 		//  bool use_msbuild; (TODO) // This will generate VS project files and call the MSBuild command to build the project.
 	} windows;
+
+	struct {
+		// Compiler driver used for both compiling and linking, e.g. "clang++". By default, clang/clang++ is used if it's
+		// found in PATH, otherwise gcc/g++. The C++ driver is picked if any source file is C++.
+		const char* compiler;
+
+		// Passed to the compiler as -fuse-ld=. By default, the fastest linker found in PATH is used: mold, lld or gold,
+		// in that order, otherwise the compiler's default linker.
+		const char* linker;
+	} posix;
 } BUILD_ProjectOptions;
 
 typedef struct BUILD_Project BUILD_Project;
@@ -66,6 +109,15 @@ BUILD_API void BUILD_AddExtraLinkerArg(BUILD_Project* project, const char* arg_s
 BUILD_API void BUILD_AddExtraCompilerArg(BUILD_Project* project, const char* arg_string);
 BUILD_API void BUILD_AddVisualStudioNatvisFile(BUILD_Project* project, const char* natvis_file);
 
+// When both projects are compiled in the same BUILD_CompileProjects call, `project` is linked after `dependency` and
+// against its output (the import library on Windows).
+BUILD_API void BUILD_AddLinkDependency(BUILD_Project* project, BUILD_Project* dependency);
+
+// The contents of cache inputs are hashed into the cache key of every source file. Headers that the source files include
+// are tracked through the compiler's dependency files, so this is for inputs that the compiler doesn't report.
+// Only used with `object_cache_directory`. A file that doesn't exist is hashed as empty.
+BUILD_API void BUILD_AddCacheInput(BUILD_Project* project, const char* file);
+
 // TODO:
 // BUILD_API void BUILD_AddSourceDir(BUILD_Project *project, const char *source_dir); // Add all .c and .cpp files inside a directory as source files
 
@@ -76,6 +128,20 @@ BUILD_API BUILD_Log* BUILD_GetConsole();
 BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_directory, const char* relative_build_directory,
 	BUILD_Log* log_or_null);
 
+typedef struct BUILD_ProjectBuild {
+	BUILD_Project* project;
+	const char* build_directory; // All build outputs go into this directory
+	BUILD_Log* log_or_null;
+	bool ok; // Set by BUILD_CompileProjects
+} BUILD_ProjectBuild;
+
+// Compiles multiple projects, running up to `max_parallel_jobs` compiler and linker processes at a time, or one per CPU core
+// if it's 0. The source files of all projects are compiled in parallel, and each project is linked as soon as its own object
+// files and its link dependencies are done. The output of each process is written to the log of its project once it exits.
+// Returns true if every project was built successfully.
+// On Windows, projects are built one at a time, in the order of their link dependencies.
+BUILD_API bool BUILD_CompileProjects(BUILD_ProjectBuild* builds, int builds_count, int max_parallel_jobs);
+
 // * All build outputs (object files, executables, etc) go into the build directory.
 // * `relative_build_directory` is relative to `project_directory`
 BUILD_API bool BUILD_CreateVisualStudioSolution(const char* project_directory, const char* relative_build_directory,
@@ -107,20 +173,45 @@ struct BUILD_Project {
 	BUILD_Array(const char*) linker_inputs;
 	BUILD_Array(const char*) extra_linker_args;
 	BUILD_Array(const char*) extra_compiler_args;
+	BUILD_Array(const char*) cache_inputs;
+	BUILD_Array(BUILD_Project*) link_dependencies;
+
+	// Set by BUILD_CompileProject when `object_cache_directory` is used
+	int cache_hits;
+	int cache_misses;
+
+	// Set by BUILD_CompileProject when `object_cache_directory` is used: every file that the compiler read to build the
+	// project's object files, e.g. the source files and every header they include, as reported by the compiler.
+	BUILD_Array(char*) dependencies;
 };
 
-#ifdef /* ---------------- */ FIRE_BUILD_IMPLEMENTATION /* ---------------- */
 
-#pragma comment(lib, "Ole32.lib") // for StringFromGUID2
-#pragma comment(lib, "Advapi32.lib") // for RegCloseKey
+#ifdef /* ---------------- */ FIRE_BUILD_IMPLEMENTATION /* ---------------- */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#include <io.h>         // For _get_osfhandle
 #include <string.h>
 #include <assert.h>
+
+#ifdef _WIN32
+#pragma comment(lib, "Ole32.lib") // for StringFromGUID2
+#pragma comment(lib, "Advapi32.lib") // for RegCloseKey
+
+#include <io.h>         // For _get_osfhandle
 #include <Windows.h>
+#else
+#include <stdlib.h>
+#include <errno.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
 
 #define BUILD_ArrayReserve(ARR, CAPACITY) \
 	while ((CAPACITY) > (ARR)->capacity) { \
@@ -150,6 +241,7 @@ static void BUILD_LogPrint4(BUILD_Log* log_or_null, const char* A, const char* B
 	}
 }
 
+#ifdef _WIN32
 static void BUILD_WPrint(BUILD_WStrBuilder* builder, const wchar_t* string) {
 	for (const wchar_t* ptr = string; *ptr; ptr++) {
 		BUILD_ArrayPush(builder, *ptr);
@@ -172,6 +264,7 @@ static void BUILD_WPrintUTF8(BUILD_WStrBuilder* builder, const char* string) {
 	MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, string, -1, builder->data + builder->count, size + 1);
 	builder->count += size;
 }
+#endif
 
 static void BUILD_Print(BUILD_StrBuilder* builder, const char* string) {
 	for (const char* ptr = string; *ptr; ptr++) {
@@ -189,12 +282,14 @@ static void BUILD_Print4(BUILD_StrBuilder* builder, const char* a, const char* b
 	if (d) BUILD_Print(builder, d);
 }
 
+#ifdef _WIN32
 static void BUILD_PrintW(BUILD_StrBuilder* builder, wchar_t* string) {
 	int size = WideCharToMultiByte(CP_UTF8, 0, string, -1, NULL, 0, NULL, NULL) - 1;
 	BUILD_ArrayReserve(builder, builder->count + size);
 	WideCharToMultiByte(CP_UTF8, 0, string, -1, builder->data + builder->count, size + 1, NULL, NULL);
 	builder->count += size;
 }
+#endif
 
 BUILD_API char* BUILD_Concat2(const char* a, const char* b) {
 	BUILD_StrBuilder s = {0};
@@ -223,8 +318,10 @@ BUILD_API char* BUILD_Concat4(const char* a, const char* b, const char* c, const
 	return s.data;
 }
 
+#ifdef _WIN32
 // NOTE: CreateProcessW may write to the command_string in-place! CreateProcessW requires that.
-static bool BUILD_RunProcess(wchar_t* command_string, uint32_t* out_exit_code, BUILD_Log* log_or_null) {
+// If `working_directory` is NULL, the process inherits ours.
+static bool BUILD_RunProcess(wchar_t* command_string, const char* working_directory, uint32_t* out_exit_code, BUILD_Log* log_or_null) {
 	// https://learn.microsoft.com/en-us/windows/win32/procthread/creating-a-child-process-with-redirected-input-and-output
 
 	PROCESS_INFORMATION process_info = {0};
@@ -250,7 +347,14 @@ static bool BUILD_RunProcess(wchar_t* command_string, uint32_t* out_exit_code, B
 	startup_info.hStdError = ERR_Wr;
 	startup_info.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
 
-	if (ok) ok = CreateProcessW(NULL, command_string, NULL, NULL, true, CREATE_UNICODE_ENVIRONMENT, NULL, NULL, &startup_info, &process_info);
+	BUILD_WStrBuilder current_directory = {0};
+	if (working_directory) {
+		BUILD_WPrintUTF8(&current_directory, working_directory);
+		BUILD_WPrintNullTermination(&current_directory);
+	}
+
+	if (ok) ok = CreateProcessW(NULL, command_string, NULL, NULL, true, CREATE_UNICODE_ENVIRONMENT, NULL, current_directory.data, &startup_info, &process_info);
+	BUILD_ArrayFree(&current_directory);
 
 	// We don't need these handles for ourselves and we must close them to say that we won't be using them, to let `ReadFile` exit
 	// when the process finishes instead of locking. At least that's how I think it works.
@@ -496,6 +600,7 @@ static bool BUILD_GenerateVisualStudioProject(const BUILD_Project* project,
 	BUILD_ArrayFree(&s);
 	return ok;
 }
+#endif // _WIN32
 
 BUILD_API void BUILD_ProjectInit(BUILD_Project* project, const char* name, const BUILD_ProjectOptions* options) {
 	memset(project, 0, sizeof(*project));
@@ -512,6 +617,10 @@ BUILD_API void BUILD_ProjectDeinit(BUILD_Project* project) {
 	BUILD_ArrayFree(&project->linker_inputs);
 	BUILD_ArrayFree(&project->extra_linker_args);
 	BUILD_ArrayFree(&project->extra_compiler_args);
+	BUILD_ArrayFree(&project->cache_inputs);
+	BUILD_ArrayFree(&project->link_dependencies);
+	for (int i = 0; i < project->dependencies.count; i++) free(project->dependencies.data[i]);
+	BUILD_ArrayFree(&project->dependencies);
 }
 
 BUILD_API void BUILD_AddSourceFile(BUILD_Project* project, const char* source_file) {
@@ -546,6 +655,14 @@ BUILD_API void BUILD_AddExtraCompilerArg(BUILD_Project* project, const char* arg
 	BUILD_ArrayPush(&project->extra_compiler_args, arg_string);
 }
 
+BUILD_API void BUILD_AddLinkDependency(BUILD_Project* project, BUILD_Project* dependency) {
+	BUILD_ArrayPush(&project->link_dependencies, dependency);
+}
+
+BUILD_API void BUILD_AddCacheInput(BUILD_Project* project, const char* file) {
+	BUILD_ArrayPush(&project->cache_inputs, file);
+}
+
 static void BUILD_OSConsolePrint(BUILD_Log* log, const char* message) {
 	printf("%s", message);
 }
@@ -555,6 +672,290 @@ BUILD_API BUILD_Log* BUILD_GetConsole() {
 	return (BUILD_Log*)&log;
 }
 
+// 64-bit FNV-1a
+static uint64_t BUILD_Hash(const void* data, size_t size, uint64_t hash) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= ((const uint8_t*)data)[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+#define BUILD_HASH_SEED 14695981039346656037ull
+
+static uint64_t BUILD_HashString(const char* string, uint64_t hash) {
+	return BUILD_Hash(string, strlen(string) + 1, hash); // include the null termination to separate consecutive strings
+}
+
+static uint64_t BUILD_HashFileContents(const char* file, uint64_t hash) {
+	FILE* f = fopen(file, "rb");
+	if (f) {
+		char buf[4096];
+		for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) hash = BUILD_Hash(buf, n, hash);
+		fclose(f);
+	}
+	return hash;
+}
+
+static bool BUILD_FileExists(const char* file) {
+	FILE* f = fopen(file, "rb");
+	if (f) fclose(f);
+	return f != NULL;
+}
+
+// `args_hash` should include everything that affects the output of the compiler other than the source file itself.
+static char* BUILD_CachedObjectFilePath(BUILD_Project* project, const char* code_file, uint64_t args_hash, const char* extension) {
+	uint64_t hash = BUILD_HashString(code_file, args_hash); // for __FILE__ and the paths in debug info
+	hash = BUILD_HashFileContents(code_file, hash);
+
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx", (unsigned long long)hash);
+	return BUILD_Concat3(project->opts.object_cache_directory, name, extension);
+}
+
+static uint64_t BUILD_HashCacheInputs(BUILD_Project* project, uint64_t hash) {
+	for (int i = 0; i < project->cache_inputs.count; i++) {
+		hash = BUILD_HashString(project->cache_inputs.data[i], hash);
+		hash = BUILD_HashFileContents(project->cache_inputs.data[i], hash);
+	}
+	return hash;
+}
+
+static void BUILD_LogCacheStats(BUILD_Project* project, BUILD_Log* log_or_null) {
+	char message[128];
+	snprintf(message, sizeof(message), "Object cache: %d hits, %d misses\n", project->cache_hits, project->cache_misses);
+	BUILD_LogPrint1(log_or_null, message);
+}
+
+static bool BUILD_EndsWith(const char* string, const char* end) {
+	size_t string_len = strlen(string), end_len = strlen(end);
+	return string_len >= end_len && memcmp(string + string_len - end_len, end, end_len) == 0;
+}
+
+static bool BUILD_IsCPPFile(const char* file) {
+	return BUILD_EndsWith(file, ".cpp") || BUILD_EndsWith(file, ".cc") || BUILD_EndsWith(file, ".cxx");
+}
+
+static long BUILD_FileSize(const char* file) {
+	FILE* f = fopen(file, "rb");
+	if (f == NULL) return -1;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fclose(f);
+	return size;
+}
+
+// Rewriting a file with the same contents would still make it look changed to anything that watches modification times
+static bool BUILD_WriteFileIfChanged(const char* file, const char* data, size_t size) {
+	FILE* f = fopen(file, "rb");
+	if (f) {
+		bool same = true;
+		size_t offset = 0;
+		char buf[4096];
+		for (size_t n; same && (n = fread(buf, 1, sizeof(buf), f)) > 0; offset += n) {
+			same = offset + n <= size && memcmp(buf, data + offset, n) == 0;
+		}
+		fclose(f);
+		if (same && offset == size) return true;
+	}
+
+	f = fopen(file, "wb");
+	if (f == NULL) return false;
+	bool ok = fwrite(data, 1, size, f) == size;
+	fclose(f);
+	return ok;
+}
+
+// Returns `opts.working_directory`, or the working directory of the process if it's not set. The result must be freed.
+static char* BUILD_GetWorkingDirectory(BUILD_Project* project) {
+	if (project->opts.working_directory) return BUILD_Concat2(project->opts.working_directory, "");
+#ifdef _WIN32
+	char cwd[MAX_PATH];
+	bool has_cwd = GetCurrentDirectoryA(MAX_PATH, cwd);
+#else
+	char cwd[4096];
+	bool has_cwd = getcwd(cwd, sizeof(cwd)) != NULL;
+#endif
+	return BUILD_Concat2(has_cwd ? cwd : ".", "");
+}
+
+static char* BUILD_AbsolutePath(BUILD_Project* project, const char* path) {
+#ifdef _WIN32
+	bool is_absolute = path[0] == '/' || path[0] == '\\' || (path[0] != 0 && path[1] == ':');
+#else
+	bool is_absolute = path[0] == '/';
+#endif
+	if (is_absolute) return BUILD_Concat2(path, "");
+
+	char* working_directory = BUILD_GetWorkingDirectory(project);
+	char* result = BUILD_Concat3(working_directory, "/", path);
+	free(working_directory);
+	return result;
+}
+
+static bool BUILD_IsUnityBuildMember(BUILD_Project* project, const char* code_file) {
+	return project->opts.unity_build && BUILD_IsCPPFile(code_file) && BUILD_FileSize(code_file) <= BUILD_UNITY_BUILD_MAX_FILE_SIZE;
+}
+
+typedef struct BUILD_TranslationUnits {
+	BUILD_Array(char*) files;
+	int unity_file; // index into `files`, or -1
+	uint64_t unity_hash; // hash of the paths and contents of the files included by the unity file
+} BUILD_TranslationUnits;
+
+// Returns the source files to compile. With `unity_build`, the C++ files that are small enough are replaced by a single
+// file that includes them, at the position of the first one. The unity file is only written if its contents changed.
+// The object cache only hashes the contents of the unity file itself, so `unity_hash` must be added to its cache key.
+static bool BUILD_GetTranslationUnits(BUILD_Project* project, const char* abs_build_directory, BUILD_TranslationUnits* out) {
+	memset(out, 0, sizeof(*out));
+	out->unity_file = -1;
+	out->unity_hash = BUILD_HASH_SEED;
+
+	int unity_members_count = 0;
+	for (int i = 0; i < project->code_files.count; i++) {
+		if (BUILD_IsUnityBuildMember(project, project->code_files.data[i])) unity_members_count++;
+	}
+
+	BUILD_StrBuilder unity_source = {0};
+	for (int i = 0; i < project->code_files.count; i++) {
+		const char* code_file = project->code_files.data[i];
+		if (unity_members_count >= 2 && BUILD_IsUnityBuildMember(project, code_file)) {
+			char* abs_code_file = BUILD_AbsolutePath(project, code_file);
+			BUILD_Print3(&unity_source, "#include \"", abs_code_file, "\"\n");
+			out->unity_hash = BUILD_HashString(abs_code_file, out->unity_hash);
+			out->unity_hash = BUILD_HashFileContents(abs_code_file, out->unity_hash);
+			free(abs_code_file);
+
+			if (out->unity_file == -1) {
+				out->unity_file = out->files.count;
+				BUILD_ArrayPush(&out->files, NULL); // set below
+			}
+		}
+		else {
+			BUILD_ArrayPush(&out->files, BUILD_Concat2(code_file, ""));
+		}
+	}
+
+	bool ok = true;
+	if (out->unity_file != -1) {
+		char* unity_file = BUILD_Concat4(abs_build_directory, "/", project->name, ".unity.cpp");
+		ok = BUILD_WriteFileIfChanged(unity_file, unity_source.data, unity_source.count);
+		out->files.data[out->unity_file] = unity_file;
+	}
+	BUILD_ArrayFree(&unity_source);
+	return ok;
+}
+
+static void BUILD_TranslationUnitsFree(BUILD_TranslationUnits* units) {
+	for (int i = 0; i < units->files.count; i++) free(units->files.data[i]);
+	BUILD_ArrayFree(&units->files);
+}
+
+typedef BUILD_Array(char*) BUILD_FileList;
+
+// The list is left empty, so it can be reused
+static void BUILD_FileListFree(BUILD_FileList* list) {
+	for (int i = 0; i < list->count; i++) free(list->data[i]);
+	BUILD_ArrayFree(list);
+	memset(list, 0, sizeof(*list));
+}
+
+// Nanoseconds on POSIX and 100-nanosecond intervals on Windows, or 0 if the file doesn't exist
+static uint64_t BUILD_FileModtime(const char* file) {
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(file, GetFileExInfoStandard, &data)) return 0;
+	return ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat st;
+	if (stat(file, &st) != 0) return 0;
+	return (uint64_t)st.st_mtim.tv_sec * 1000000000ull + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+}
+
+// Reads the files that the compiler wrote into a dependency file: a make rule from -MD with GCC/Clang, e.g.
+// "a.o: a.cpp a.h \<newline> b.h", where spaces in paths are escaped with a backslash, or the JSON from /sourceDependencies
+// with MSVC, where the headers are listed in "Includes". Returns false if the file couldn't be read.
+static bool BUILD_ReadDependencyFile(const char* dependency_file, BUILD_FileList* out_files) {
+	FILE* f = fopen(dependency_file, "rb");
+	if (f == NULL) return false;
+
+	BUILD_StrBuilder text = {0};
+	char buf[4096];
+	for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) {
+		for (size_t i = 0; i < n; i++) BUILD_ArrayPush(&text, buf[i]);
+	}
+	fclose(f);
+	BUILD_PrintNullTermination(&text);
+
+	BUILD_StrBuilder path = {0};
+#ifdef _WIN32
+	const char* p = strstr(text.data, "\"Includes\"");
+	p = p ? strchr(p, '[') : NULL;
+	for (; p && *p && *p != ']'; p++) {
+		if (*p != '"') continue;
+		path.count = 0;
+		for (p++; *p && *p != '"'; p++) {
+			if (*p == '\\' && p[1]) p++; // JSON escapes; paths only use \\ and \"
+			BUILD_ArrayPush(&path, *p);
+		}
+		BUILD_PrintNullTermination(&path);
+		BUILD_ArrayPush(out_files, BUILD_Concat2(path.data, ""));
+		if (*p == 0) break;
+	}
+#else
+	const char* p = text.data;
+	for (; *p && *p != ':'; p++) { if (*p == '\\' && p[1]) p++; } // skip the target
+	for (p = *p ? p + 1 : p; *p;) {
+		path.count = 0;
+		for (; *p; p++) {
+			if (*p == '\\' && p[1] == '\n') { p++; break; } // line continuation
+			if (*p == '\\' && p[1] == '\r' && p[2] == '\n') { p += 2; break; }
+			if (*p == '\\' && (p[1] == ' ' || p[1] == '#' || p[1] == '\\')) { p++; }
+			else if (*p == '$' && p[1] == '$') { p++; }
+			else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') break;
+			BUILD_ArrayPush(&path, *p);
+		}
+		if (*p) p++;
+		if (path.count > 0) {
+			BUILD_PrintNullTermination(&path);
+			BUILD_ArrayPush(out_files, BUILD_Concat2(path.data, ""));
+		}
+	}
+#endif
+	BUILD_ArrayFree(&path);
+	BUILD_ArrayFree(&text);
+	return true;
+}
+
+// Returns true if the output is missing, if its dependency file can't be read, or if any file in it has changed since
+// the output was written. The dependencies are added to `out_files`.
+static bool BUILD_OutputIsStale(const char* output_file, const char* dependency_file, BUILD_FileList* out_files) {
+	uint64_t output_modtime = BUILD_FileModtime(output_file);
+	if (output_modtime == 0 || !BUILD_ReadDependencyFile(dependency_file, out_files)) return true;
+
+	for (int i = 0; i < out_files->count; i++) {
+		uint64_t modtime = BUILD_FileModtime(out_files->data[i]);
+		if (modtime == 0 || modtime > output_modtime) return true;
+	}
+	return false;
+}
+
+// Adds the files to `project->dependencies`, skipping the ones that are already there. The strings are moved, so
+// `files` is left empty.
+static void BUILD_AddDependencies(BUILD_Project* project, BUILD_FileList* files) {
+	for (int i = 0; i < files->count; i++) {
+		bool found = false;
+		for (int j = 0; j < project->dependencies.count && !found; j++) {
+			found = strcmp(project->dependencies.data[j], files->data[i]) == 0;
+		}
+		if (found) free(files->data[i]);
+		else BUILD_ArrayPush(&project->dependencies, files->data[i]);
+	}
+	files->count = 0;
+}
+
+#ifdef _WIN32
 typedef struct BUILD_VSWhereLog {
 	BUILD_Log base;
 	BUILD_StrBuilder output;
@@ -578,7 +979,7 @@ BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_
 		BUILD_WPrintNullTermination(&vswhere_args);
 
 		uint32_t vswhere_exit_code = 0;
-		ok = BUILD_RunProcess(vswhere_args.data, &vswhere_exit_code, &vswhere_log.base) && vswhere_exit_code == 0;
+		ok = BUILD_RunProcess(vswhere_args.data, NULL, &vswhere_exit_code, &vswhere_log.base) && vswhere_exit_code == 0;
 		BUILD_ArrayFree(&vswhere_args);
 	}
 
@@ -683,22 +1084,12 @@ BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_
 			if (project->opts.c_runtime_library_debug) __debugbreak(); // TODO
 			if (project->opts.c_runtime_library_dll)   __debugbreak(); // TODO
 
-			for (int i = 0; i < project->code_files.count; i++) {
-				BUILD_WPrint(&msvc_args, L" \"");
-				BUILD_WPrintUTF8(&msvc_args, project->code_files.data[i]);
-				BUILD_WPrint(&msvc_args, L"\"");
-			}
-
 			for (int i = 0; i < project->include_dirs.count; i++) {
 				BUILD_WPrint(&msvc_args, L" \"/I");
 				BUILD_WPrintUTF8(&msvc_args, project->include_dirs.data[i]);
 				BUILD_WPrint(&msvc_args, L"\"");
 			}
 
-			BUILD_WPrint(&msvc_args, L" \"/Fo");
-			BUILD_WPrintUTF8(&msvc_args, abs_build_directory.data);
-			BUILD_WPrint(&msvc_args, L"/\"");
-			
 			// MSVC include folder
 			BUILD_WPrint(&msvc_args, L" \"/I");
 			BUILD_WPrintUTF8(&msvc_args, vswhere_log.output.data);
@@ -726,6 +1117,154 @@ BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_
 			BUILD_WPrint(&msvc_args, L"\\Include\\");
 			BUILD_WPrint(&msvc_args, win_sdk_version);
 			BUILD_WPrint(&msvc_args, L".0\\um\"");
+
+			const char* cache_dir = project->opts.object_cache_directory;
+			project->cache_hits = 0;
+			project->cache_misses = 0;
+
+			if (cache_dir) {
+				// Everything in msvc_args so far is common to each source file. Compile each source file that isn't
+				// in the cache separately with /c, then pass the object files to cl.exe instead of the source files.
+				char* working_directory = BUILD_GetWorkingDirectory(project);
+				uint64_t args_hash = BUILD_Hash(msvc_args.data, msvc_args.count * sizeof(wchar_t), BUILD_HASH_SEED);
+				args_hash = BUILD_HashString(working_directory, args_hash); // for relative include directories
+				free(working_directory);
+				args_hash = BUILD_HashCacheInputs(project, args_hash);
+
+				// The precompiled header is created by compiling an empty source file that force-includes it. Its object
+				// file must be linked too.
+				char* pch_file = NULL;
+				bool pch_rebuilt = false;
+				if (project->opts.precompiled_header) {
+					pch_file = BUILD_CachedObjectFilePath(project, project->opts.precompiled_header, args_hash, ".pch");
+					char* pch_object_file = BUILD_Concat2(pch_file, ".obj");
+					char* pch_dependency_file = BUILD_Concat2(pch_file, ".json");
+
+					BUILD_FileList dependencies = {0};
+					pch_rebuilt = !BUILD_FileExists(pch_file) || BUILD_OutputIsStale(pch_object_file, pch_dependency_file, &dependencies);
+					if (pch_rebuilt) {
+						char* pch_source_file = BUILD_Concat2(pch_file, ".cpp");
+						ok = BUILD_WriteFileIfChanged(pch_source_file, "", 0);
+
+						BUILD_WStrBuilder compile_args = {0};
+						for (int j = 0; j < msvc_args.count; j++) BUILD_ArrayPush(&compile_args, msvc_args.data[j]);
+						BUILD_WPrint(&compile_args, L" /c \"");
+						BUILD_WPrintUTF8(&compile_args, pch_source_file);
+						BUILD_WPrint(&compile_args, L"\" \"/Yc");
+						BUILD_WPrintUTF8(&compile_args, project->opts.precompiled_header);
+						BUILD_WPrint(&compile_args, L"\" \"/FI");
+						BUILD_WPrintUTF8(&compile_args, project->opts.precompiled_header);
+						BUILD_WPrint(&compile_args, L"\" \"/Fp");
+						BUILD_WPrintUTF8(&compile_args, pch_file);
+						BUILD_WPrint(&compile_args, L"\" \"/Fo");
+						BUILD_WPrintUTF8(&compile_args, pch_object_file);
+						BUILD_WPrint(&compile_args, L"\" /sourceDependencies \"");
+						BUILD_WPrintUTF8(&compile_args, pch_dependency_file);
+						BUILD_WPrint(&compile_args, L"\"");
+						BUILD_WPrintNullTermination(&compile_args);
+
+						uint32_t exit_code = 0;
+						ok = ok && BUILD_RunProcess(compile_args.data, project->opts.working_directory, &exit_code, log_or_null) && exit_code == 0;
+						if (!ok) {
+							remove(pch_file);
+							remove(pch_object_file);
+						}
+						BUILD_ArrayFree(&compile_args);
+						free(pch_source_file);
+
+						BUILD_FileListFree(&dependencies);
+						if (ok) BUILD_ReadDependencyFile(pch_dependency_file, &dependencies);
+					}
+					BUILD_AddDependencies(project, &dependencies);
+					BUILD_FileListFree(&dependencies);
+					free(pch_dependency_file);
+
+					BUILD_WPrint(&msvc_args, L" \"");
+					BUILD_WPrintUTF8(&msvc_args, pch_object_file);
+					BUILD_WPrint(&msvc_args, L"\"");
+					free(pch_object_file);
+				}
+
+				BUILD_TranslationUnits units;
+				bool units_ok = BUILD_GetTranslationUnits(project, abs_build_directory.data, &units);
+				ok = ok && units_ok;
+
+				for (int i = 0; ok && i < units.files.count; i++) {
+					const char* code_file = units.files.data[i];
+					bool uses_pch = pch_file && BUILD_IsCPPFile(code_file);
+
+					uint64_t file_args_hash = args_hash;
+					if (i == units.unity_file) file_args_hash = BUILD_Hash(&units.unity_hash, sizeof(units.unity_hash), file_args_hash);
+					if (uses_pch) file_args_hash = BUILD_HashString(pch_file, file_args_hash);
+					char* object_file = BUILD_CachedObjectFilePath(project, code_file, file_args_hash, ".obj");
+					char* dependency_file = BUILD_Concat2(object_file, ".json");
+
+					BUILD_FileList dependencies = {0};
+					if (uses_pch) BUILD_ArrayPush(&dependencies, BUILD_Concat2(pch_file, ""));
+					if (!(uses_pch && pch_rebuilt) && !BUILD_OutputIsStale(object_file, dependency_file, &dependencies)) {
+						project->cache_hits++;
+					}
+					else {
+						project->cache_misses++;
+
+						BUILD_WStrBuilder compile_args = {0};
+						for (int j = 0; j < msvc_args.count; j++) BUILD_ArrayPush(&compile_args, msvc_args.data[j]);
+						if (uses_pch) {
+							BUILD_WPrint(&compile_args, L" \"/Yu");
+							BUILD_WPrintUTF8(&compile_args, project->opts.precompiled_header);
+							BUILD_WPrint(&compile_args, L"\" \"/FI");
+							BUILD_WPrintUTF8(&compile_args, project->opts.precompiled_header);
+							BUILD_WPrint(&compile_args, L"\" \"/Fp");
+							BUILD_WPrintUTF8(&compile_args, pch_file);
+							BUILD_WPrint(&compile_args, L"\"");
+						}
+						BUILD_WPrint(&compile_args, L" /c \"");
+						BUILD_WPrintUTF8(&compile_args, code_file);
+						BUILD_WPrint(&compile_args, L"\" \"/Fo");
+						BUILD_WPrintUTF8(&compile_args, object_file);
+						BUILD_WPrint(&compile_args, L"\" /sourceDependencies \"");
+						BUILD_WPrintUTF8(&compile_args, dependency_file);
+						BUILD_WPrint(&compile_args, L"\"");
+						BUILD_WPrintNullTermination(&compile_args);
+
+						uint32_t exit_code = 0;
+						ok = BUILD_RunProcess(compile_args.data, project->opts.working_directory, &exit_code, log_or_null) && exit_code == 0;
+						if (!ok) remove(object_file); // don't leave a broken object file in the cache
+						BUILD_ArrayFree(&compile_args);
+
+						BUILD_FileListFree(&dependencies);
+						if (uses_pch) BUILD_ArrayPush(&dependencies, BUILD_Concat2(pch_file, ""));
+						if (ok) BUILD_ReadDependencyFile(dependency_file, &dependencies);
+					}
+					BUILD_ArrayPush(&dependencies, BUILD_Concat2(code_file, "")); // /sourceDependencies lists only the includes
+					BUILD_AddDependencies(project, &dependencies);
+					BUILD_FileListFree(&dependencies);
+					free(dependency_file);
+
+					BUILD_WPrint(&msvc_args, L" \"");
+					BUILD_WPrintUTF8(&msvc_args, object_file);
+					BUILD_WPrint(&msvc_args, L"\"");
+					free(object_file);
+				}
+				BUILD_LogCacheStats(project, log_or_null);
+				BUILD_TranslationUnitsFree(&units);
+				free(pch_file);
+			}
+			else {
+				// Without the object cache, there's nowhere to keep the precompiled header, so `precompiled_header` is ignored
+				BUILD_TranslationUnits units;
+				ok = BUILD_GetTranslationUnits(project, abs_build_directory.data, &units);
+				for (int i = 0; i < units.files.count; i++) {
+					BUILD_WPrint(&msvc_args, L" \"");
+					BUILD_WPrintUTF8(&msvc_args, units.files.data[i]);
+					BUILD_WPrint(&msvc_args, L"\"");
+				}
+				BUILD_TranslationUnitsFree(&units);
+
+				BUILD_WPrint(&msvc_args, L" \"/Fo");
+				BUILD_WPrintUTF8(&msvc_args, abs_build_directory.data);
+				BUILD_WPrint(&msvc_args, L"/\"");
+			}
 			
 			switch (project->opts.target) {
 			case BUILD_Target_Executable: break;
@@ -777,8 +1316,12 @@ BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_
 
 			BUILD_WPrintNullTermination(&msvc_args);
 
-			uint32_t exit_code = 0;
-			ok = BUILD_RunProcess(msvc_args.data, &exit_code, log_or_null) && exit_code == 0;
+			// With the object cache, object files are already compiled at this point and only linking is left
+			bool cl_has_work = !(cache_dir && project->opts.target == BUILD_Target_ObjectFile);
+			if (ok && cl_has_work) {
+				uint32_t exit_code = 0;
+				ok = BUILD_RunProcess(msvc_args.data, project->opts.working_directory, &exit_code, log_or_null) && exit_code == 0;
+			}
 
 			BUILD_ArrayFree(&abs_build_directory);
 		}
@@ -790,6 +1333,65 @@ BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_
 	return ok;
 }
 
+BUILD_API bool BUILD_CompileProjects(BUILD_ProjectBuild* builds, int builds_count, int max_parallel_jobs) {
+	bool* done = (bool*)calloc(builds_count, sizeof(bool));
+
+	// Each pass builds the projects whose link dependencies are done, until no project can be built anymore
+	for (bool progressed = true; progressed;) {
+		progressed = false;
+		for (int i = 0; i < builds_count; i++) {
+			if (done[i]) continue;
+			BUILD_Project* project = builds[i].project;
+
+			bool ready = true, dependency_failed = false;
+			int added_linker_inputs = 0;
+			for (int j = 0; j < project->link_dependencies.count; j++) {
+				for (int k = 0; k < builds_count; k++) {
+					if (builds[k].project != project->link_dependencies.data[j]) continue;
+					if (!done[k]) ready = false;
+					else if (!builds[k].ok) dependency_failed = true;
+				}
+			}
+			if (!ready) continue;
+
+			progressed = true;
+			done[i] = true;
+			builds[i].ok = false;
+			if (dependency_failed) {
+				BUILD_LogPrint3(builds[i].log_or_null, "Not linking ", project->name, ", because a project it links with failed to build\n");
+				continue;
+			}
+
+			// Link against the import libraries of the dependencies
+			for (int j = 0; j < project->link_dependencies.count; j++) {
+				for (int k = 0; k < builds_count; k++) {
+					if (builds[k].project != project->link_dependencies.data[j]) continue;
+					char* import_lib = BUILD_Concat4(builds[k].build_directory, "/", builds[k].project->name, ".lib");
+					BUILD_AddLinkerInput(project, import_lib);
+					added_linker_inputs++;
+				}
+			}
+
+			builds[i].ok = BUILD_CompileProject(project, builds[i].build_directory, ".", builds[i].log_or_null);
+
+			for (int j = 0; j < added_linker_inputs; j++) {
+				free((char*)project->linker_inputs.data[--project->linker_inputs.count]);
+			}
+		}
+	}
+
+	bool all_ok = true;
+	for (int i = 0; i < builds_count; i++) {
+		if (!done[i]) {
+			BUILD_LogPrint3(builds[i].log_or_null, "Not linking ", builds[i].project->name, ", because its link dependencies are circular\n");
+			builds[i].ok = false;
+		}
+		all_ok = all_ok && builds[i].ok;
+	}
+	free(done);
+	return all_ok;
+}
+
 BUILD_API bool BUILD_CreateDirectory(const char* directory) {
 	bool success = CreateDirectoryA(directory, NULL); // TODO: Unicode support
 	return success || GetLastError() == ERROR_ALREADY_EXISTS;
@@ -904,5 +1506,590 @@ BUILD_API bool BUILD_CreateVisualStudioSolution(const char* project_directory, c
 	return ok;
 }
 
+#else // _WIN32
+
+typedef BUILD_Array(char*) BUILD_Args;
+
+static void BUILD_PushArg2(BUILD_Args* args, const char* a, const char* b) {
+	char* arg = BUILD_Concat2(a, b);
+	BUILD_ArrayPush(args, arg);
+}
+
+#define BUILD_PushArg(ARGS, A) BUILD_PushArg2(ARGS, A, "")
+
+// Pushes each whitespace-separated argument in `arg_string`. Quotes aren't supported.
+static void BUILD_PushArgString(BUILD_Args* args, const char* arg_string) {
+	for (const char* p = arg_string; *p;) {
+		if (*p == ' ' || *p == '\t') { p++; continue; }
+
+		BUILD_StrBuilder arg = {0};
+		for (; *p && *p != ' ' && *p != '\t'; p++) BUILD_ArrayPush(&arg, *p);
+		BUILD_PrintNullTermination(&arg);
+		BUILD_ArrayPush(args, arg.data);
+	}
+}
+
+static void BUILD_ArgsFree(BUILD_Args* args) {
+	for (int i = 0; i < args->count; i++) free(args->data[i]);
+	BUILD_ArrayFree(args);
+}
+
+static bool BUILD_ProgramIsInPath(const char* program) {
+	const char* path = getenv("PATH");
+	if (path == NULL) return false;
+
+	bool found = false;
+	for (const char* dir = path; !found;) {
+		const char* dir_end = strchr(dir, ':');
+		if (dir_end == NULL) dir_end = dir + strlen(dir);
+
+		BUILD_StrBuilder file = {0};
+		for (const char* p = dir; p < dir_end; p++) BUILD_ArrayPush(&file, *p);
+		BUILD_Print2(&file, "/", program);
+		BUILD_PrintNullTermination(&file);
+		found = access(file.data, X_OK) == 0;
+		BUILD_ArrayFree(&file);
+
+		if (*dir_end == 0) break;
+		dir = dir_end + 1;
+	}
+	return found;
+}
+
+// Object files are named after the source file, without its directory. Same as /Fo with a directory in MSVC.
+static char* BUILD_ObjectFilePath(const char* abs_build_directory, const char* code_file) {
+	const char* name = strrchr(code_file, '/');
+	name = name ? name + 1 : code_file;
+
+	BUILD_StrBuilder path = {0};
+	BUILD_Print2(&path, abs_build_directory, "/");
+	const char* ext = strrchr(name, '.');
+	for (const char* p = name; p < (ext ? ext : name + strlen(name)); p++) BUILD_ArrayPush(&path, *p);
+	BUILD_Print(&path, ".o");
+	BUILD_PrintNullTermination(&path);
+	return path.data;
+}
+
+// A compiler or linker invocation
+typedef struct BUILD_Job {
+	BUILD_Args args;
+	int build_index;
+	bool is_link;
+	bool remove_output_on_failure; // for object files in the cache
+	int wait_for_job; // a job that must finish before this one can start, e.g. the precompiled header, or -1
+	char* output_file;
+	char* dependency_file; // written by the compiler with -MD when the object cache is used, otherwise NULL
+
+	bool started;
+	bool finished;
+	pid_t pid;
+	int pipe_fd; // -1 once the process has closed its output
+	BUILD_StrBuilder output; // printed to the log when the job finishes, so that the output of parallel jobs isn't interleaved
+} BUILD_Job;
+
+typedef enum BUILD_BuildState {
+	BUILD_BuildState_InProgress,
+	BUILD_BuildState_Succeeded,
+	BUILD_BuildState_Failed,
+} BUILD_BuildState;
+
+typedef struct BUILD_BuildProgress {
+	BUILD_BuildState state;
+	int pending_compile_jobs;
+	int link_job; // -1 for BUILD_Target_ObjectFile
+	char* output_file; // the linked library or executable
+} BUILD_BuildProgress;
+
+typedef BUILD_Array(BUILD_Job) BUILD_Jobs;
+
+// Adds the compile jobs of the source files that aren't in the object cache, and the link job
+static void BUILD_AddProjectJobs(BUILD_ProjectBuild* builds, int build_index, BUILD_BuildProgress* progress, BUILD_Jobs* jobs) {
+	BUILD_Project* project = builds[build_index].project;
+	BUILD_Log* log_or_null = builds[build_index].log_or_null;
+
+	bool has_cpp_files = false;
+	for (int i = 0; i < project->code_files.count; i++) {
+		if (BUILD_IsCPPFile(project->code_files.data[i])) has_cpp_files = true;
+	}
+
+	const char* compiler = project->opts.posix.compiler;
+	if (compiler == NULL) {
+		bool use_clang = BUILD_ProgramIsInPath("clang");
+		compiler = has_cpp_files ? (use_clang ? "clang++" : "g++") : (use_clang ? "clang" : "gcc");
+	}
+	bool compiler_is_clang = strstr(compiler, "clang") != NULL;
+
+	const char* linker = project->opts.posix.linker;
+	if (linker == NULL) {
+		/**/ if (BUILD_ProgramIsInPath("mold"))    linker = "mold";
+		else if (BUILD_ProgramIsInPath("ld.lld"))  linker = "lld";
+		else if (BUILD_ProgramIsInPath("ld.gold")) linker = "gold";
+	}
+
+	// The same warnings as in the MSVC version. -Wall is stricter than /W3, so only the warnings that are explicitly
+	// enabled there are enabled here.
+	BUILD_Args compile_args = {0};
+	BUILD_PushArg(&compile_args, compiler);
+	BUILD_PushArg(&compile_args, "-Werror"); // treat warnings as errors
+
+	for (int i = 0; i < project->defines.count; i++) {
+		BUILD_PushArg2(&compile_args, "-D", project->defines.data[i]);
+	}
+
+	if (project->opts.debug_info) BUILD_PushArg(&compile_args, "-g");
+	if (project->opts.enable_optimizations) BUILD_PushArg(&compile_args, "-O2");
+	if (project->opts.enable_warning_unused_variables) BUILD_PushArg(&compile_args, "-Wunused-variable");
+	if (!project->opts.disable_warning_unhandled_switch_cases) BUILD_PushArg(&compile_args, "-Wswitch");
+	if (!project->opts.disable_warning_shadowed_locals && !compiler_is_clang) {
+		BUILD_PushArg(&compile_args, "-Wshadow=local"); // clang has no warning for shadowed locals only, like C4456 in MSVC
+	}
+
+	if (project->opts.target == BUILD_Target_DynamicLibrary) {
+		BUILD_PushArg(&compile_args, "-fPIC");
+		BUILD_PushArg(&compile_args, "-fvisibility=hidden"); // export only what's marked for export, like a DLL
+	}
+
+	for (int i = 0; i < project->extra_compiler_args.count; i++) {
+		BUILD_PushArgString(&compile_args, project->extra_compiler_args.data[i]);
+	}
+
+	// The runtime library options only apply to MSVC
+
+	for (int i = 0; i < project->include_dirs.count; i++) {
+		BUILD_PushArg2(&compile_args, "-I", project->include_dirs.data[i]);
+	}
+
+	const char* cache_dir = project->opts.object_cache_directory;
+	project->cache_hits = 0;
+	project->cache_misses = 0;
+	for (int i = 0; i < project->dependencies.count; i++) free(project->dependencies.data[i]);
+	project->dependencies.count = 0;
+
+	uint64_t args_hash = BUILD_HASH_SEED;
+	if (cache_dir) {
+		char* working_directory = BUILD_GetWorkingDirectory(project);
+		args_hash = BUILD_HashString(working_directory, args_hash); // for relative include directories
+		free(working_directory);
+		for (int i = 0; i < compile_args.count; i++) args_hash = BUILD_HashString(compile_args.data[i], args_hash);
+		args_hash = BUILD_HashCacheInputs(project, args_hash);
+	}
+
+	BUILD_TranslationUnits units;
+	if (!BUILD_GetTranslationUnits(project, builds[build_index].build_directory, &units)) {
+		BUILD_LogPrint3(log_or_null, "Failed to write the unity build file of ", project->name, "\n");
+		progress->state = BUILD_BuildState_Failed;
+	}
+
+	// The compiler finds the precompiled header next to the header passed to -include, so the precompiled header is
+	// included through a wrapper header that's named after its cache key. The wrapper is compiled first, by a job that the
+	// C++ source files wait for.
+	char* pch_include = NULL;
+	char* pch_output = NULL;
+	int pch_job = -1;
+	if (cache_dir && project->opts.precompiled_header && has_cpp_files) {
+		pch_include = BUILD_CachedObjectFilePath(project, project->opts.precompiled_header, args_hash, ".pch.h");
+
+		char* abs_header = BUILD_AbsolutePath(project, project->opts.precompiled_header);
+		BUILD_StrBuilder wrapper = {0};
+		BUILD_Print3(&wrapper, "#include \"", abs_header, "\"\n");
+		if (!BUILD_WriteFileIfChanged(pch_include, wrapper.data, wrapper.count)) {
+			BUILD_LogPrint3(log_or_null, "Failed to write ", pch_include, "\n");
+			progress->state = BUILD_BuildState_Failed;
+		}
+		BUILD_ArrayFree(&wrapper);
+		free(abs_header);
+
+		BUILD_Job job = {0};
+		job.build_index = build_index;
+		job.wait_for_job = -1;
+		job.pipe_fd = -1;
+		pch_output = BUILD_Concat2(pch_include, compiler_is_clang ? ".pch" : ".gch");
+		job.output_file = BUILD_Concat2(pch_output, "");
+		job.dependency_file = BUILD_Concat2(pch_output, ".d");
+		job.remove_output_on_failure = true;
+
+		BUILD_FileList dependencies = {0};
+		if (!BUILD_OutputIsStale(job.output_file, job.dependency_file, &dependencies)) {
+			BUILD_AddDependencies(project, &dependencies);
+			free(job.output_file);
+			free(job.dependency_file);
+		}
+		else {
+			for (int j = 0; j < compile_args.count; j++) BUILD_PushArg(&job.args, compile_args.data[j]);
+			BUILD_PushArg(&job.args, "-x");
+			BUILD_PushArg(&job.args, "c++-header");
+			BUILD_PushArg(&job.args, pch_include);
+			BUILD_PushArg(&job.args, "-o");
+			BUILD_PushArg(&job.args, job.output_file);
+			BUILD_PushArg(&job.args, "-MD");
+			BUILD_PushArg(&job.args, "-MF");
+			BUILD_PushArg(&job.args, job.dependency_file);
+			pch_job = jobs->count;
+			BUILD_ArrayPush(jobs, job);
+			progress->pending_compile_jobs++;
+		}
+		BUILD_FileListFree(&dependencies);
+	}
+
+	BUILD_Job link_job = {0};
+	link_job.build_index = build_index;
+	link_job.is_link = true;
+	link_job.wait_for_job = -1;
+	link_job.pipe_fd = -1;
+	BUILD_PushArg(&link_job.args, compiler);
+
+	for (int i = 0; i < units.files.count; i++) {
+		const char* code_file = units.files.data[i];
+		bool uses_pch = pch_include && BUILD_IsCPPFile(code_file);
+
+		BUILD_Job job = {0};
+		job.build_index = build_index;
+		job.wait_for_job = uses_pch ? pch_job : -1;
+		job.pipe_fd = -1;
+
+		if (cache_dir) {
+			uint64_t file_args_hash = args_hash;
+			if (i == units.unity_file) file_args_hash = BUILD_Hash(&units.unity_hash, sizeof(units.unity_hash), file_args_hash);
+			if (uses_pch) file_args_hash = BUILD_HashString(pch_include, file_args_hash);
+
+			job.output_file = BUILD_CachedObjectFilePath(project, code_file, file_args_hash, ".o");
+			job.dependency_file = BUILD_Concat2(job.output_file, ".d");
+			job.remove_output_on_failure = true;
+
+			// GCC doesn't list the precompiled header or its headers in the dependency files of the source files that use
+			// it, so they're recompiled whenever the precompiled header is.
+			BUILD_FileList dependencies = {0};
+			if (uses_pch) BUILD_ArrayPush(&dependencies, BUILD_Concat2(pch_output, ""));
+			bool stale = (uses_pch && pch_job != -1) || BUILD_OutputIsStale(job.output_file, job.dependency_file, &dependencies);
+			if (!stale) BUILD_AddDependencies(project, &dependencies);
+			BUILD_FileListFree(&dependencies);
+
+			if (!stale) {
+				project->cache_hits++;
+				BUILD_ArrayPush(&link_job.args, job.output_file);
+				free(job.dependency_file);
+				continue;
+			}
+			project->cache_misses++;
+		}
+		else {
+			job.output_file = BUILD_ObjectFilePath(builds[build_index].build_directory, code_file);
+		}
+
+		for (int j = 0; j < compile_args.count; j++) BUILD_PushArg(&job.args, compile_args.data[j]);
+		if (uses_pch) {
+			BUILD_PushArg(&job.args, "-include");
+			BUILD_PushArg(&job.args, pch_include);
+		}
+		BUILD_PushArg(&job.args, "-c");
+		BUILD_PushArg(&job.args, code_file);
+		BUILD_PushArg(&job.args, "-o");
+		BUILD_PushArg(&job.args, job.output_file);
+		if (job.dependency_file) {
+			// Not -MMD, as that would leave out the headers in -isystem directories
+			BUILD_PushArg(&job.args, "-MD");
+			BUILD_PushArg(&job.args, "-MF");
+			BUILD_PushArg(&job.args, job.dependency_file);
+		}
+		BUILD_ArrayPush(jobs, job);
+		progress->pending_compile_jobs++;
+
+		BUILD_PushArg(&link_job.args, job.output_file);
+	}
+	if (cache_dir) BUILD_LogCacheStats(project, log_or_null);
+	BUILD_TranslationUnitsFree(&units);
+	free(pch_include);
+	free(pch_output);
+
+	progress->link_job = -1;
+	if (project->opts.target != BUILD_Target_ObjectFile) {
+		if (project->opts.target == BUILD_Target_DynamicLibrary) BUILD_PushArg(&link_job.args, "-shared");
+		if (project->opts.disable_aslr && project->opts.target == BUILD_Target_Executable) BUILD_PushArg(&link_job.args, "-no-pie");
+		if (project->opts.debug_info) BUILD_PushArg(&link_job.args, "-g");
+		if (linker) BUILD_PushArg2(&link_job.args, "-fuse-ld=", linker);
+
+		link_job.output_file = BUILD_Concat3(builds[build_index].build_directory, "/", project->name);
+		if (project->opts.target == BUILD_Target_DynamicLibrary) {
+			char* so_file = BUILD_Concat2(link_job.output_file, ".so");
+			free(link_job.output_file);
+			link_job.output_file = so_file;
+		}
+		BUILD_PushArg(&link_job.args, "-o");
+		BUILD_PushArg(&link_job.args, link_job.output_file);
+		progress->output_file = link_job.output_file;
+
+		for (int i = 0; i < project->linker_inputs.count; i++) {
+			BUILD_PushArg(&link_job.args, project->linker_inputs.data[i]);
+		}
+		for (int i = 0; i < project->extra_linker_args.count; i++) {
+			BUILD_PushArgString(&link_job.args, project->extra_linker_args.data[i]);
+		}
+		// The outputs of link dependencies are added when the link job starts, as they're only known by then
+
+		progress->link_job = jobs->count;
+		BUILD_ArrayPush(jobs, link_job);
+	}
+	else {
+		BUILD_ArgsFree(&link_job.args);
+	}
+
+	BUILD_ArgsFree(&compile_args);
+}
+
+// Starts args[0] with the arguments, searching PATH for it like a shell would. The output of the process, including
+// stderr, can be read from `job->pipe_fd`. If `working_directory` is NULL, the process inherits ours.
+static bool BUILD_StartJob(BUILD_Job* job, const char* working_directory) {
+	job->started = true;
+	BUILD_ArrayPush(&job->args, NULL); // posix_spawn wants a null-terminated array
+	job->args.count--;
+
+	int pipe_fds[2];
+	if (pipe(pipe_fds) != 0) return false;
+
+	// Don't let the other jobs inherit the pipe, or `read` wouldn't return 0 until they have exited too
+	fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+
+	posix_spawn_file_actions_t file_actions;
+	posix_spawn_file_actions_init(&file_actions);
+	posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&file_actions, pipe_fds[1], STDERR_FILENO);
+	if (working_directory) posix_spawn_file_actions_addchdir_np(&file_actions, working_directory);
+
+	bool ok = posix_spawnp(&job->pid, job->args.data[0], &file_actions, NULL, job->args.data, environ) == 0;
+	posix_spawn_file_actions_destroy(&file_actions);
+
+	// Close our end of the write pipe, so that `read` returns 0 when the process exits instead of blocking forever
+	close(pipe_fds[1]);
+
+	if (ok) {
+		job->pipe_fd = pipe_fds[0];
+	}
+	else {
+		close(pipe_fds[0]);
+		BUILD_Print3(&job->output, "Failed to run `", job->args.data[0], "`\n");
+	}
+	return ok;
+}
+
+// Returns true once the process has exited
+static bool BUILD_ReadJobOutput(BUILD_Job* job) {
+	char buf[512];
+	ssize_t num_read_bytes = read(job->pipe_fd, buf, sizeof(buf));
+	if (num_read_bytes < 0 && errno == EINTR) return false;
+	if (num_read_bytes > 0) {
+		for (ssize_t i = 0; i < num_read_bytes; i++) BUILD_ArrayPush(&job->output, buf[i]);
+		return false;
+	}
+
+	close(job->pipe_fd);
+	job->pipe_fd = -1;
+	return true;
+}
+
+static bool BUILD_WaitJob(BUILD_Job* job) {
+	int status;
+	pid_t waited;
+	do { waited = waitpid(job->pid, &status, 0); } while (waited < 0 && errno == EINTR);
+	return waited == job->pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int BUILD_FindBuild(BUILD_ProjectBuild* builds, int builds_count, BUILD_Project* project) {
+	for (int i = 0; i < builds_count; i++) {
+		if (builds[i].project == project) return i;
+	}
+	return -1;
+}
+
+// A link job can start once the project's own object files are compiled and its link dependencies are linked
+static bool BUILD_LinkJobIsReady(BUILD_ProjectBuild* builds, int builds_count, BUILD_BuildProgress* progress, BUILD_Job* job, bool* out_dependency_failed) {
+	*out_dependency_failed = false;
+	if (progress[job->build_index].pending_compile_jobs > 0) return false;
+
+	BUILD_Project* project = builds[job->build_index].project;
+	for (int i = 0; i < project->link_dependencies.count; i++) {
+		int dep = BUILD_FindBuild(builds, builds_count, project->link_dependencies.data[i]);
+		if (dep == -1) continue; // not part of this build, so it must have been built before
+
+		if (progress[dep].state == BUILD_BuildState_Failed) *out_dependency_failed = true;
+		if (progress[dep].state != BUILD_BuildState_Succeeded) return false;
+	}
+	return true;
+}
+
+BUILD_API bool BUILD_CompileProjects(BUILD_ProjectBuild* builds, int builds_count, int max_parallel_jobs) {
+	if (max_parallel_jobs <= 0) max_parallel_jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (max_parallel_jobs <= 0) max_parallel_jobs = 1;
+
+	BUILD_Jobs jobs = {0};
+	BUILD_BuildProgress* progress = (BUILD_BuildProgress*)calloc(builds_count, sizeof(BUILD_BuildProgress));
+
+	for (int i = 0; i < builds_count; i++) {
+		builds[i].ok = false;
+		if (builds[i].project->code_files.count == 0) {
+			progress[i].state = BUILD_BuildState_Failed;
+			continue;
+		}
+		BUILD_AddProjectJobs(builds, i, &progress[i], &jobs);
+	}
+
+	struct pollfd* poll_fds = (struct pollfd*)calloc(max_parallel_jobs, sizeof(struct pollfd));
+	int* poll_jobs = (int*)calloc(max_parallel_jobs, sizeof(int));
+	int running_count = 0;
+
+	for (;;) {
+		// Mark the projects whose jobs have all finished
+		for (int i = 0; i < builds_count; i++) {
+			BUILD_BuildProgress* p = &progress[i];
+			if (p->state == BUILD_BuildState_InProgress && p->pending_compile_jobs == 0 &&
+				(p->link_job == -1 || jobs.data[p->link_job].finished))
+			{
+				p->state = BUILD_BuildState_Succeeded;
+			}
+		}
+
+		// Start as many jobs as we can. Compile jobs are started in the order of the projects, and link jobs as soon
+		// as they're ready, so that the projects that others depend on are finished first.
+		for (int i = 0; i < jobs.count && running_count < max_parallel_jobs; i++) {
+			BUILD_Job* job = &jobs.data[i];
+			if (job->started) continue;
+
+			BUILD_BuildProgress* p = &progress[job->build_index];
+			if (p->state == BUILD_BuildState_Failed) { job->started = true; continue; } // skip
+			if (job->wait_for_job != -1 && !jobs.data[job->wait_for_job].finished) continue;
+
+			if (job->is_link) {
+				bool dependency_failed;
+				if (!BUILD_LinkJobIsReady(builds, builds_count, progress, job, &dependency_failed)) {
+					if (dependency_failed) {
+						BUILD_LogPrint3(builds[job->build_index].log_or_null, "Not linking ", builds[job->build_index].project->name,
+							", because a project it links with failed to build\n");
+						p->state = BUILD_BuildState_Failed;
+						job->started = true;
+					}
+					continue;
+				}
+
+				BUILD_Project* project = builds[job->build_index].project;
+				for (int j = 0; j < project->link_dependencies.count; j++) {
+					int dep = BUILD_FindBuild(builds, builds_count, project->link_dependencies.data[j]);
+					if (dep != -1 && progress[dep].output_file) BUILD_PushArg(&job->args, progress[dep].output_file);
+				}
+			}
+
+			if (BUILD_StartJob(job, builds[job->build_index].project->opts.working_directory)) {
+				poll_fds[running_count].fd = job->pipe_fd;
+				poll_fds[running_count].events = POLLIN;
+				poll_jobs[running_count] = i;
+				running_count++;
+			}
+			else {
+				BUILD_PrintNullTermination(&job->output);
+				BUILD_LogPrint1(builds[job->build_index].log_or_null, job->output.data);
+				p->state = BUILD_BuildState_Failed;
+			}
+		}
+
+		if (running_count == 0) break;
+
+		int num_ready = poll(poll_fds, running_count, -1);
+		if (num_ready < 0 && errno != EINTR) break;
+
+		for (int i = running_count - 1; i >= 0; i--) {
+			if (poll_fds[i].revents == 0) continue;
+
+			BUILD_Job* job = &jobs.data[poll_jobs[i]];
+			if (!BUILD_ReadJobOutput(job)) continue;
+
+			// The process has exited, so remove it from the running list
+			running_count--;
+			poll_fds[i] = poll_fds[running_count];
+			poll_jobs[i] = poll_jobs[running_count];
+
+			bool ok = BUILD_WaitJob(job);
+			job->finished = true;
+
+			BUILD_PrintNullTermination(&job->output);
+			BUILD_LogPrint1(builds[job->build_index].log_or_null, job->output.data);
+
+			BUILD_BuildProgress* p = &progress[job->build_index];
+			if (!job->is_link) p->pending_compile_jobs--;
+			if (!ok) {
+				if (job->remove_output_on_failure) remove(job->output_file); // don't leave a broken object file in the cache
+				p->state = BUILD_BuildState_Failed;
+			}
+			else if (job->dependency_file) {
+				BUILD_FileList dependencies = {0};
+				BUILD_ReadDependencyFile(job->dependency_file, &dependencies);
+				BUILD_AddDependencies(builds[job->build_index].project, &dependencies);
+				BUILD_FileListFree(&dependencies);
+			}
+		}
+	}
+
+	bool all_ok = true;
+	for (int i = 0; i < builds_count; i++) {
+		if (progress[i].state == BUILD_BuildState_InProgress) {
+			BUILD_LogPrint3(builds[i].log_or_null, "Not linking ", builds[i].project->name, ", because its link dependencies are circular\n");
+		}
+		builds[i].ok = progress[i].state == BUILD_BuildState_Succeeded;
+		all_ok = all_ok && builds[i].ok;
+	}
+
+	for (int i = 0; i < jobs.count; i++) {
+		BUILD_ArgsFree(&jobs.data[i].args);
+		BUILD_ArrayFree(&jobs.data[i].output);
+		free(jobs.data[i].output_file);
+		free(jobs.data[i].dependency_file);
+	}
+	BUILD_ArrayFree(&jobs);
+	free(progress);
+	free(poll_fds);
+	free(poll_jobs);
+	return all_ok;
+}
+
+BUILD_API bool BUILD_CompileProject(BUILD_Project* project, const char* project_directory, const char* relative_build_directory,
+	BUILD_Log* log_or_null)
+{
+	BUILD_ProjectBuild build = {0};
+	build.project = project;
+	build.build_directory = BUILD_Concat3(project_directory, "/", relative_build_directory);
+	build.log_or_null = log_or_null;
+
+	BUILD_CompileProjects(&build, 1, 0);
+
+	free((char*)build.build_directory);
+	return build.ok;
+}
+
+BUILD_API bool BUILD_CreateDirectory(const char* directory) {
+	return mkdir(directory, 0777) == 0 || errno == EEXIST;
+}
+
+BUILD_API bool BUILD_CopyFile(const char* file, const char* new_file) {
+	FILE* src = fopen(file, "rb");
+	FILE* dst = src ? fopen(new_file, "wb") : NULL;
+	bool ok = dst != NULL;
+
+	char buf[4096];
+	for (size_t n; ok && (n = fread(buf, 1, sizeof(buf), src)) > 0;) {
+		ok = fwrite(buf, 1, n, dst) == n;
+	}
+
+	if (src) fclose(src);
+	if (dst) fclose(dst);
+	return ok;
+}
+
+BUILD_API bool BUILD_CreateVisualStudioSolution(const char* project_directory, const char* relative_build_directory,
+	const char* solution_name, BUILD_Project** projects, int projects_count, BUILD_Log* log_or_null)
+{
+	BUILD_LogPrint1(log_or_null, "Visual Studio solutions can only be generated on Windows\n");
+	return false;
+}
+
+#endif // _WIN32
+
 #endif // FIRE_BUILD_IMPLEMENTATION
 #endif // FIRE_BUILD_INCLUDED
\ No newline at end of file
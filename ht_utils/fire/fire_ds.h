@@ -5,7 +5,7 @@
 // - Hash maps & sets
 // - Memory arenas
 // - Bucket arrays
-// - Slot allocators
+// - Slot maps
 //
 // This code is released under the MIT license (https://opensource.org/licenses/MIT).
 //
@@ -126,6 +126,7 @@ typedef struct DS_Arena {
 #endif
 
 #ifndef DS_NO_MALLOC
+#ifdef _WIN32
 static void* DS_HeapAllocatorProc(DS_AllocatorBase* allocator, void* ptr, size_t old_size, size_t size, size_t align) {
 	if (size == 0) {
 		if (old_size != 0) _aligned_free(ptr);
@@ -135,6 +136,23 @@ static void* DS_HeapAllocatorProc(DS_AllocatorBase* allocator, void* ptr, size_t
 		return _aligned_realloc(ptr, size, align);
 	}
 }
+#else
+static void* DS_HeapAllocatorProc(DS_AllocatorBase* allocator, void* ptr, size_t old_size, size_t size, size_t align) {
+	if (size == 0) {
+		if (old_size != 0) free(ptr);
+		return NULL;
+	}
+	// There is no aligned realloc outside of Windows, but the old size is always known here
+	if (align < sizeof(void*)) align = sizeof(void*);
+	void* new_ptr = NULL;
+	if (posix_memalign(&new_ptr, align, size) != 0) return NULL;
+	if (old_size != 0) {
+		memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+		free(ptr);
+	}
+	return new_ptr;
+}
+#endif
 
 typedef struct DS_BasicMemConfig {
 	DS_Info ds_info;
@@ -161,13 +179,6 @@ typedef struct DS_BasicMemConfig {
 
 #define DS_BucketElemSize(ARRAY) sizeof(*(ARRAY)->buckets->elems)
 
-#ifdef __cplusplus
-template<typename T> static inline T* DS_Clone__(DS_Arena* a, const T& v) { T* x = (T*)DS_ArenaPush(a, sizeof(T)); *x = v; return x; }
-#define DS_Clone_(T, ARENA, ...) DS_Clone__<T>(ARENA, __VA_ARGS__)
-#else
-#define DS_Clone_(T, ARENA, ...) ((T*)0 == &(__VA_ARGS__), (T*)DS_MemClone(ARENA, &(__VA_ARGS__), sizeof(__VA_ARGS__)))
-#endif
-
 // -------------------------------------------------------------------
 
 #define DS_ArrayCount(x) (sizeof(x) / sizeof(x[0]))
@@ -414,6 +425,13 @@ DS_API DS_ArenaMark DS_ArenaGetMark(DS_Arena* arena);
 DS_API void DS_ArenaSetMark(DS_Arena* arena, DS_ArenaMark mark);
 DS_API void DS_ArenaReset(DS_Arena* arena);
 
+#ifdef __cplusplus
+template<typename T> static inline T* DS_Clone__(DS_Arena* a, const T& v) { T* x = (T*)DS_ArenaPush(a, sizeof(T)); *x = v; return x; }
+#define DS_Clone_(T, ARENA, ...) DS_Clone__<T>(ARENA, __VA_ARGS__)
+#else
+#define DS_Clone_(T, ARENA, ...) ((T*)0 == &(__VA_ARGS__), (T*)DS_MemClone(ARENA, &(__VA_ARGS__), sizeof(__VA_ARGS__)))
+#endif
+
 // -- Scope ------------------------------------------
 
 // DS_Scope provides convenience functions for storing an arena mark as a local and
@@ -463,14 +481,14 @@ static inline void* DS_MemCloneAligned(DS_Arena* arena, const void* value, int s
 
 #ifdef __cplusplus
 template<class T> struct DS_DynArray {
-	DS_Allocator* allocator; T* data; int32_t count; int32_t capacity;
+	DS_Allocator* allocator; T* data; int32_t count; int32_t capacity; int32_t data_is_in_buffer;
 	inline T& operator [](size_t i)       { return DS_ArrBoundsCheck((*this), i), data[i]; }
 	inline T operator [](size_t i) const  { return DS_ArrBoundsCheck((*this), i), data[i]; }
 };
 #define DS_DynArray(T) DS_DynArray<T>
-typedef struct { DS_Allocator* allocator; void* data; int32_t count; int32_t capacity; } DS_DynArrayRaw;
+typedef struct { DS_Allocator* allocator; void* data; int32_t count; int32_t capacity; int32_t data_is_in_buffer; } DS_DynArrayRaw;
 #else
-#define DS_DynArray(T) struct { DS_Allocator* allocator; T* data; int32_t count; int32_t capacity; }
+#define DS_DynArray(T) struct { DS_Allocator* allocator; T* data; int32_t count; int32_t capacity; int32_t data_is_in_buffer; }
 typedef DS_DynArray(void) DS_DynArrayRaw;
 #endif
 
@@ -485,8 +503,19 @@ typedef DS_DynArray(void) DS_DynArrayRaw;
 
 #define DS_ArrReserve(ARR, CAPACITY)   DS_ArrReserveRaw((DS_DynArrayRaw*)(ARR), CAPACITY, DS_ArrElemSize(*ARR))
 
+// Reserve exactly CAPACITY elements instead of rounding up to the next power of two. Useful when the final size is known up-front.
+#define DS_ArrReserveExact(ARR, CAPACITY) DS_ArrReserveExactRaw((DS_DynArrayRaw*)(ARR), CAPACITY, DS_ArrElemSize(*ARR))
+
 #define DS_ArrInit(ARR, ALLOCATOR)     DS_ArrInitRaw((DS_DynArrayRaw*)(ARR), (ALLOCATOR))
 
+// Initialize an array that stores its elements in BUFFER (a fixed-size C array, e.g. on the stack) until it outgrows it,
+// at which point the elements are moved to memory from ALLOCATOR. The buffer must outlive the array.
+// Example:
+//   Asset* packages_buffer[16];
+//   DS_DynArray(Asset*) packages;
+//   DS_ArrInitBuffer(&packages, TEMP, packages_buffer);
+#define DS_ArrInitBuffer(ARR, ALLOCATOR, BUFFER) (DS_ArrTypecheck(ARR, BUFFER), DS_ArrInitBufferRaw((DS_DynArrayRaw*)(ARR), (ALLOCATOR), (BUFFER), DS_ArrayCount(BUFFER)))
+
 #define DS_ArrPush(ARR, ...) do { \
 	DS_ArrReserveRaw((DS_DynArrayRaw*)(ARR), (ARR)->count + 1, DS_ArrElemSize(*(ARR))); \
 	(ARR)->data[(ARR)->count++] = __VA_ARGS__; } while (0)
@@ -537,6 +566,7 @@ DS_API void DS_ArrRemoveRaw(DS_DynArrayRaw* array, int i, int elem_size);
 DS_API void DS_ArrRemoveNRaw(DS_DynArrayRaw* array, int i, int n, int elem_size);
 DS_API void DS_ArrPopRaw(DS_DynArrayRaw* array, DS_OUT void* out_elem, int elem_size);
 DS_API void DS_ArrReserveRaw(DS_DynArrayRaw* array, int capacity, int elem_size);
+DS_API void DS_ArrReserveExactRaw(DS_DynArrayRaw* array, int capacity, int elem_size);
 DS_API void DS_ArrCloneRaw(DS_Arena* arena, DS_DynArrayRaw* array, int elem_size);
 DS_API void DS_ArrResizeRaw(DS_DynArrayRaw* array, int count, const void* value, int elem_size); // set value to NULL to not initialize the memory
 
@@ -600,6 +630,81 @@ typedef DS_BucketArray(void) DS_BucketArrayRaw;
 
 // #define DS_BucketArraySetViewToArray(ARRAY, ELEMS_DATA, ELEMS_COUNT) DS_BucketArraySetViewToArrayRaw((DS_BucketArrayRaw*)(ARRAY), (ELEMS_DATA), (uint32_t)(ELEMS_COUNT))
 
+// -- Slot Map ------------------------------------------------------------------------
+
+// DS_SlotMap is a pool of elements that are referred to by generation-checked handles. Elements are stored in
+// fixed-size buckets, so their addresses stay stable for as long as they're alive. Adding and removing an element are O(1).
+// The slot indices of the live elements are kept in a separate dense array, so iteration doesn't need to skip over free slots.
+
+// DS_SlotHandle encodes the following struct: { uint32_t slot_index; uint32_t generation; }
+// The generation of a slot is never 0, which means that the handle 0 is always invalid.
+typedef uint64_t DS_SlotHandle;
+
+#define DS_EncodeSlotHandle(SLOT, GENERATION) ((uint64_t)(SLOT) | ((uint64_t)(GENERATION) << 32))
+#define DS_SlotFromHandle(HANDLE)       (uint32_t)(HANDLE)
+#define DS_GenerationFromHandle(HANDLE) (uint32_t)((HANDLE) >> 32)
+
+typedef struct DS_SlotMapSlot {
+	uint32_t generation; // incremented whenever the slot is freed
+	uint32_t is_alive : 1;
+	uint32_t link : 31;  // if alive, this is the index into the dense array. Otherwise, this is the next free slot index plus one.
+} DS_SlotMapSlot;
+
+#define DS_SlotMap(T) struct { \
+	DS_Allocator* allocator; \
+	T** buckets; \
+	uint32_t buckets_count; \
+	uint32_t buckets_capacity; \
+	uint32_t elems_per_bucket; \
+	uint32_t slots_count; \
+	uint32_t slots_capacity; \
+	uint32_t first_free_slot; /* slot index plus one, 0 if there are no free slots */ \
+	uint32_t count; \
+	DS_SlotMapSlot* slots; \
+	uint32_t* dense; /* slot indices of the live elements */ }
+
+typedef DS_SlotMap(void) DS_SlotMapRaw;
+
+#define DS_SlotMapElemSize(MAP) sizeof(**(MAP)->buckets)
+
+#define DS_SlotMapInit(MAP, ALLOCATOR, ELEMS_PER_BUCKET) DS_SlotMapInitRaw((DS_SlotMapRaw*)(MAP), (ALLOCATOR), (ELEMS_PER_BUCKET))
+
+#define DS_SlotMapDeinit(MAP) DS_SlotMapDeinitRaw((DS_SlotMapRaw*)(MAP))
+
+// Returns a pointer to the new zero-initialized element. Its handle is written to OUT_HANDLE.
+#define DS_SlotMapAdd(MAP, OUT_HANDLE) DS_SlotMapAddRaw((DS_SlotMapRaw*)(MAP), (OUT_HANDLE), DS_SlotMapElemSize(MAP))
+
+// Returns false if the handle is not valid.
+#define DS_SlotMapRemove(MAP, HANDLE) DS_SlotMapRemoveRaw((DS_SlotMapRaw*)(MAP), (HANDLE))
+
+// Returns NULL if the handle is not valid.
+#define DS_SlotMapGet(MAP, HANDLE) DS_SlotMapGetRaw((DS_SlotMapRaw*)(MAP), (HANDLE), DS_SlotMapElemSize(MAP))
+
+// Releases the memory of trailing buckets that don't contain live elements, sorts the dense array by slot index
+// for better memory locality when iterating, and reorders the freelist so that the lowest free slots get reused first.
+// Existing handles remain valid.
+#define DS_SlotMapCompact(MAP) DS_SlotMapCompactRaw((DS_SlotMapRaw*)(MAP))
+
+#define DS_SlotMapElemFromSlot(MAP, SLOT) (&(MAP)->buckets[(SLOT) / (MAP)->elems_per_bucket][(SLOT) % (MAP)->elems_per_bucket])
+
+// Iterate over the live elements in the dense order. IT is an index into the dense array.
+// Removing the element at IT moves the last element into its place, so when removing elements while iterating, iterate backwards instead.
+// Example:
+//   for (DS_SlotMapEach(&my_map, it)) {
+//       MyThing* thing = DS_SlotMapAt(&my_map, it);
+//   }
+#define DS_SlotMapEach(MAP, IT) uint32_t IT = 0; IT < (MAP)->count; IT++
+
+#define DS_SlotMapAt(MAP, DENSE_INDEX) DS_SlotMapElemFromSlot(MAP, (MAP)->dense[DENSE_INDEX])
+#define DS_SlotMapHandleAt(MAP, DENSE_INDEX) DS_EncodeSlotHandle((MAP)->dense[DENSE_INDEX], (MAP)->slots[(MAP)->dense[DENSE_INDEX]].generation)
+
+DS_API void DS_SlotMapInitRaw(DS_SlotMapRaw* map, DS_Allocator* allocator, uint32_t elems_per_bucket);
+DS_API void DS_SlotMapDeinitRaw(DS_SlotMapRaw* map);
+DS_API void* DS_SlotMapAddRaw(DS_SlotMapRaw* map, DS_OUT DS_SlotHandle* out_handle, uint32_t elem_size);
+DS_API bool DS_SlotMapRemoveRaw(DS_SlotMapRaw* map, DS_SlotHandle handle);
+DS_API void* DS_SlotMapGetRaw(const DS_SlotMapRaw* map, DS_SlotHandle handle, uint32_t elem_size);
+DS_API void DS_SlotMapCompactRaw(DS_SlotMapRaw* map);
+
 // -- C++ extras -----------------------------------
 
 #ifdef __cplusplus
@@ -772,26 +877,175 @@ static inline void* DS_BucketArrayPushRaw(DS_BucketArrayRaw* array, uint32_t ele
 	return result;
 }
 
+DS_API void DS_SlotMapInitRaw(DS_SlotMapRaw* map, DS_Allocator* allocator, uint32_t elems_per_bucket) {
+	DS_SlotMapRaw result = {0};
+	result.allocator = allocator;
+	result.elems_per_bucket = elems_per_bucket;
+	*map = result;
+}
+
+DS_API void DS_SlotMapDeinitRaw(DS_SlotMapRaw* map) {
+	DS_ProfEnter();
+	for (uint32_t i = 0; i < map->buckets_count; i++) {
+		DS_MemFree(map->allocator, map->buckets[i]);
+	}
+	DS_MemFree(map->allocator, map->buckets);
+	DS_MemFree(map->allocator, map->slots);
+	DS_MemFree(map->allocator, map->dense);
+	DS_DebugFillGarbage(map, sizeof(*map));
+	DS_ProfExit();
+}
+
+DS_API void* DS_SlotMapAddRaw(DS_SlotMapRaw* map, DS_OUT DS_SlotHandle* out_handle, uint32_t elem_size) {
+	DS_ProfEnter();
+	DS_ASSERT(map->elems_per_bucket > 0); // did you remember to call DS_SlotMapInit?
+
+	uint32_t slot_index;
+	if (map->first_free_slot) {
+		slot_index = map->first_free_slot - 1;
+		map->first_free_slot = map->slots[slot_index].link;
+	}
+	else {
+		if (map->slots_count == map->slots_capacity) {
+			uint32_t new_cap = map->slots_capacity == 0 ? 8 : map->slots_capacity * 2;
+			map->slots = (DS_SlotMapSlot*)DS_MemResize(map->allocator, map->slots, map->slots_capacity * sizeof(DS_SlotMapSlot), new_cap * sizeof(DS_SlotMapSlot));
+			map->dense = (uint32_t*)DS_MemResize(map->allocator, map->dense, map->slots_capacity * sizeof(uint32_t), new_cap * sizeof(uint32_t));
+			map->slots_capacity = new_cap;
+		}
+		slot_index = map->slots_count++;
+		DS_SlotMapSlot new_slot = {0};
+		new_slot.generation = 1;
+		map->slots[slot_index] = new_slot;
+	}
+
+	// Make sure the bucket for this slot exists. Buckets may have been released by DS_SlotMapCompact.
+	uint32_t bucket_index = slot_index / map->elems_per_bucket;
+	while (bucket_index >= map->buckets_count) {
+		if (map->buckets_count == map->buckets_capacity) {
+			uint32_t new_cap = map->buckets_capacity == 0 ? 8 : map->buckets_capacity * 2;
+			map->buckets = (void**)DS_MemResize(map->allocator, map->buckets, map->buckets_capacity * sizeof(void*), new_cap * sizeof(void*));
+			map->buckets_capacity = new_cap;
+		}
+		map->buckets[map->buckets_count++] = DS_MemAlloc(map->allocator, elem_size * map->elems_per_bucket);
+	}
+
+	DS_SlotMapSlot* slot = &map->slots[slot_index];
+	slot->is_alive = 1;
+	slot->link = map->count;
+	map->dense[map->count++] = slot_index;
+
+	void* result = (char*)map->buckets[bucket_index] + (slot_index % map->elems_per_bucket) * elem_size;
+	memset(result, 0, elem_size);
+
+	if (out_handle) *out_handle = DS_EncodeSlotHandle(slot_index, slot->generation);
+	DS_ProfExit();
+	return result;
+}
+
+DS_API bool DS_SlotMapRemoveRaw(DS_SlotMapRaw* map, DS_SlotHandle handle) {
+	uint32_t slot_index = DS_SlotFromHandle(handle);
+	if (slot_index >= map->slots_count) return false;
+
+	DS_SlotMapSlot* slot = &map->slots[slot_index];
+	if (!slot->is_alive || slot->generation != DS_GenerationFromHandle(handle)) return false;
+
+	// Swap-remove from the dense array
+	uint32_t dense_index = slot->link;
+	uint32_t last_slot_index = map->dense[--map->count];
+	map->dense[dense_index] = last_slot_index;
+	map->slots[last_slot_index].link = dense_index;
+
+	slot->generation += 1;
+	if (slot->generation == 0) slot->generation = 1;
+	slot->is_alive = 0;
+	slot->link = map->first_free_slot;
+	map->first_free_slot = slot_index + 1;
+	return true;
+}
+
+DS_API void* DS_SlotMapGetRaw(const DS_SlotMapRaw* map, DS_SlotHandle handle, uint32_t elem_size) {
+	uint32_t slot_index = DS_SlotFromHandle(handle);
+	if (slot_index < map->slots_count) {
+		DS_SlotMapSlot slot = map->slots[slot_index];
+		if (slot.is_alive && slot.generation == DS_GenerationFromHandle(handle)) {
+			return (char*)map->buckets[slot_index / map->elems_per_bucket] + (slot_index % map->elems_per_bucket) * elem_size;
+		}
+	}
+	return NULL;
+}
+
+DS_API void DS_SlotMapCompactRaw(DS_SlotMapRaw* map) {
+	DS_ProfEnter();
+	
+	// Rebuild the dense array in slot order and the freelist in ascending order. The slots themselves are kept
+	// even when their buckets are released, so that the generations of stale handles are never reused.
+	uint32_t highest_alive_slot_plus_one = 0;
+	uint32_t dense_count = 0;
+	map->first_free_slot = 0;
+	for (uint32_t i = map->slots_count; i > 0; i--) {
+		DS_SlotMapSlot* slot = &map->slots[i - 1];
+		if (slot->is_alive) {
+			if (highest_alive_slot_plus_one == 0) highest_alive_slot_plus_one = i;
+			dense_count++;
+		}
+		else {
+			slot->link = map->first_free_slot;
+			map->first_free_slot = i;
+		}
+	}
+	DS_ASSERT(dense_count == map->count);
+
+	uint32_t dense_index = 0;
+	for (uint32_t i = 0; i < highest_alive_slot_plus_one; i++) {
+		DS_SlotMapSlot* slot = &map->slots[i];
+		if (slot->is_alive) {
+			slot->link = dense_index;
+			map->dense[dense_index++] = i;
+		}
+	}
+
+	uint32_t buckets_needed = (highest_alive_slot_plus_one + map->elems_per_bucket - 1) / map->elems_per_bucket;
+	for (uint32_t i = buckets_needed; i < map->buckets_count; i++) {
+		DS_MemFree(map->allocator, map->buckets[i]);
+	}
+	if (buckets_needed < map->buckets_count) map->buckets_count = buckets_needed;
+	
+	DS_ProfExit();
+}
+
 DS_API void DS_ArrCloneRaw(DS_Arena* arena, DS_DynArrayRaw* array, int elem_size) {
 	array->data = DS_MemClone(arena, array->data, array->count * elem_size);
+	array->data_is_in_buffer = 0;
 }
 
-DS_API void DS_ArrReserveRaw(DS_DynArrayRaw* array, int capacity, int elem_size) {
+DS_API void DS_ArrReserveExactRaw(DS_DynArrayRaw* array, int capacity, int elem_size) {
 	DS_ProfEnter();
 
 	DS_ASSERT(array->allocator != NULL); // Have you called DS_ArrInit?
 
+	if (capacity > array->capacity) {
+		if (array->data_is_in_buffer) {
+			// Move out of the user buffer. The buffer is not ours to free.
+			void* new_data = DS_MemAlloc(array->allocator, capacity * elem_size);
+			memcpy(new_data, array->data, array->count * elem_size);
+			array->data = new_data;
+			array->data_is_in_buffer = 0;
+		}
+		else {
+			array->data = DS_MemResize(array->allocator, array->data, array->capacity * elem_size, capacity * elem_size);
+		}
+		array->capacity = capacity;
+	}
+
+	DS_ProfExit();
+}
+
+DS_API void DS_ArrReserveRaw(DS_DynArrayRaw* array, int capacity, int elem_size) {
 	int new_capacity = array->capacity;
 	while (capacity > new_capacity) {
 		new_capacity = new_capacity == 0 ? 8 : new_capacity * 2;
 	}
-
-	if (new_capacity != array->capacity) {
-		array->data = DS_MemResize(array->allocator, array->data, array->capacity * elem_size, new_capacity * elem_size);
-		array->capacity = new_capacity;
-	}
-
-	DS_ProfExit();
+	DS_ArrReserveExactRaw(array, new_capacity, elem_size);
 }
 
 DS_API void DS_ArrRemoveRaw(DS_DynArrayRaw* array, int i, int elem_size) { DS_ArrRemoveNRaw(array, i, 1, elem_size); }
@@ -860,9 +1114,18 @@ DS_API void DS_ArrInitRaw(DS_DynArrayRaw* array, DS_Allocator* allocator) {
 	array->allocator = allocator;
 }
 
+DS_API void DS_ArrInitBufferRaw(DS_DynArrayRaw* array, DS_Allocator* allocator, void* buffer, int buffer_capacity) {
+	DS_DynArrayRaw result = {0};
+	result.allocator = allocator;
+	result.data = buffer;
+	result.capacity = buffer_capacity;
+	result.data_is_in_buffer = 1;
+	*array = result;
+}
+
 DS_API void DS_ArrDeinitRaw(DS_DynArrayRaw* array, int elem_size) {
 	DS_DebugFillGarbage(array->data, array->capacity * elem_size);
-	DS_MemFree(array->allocator, array->data);
+	if (!array->data_is_in_buffer) DS_MemFree(array->allocator, array->data);
 	DS_DebugFillGarbage(array, sizeof(*array));
 }
 
@@ -1,6 +1,6 @@
 // fire_os_sync.h - by Eero Mutka (https://eeromutka.github.io/)
 // 
-// Threading and synchronization primitives. Only Windows is supported for time being.
+// Threading and synchronization primitives. Supports Windows and POSIX threads.
 //
 // This code is released under the MIT license (https://opensource.org/licenses/MIT).
 //
@@ -15,6 +15,7 @@
 #endif
 
 #include <assert.h>
+#include <stdint.h>
 
 typedef void (*OS_ThreadFn)(void* user_data);
 typedef struct OS_Thread {
@@ -28,7 +29,11 @@ typedef struct OS_Mutex {
 } OS_Mutex;
 
 typedef struct OS_ConditionVar {
+#ifdef _WIN32
 	uint64_t os_specific;
+#else
+	uint64_t os_specific[6]; // pthread_cond_t
+#endif
 } OS_ConditionVar;
 
 // NOTE: The `thread` pointer may not be moved or copied while in use.
@@ -56,7 +61,14 @@ OS_SYNC_API void OS_ConditionVarBroadcast(OS_ConditionVar* condition_var);
 // * The mutex must be locked/entered exactly once prior to calling this function!
 OS_SYNC_API void OS_ConditionVarWait(OS_ConditionVar* condition_var, OS_Mutex* mutex);
 
+// Atomically adds `value` to `*addend` and returns the resulting value. This is a full memory barrier.
+OS_SYNC_API int32_t OS_AtomicAddI32(volatile int32_t* addend, int32_t value);
+
+// Returns the number of logical processors available to this process.
+OS_SYNC_API int OS_GetLogicalProcessorCount(void);
+
 #ifdef /**********/ FIRE_OS_SYNC_IMPLEMENTATION /**********/
+#ifdef _WIN32
 
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -140,5 +152,113 @@ OS_SYNC_API void OS_ConditionVarBroadcast(OS_ConditionVar* condition_var) {
 	WakeAllConditionVariable((CONDITION_VARIABLE*)condition_var);
 }
 
+OS_SYNC_API int32_t OS_AtomicAddI32(volatile int32_t* addend, int32_t value) {
+	return InterlockedAdd((volatile LONG*)addend, value);
+}
+
+OS_SYNC_API int OS_GetLogicalProcessorCount(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int)info.dwNumberOfProcessors;
+}
+
+#else // _WIN32
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // for pthread_setname_np. Only has an effect if no system header was included before this one.
+#endif
+#include <pthread.h>
+#include <unistd.h> // for sysconf
+#include <string.h> // for memset
+
+static void* OS_ThreadEntryFn(void* args) {
+	OS_Thread* thread = (OS_Thread*)args;
+	thread->fn(thread->user_data);
+	return NULL;
+}
+
+OS_SYNC_API void OS_ThreadStart(OS_Thread* thread, OS_ThreadFn fn, void* user_data, const char* debug_name) {
+	assert(thread->os_specific == NULL);
+	assert(sizeof(thread->os_specific) >= sizeof(pthread_t));
+
+	// See the Windows version for why `fn` and `user_data` are passed in the OS_Thread structure
+	thread->fn = fn;
+	thread->user_data = user_data;
+
+	pthread_t handle;
+	int err = pthread_create(&handle, NULL, OS_ThreadEntryFn, thread);
+	assert(err == 0);
+	memcpy(&thread->os_specific, &handle, sizeof(handle));
+
+#ifdef __linux__
+	if (debug_name && *debug_name) {
+		char debug_name_short[16]; // Linux thread names are limited to 15 characters
+		strncpy(debug_name_short, debug_name, 15);
+		debug_name_short[15] = 0;
+		pthread_setname_np(handle, debug_name_short);
+	}
+#endif
+}
+
+OS_SYNC_API void OS_ThreadJoin(OS_Thread* thread) {
+	pthread_t handle;
+	memcpy(&handle, &thread->os_specific, sizeof(handle));
+	pthread_join(handle, NULL);
+	memset(thread, 0, sizeof(*thread)); // Do this so that we can safely start a new thread again using this same struct
+}
+
+OS_SYNC_API void OS_MutexInit(OS_Mutex* mutex) {
+	assert(sizeof(OS_Mutex) >= sizeof(pthread_mutex_t));
+
+	// Critical sections on Windows are recursive, so match that
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init((pthread_mutex_t*)mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+OS_SYNC_API void OS_MutexDestroy(OS_Mutex* mutex) {
+	pthread_mutex_destroy((pthread_mutex_t*)mutex);
+}
+
+OS_SYNC_API void OS_MutexLock(OS_Mutex* mutex) {
+	pthread_mutex_lock((pthread_mutex_t*)mutex);
+}
+
+OS_SYNC_API void OS_MutexUnlock(OS_Mutex* mutex) {
+	pthread_mutex_unlock((pthread_mutex_t*)mutex);
+}
+
+OS_SYNC_API void OS_ConditionVarInit(OS_ConditionVar* condition_var) {
+	assert(sizeof(OS_ConditionVar) >= sizeof(pthread_cond_t));
+	pthread_cond_init((pthread_cond_t*)condition_var, NULL);
+}
+
+OS_SYNC_API void OS_ConditionVarDestroy(OS_ConditionVar* condition_var) {
+	pthread_cond_destroy((pthread_cond_t*)condition_var);
+}
+
+OS_SYNC_API void OS_ConditionVarWait(OS_ConditionVar* condition_var, OS_Mutex* mutex) {
+	pthread_cond_wait((pthread_cond_t*)condition_var, (pthread_mutex_t*)mutex);
+}
+
+OS_SYNC_API void OS_ConditionVarSignal(OS_ConditionVar* condition_var) {
+	pthread_cond_signal((pthread_cond_t*)condition_var);
+}
+
+OS_SYNC_API void OS_ConditionVarBroadcast(OS_ConditionVar* condition_var) {
+	pthread_cond_broadcast((pthread_cond_t*)condition_var);
+}
+
+OS_SYNC_API int32_t OS_AtomicAddI32(volatile int32_t* addend, int32_t value) {
+	return __atomic_add_fetch(addend, value, __ATOMIC_SEQ_CST);
+}
+
+OS_SYNC_API int OS_GetLogicalProcessorCount(void) {
+	return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+#endif // _WIN32
 #endif // FIRE_OS_SYNC_IMPLEMENTATION
 #endif // FIRE_OS_SYNC_INCLUDED
\ No newline at end of file
@@ -1,6 +1,6 @@
 // fire_os_timing.h - by Eero Mutka (https://eeromutka.github.io/)
 // 
-// High-performance time measurements. Only Windows is supported for time being.
+// High-performance time measurements. Supports Windows and POSIX systems.
 // 
 // This code is released under the MIT license (https://opensource.org/licenses/MIT).
 //
@@ -24,6 +24,7 @@ OS_TIMING_API uint64_t OS_GetCPUTick();
 OS_TIMING_API double OS_GetDuration(uint64_t cpu_frequency, uint64_t start, uint64_t end);
 
 #ifdef /**********/ FIRE_OS_TIMING_IMPLEMENTATION /**********/
+#ifdef _WIN32
 
 // -- from Windows.h -----------------------------------------
 #ifdef __cplusplus
@@ -55,5 +56,26 @@ OS_TIMING_API double OS_GetDuration(uint64_t cpu_frequency, uint64_t start, uint
 	return (double)elapsed / (double)cpu_frequency;
 }
 
+#else // _WIN32
+
+#include <time.h>
+
+// Ticks are nanoseconds of CLOCK_MONOTONIC
+OS_TIMING_API uint64_t OS_GetCPUFrequency() {
+	return 1000000000;
+}
+
+OS_TIMING_API uint64_t OS_GetCPUTick() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000 + (uint64_t)t.tv_nsec;
+}
+
+OS_TIMING_API double OS_GetDuration(uint64_t cpu_frequency, uint64_t start, uint64_t end) {
+	uint64_t elapsed = end - start;
+	return (double)elapsed / (double)cpu_frequency;
+}
+
+#endif // _WIN32
 #endif // FIRE_OS_TIMING_IMPLEMENTATION
 #endif // FIRE_OS_TIMING_INCLUDED
\ No newline at end of file
@@ -15,7 +15,19 @@
 #include <stdbool.h>
 #include <string.h>  // memcpy, memmove, memset, memcmp, strlen
 #include <stdarg.h>
-#include <math.h> // isnan, isinf
+#include <math.h> // isnan, isinf, nextafterf
+#include <stdlib.h> // strtod, strtof
+
+// Searching and UTF-8 scanning use SSE2 on x64, and AVX2 when compiling with AVX2 enabled (/arch:AVX2 or -mavx2).
+// Define STR_NO_SIMD to use the plain loops instead.
+#if !defined(STR_NO_SIMD) && (defined(_M_X64) || defined(__SSE2__))
+#define STR_USE_SSE2
+#include <emmintrin.h>
+#if defined(__AVX2__)
+#define STR_USE_AVX2
+#include <immintrin.h>
+#endif
+#endif
 
 #ifdef STR_CUSTOM_MALLOC
 // (Provide your own implementation before including this file)
@@ -69,6 +81,7 @@ typedef struct STR_Builder {
 	void* allocator;
 	STR_View str;
 	size_t capacity;
+	bool str_is_in_buffer; // true while `str` points into the user buffer given to STR_BuilderInitBuffer
 } STR_Builder;
 
 typedef struct { STR_View* data; size_t size; } STR_Array;
@@ -114,6 +127,13 @@ STR_API const char* STR_FormC(void* allocator, const char* fmt, ...); // Allocat
 STR_API void STR_BuilderInit(STR_Builder* s, void* allocator); // Alternatively, init by {}-initializer and passing in the allocator field
 STR_API void STR_BuilderDeinit(STR_Builder* s);
 
+// Use `buffer` (e.g. an array on the stack) as the initial storage. The string is moved to memory from `allocator` only if it outgrows the buffer.
+// While the string fits in the buffer, `s->str` points into it, so clone the result if it needs to outlive the buffer.
+STR_API void STR_BuilderInitBuffer(STR_Builder* s, void* allocator, char* buffer, size_t buffer_size);
+
+// Grow the capacity to at least `capacity` bytes. Reserving up-front avoids the intermediate allocations of repeated doubling.
+STR_API void STR_BuilderReserve(STR_Builder* s, size_t capacity);
+
 STR_API void STR_Print(STR_Builder* s, STR_View string);
 STR_API void STR_PrintF(STR_Builder* s, const char* fmt, ...);
 STR_API void STR_PrintVA(STR_Builder* s, const char* fmt, va_list args);
@@ -130,12 +150,20 @@ STR_API bool STR_ParseU64Ex(STR_View s, int base, uint64_t* out_value);
 STR_API bool STR_ParseI64Ex(STR_View s, int base, int64_t* out_value);
 STR_API bool STR_ParseI64(STR_View s, int64_t* out_value);
 
+// * The result is correctly rounded. `s` doesn't need to be null-terminated and may be of any length.
+// * Characters after the number are ignored.
 STR_API bool STR_ParseFloat(STR_View s, double* out);
+STR_API bool STR_ParseFloat32(STR_View s, float* out); // Rounds directly to float, which can differ from rounding to double first
 
 STR_API STR_View STR_IntToStr(void* allocator, int value);
 STR_API STR_View STR_IntToStrEx(void* allocator, uint64_t data, bool is_signed, int radix);
 STR_API STR_View STR_FloatToStr(void* allocator, double value, int min_decimals);
 
+// Prints the shortest decimal string that STR_ParseFloat32 parses back to exactly `value`. The string has no exponent and
+// always has a decimal point, e.g. "0.1", "-2.0" or "100000000000000000000.0". `buffer` must have room for STR_FLOAT32_MAX_SIZE bytes.
+#define STR_FLOAT32_MAX_SIZE 64
+STR_API size_t STR_Float32ToStrBufShortest(char* buffer, float value);
+
 STR_API size_t STR_CodepointToUTF8(char* output, uint32_t codepoint); // returns the number of bytes written
 STR_API uint32_t STR_UTF8ToCodepoint(STR_View str);
 STR_API size_t STR_CodepointSizeAsUTF8(uint32_t codepoint);
@@ -150,6 +178,9 @@ STR_API uint32_t STR_PrevCodepoint(STR_View str, size_t* byteoffset);
 
 STR_API size_t STR_CodepointCount(STR_View str);
 
+// Returns true if `str` is well-formed UTF-8, i.e. has no overlong encodings, surrogates, codepoints above U+10FFFF or truncated sequences.
+STR_API bool STR_IsValidUTF8(STR_View str);
+
 // -- String view utilities -------------
 
 STR_API STR_View STR_Advance(STR_View* str, size_t size);
@@ -207,6 +238,74 @@ static bool STR_ASCIISetContains(STR_ASCIISet set, char c) {
 	return (set.bytes[c / 8] & 1 << (c % 8)) != 0;
 }
 
+#define STR_NOT_FOUND_ ((size_t)-1)
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline uint32_t STR_LowestBitIndex_(uint32_t x) { unsigned long i; _BitScanForward(&i, x); return (uint32_t)i; }
+static inline uint32_t STR_HighestBitIndex_(uint32_t x) { unsigned long i; _BitScanReverse(&i, x); return (uint32_t)i; }
+#else
+static inline uint32_t STR_LowestBitIndex_(uint32_t x) { return (uint32_t)__builtin_ctz(x); }
+static inline uint32_t STR_HighestBitIndex_(uint32_t x) { return 31 - (uint32_t)__builtin_clz(x); }
+#endif
+
+static inline uint32_t STR_PopCount32_(uint32_t x) {
+	x = x - ((x >> 1) & 0x55555555);
+	x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+	return (((x + (x >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+// Returns the offset of the first `c` in `data`, or STR_NOT_FOUND_
+static size_t STR_FindByte_(const char* data, size_t size, char c) {
+	size_t i = 0;
+#ifdef STR_USE_AVX2
+	__m256i c_x32 = _mm256_set1_epi8(c);
+	for (; i + 32 <= size; i += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, c_x32));
+		if (mask) return i + STR_LowestBitIndex_(mask);
+	}
+#endif
+#ifdef STR_USE_SSE2
+	__m128i c_x16 = _mm_set1_epi8(c);
+	for (; i + 16 <= size; i += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, c_x16));
+		if (mask) return i + STR_LowestBitIndex_(mask);
+	}
+#endif
+	for (; i < size; i++) {
+		if (data[i] == c) return i;
+	}
+	return STR_NOT_FOUND_;
+}
+
+// Returns the offset of the last `c` in `data`, or STR_NOT_FOUND_
+static size_t STR_FindByteLast_(const char* data, size_t size, char c) {
+	size_t i = size;
+#ifdef STR_USE_AVX2
+	__m256i c_x32 = _mm256_set1_epi8(c);
+	for (; i >= 32; i -= 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*)(data + i - 32));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, c_x32));
+		if (mask) return i - 32 + STR_HighestBitIndex_(mask);
+	}
+#endif
+#ifdef STR_USE_SSE2
+	__m128i c_x16 = _mm_set1_epi8(c);
+	for (; i >= 16; i -= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(data + i - 16));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, c_x16));
+		if (mask) return i - 16 + STR_HighestBitIndex_(mask);
+	}
+#endif
+	while (i > 0) {
+		i--;
+		if (data[i] == c) return i;
+	}
+	return STR_NOT_FOUND_;
+}
+
 STR_API bool STR_ParseToAndSkip(STR_View* remaining, uint32_t codepoint, STR_View* result) {
 	size_t i = 0, i_next = 0;
 	for (uint32_t r; r = STR_NextCodepoint(*remaining, &i_next); i = i_next) {
@@ -221,26 +320,47 @@ STR_API bool STR_ParseToAndSkip(STR_View* remaining, uint32_t codepoint, STR_Vie
 	return i_next > 0;
 }
 
+// UTF-8 is self-synchronizing, so a codepoint can be searched for as a plain byte sequence.
 STR_API bool STR_FindFirst(STR_View str, uint32_t codepoint, size_t* out_offset) {
-	size_t i = 0, i_next = 0;
-	for (uint32_t r; r = STR_NextCodepoint(str, &i_next); i = i_next) {
-		if (r == codepoint) {
-			*out_offset = i;
-			return true;
-		}
+	STR_ProfEnter();
+	char utf8[4];
+	STR_View needle = { utf8, STR_CodepointToUTF8(utf8, codepoint) };
+	
+	bool found = false;
+	if (needle.size == 1) {
+		size_t offset = STR_FindByte_(str.data, str.size, utf8[0]);
+		found = offset != STR_NOT_FOUND_;
+		if (found) *out_offset = offset;
 	}
-	return false;
+	else if (needle.size > 1) {
+		found = STR_Find(str, needle, out_offset);
+	}
+	STR_ProfExit();
+	return found;
 }
 
 STR_API bool STR_FindLast(STR_View str, uint32_t codepoint, size_t* out_offset) {
-	size_t i = str.size;
-	for (uint32_t r; r = STR_PrevCodepoint(str, &i);) {
-		if (r == codepoint) {
-			*out_offset = i;
-			return true;
+	STR_ProfEnter();
+	char utf8[4];
+	size_t utf8_size = STR_CodepointToUTF8(utf8, codepoint);
+
+	bool found = false;
+	if (utf8_size > 0) {
+		// Find the lead byte from the end, then check the rest of the sequence
+		for (size_t end = str.size;;) {
+			size_t offset = STR_FindByteLast_(str.data, end, utf8[0]);
+			if (offset == STR_NOT_FOUND_) break;
+
+			if (offset + utf8_size <= str.size && memcmp(str.data + offset + 1, utf8 + 1, utf8_size - 1) == 0) {
+				*out_offset = offset;
+				found = true;
+				break;
+			}
+			end = offset;
 		}
 	}
-	return false;
+	STR_ProfExit();
+	return found;
 }
 
 STR_API bool STR_LastIdxOfAnyChar(STR_View str, STR_View chars, size_t* out_index) {
@@ -355,32 +475,65 @@ STR_API bool STR_Contains(STR_View str, STR_View substr) {
 	return STR_Find(str, substr, NULL);
 }
 
+// Returns the offset of the first occurrence of `substr`, or STR_NOT_FOUND_. `substr` must be at least 2 bytes long.
+// Candidate positions are those where both the first and the last byte of `substr` match, which are found 16 or 32 at a time,
+// and only those are compared in full. See http://0x80.pl/articles/simd-strfind.html
+static size_t STR_FindSubstring_(STR_View str, STR_View substr) {
+	const char* data = str.data;
+	size_t n = substr.size;
+	size_t i = 0;
+
+#ifdef STR_USE_AVX2
+	__m256i first_x32 = _mm256_set1_epi8(substr.data[0]);
+	__m256i last_x32 = _mm256_set1_epi8(substr.data[n - 1]);
+	for (; i + n - 1 + 32 <= str.size; i += 32) {
+		__m256i first = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i last = _mm256_loadu_si256((const __m256i*)(data + i + n - 1));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, first_x32), _mm256_cmpeq_epi8(last, last_x32)));
+		for (; mask; mask &= mask - 1) {
+			size_t offset = i + STR_LowestBitIndex_(mask);
+			if (memcmp(data + offset + 1, substr.data + 1, n - 2) == 0) return offset;
+		}
+	}
+#endif
+#ifdef STR_USE_SSE2
+	__m128i first_x16 = _mm_set1_epi8(substr.data[0]);
+	__m128i last_x16 = _mm_set1_epi8(substr.data[n - 1]);
+	for (; i + n - 1 + 16 <= str.size; i += 16) {
+		__m128i first = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i last = _mm_loadu_si128((const __m128i*)(data + i + n - 1));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, first_x16), _mm_cmpeq_epi8(last, last_x16)));
+		for (; mask; mask &= mask - 1) {
+			size_t offset = i + STR_LowestBitIndex_(mask);
+			if (memcmp(data + offset + 1, substr.data + 1, n - 2) == 0) return offset;
+		}
+	}
+#endif
+	for (; i + n <= str.size; i++) {
+		if (data[i] == substr.data[0] && data[i + n - 1] == substr.data[n - 1] && memcmp(data + i + 1, substr.data + 1, n - 2) == 0) return i;
+	}
+	return STR_NOT_FOUND_;
+}
+
 STR_API bool STR_Find(STR_View str, STR_View substr, size_t* out_offset) {
 	STR_ProfEnter();
 	
-	bool found = false;
+	size_t offset = STR_NOT_FOUND_;
 	if (str.size >= substr.size) {
-		char* ptr = (char*)str.data;
-		char* end = (char*)str.data + str.size - substr.size;
-		for (; ptr <= end; ptr++) {
-			if (memcmp(ptr, substr.data, substr.size) == 0) {
-				if (out_offset) *out_offset = (size_t)(ptr - str.data);
-				found = true;
-				break;
-			}
-		}
+		if (substr.size == 0) offset = 0;
+		else if (substr.size == 1) offset = STR_FindByte_(str.data, str.size, substr.data[0]);
+		else offset = STR_FindSubstring_(str, substr);
 	}
-
+	
+	bool found = offset != STR_NOT_FOUND_;
+	if (found && out_offset) *out_offset = offset;
 	STR_ProfExit();
 	return found;
 };
 
 STR_API bool STR_ContainsU(STR_View str, uint32_t codepoint) {
-	size_t i = 0;
-	for (uint32_t r; r = STR_NextCodepoint(str, &i);) {
-		if (r == codepoint) return true;
-	}
-	return false;
+	size_t offset;
+	return STR_FindFirst(str, codepoint, &offset);
 }
 
 STR_API bool STR_EndsWith(STR_View str, STR_View end) {
@@ -618,6 +771,212 @@ STR_API STR_View STR_FloatToStr(void* allocator, double value, int min_decimals)
 	return STR_Clone(allocator, value_str);
 }
 
+// -- Shortest float32 printing ------------------------------------------------
+// Based on Ryu by Ulf Adams (https://github.com/ulfjack/ryu; Apache 2.0 / Boost license).
+// The tables hold 5^i and 2^k/5^i rounded to 61 and 59+ significant bits.
+
+#define STR_FLOAT_POW5_INV_BITCOUNT 59
+#define STR_FLOAT_POW5_BITCOUNT 61
+
+static const uint64_t STR_FLOAT_POW5_INV_SPLIT[31] = {
+	0x0800000000000001, 0x0666666666666667, 0x051EB851EB851EB9, 0x04189374BC6A7EFA,
+	0x068DB8BAC710CB2A, 0x053E2D6238DA3C22, 0x0431BDE82D7B634E, 0x06B5FCA6AF2BD216,
+	0x055E63B88C230E78, 0x044B82FA09B5A52D, 0x06DF37F675EF6EAE, 0x057F5FF85E592558,
+	0x0465E6604B7A8447, 0x0709709A125DA071, 0x05A126E1A84AE6C1, 0x0480EBE7B9D58567,
+	0x0734ACA5F6226F0B, 0x05C3BD5191B525A3, 0x049C97747490EAE9, 0x0760F253EDB4AB0E,
+	0x05E72843249088D8, 0x04B8ED0283A6D3E0, 0x078E480405D7B966, 0x060B6CD004AC9452,
+	0x04D5F0A66A23A9DB, 0x07BCB43D769F762B, 0x063090312BB2C4EF, 0x04F3A68DBC8F03F3,
+	0x07EC3DAF94180651, 0x065697BFA9ACD1DA, 0x051212FFBAF0A7E2,
+};
+
+static const uint64_t STR_FLOAT_POW5_SPLIT[48] = {
+	0x1000000000000000, 0x1400000000000000, 0x1900000000000000, 0x1F40000000000000,
+	0x1388000000000000, 0x186A000000000000, 0x1E84800000000000, 0x1312D00000000000,
+	0x17D7840000000000, 0x1DCD650000000000, 0x12A05F2000000000, 0x174876E800000000,
+	0x1D1A94A200000000, 0x12309CE540000000, 0x16BCC41E90000000, 0x1C6BF52634000000,
+	0x11C37937E0800000, 0x16345785D8A00000, 0x1BC16D674EC80000, 0x1158E460913D0000,
+	0x15AF1D78B58C4000, 0x1B1AE4D6E2EF5000, 0x10F0CF064DD59200, 0x152D02C7E14AF680,
+	0x1A784379D99DB420, 0x108B2A2C28029094, 0x14ADF4B7320334B9, 0x19D971E4FE8401E7,
+	0x1027E72F1F128130, 0x1431E0FAE6D7217C, 0x193E5939A08CE9DB, 0x1F8DEF8808B02452,
+	0x13B8B5B5056E16B3, 0x18A6E32246C99C60, 0x1ED09BEAD87C0378, 0x13426172C74D822B,
+	0x1812F9CF7920E2B6, 0x1E17B84357691B64, 0x12CED32A16A1B11E, 0x178287F49C4A1D66,
+	0x1D6329F1C35CA4BF, 0x125DFA371A19E6F7, 0x16F578C4E0A060B5, 0x1CB2D6F618C878E3,
+	0x11EFC659CF7D4B8D, 0x166BB7F0435C9E71, 0x1C06A5EC5433C60D, 0x118427B3B4A05BC8,
+};
+
+static inline int32_t STR_Pow5Bits_(int32_t e) { return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1; } // ceil(log2(5^e)), or 1 for e = 0
+static inline uint32_t STR_Log10Pow2_(int32_t e) { return ((uint32_t)e * 78913) >> 18; } // floor(log10(2^e))
+static inline uint32_t STR_Log10Pow5_(int32_t e) { return ((uint32_t)e * 732923) >> 20; } // floor(log10(5^e))
+
+static inline bool STR_MultipleOfPowerOf5_(uint32_t value, uint32_t p) {
+	uint32_t count = 0;
+	for (; value % 5 == 0; value /= 5) count++;
+	return count >= p;
+}
+
+static inline uint32_t STR_MulShift_(uint32_t m, uint64_t factor, int32_t shift) {
+	uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+	uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+	uint64_t sum = (bits0 >> 32) + bits1;
+	return (uint32_t)(sum >> (shift - 32));
+}
+
+STR_API size_t STR_Float32ToStrBufShortest(char* buffer, float value) {
+	STR_ProfEnter();
+	size_t offset = 0;
+
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+	uint32_t ieee_mantissa = bits & ((1u << 23) - 1);
+	uint32_t ieee_exponent = (bits >> 23) & 0xFF;
+	bool sign = (bits >> 31) != 0;
+
+	if (ieee_exponent == 0xFF) {
+		if (ieee_mantissa) {
+			memcpy(buffer, "nan", 3), offset += 3;
+		}
+		else {
+			if (sign) buffer[offset++] = '-';
+			memcpy(buffer + offset, "inf", 3), offset += 3;
+		}
+		STR_ProfExit();
+		return offset;
+	}
+	if (sign) buffer[offset++] = '-';
+
+	uint32_t output = 0;
+	int32_t exponent = 0; // the value is output * 10^exponent
+	if (ieee_exponent != 0 || ieee_mantissa != 0) {
+		int32_t e2;
+		uint32_t m2;
+		if (ieee_exponent == 0) {
+			e2 = 1 - 127 - 23 - 2;
+			m2 = ieee_mantissa;
+		}
+		else {
+			e2 = (int32_t)ieee_exponent - 127 - 23 - 2;
+			m2 = (1u << 23) | ieee_mantissa;
+		}
+		bool accept_bounds = (m2 & 1) == 0;
+
+		// Determine the interval of values that round to this float, scaled by 4
+		uint32_t mv = 4 * m2;
+		uint32_t mp = 4 * m2 + 2;
+		uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+		uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+		// Convert the interval to a decimal exponent
+		uint32_t vr, vp, vm;
+		int32_t e10;
+		bool vm_is_trailing_zeros = false, vr_is_trailing_zeros = false;
+		uint8_t last_removed_digit = 0;
+		if (e2 >= 0) {
+			uint32_t q = STR_Log10Pow2_(e2);
+			e10 = (int32_t)q;
+			int32_t k = STR_FLOAT_POW5_INV_BITCOUNT + STR_Pow5Bits_((int32_t)q) - 1;
+			int32_t i = -e2 + (int32_t)q + k;
+			vr = STR_MulShift_(mv, STR_FLOAT_POW5_INV_SPLIT[q], i);
+			vp = STR_MulShift_(mp, STR_FLOAT_POW5_INV_SPLIT[q], i);
+			vm = STR_MulShift_(mm, STR_FLOAT_POW5_INV_SPLIT[q], i);
+			if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+				// We need to know one removed digit even if we are not going to loop below
+				int32_t l = STR_FLOAT_POW5_INV_BITCOUNT + STR_Pow5Bits_((int32_t)(q - 1)) - 1;
+				last_removed_digit = (uint8_t)(STR_MulShift_(mv, STR_FLOAT_POW5_INV_SPLIT[q - 1], -e2 + (int32_t)q - 1 + l) % 10);
+			}
+			if (q <= 9) {
+				// Only one of mp, mv and mm can be a multiple of 5, if any
+				if (mv % 5 == 0) vr_is_trailing_zeros = STR_MultipleOfPowerOf5_(mv, q);
+				else if (accept_bounds) vm_is_trailing_zeros = STR_MultipleOfPowerOf5_(mm, q);
+				else vp -= STR_MultipleOfPowerOf5_(mp, q);
+			}
+		}
+		else {
+			uint32_t q = STR_Log10Pow5_(-e2);
+			e10 = (int32_t)q + e2;
+			int32_t i = -e2 - (int32_t)q;
+			int32_t k = STR_Pow5Bits_(i) - STR_FLOAT_POW5_BITCOUNT;
+			int32_t j = (int32_t)q - k;
+			vr = STR_MulShift_(mv, STR_FLOAT_POW5_SPLIT[i], j);
+			vp = STR_MulShift_(mp, STR_FLOAT_POW5_SPLIT[i], j);
+			vm = STR_MulShift_(mm, STR_FLOAT_POW5_SPLIT[i], j);
+			if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+				j = (int32_t)q - 1 - (STR_Pow5Bits_(i + 1) - STR_FLOAT_POW5_BITCOUNT);
+				last_removed_digit = (uint8_t)(STR_MulShift_(mv, STR_FLOAT_POW5_SPLIT[i + 1], j) % 10);
+			}
+			if (q <= 1) {
+				// mv has at least q trailing zero bits, since it's a multiple of 4
+				vr_is_trailing_zeros = true;
+				if (accept_bounds) vm_is_trailing_zeros = mm_shift == 1;
+				else vp--;
+			}
+			else if (q < 31) {
+				vr_is_trailing_zeros = (mv & ((1u << (q - 1)) - 1)) == 0;
+			}
+		}
+
+		// Find the shortest representation in the interval
+		int32_t removed = 0;
+		if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+			for (; vp / 10 > vm / 10; removed++) {
+				vm_is_trailing_zeros &= vm % 10 == 0;
+				vr_is_trailing_zeros &= last_removed_digit == 0;
+				last_removed_digit = (uint8_t)(vr % 10);
+				vr /= 10; vp /= 10; vm /= 10;
+			}
+			if (vm_is_trailing_zeros) {
+				for (; vm % 10 == 0; removed++) {
+					vr_is_trailing_zeros &= last_removed_digit == 0;
+					last_removed_digit = (uint8_t)(vr % 10);
+					vr /= 10; vp /= 10; vm /= 10;
+				}
+			}
+			if (vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+				last_removed_digit = 4; // round to even if the exact value is .....50..0
+			}
+			output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) || last_removed_digit >= 5);
+		}
+		else {
+			for (; vp / 10 > vm / 10; removed++) {
+				last_removed_digit = (uint8_t)(vr % 10);
+				vr /= 10; vp /= 10; vm /= 10;
+			}
+			output = vr + (vr == vm || last_removed_digit >= 5);
+		}
+		exponent = e10 + removed;
+	}
+
+	// Print the digits in plain decimal notation
+	char digits[10];
+	int32_t digits_count = 0;
+	do {
+		digits[9 - digits_count++] = '0' + (char)(output % 10);
+		output /= 10;
+	} while (output);
+	const char* digits_start = digits + 10 - digits_count;
+
+	int32_t point = digits_count + exponent; // number of digits before the decimal point
+	if (point <= 0) {
+		buffer[offset++] = '0';
+		buffer[offset++] = '.';
+		memset(buffer + offset, '0', -point), offset += -point;
+		memcpy(buffer + offset, digits_start, digits_count), offset += digits_count;
+	}
+	else if (point >= digits_count) {
+		memcpy(buffer + offset, digits_start, digits_count), offset += digits_count;
+		memset(buffer + offset, '0', point - digits_count), offset += point - digits_count;
+		buffer[offset++] = '.';
+		buffer[offset++] = '0';
+	}
+	else {
+		memcpy(buffer + offset, digits_start, point), offset += point;
+		buffer[offset++] = '.';
+		memcpy(buffer + offset, digits_start + point, digits_count - point), offset += digits_count - point;
+	}
+
+	STR_ProfExit();
+	return offset;
+}
+
 STR_API STR_View STR_IntToStr(void* allocator, int value) { return STR_IntToStrEx(allocator, value, true, 10); }
 
 STR_API STR_View STR_IntToStrEx(void* allocator, uint64_t data, bool is_signed, int radix) {
@@ -704,15 +1063,78 @@ STR_API uint32_t STR_PrevCodepoint(STR_View str, size_t* byteoffset) {
 
 STR_API size_t STR_CodepointCount(STR_View str) {
 	STR_ProfEnter();
+	// Count the bytes that start a codepoint, i.e. everything except 10xxxxxx.
+	// As signed bytes, the continuation bytes are exactly the ones in [-128, -65].
 	size_t count = 0;
 	size_t i = 0;
-	for (uint32_t r; r = STR_NextCodepoint(str, &i);) {
-		count++;
+#ifdef STR_USE_AVX2
+	__m256i threshold_x32 = _mm256_set1_epi8(-65);
+	for (; i + 32 <= str.size; i += 32) {
+		__m256i chunk = _mm256_loadu_si256((const __m256i*)(str.data + i));
+		count += STR_PopCount32_((uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(chunk, threshold_x32)));
 	}
+#endif
+#ifdef STR_USE_SSE2
+	__m128i threshold_x16 = _mm_set1_epi8(-65);
+	for (; i + 16 <= str.size; i += 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)(str.data + i));
+		count += STR_PopCount32_((uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(chunk, threshold_x16)));
+	}
+#endif
+	for (; i < str.size; i++) {
+		count += STR_IsUtf8FirstByte(str.data[i]);
+	}
+	
+	// STR_NextCodepoint treats stray continuation bytes at the start as one codepoint
+	if (str.size > 0 && !STR_IsUtf8FirstByte(str.data[0])) count++;
 	STR_ProfExit();
 	return count;
 }
 
+STR_API bool STR_IsValidUTF8(STR_View str) {
+	STR_ProfEnter();
+	const uint8_t* data = (const uint8_t*)str.data;
+	bool valid = true;
+	for (size_t i = 0; i < str.size;) {
+		// Skip over ASCII a chunk at a time, since that's what most text is
+#ifdef STR_USE_AVX2
+		for (; i + 32 <= str.size; i += 32) {
+			if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(data + i))) != 0) break;
+		}
+#endif
+#ifdef STR_USE_SSE2
+		for (; i + 16 <= str.size; i += 16) {
+			if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + i))) != 0) break;
+		}
+#endif
+		if (i >= str.size) break;
+
+		uint8_t c = data[i];
+		if (c < 0x80) {
+			i++;
+			continue;
+		}
+
+		size_t size;
+		uint32_t codepoint, min_codepoint;
+		if ((c & 0xE0) == 0xC0)      { size = 2; codepoint = c & 0x1F; min_codepoint = 0x80; }
+		else if ((c & 0xF0) == 0xE0) { size = 3; codepoint = c & 0x0F; min_codepoint = 0x800; }
+		else if ((c & 0xF8) == 0xF0) { size = 4; codepoint = c & 0x07; min_codepoint = 0x10000; }
+		else { valid = false; break; }
+
+		if (i + size > str.size) { valid = false; break; }
+		for (size_t j = 1; j < size; j++) {
+			if ((data[i + j] & 0xC0) != 0x80) valid = false;
+			codepoint = (codepoint << 6) | (data[i + j] & 0x3F);
+		}
+		if (codepoint < min_codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) valid = false;
+		if (!valid) break;
+		i += size;
+	}
+	STR_ProfExit();
+	return valid;
+}
+
 // https://graphitemaster.github.io/aau/#unsigned-multiplication-can-overflow
 inline bool DoesMulOverflow(uint64_t x, uint64_t y) { return y && x > ((uint64_t)-1) / y; }
 inline bool DoesAddOverflow(uint64_t x, uint64_t y) { return x + y < x; }
@@ -777,7 +1199,7 @@ STR_API bool STR_ParseI64Ex(STR_View s, int base, int64_t* out_value) {
 STR_API const char* STR_CloneC(void* allocator, const char* str) {
 	size_t size = strlen(str) + 1;
 	char* data = (char*)STR_MemAlloc(allocator, size);
-	strcpy_s(data, size, str);
+	memcpy(data, str, size);
 	return data;
 }
 
@@ -806,128 +1228,208 @@ STR_API void STR_Free(void* allocator, STR_View str) {
 	STR_MemFree(allocator, str.data);
 }
 
-static double STR_ToFloat_(const char* str, int* success) {
-	// CREDIT: Michael Hartmann (https://github.com/michael-hartmann/parsefloat/blob/master/strtodouble.c; public domain)
-
-	double intpart = 0, fracpart = 0;
-	int sign = +1, size = 0, conversion = 0, exponent = 0;
-
-	// skip whitespace
-	//while(isspace(*str)) str++;
-
-	// check for sign (optional; either + or -)
-	if (*str == '-') {
-		sign = -1;
-		str++;
+// Decimal number split into its leading significant digits and a base-10 exponent
+typedef struct STR_DecimalFloat_ {
+	uint64_t mantissa; // up to 19 leading significant digits
+	int64_t exponent;
+	bool negative;
+	bool truncated; // true if there are nonzero digits beyond the ones in `mantissa`
+	bool is_nan;
+	bool is_inf;
+} STR_DecimalFloat_;
+
+#define STR_MAX_PARSED_EXPONENT_ 100000 // larger exponents are clamped, since they overflow or underflow anyway
+
+static bool STR_ParseDecimalFloat_(STR_View s, STR_DecimalFloat_* out) {
+	STR_DecimalFloat_ result = {0};
+	const char* p = s.data;
+	const char* end = s.data + s.size;
+
+	if (p < end && (*p == '-' || *p == '+')) {
+		result.negative = *p == '-';
+		p++;
 	}
-	else if (*str == '+') str++;
 
 	// check for nan and inf
-	if (STR_CodepointToLower(str[0]) == 'n' && STR_CodepointToLower(str[1]) == 'a' && STR_CodepointToLower(str[2]) == 'n') {
-		if (success != NULL) *success = 1;
-		return NAN;
-	}
-	if (STR_CodepointToLower(str[0]) == 'i' && STR_CodepointToLower(str[1]) == 'n' && STR_CodepointToLower(str[2]) == 'f') {
-		if (success != NULL) *success = 1;
-		return sign * INFINITY;
+	if (end - p >= 3) {
+		if (STR_CodepointToLower(p[0]) == 'n' && STR_CodepointToLower(p[1]) == 'a' && STR_CodepointToLower(p[2]) == 'n') {
+			result.is_nan = true;
+			*out = result;
+			return true;
+		}
+		if (STR_CodepointToLower(p[0]) == 'i' && STR_CodepointToLower(p[1]) == 'n' && STR_CodepointToLower(p[2]) == 'f') {
+			result.is_inf = true;
+			*out = result;
+			return true;
+		}
 	}
 
-	// find number of digits before decimal point
-	{
-		const char* p = str;
-		size = 0;
-		while (*p >= '0' && *p <= '9') {
-			p++;
-			size++;
+	int digits_count = 0;
+	int significant_digits = 0;
+	for (; p < end && *p >= '0' && *p <= '9'; p++, digits_count++) {
+		if (significant_digits < 19) {
+			result.mantissa = result.mantissa * 10 + (uint64_t)(*p - '0');
+			if (result.mantissa != 0) significant_digits++;
+		}
+		else {
+			result.truncated |= *p != '0';
+			result.exponent++;
 		}
 	}
 
-	if (size) conversion = 1;
-
-	// convert intpart part of decimal point to a float
-	{
-		double f = 1;
-		for (size_t i = 0; i < size; i++) {
-			int v = str[size - 1 - i] - '0';
-			intpart += v * f;
-			f *= 10;
+	if (p < end && *p == '.') {
+		p++;
+		for (; p < end && *p >= '0' && *p <= '9'; p++, digits_count++) {
+			if (significant_digits < 19) {
+				result.mantissa = result.mantissa * 10 + (uint64_t)(*p - '0');
+				if (result.mantissa != 0) significant_digits++;
+				result.exponent--;
+			}
+			else {
+				result.truncated |= *p != '0';
+			}
 		}
-		str += size;
 	}
 
-	// check for decimal point (optional)
-	if (*str == '.') {
-		const char* p = ++str;
+	if (digits_count == 0) return false;
 
-		// find number of digits after decimal point
-		size = 0;
-		while (*p >= '0' && *p <= '9') {
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool exponent_negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			exponent_negative = *p == '-';
 			p++;
-			size++;
 		}
 
-		if (size) conversion = 1;
-
-		// convert fracpart part of decimal point to a float
-		double f = 0.1;
-		for (size_t i = 0; i < size; i++) {
-			int v = str[i] - '0';
-			fracpart += v * f;
-			f *= 0.1;
+		int64_t exponent = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (exponent < STR_MAX_PARSED_EXPONENT_) exponent = exponent * 10 + (*p - '0');
 		}
-
-		str = p;
+		result.exponent += exponent_negative ? -exponent : exponent;
 	}
 
-	if (conversion && (*str == 'e' || *str == 'E')) {
-		int expsign = +1;
-		const char* p = ++str;
+	*out = result;
+	return true;
+}
 
-		if (*p == '+') p++;
-		else if (*p == '-') {
-			expsign = -1;
-			p++;
+// Exact fallback for the cases that the fast path doesn't cover. Passes at most 768 significant digits to strtod,
+// followed by a nonzero sticky digit if there were more, which is enough to decide the rounding of any double.
+// Only digits and an exponent are passed, because strtod uses the decimal point of the current C locale.
+// Returns the absolute value.
+static double STR_ParseFloatSlow_(STR_View s, bool to_float32) {
+	char buffer[800];
+	int buffer_size = 0;
+	int64_t exponent = 0;
+	bool truncated = false;
+	bool after_point = false;
+
+	const char* p = s.data;
+	const char* end = s.data + s.size;
+	if (p < end && (*p == '-' || *p == '+')) p++;
+
+	for (; p < end; p++) {
+		if (*p == '.' && !after_point) {
+			after_point = true;
+			continue;
 		}
+		if (*p < '0' || *p > '9') break;
 
-		str = p;
-		size = 0;
-		while (*p >= '0' && *p <= '9') {
-			size++;
-			p++;
+		if (*p == '0' && buffer_size == 0) { // leading zero
+			if (after_point) exponent--;
 		}
-
-		int f = 1;
-		for (size_t i = 0; i < size; i++) {
-			int v = str[size - 1 - i] - '0';
-			exponent += v * f;
-			f *= 10;
+		else if (buffer_size < 768) {
+			buffer[buffer_size++] = *p;
+			if (after_point) exponent--;
+		}
+		else {
+			truncated |= *p != '0';
+			if (!after_point) exponent++;
 		}
-
-		exponent *= expsign;
 	}
+	if (truncated) {
+		buffer[buffer_size++] = '1';
+		exponent--;
+	}
+	if (buffer_size == 0) buffer[buffer_size++] = '0';
 
-	if (!conversion) {
-		if (success) *success = 0;
-		return NAN;
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		p++;
+		bool exponent_negative = false;
+		if (p < end && (*p == '-' || *p == '+')) {
+			exponent_negative = *p == '-';
+			p++;
+		}
+		int64_t e = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (e < STR_MAX_PARSED_EXPONENT_) e = e * 10 + (*p - '0');
+		}
+		exponent += exponent_negative ? -e : e;
 	}
 
-	if (success) *success = 1;
+	buffer[buffer_size++] = 'e';
+	buffer_size += (int)STR_IntToStrBuf(buffer + buffer_size, (uint64_t)exponent, true, 10);
+	buffer[buffer_size] = 0;
+	return to_float32 ? (double)strtof(buffer, NULL) : strtod(buffer, NULL);
+}
+
+static const double STR_POWERS_OF_TEN_[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-	return sign * (intpart + fracpart) * pow(10.0, exponent);
+// Clinger's fast path: when both the mantissa and the power of ten are exactly representable as doubles,
+// a single multiplication or division gives the correctly rounded result.
+static bool STR_ParseFloatFast_(const STR_DecimalFloat_* d, double* out) {
+	if (d->truncated || d->mantissa > (1ull << 53) || d->exponent < -22 || d->exponent > 22) return false;
+	double value = (double)d->mantissa;
+	if (d->exponent < 0) value /= STR_POWERS_OF_TEN_[-d->exponent];
+	else value *= STR_POWERS_OF_TEN_[d->exponent];
+	*out = value;
+	return true;
 }
 
 STR_API bool STR_ParseFloat(STR_View s, double* out) {
 	STR_ProfEnter();
+	STR_DecimalFloat_ d;
+	bool ok = STR_ParseDecimalFloat_(s, &d);
+	if (ok) {
+		double value;
+		if (d.is_nan) value = NAN;
+		else if (d.is_inf) value = INFINITY;
+		else if (d.mantissa == 0) value = 0.;
+		else if (!STR_ParseFloatFast_(&d, &value)) value = STR_ParseFloatSlow_(s, false);
+		*out = d.negative ? -value : value;
+	}
+	STR_ProfExit();
+	return ok;
+}
 
-	STR_ASSERT(s.size < 63);
-	char cstr[64] = {0};
-	memcpy(cstr, s.data, s.size);
-
-	int success;
-	*out = STR_ToFloat_(cstr, &success);
-
+STR_API bool STR_ParseFloat32(STR_View s, float* out) {
+	STR_ProfEnter();
+	STR_DecimalFloat_ d;
+	bool ok = STR_ParseDecimalFloat_(s, &d);
+	if (ok) {
+		float value;
+		double value_f64;
+		if (d.is_nan) value = NAN;
+		else if (d.is_inf) value = INFINITY;
+		else if (d.mantissa == 0) value = 0.f;
+		else if (STR_ParseFloatFast_(&d, &value_f64)) {
+			// Rounding the correctly rounded double to float gives the correctly rounded float, unless the double
+			// lands exactly halfway between two floats, in which case the exact value may be on either side.
+			value = (float)value_f64;
+			if ((double)value != value_f64) {
+				double other = (double)nextafterf(value, (double)value < value_f64 ? INFINITY : -INFINITY);
+				if (other - value_f64 == value_f64 - (double)value) {
+					value = (float)STR_ParseFloatSlow_(s, true);
+				}
+			}
+		}
+		else value = (float)STR_ParseFloatSlow_(s, true);
+		*out = d.negative ? -value : value;
+	}
 	STR_ProfExit();
-	return success == 1;
+	return ok;
 }
 
 STR_API STR_View STR_Replace(void* allocator, STR_View str, STR_View search_for, STR_View replace_with) {
@@ -935,19 +1437,16 @@ STR_API STR_View STR_Replace(void* allocator, STR_View str, STR_View search_for,
 	STR_ProfEnter();
 
 	STR_Builder builder = { allocator };
-
-	size_t last = str.size - search_for.size;
-	for (size_t i = 0; i <= last;) {
-		if (memcmp(str.data + i, search_for.data, search_for.size) == 0) {
-			STR_Print(&builder, replace_with);
-			i += search_for.size;
-		}
-		else {
-			STR_View char_str = { &str.data[i], 1 };
-			STR_Print(&builder, char_str);
-			i++;
-		}
+	STR_BuilderReserve(&builder, str.size);
+
+	// Copy the text between the matches in bulk
+	STR_View remaining = str;
+	for (size_t offset; search_for.size > 0 && STR_Find(remaining, search_for, &offset);) {
+		STR_Print(&builder, STR_SliceBefore(remaining, offset));
+		STR_Print(&builder, replace_with);
+		remaining = STR_SliceAfter(remaining, offset + search_for.size);
 	}
+	STR_Print(&builder, remaining);
 	STR_ProfExit();
 	return builder.str;
 }
@@ -958,29 +1457,41 @@ STR_API STR_View STR_ReplaceMulti(void* allocator, STR_View str, STR_Array searc
 	size_t n = search_for.size;
 
 	STR_Builder builder = { allocator };
+	STR_BuilderReserve(&builder, str.size);
+
+	// Only positions that start with the first byte of some search string need to be checked
+	bool is_first_byte[256] = {0};
+	for (size_t j = 0; j < n; j++) {
+		STR_View search_for_j = ((STR_View*)search_for.data)[j];
+		if (search_for_j.size > 0) is_first_byte[(uint8_t)search_for_j.data[0]] = true;
+	}
 
+	size_t run_start = 0; // start of the text that hasn't been copied yet
 	for (size_t i = 0; i < str.size;) {
+		if (!is_first_byte[(uint8_t)str.data[i]]) {
+			i++;
+			continue;
+		}
 
 		bool replaced = false;
 		for (size_t j = 0; j < n; j++) {
 			STR_View search_for_j = ((STR_View*)search_for.data)[j];
-			if (i + search_for_j.size > str.size) continue;
+			if (search_for_j.size == 0 || i + search_for_j.size > str.size) continue;
 
 			if (memcmp(str.data + i, search_for_j.data, search_for_j.size) == 0) {
 				STR_View replace_with_j = ((STR_View*)replace_with.data)[j];
+				STR_Print(&builder, STR_Slice(str, run_start, i));
 				STR_Print(&builder, replace_with_j);
 				i += search_for_j.size;
+				run_start = i;
 				replaced = true;
 				break;
 			}
 		}
 
-		if (!replaced) {
-			STR_View char_str = { &str.data[i], 1 };
-			STR_Print(&builder, char_str);
-			i++;
-		}
+		if (!replaced) i++;
 	}
+	STR_Print(&builder, STR_SliceAfter(str, run_start));
 	STR_ProfExit();
 	return builder.str;
 }
@@ -1080,21 +1591,28 @@ STR_API void STR_PrintVA(STR_Builder* s, const char* fmt, va_list args) {
 	}
 }
 
+// Formatted strings are first printed into a stack buffer, so that short strings only need a single, exactly-sized allocation.
+#define STR_FORM_BUFFER_SIZE 256
+
 STR_API const char* STR_FormC(void* allocator, const char* fmt, ...) {
 	va_list args; va_start(args, fmt);
-	STR_Builder builder = { allocator };
+	char buffer[STR_FORM_BUFFER_SIZE];
+	STR_Builder builder;
+	STR_BuilderInitBuffer(&builder, allocator, buffer, sizeof(buffer));
 	STR_PrintVA(&builder, fmt, args);
 	STR_PrintU(&builder, 0); // null-terminate
 	va_end(args);
-	return builder.str.data;
+	return builder.str_is_in_buffer ? STR_Clone(allocator, builder.str).data : builder.str.data;
 }
 
 STR_API STR_View STR_Form(void* allocator, const char* fmt, ...) {
 	va_list args; va_start(args, fmt);
-	STR_Builder builder = { allocator };
+	char buffer[STR_FORM_BUFFER_SIZE];
+	STR_Builder builder;
+	STR_BuilderInitBuffer(&builder, allocator, buffer, sizeof(buffer));
 	STR_PrintVA(&builder, fmt, args);
 	va_end(args);
-	return builder.str;
+	return builder.str_is_in_buffer ? STR_Clone(allocator, builder.str) : builder.str;
 }
 
 STR_API void STR_BuilderInit(STR_Builder* s, void* allocator) {
@@ -1103,7 +1621,27 @@ STR_API void STR_BuilderInit(STR_Builder* s, void* allocator) {
 }
 
 STR_API void STR_BuilderDeinit(STR_Builder* s) {
-	STR_Free(s->allocator, s->str);
+	if (!s->str_is_in_buffer) STR_Free(s->allocator, s->str);
+}
+
+STR_API void STR_BuilderInitBuffer(STR_Builder* s, void* allocator, char* buffer, size_t buffer_size) {
+	STR_Builder result = {allocator};
+	result.str.data = buffer;
+	result.capacity = buffer_size;
+	result.str_is_in_buffer = true;
+	*s = result;
+}
+
+STR_API void STR_BuilderReserve(STR_Builder* s, size_t capacity) {
+	if (capacity <= s->capacity) return;
+
+	char* new_memory = (char*)STR_MemAlloc(s->allocator, capacity);
+	memcpy(new_memory, s->str.data, s->str.size);
+	if (!s->str_is_in_buffer) STR_MemFree(s->allocator, s->str.data);
+
+	s->str.data = new_memory;
+	s->capacity = capacity;
+	s->str_is_in_buffer = false;
 }
 
 STR_API void STR_Print(STR_Builder* s, STR_View string) {
@@ -1113,16 +1651,7 @@ STR_API void STR_Print(STR_Builder* s, STR_View string) {
 	while (new_size > capacity) {
 		capacity = capacity == 0 ? 8 : capacity * 2;
 	}
-
-	// Resize string if necessary
-	if (capacity != s->capacity) {
-		char* new_memory = (char*)STR_MemAlloc(s->allocator, capacity);
-		memcpy(new_memory, s->str.data, s->str.size);
-		STR_MemFree(s->allocator, s->str.data);
-		
-		s->str.data = new_memory;
-		s->capacity = capacity;
-	}
+	STR_BuilderReserve(s, capacity);
 
 	memcpy((char*)s->str.data + s->str.size, string.data, string.size);
 	s->str.size = new_size;
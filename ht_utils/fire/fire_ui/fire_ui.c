@@ -1,10 +1,5 @@
 #include "fire_ui.h"
 
-// -- Global state ---------
-UI_API UI_State UI_STATE;
-UI_API DS_Arena* UI_TEMP;
-// -------------------------
-
 #define UI_TODO() __debugbreak()
 
 UI_API bool UI_MarkGreaterThan(UI_Mark a, UI_Mark b) { return a.line > b.line || (a.line == b.line && a.col > b.col); }
@@ -458,8 +458,10 @@ typedef struct UI_SplittersState {
 static const UI_Vec2 UI_DEFAULT_TEXT_PADDING = { 10.f, 5.f };
 
 // -- Global state -------
-UI_EXTERN UI_State UI_STATE;
-UI_EXTERN DS_Arena* UI_TEMP; // Temporary arena for per-frame allocations
+// With the default UI_API these are declarations only and the user defines them. With `#define UI_API static`, this is the
+// definition, so fire_ui.c doesn't repeat it (GCC and Clang reject an extern declaration followed by a static definition).
+UI_API UI_State UI_STATE;
+UI_API DS_Arena* UI_TEMP; // Temporary arena for per-frame allocations
 // -----------------------
 
 static inline bool UI_InputIsDown(UI_Input input)               { return UI_STATE.input_is_down[input]; }
@@ -1,3 +1,4 @@
+#pragma once
 
 static inline bool InputIsDown(const HT_InputFrame* in, HT_InputKey key);
 static inline bool InputWentDown(const HT_InputFrame* in, HT_InputKey key);
@@ -47,3 +47,41 @@ project "hatch-gen"
 	filter "configurations:Release"
 		optimize "On"
 
+
+project "hatch-headless"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++17"
+	targetdir ".build"
+	
+	includedirs "."
+	
+	files "ht_editor_source/main_headless.cpp"
+	files "ht_editor_source/ht_data_model.cpp"
+	files "ht_editor_source/ht_dependencies.cpp"
+	files "ht_editor_source/ht_md_reader.cpp"
+	files "ht_editor_source/ht_names.cpp"
+	files "ht_editor_source/ht_plugin_compiler.cpp"
+	files "ht_editor_source/ht_serialize.cpp"
+	files "ht_editor_source/ht_snapshot.cpp"
+	files "ht_editor_source/ht_libs_impl.c"
+	files "ht_editor_source/third_party/md.c"
+	
+	defines "HT_HEADLESS"
+	defines "HT_ALL_STATIC_EXPORTS="
+	defines { "HATCH_DIR=\"" .. path.getabsolute(".") .. "\"" }
+	
+	filter "system:windows"
+		specify_warnings()
+		files { "ht_editor_source/utils/os_misc.c", "ht_editor_source/utils/os_directory_watch.c" }
+	
+	filter "system:not windows"
+		files { "ht_editor_source/utils/os_misc_posix.c", "ht_editor_source/utils/os_directory_watch_posix.c" }
+		links { "pthread", "dl" }
+		linkoptions "-rdynamic" -- plugins compiled with --compile-plugins import HT_LogInfo etc. from the executable
+	
+	filter "configurations:Debug"
+		symbols "On"
+
+	filter "configurations:Release"
+		optimize "On"